@@ -108,6 +108,58 @@ namespace pcpp
 	 */
 	uint16_t compute_checksum(ScalarBuffer<uint16_t> vec[], size_t vecSize);
 
+	/**
+	 * An enum of the implementations of the one's complement sum used by compute_checksum()
+	 */
+	enum ChecksumImplementation
+	{
+		/** A portable implementation which sums 32-bit words into a 64-bit accumulator */
+		ChecksumPortable,
+		/** An SSE2 implementation (x86 and x86-64 only) */
+		ChecksumSSE2,
+		/** An AVX2 implementation (x86 and x86-64 only) */
+		ChecksumAVX2
+	};
+
+	/**
+	 * Get the implementation compute_checksum() currently uses. By default it's the fastest implementation the CPU supports,
+	 * which is detected at runtime the first time a checksum is computed
+	 * @return The current checksum implementation
+	 */
+	ChecksumImplementation getChecksumImplementation();
+
+	/**
+	 * Set the implementation compute_checksum() uses. All implementations give identical results, so this is only useful for
+	 * testing and benchmarking. Notice this setting is global and isn't thread-safe
+	 * @param[in] implementation The implementation to use
+	 * @return True if the implementation was set or false if it isn't supported by this CPU or build
+	 */
+	bool setChecksumImplementation(ChecksumImplementation implementation);
+
+	/**
+	 * Update an Internet checksum after a 16-bit word of the data it covers has changed, without computing it again over the
+	 * whole data (RFC 1624, eqn. 3). The checksum and the values are given as they appear in the packet (network byte order).
+	 * The result is identical to the result of compute_checksum() on the modified data, assuming the original checksum was
+	 * correct
+	 * @param[in] checksum The current checksum as it appears in the packet
+	 * @param[in] oldValue The old value of the modified word as it appears in the packet
+	 * @param[in] newValue The new value of the modified word as it appears in the packet
+	 * @return The updated checksum, to be written to the packet as is
+	 */
+	uint16_t update_checksum(uint16_t checksum, uint16_t oldValue, uint16_t newValue);
+
+	/**
+	 * Update an Internet checksum after a range of the data it covers has changed (for example an IPv4 or IPv6 address). The
+	 * cost depends only on the length of the modified range. See update_checksum(uint16_t, uint16_t, uint16_t)
+	 * @param[in] checksum The current checksum as it appears in the packet
+	 * @param[in] oldData The old content of the modified range
+	 * @param[in] newData The new content of the modified range
+	 * @param[in] dataLen The length of the modified range in bytes. Must be even and the range must start at an even offset of
+	 * the checksummed data
+	 * @return The updated checksum, to be written to the packet as is
+	 */
+	uint16_t update_checksum(uint16_t checksum, const uint8_t* oldData, const uint8_t* newData, size_t dataLen);
+
 	/**
 	 * Computes Fowler-Noll-Vo (FNV-1) 32bit hash function on an array of byte buffers. The hash is calculated on each
 	 * byte in each byte buffer, as if all byte buffers were one long byte buffer
@@ -62,6 +62,7 @@ namespace pcpp
 		PcapLogModuleMBufRawPacket, ///< MBufRawPacket module (Pcap++)
 		PcapLogModuleDpdkDevice, ///< DpdkDevice module (Pcap++)
 		PcapLogModuleKniDevice, ///< KniDevice module (Pcap++)
+		PcapLogModuleShardedTcpReassembly, ///< ShardedTcpReassembly module (Pcap++)
 		NetworkUtils, ///< NetworkUtils module (Pcap++)
 		NumOfLogModules
 	};
@@ -0,0 +1,205 @@
+#ifndef PCAPPP_SPSC_RING
+#define PCAPPP_SPSC_RING
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// @file
+
+/**
+ * The size in bytes pcpp#SpscRing assumes a cache line has. The producer's and the consumer's indices are kept this far apart so the
+ * two threads don't write to the same cache line
+ */
+#define PCPP_SPSC_RING_CACHE_LINE_SIZE 64
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class SpscRing
+	 * A bounded lock-free ring buffer that passes items of type T from one producer thread to one consumer thread. The producer and
+	 * the consumer never wait for each other and never take a lock: each of them owns one index of the ring, publishes it with release
+	 * semantics and reads the other one with acquire semantics. Each side also caches the last value it read of the other side's index,
+	 * so it touches the other side's cache line only when the ring looks full (or empty).<BR>
+	 * Items are accessed in place, which allows passing large items (for example packet buffers) without copying them into and out of
+	 * the ring: the producer fills the slot returned by reserve() and publishes it with commit(), and the consumer reads the slot
+	 * returned by front() and releases it with pop(). push() and the other overload of pop() are shortcuts that copy an item.<BR>
+	 * The slots are allocated once when the ring is constructed and are reused, so T must be default constructible. The capacity is
+	 * rounded up to a power of 2. At any time only one thread may call the producer methods and only one thread may call the consumer
+	 * methods. The ring can't be copied
+	 */
+	template<typename T>
+	class SpscRing
+	{
+	public:
+
+		/**
+		 * A c'tor for this class
+		 * @param[in] capacity The number of items the ring can hold. It's rounded up to a power of 2 (and to at least 2)
+		 */
+		explicit SpscRing(size_t capacity)
+		{
+			m_Capacity = 2;
+			while (m_Capacity < capacity)
+				m_Capacity <<= 1;
+			m_Mask = m_Capacity - 1;
+			m_Slots = new T[m_Capacity];
+			m_Head = 0;
+			m_Tail = 0;
+			m_ProducerCachedHead = 0;
+			m_ConsumerCachedTail = 0;
+		}
+
+		/**
+		 * A d'tor for this class. Frees the slots, items that weren't popped are destructed
+		 */
+		~SpscRing() { delete [] m_Slots; }
+
+		/**
+		 * @return The number of items the ring can hold
+		 */
+		size_t capacity() const { return m_Capacity; }
+
+		/**
+		 * @return The number of items in the ring. When called while the other thread uses the ring the value may be outdated by the
+		 * time it's returned
+		 */
+		size_t size() const { return loadAcquire(&m_Tail) - loadAcquire(&m_Head); }
+
+		/**
+		 * @return True if the ring has no items. When called while the other thread uses the ring the value may be outdated by the
+		 * time it's returned
+		 */
+		bool empty() const { return size() == 0; }
+
+		/**
+		 * Producer: get the next free slot of the ring. The slot isn't visible to the consumer until commit() is called. Calling
+		 * reserve() again before commit() returns the same slot
+		 * @return A pointer to the free slot or NULL if the ring is full
+		 */
+		T* reserve()
+		{
+			size_t tail = m_Tail;
+			if (tail - m_ProducerCachedHead >= m_Capacity)
+			{
+				m_ProducerCachedHead = loadAcquire(&m_Head);
+				if (tail - m_ProducerCachedHead >= m_Capacity)
+					return NULL;
+			}
+
+			return &m_Slots[tail & m_Mask];
+		}
+
+		/**
+		 * Producer: publish the slot returned by the last call to reserve() to the consumer
+		 */
+		void commit() { storeRelease(&m_Tail, m_Tail + 1); }
+
+		/**
+		 * Producer: copy an item into the ring
+		 * @param[in] item The item to copy
+		 * @return False if the ring is full, true otherwise
+		 */
+		bool push(const T& item)
+		{
+			T* slot = reserve();
+			if (slot == NULL)
+				return false;
+
+			*slot = item;
+			commit();
+			return true;
+		}
+
+		/**
+		 * Consumer: get the oldest item of the ring. The item stays in the ring (and its slot isn't reused by the producer) until pop()
+		 * is called
+		 * @return A pointer to the oldest item or NULL if the ring is empty
+		 */
+		T* front()
+		{
+			size_t head = m_Head;
+			if (head == m_ConsumerCachedTail)
+			{
+				m_ConsumerCachedTail = loadAcquire(&m_Tail);
+				if (head == m_ConsumerCachedTail)
+					return NULL;
+			}
+
+			return &m_Slots[head & m_Mask];
+		}
+
+		/**
+		 * Consumer: remove the oldest item of the ring, meaning the item returned by front(), and give its slot back to the producer.
+		 * Must be called only if front() returned an item
+		 */
+		void pop() { storeRelease(&m_Head, m_Head + 1); }
+
+		/**
+		 * Consumer: copy the oldest item of the ring and remove it
+		 * @param[out] item The item to copy to
+		 * @return False if the ring is empty, true otherwise
+		 */
+		bool pop(T& item)
+		{
+			T* slot = front();
+			if (slot == NULL)
+				return false;
+
+			item = *slot;
+			pop();
+			return true;
+		}
+
+	private:
+		T* m_Slots;
+		size_t m_Capacity;
+		size_t m_Mask;
+		uint8_t m_Padding1[PCPP_SPSC_RING_CACHE_LINE_SIZE];
+
+		// written by the consumer: the index of the oldest item, and the last value the consumer read of m_Tail
+		size_t m_Head;
+		size_t m_ConsumerCachedTail;
+		uint8_t m_Padding2[PCPP_SPSC_RING_CACHE_LINE_SIZE];
+
+		// written by the producer: the index of the next free slot, and the last value the producer read of m_Head
+		size_t m_Tail;
+		size_t m_ProducerCachedHead;
+		uint8_t m_Padding3[PCPP_SPSC_RING_CACHE_LINE_SIZE];
+
+		SpscRing(const SpscRing& other);
+		SpscRing& operator=(const SpscRing& other);
+
+		static size_t loadAcquire(const size_t* index)
+		{
+#ifdef _MSC_VER
+			// volatile accesses have acquire/release semantics in MSVC, the barrier prevents compiler reordering
+			size_t value = *(const volatile size_t*)index;
+			_ReadWriteBarrier();
+			return value;
+#else
+			return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#endif
+		}
+
+		static void storeRelease(size_t* index, size_t value)
+		{
+#ifdef _MSC_VER
+			_ReadWriteBarrier();
+			*(volatile size_t*)index = value;
+#else
+			__atomic_store_n(index, value, __ATOMIC_RELEASE);
+#endif
+		}
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_SPSC_RING */
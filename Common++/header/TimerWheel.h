@@ -0,0 +1,355 @@
+#ifndef PCAPPP_TIMER_WHEEL
+#define PCAPPP_TIMER_WHEEL
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/**
+ * The number of levels of pcpp#TimerWheel. Each level covers 64 times the range of the level below it, so 4 levels cover 2^24 ticks.
+ * Timers that expire further away are kept in an overflow list and moved into the wheel when they get in range
+ */
+#define PCPP_TIMER_WHEEL_LEVELS 4
+
+/**
+ * The number of bits of a tick handled by each level of pcpp#TimerWheel, which means each level has 2^PCPP_TIMER_WHEEL_SLOT_BITS slots
+ */
+#define PCPP_TIMER_WHEEL_SLOT_BITS 6
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class TimerWheel
+	 * A hierarchical timing wheel that manages a large number of timers in O(1) per scheduled or cancelled timer. The wheel doesn't
+	 * read any clock: time is measured in abstract ticks (for example seconds of packet timestamps) and moves forward only when
+	 * advance() is called, so expiry is deterministic and can follow the timestamps of a replayed capture file.<BR>
+	 * Timers are intrusive: the user embeds a TimerWheel#Timer in its own objects and the wheel only links them, so scheduling and
+	 * cancelling never allocate memory. A timer carries a user value of type T (for example an index or a handle of the object it's
+	 * embedded in) which is the way to get back to the object when the timer expires. A timer must stay at the same address while
+	 * it's scheduled and must not be destructed before it's cancelled or popped.<BR>
+	 * Timers that expire when the wheel advances are moved to an expired list, in which they stay until they're taken by
+	 * popExpired(). This allows the user to handle only part of them and handle the rest later.<BR>
+	 * The wheel isn't thread-safe and can't be copied
+	 */
+	template<typename T>
+	class TimerWheel
+	{
+	public:
+
+		/**
+		 * @class Timer
+		 * A timer that can be scheduled in a TimerWheel
+		 */
+		class Timer
+		{
+			friend class TimerWheel<T>;
+
+		public:
+			/** The user value of the timer */
+			T data;
+
+			/**
+			 * A c'tor that creates a timer that isn't scheduled
+			 */
+			Timer() : data(), m_Next(NULL), m_Prev(NULL), m_Expiry(0), m_ListIndex(0) {}
+
+			/**
+			 * A copy c'tor that copies only the user value. The new timer isn't scheduled
+			 * @param[in] other The timer to copy
+			 */
+			Timer(const Timer& other) : data(other.data), m_Next(NULL), m_Prev(NULL), m_Expiry(0), m_ListIndex(0) {}
+
+			/**
+			 * An assignment operator that copies only the user value. The timer remains scheduled (or not scheduled) as it was
+			 * @param[in] other The timer to copy
+			 * @return A reference to this timer
+			 */
+			Timer& operator=(const Timer& other) { data = other.data; return *this; }
+
+			/**
+			 * @return True if the timer is scheduled in a wheel or waits in its expired list
+			 */
+			bool isScheduled() const { return m_Next != NULL; }
+
+			/**
+			 * @return The tick the timer expires at. Relevant only if the timer is scheduled
+			 */
+			uint64_t getExpiry() const { return m_Expiry; }
+
+		private:
+			Timer* m_Next;
+			Timer* m_Prev;
+			uint64_t m_Expiry;
+			uint32_t m_ListIndex;
+		};
+
+		/**
+		 * A c'tor that creates an empty wheel
+		 * @param[in] currentTick The initial time of the wheel. The default is 0
+		 */
+		explicit TimerWheel(uint64_t currentTick = 0) : m_CurrentTick(currentTick), m_NumOfPendingTimers(0)
+		{
+			for (int i = 0; i < NumOfLists; i++)
+				m_Lists[i].m_Next = m_Lists[i].m_Prev = &m_Lists[i];
+
+			for (int i = 0; i < PCPP_TIMER_WHEEL_LEVELS; i++)
+				m_OccupiedSlots[i] = 0;
+		}
+
+		/**
+		 * @return The current time of the wheel
+		 */
+		uint64_t getCurrentTick() const { return m_CurrentTick; }
+
+		/**
+		 * @return The number of timers that didn't expire yet (not including timers in the expired list)
+		 */
+		size_t getNumOfPendingTimers() const { return m_NumOfPendingTimers; }
+
+		/**
+		 * @return True if there are expired timers that weren't taken by popExpired() yet
+		 */
+		bool hasExpired() const { return m_Lists[ExpiredList].m_Next != &m_Lists[ExpiredList]; }
+
+		/**
+		 * Schedule a timer. If the timer is already scheduled it's rescheduled
+		 * @param[in] timer The timer to schedule
+		 * @param[in] expiry The tick the timer expires at. If it's not later than the current tick the timer is moved to the expired
+		 * list right away
+		 */
+		void schedule(Timer* timer, uint64_t expiry)
+		{
+			cancel(timer);
+			timer->m_Expiry = expiry;
+			place(timer);
+		}
+
+		/**
+		 * Cancel a timer. Cancelling a timer that isn't scheduled does nothing
+		 * @param[in] timer The timer to cancel
+		 */
+		void cancel(Timer* timer)
+		{
+			if (!timer->isScheduled())
+				return;
+
+			unlink(timer);
+			timer->m_Next = timer->m_Prev = NULL;
+		}
+
+		/**
+		 * Move the time of the wheel forward and move all timers that expire until this time to the expired list. The cost is
+		 * proportional to the number of expired timers and the number of wheel slots that have timers, not to the number of ticks
+		 * passed. Moving the time backward does nothing
+		 * @param[in] tick The new time of the wheel
+		 */
+		void advance(uint64_t tick)
+		{
+			while (m_NumOfPendingTimers > 0)
+			{
+				uint64_t nextEvent = getNextEventTick();
+				if (nextEvent > tick)
+					break;
+
+				m_CurrentTick = nextEvent;
+				cascade();
+
+				// after cascading, the timers of the current level 0 slot are the ones that expire at this tick
+				moveListToExpired(getListIndex(0, (int)(m_CurrentTick & SlotMask)));
+			}
+
+			if (tick > m_CurrentTick)
+				m_CurrentTick = tick;
+		}
+
+		/**
+		 * Take the first timer out of the expired list. Timers expired in the same call to advance() are returned in no
+		 * particular order, timers expired in different calls are returned in the order of expiry
+		 * @return The timer (which is no longer scheduled) or NULL if the expired list is empty
+		 */
+		Timer* popExpired()
+		{
+			Timer* timer = m_Lists[ExpiredList].m_Next;
+			if (timer == &m_Lists[ExpiredList])
+				return NULL;
+
+			cancel(timer);
+			return timer;
+		}
+
+	private:
+		enum
+		{
+			NumOfSlots = 1 << PCPP_TIMER_WHEEL_SLOT_BITS,
+			SlotMask = NumOfSlots - 1,
+			OverflowList = PCPP_TIMER_WHEEL_LEVELS * NumOfSlots,
+			ExpiredList = OverflowList + 1,
+			NumOfLists = ExpiredList + 1
+		};
+
+		uint64_t m_CurrentTick;
+		size_t m_NumOfPendingTimers;
+		// the sentinel heads of the circular lists of all slots, the overflow list and the expired list
+		Timer m_Lists[NumOfLists];
+		// a bit per slot of each level which is set if the slot isn't empty
+		uint64_t m_OccupiedSlots[PCPP_TIMER_WHEEL_LEVELS];
+
+		// the wheel holds pointers to its own members and to the user's timers, so it can't be copied
+		TimerWheel(const TimerWheel& other);
+		TimerWheel& operator=(const TimerWheel& other);
+
+		static int getListIndex(int level, int slot) { return level * NumOfSlots + slot; }
+
+		static int getLowestSetBit(uint64_t value)
+		{
+#if defined(__GNUC__)
+			return __builtin_ctzll(value);
+#else
+			int index = 0;
+			while ((value & 1) == 0)
+			{
+				value >>= 1;
+				index++;
+			}
+			return index;
+#endif
+		}
+
+		void link(Timer* timer, int listIndex)
+		{
+			Timer* head = &m_Lists[listIndex];
+			timer->m_ListIndex = listIndex;
+			timer->m_Next = head;
+			timer->m_Prev = head->m_Prev;
+			head->m_Prev->m_Next = timer;
+			head->m_Prev = timer;
+
+			if (listIndex < OverflowList)
+				m_OccupiedSlots[listIndex / NumOfSlots] |= ((uint64_t)1 << (listIndex % NumOfSlots));
+
+			if (listIndex != ExpiredList)
+				m_NumOfPendingTimers++;
+		}
+
+		void unlink(Timer* timer)
+		{
+			int listIndex = timer->m_ListIndex;
+			timer->m_Prev->m_Next = timer->m_Next;
+			timer->m_Next->m_Prev = timer->m_Prev;
+
+			if (listIndex < OverflowList && m_Lists[listIndex].m_Next == &m_Lists[listIndex])
+				m_OccupiedSlots[listIndex / NumOfSlots] &= ~((uint64_t)1 << (listIndex % NumOfSlots));
+
+			if (listIndex != ExpiredList)
+				m_NumOfPendingTimers--;
+		}
+
+		// a timer is kept in the level of the highest bit group in which its expiry differs from the current tick. This means all
+		// timers of a slot were placed while the higher bit groups of the current tick were the same, and the slot index is always
+		// greater than the current index of its level, so a slot is handled exactly once: when the current tick reaches it
+		void place(Timer* timer)
+		{
+			if (timer->m_Expiry <= m_CurrentTick)
+			{
+				link(timer, ExpiredList);
+				return;
+			}
+
+			uint64_t diff = timer->m_Expiry ^ m_CurrentTick;
+			for (int level = 0; level < PCPP_TIMER_WHEEL_LEVELS; level++)
+			{
+				if ((diff >> (PCPP_TIMER_WHEEL_SLOT_BITS * (level + 1))) == 0)
+				{
+					int slot = (int)((timer->m_Expiry >> (PCPP_TIMER_WHEEL_SLOT_BITS * level)) & SlotMask);
+					link(timer, getListIndex(level, slot));
+					return;
+				}
+			}
+
+			link(timer, OverflowList);
+		}
+
+		// the earliest tick at which a slot of the wheel should be handled
+		uint64_t getNextEventTick() const
+		{
+			const int wheelBits = PCPP_TIMER_WHEEL_SLOT_BITS * PCPP_TIMER_WHEEL_LEVELS;
+			uint64_t nextEvent = ~(uint64_t)0;
+			if (m_Lists[OverflowList].m_Next != &m_Lists[OverflowList])
+				nextEvent = ((m_CurrentTick >> wheelBits) + 1) << wheelBits;
+
+			for (int level = 0; level < PCPP_TIMER_WHEEL_LEVELS; level++)
+			{
+				int shift = PCPP_TIMER_WHEEL_SLOT_BITS * level;
+				int curSlot = (int)((m_CurrentTick >> shift) & SlotMask);
+				if (curSlot == SlotMask)
+					continue;
+
+				uint64_t laterSlots = m_OccupiedSlots[level] & (~(uint64_t)0 << (curSlot + 1));
+				if (laterSlots == 0)
+					continue;
+
+				uint64_t slotTick = ((m_CurrentTick >> (shift + PCPP_TIMER_WHEEL_SLOT_BITS)) << (shift + PCPP_TIMER_WHEEL_SLOT_BITS)) + ((uint64_t)getLowestSetBit(laterSlots) << shift);
+				if (slotTick < nextEvent)
+					nextEvent = slotTick;
+			}
+
+			return nextEvent;
+		}
+
+		// re-place the timers of the slots the current tick has just reached in the upper levels, from the highest level down
+		void cascade()
+		{
+			int topLevel = 0;
+			while (topLevel < PCPP_TIMER_WHEEL_LEVELS && (m_CurrentTick & (((uint64_t)1 << (PCPP_TIMER_WHEEL_SLOT_BITS * (topLevel + 1))) - 1)) == 0)
+				topLevel++;
+
+			if (topLevel == PCPP_TIMER_WHEEL_LEVELS)
+			{
+				replaceList(OverflowList);
+				topLevel--;
+			}
+
+			for (int level = topLevel; level >= 1; level--)
+				replaceList(getListIndex(level, (int)((m_CurrentTick >> (PCPP_TIMER_WHEEL_SLOT_BITS * level)) & SlotMask)));
+		}
+
+		void replaceList(int listIndex)
+		{
+			Timer* head = &m_Lists[listIndex];
+			if (head->m_Next == head)
+				return;
+
+			// timers of the overflow list that are still out of range are placed back at its tail, so stop after the last timer that
+			// was in the list before
+			Timer* last = head->m_Prev;
+			bool isLast = false;
+			while (!isLast)
+			{
+				Timer* timer = head->m_Next;
+				isLast = (timer == last);
+				unlink(timer);
+				place(timer);
+			}
+		}
+
+		void moveListToExpired(int listIndex)
+		{
+			Timer* head = &m_Lists[listIndex];
+			while (head->m_Next != head)
+			{
+				Timer* timer = head->m_Next;
+				unlink(timer);
+				link(timer, ExpiredList);
+			}
+		}
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_TIMER_WHEEL */
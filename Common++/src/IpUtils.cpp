@@ -14,6 +14,24 @@
 #define NS_INT16SZ	2
 #endif
 
+// SIMD checksum kernels are compiled for x86 regardless of the compiler flags and selected at runtime by the CPU features
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define PCPP_CHECKSUM_X86
+#if _MSC_VER >= 1700
+#define PCPP_CHECKSUM_AVX2_SUPPORTED
+#endif
+#define PCPP_CHECKSUM_TARGET(isa)
+#include <intrin.h>
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PCPP_CHECKSUM_X86
+#if defined(__clang__) || (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define PCPP_CHECKSUM_AVX2_SUPPORTED
+#endif
+#define PCPP_CHECKSUM_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#endif
+
 namespace pcpp
 {
 
@@ -59,35 +77,243 @@ uint32_t in_addr2int(in_addr inAddr)
 #endif
 }
 
+// one's complement sum kernels: each one returns the sum of the native 16-bit words of an even-length buffer in a 64-bit value
+// which is later folded to 16 bits. Summing wider words is equivalent since 2^16 = 1 (mod 0xFFFF)
+typedef uint64_t (*ChecksumSumFunc)(const uint8_t* data, size_t len);
+
+static uint64_t checksumSumPortable(const uint8_t* data, size_t len)
+{
+	uint64_t sum1 = 0, sum2 = 0;
+	while (len >= 16)
+	{
+		uint64_t word1, word2;
+		memcpy(&word1, data, sizeof(word1));
+		memcpy(&word2, data + 8, sizeof(word2));
+		sum1 += (word1 & 0xFFFFFFFF) + (word1 >> 32);
+		sum2 += (word2 & 0xFFFFFFFF) + (word2 >> 32);
+		data += 16;
+		len -= 16;
+	}
+
+	uint64_t sum = sum1 + sum2;
+	while (len >= 2)
+	{
+		uint16_t word;
+		memcpy(&word, data, sizeof(word));
+		sum += word;
+		data += 2;
+		len -= 2;
+	}
+
+	return sum;
+}
+
+#ifdef PCPP_CHECKSUM_X86
+
+// the 32-bit lanes of the SIMD accumulators grow by at most 2 * 0xFFFF per iteration, so they're flushed into the 64-bit sum
+// before they can overflow
+#define PCPP_CHECKSUM_MAX_SIMD_ITERATIONS 32768
+
+PCPP_CHECKSUM_TARGET("sse2")
+static uint64_t checksumSumSSE2(const uint8_t* data, size_t len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	uint64_t sum = 0;
+
+	while (len >= 32)
+	{
+		size_t iterations = len / 32;
+		if (iterations > PCPP_CHECKSUM_MAX_SIMD_ITERATIONS)
+			iterations = PCPP_CHECKSUM_MAX_SIMD_ITERATIONS;
+
+		// two independent accumulators hide the latency of the additions
+		__m128i acc1 = zero, acc2 = zero;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			__m128i words1 = _mm_loadu_si128((const __m128i*)data);
+			__m128i words2 = _mm_loadu_si128((const __m128i*)(data + 16));
+			acc1 = _mm_add_epi32(acc1, _mm_unpacklo_epi16(words1, zero));
+			acc2 = _mm_add_epi32(acc2, _mm_unpacklo_epi16(words2, zero));
+			acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(words1, zero));
+			acc2 = _mm_add_epi32(acc2, _mm_unpackhi_epi16(words2, zero));
+			data += 32;
+		}
+
+		len -= iterations * 32;
+
+		// the lanes of both accumulators are added in 64 bits
+		uint32_t lanes[8];
+		_mm_storeu_si128((__m128i*)lanes, acc1);
+		_mm_storeu_si128((__m128i*)(lanes + 4), acc2);
+		sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+	}
+
+	return sum + checksumSumPortable(data, len);
+}
+
+#ifdef PCPP_CHECKSUM_AVX2_SUPPORTED
+PCPP_CHECKSUM_TARGET("avx2")
+static uint64_t checksumSumAVX2(const uint8_t* data, size_t len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	uint64_t sum = 0;
+
+	while (len >= 32)
+	{
+		size_t iterations = len / 32;
+		if (iterations > PCPP_CHECKSUM_MAX_SIMD_ITERATIONS)
+			iterations = PCPP_CHECKSUM_MAX_SIMD_ITERATIONS;
+
+		__m256i acc = zero;
+		for (size_t i = 0; i < iterations; i++)
+		{
+			__m256i words = _mm256_loadu_si256((const __m256i*)data);
+			acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(words, zero));
+			acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(words, zero));
+			data += 32;
+		}
+
+		len -= iterations * 32;
+
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+	}
+
+	return sum + checksumSumSSE2(data, len);
+}
+#endif // PCPP_CHECKSUM_AVX2_SUPPORTED
+
+static bool isChecksumImplementationSupported(ChecksumImplementation implementation)
+{
+	switch (implementation)
+	{
+	case ChecksumPortable:
+		return true;
+#if defined(_MSC_VER)
+	case ChecksumSSE2:
+	{
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[3] & (1 << 26)) != 0;
+	}
+	case ChecksumAVX2:
+	{
+#ifdef PCPP_CHECKSUM_AVX2_SUPPORTED
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		// AVX2 also requires the OS to save the YMM registers (OSXSAVE + XCR0)
+		if ((cpuInfo[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+		__cpuidex(cpuInfo, 7, 0);
+		return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+		return false;
+#endif
+	}
+#else
+	case ChecksumSSE2:
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse2");
+	case ChecksumAVX2:
+#ifdef PCPP_CHECKSUM_AVX2_SUPPORTED
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+#endif
+	default:
+		return false;
+	}
+}
+
+#else
+
+static bool isChecksumImplementationSupported(ChecksumImplementation implementation)
+{
+	return implementation == ChecksumPortable;
+}
+
+#endif // PCPP_CHECKSUM_X86
+
+static ChecksumSumFunc getChecksumSumFunc(ChecksumImplementation implementation)
+{
+	switch (implementation)
+	{
+#ifdef PCPP_CHECKSUM_X86
+	case ChecksumSSE2:
+		return checksumSumSSE2;
+#ifdef PCPP_CHECKSUM_AVX2_SUPPORTED
+	case ChecksumAVX2:
+		return checksumSumAVX2;
+#endif
+#endif
+	default:
+		return checksumSumPortable;
+	}
+}
+
+// the implementation is selected lazily rather than in a static initializer so it's valid even when checksums are computed
+// by other static initializers
+static bool s_ChecksumImplementationSelected = false;
+static ChecksumImplementation s_ChecksumImplementation = ChecksumPortable;
+static ChecksumSumFunc s_ChecksumSumFunc = checksumSumPortable;
+
+static void selectChecksumImplementation()
+{
+	if (isChecksumImplementationSupported(ChecksumAVX2))
+		s_ChecksumImplementation = ChecksumAVX2;
+	else if (isChecksumImplementationSupported(ChecksumSSE2))
+		s_ChecksumImplementation = ChecksumSSE2;
+	else
+		s_ChecksumImplementation = ChecksumPortable;
+
+	s_ChecksumSumFunc = getChecksumSumFunc(s_ChecksumImplementation);
+	s_ChecksumImplementationSelected = true;
+}
+
+ChecksumImplementation getChecksumImplementation()
+{
+	if (!s_ChecksumImplementationSelected)
+		selectChecksumImplementation();
+
+	return s_ChecksumImplementation;
+}
+
+bool setChecksumImplementation(ChecksumImplementation implementation)
+{
+	if (!isChecksumImplementationSupported(implementation))
+		return false;
+
+	s_ChecksumImplementation = implementation;
+	s_ChecksumSumFunc = getChecksumSumFunc(implementation);
+	s_ChecksumImplementationSelected = true;
+	return true;
+}
+
 uint16_t compute_checksum(ScalarBuffer<uint16_t> vec[], size_t vecSize)
 {
+	if (!s_ChecksumImplementationSelected)
+		selectChecksumImplementation();
+
 	uint32_t sum = 0;
 	for (size_t i = 0; i<vecSize; i++)
 	{
-		uint32_t local_sum = 0;
+		const uint8_t* data = (const uint8_t*)vec[i].buffer;
 		size_t buff_len = vec[i].len;
-		while (buff_len > 1) {
-			LOG_DEBUG("Value to add = 0x%4X", *(vec[i].buffer));
-			local_sum += *(vec[i].buffer);
-			++(vec[i].buffer);
-			buff_len -= 2;
-		}
-		LOG_DEBUG("Local sum = %d, 0x%4X", local_sum, local_sum);
 
-		if (buff_len == 1)
-		{
-			uint8_t lastByte = *(vec[i].buffer);
-			LOG_DEBUG("1 byte left, adding value: 0x%4X", lastByte);
-			local_sum += lastByte;
-			LOG_DEBUG("Local sum = %d, 0x%4X", local_sum, local_sum);
-		}
+		uint64_t local_sum = s_ChecksumSumFunc(data, buff_len & ~(size_t)1);
+
+		// an odd byte is added as is, like the low byte of a native 16-bit word
+		if (buff_len & 1)
+			local_sum += data[buff_len - 1];
 
 		while (local_sum>>16) {
 			local_sum = (local_sum & 0xffff) + (local_sum >> 16);
 		}
-		local_sum = ntohs(local_sum);
-		LOG_DEBUG("Local sum = %d, 0x%4X", local_sum, local_sum);
-		sum += local_sum;
+		LOG_DEBUG("Local sum = %d, 0x%4X", (uint32_t)local_sum, (uint32_t)local_sum);
+		sum += ntohs((uint16_t)local_sum);
 	}
 
 	while (sum>>16) {
@@ -103,6 +329,41 @@ uint16_t compute_checksum(ScalarBuffer<uint16_t> vec[], size_t vecSize)
 	return ((uint16_t) sum);
 }
 
+static inline uint16_t finalizeChecksumUpdate(uint32_t sum)
+{
+	while (sum>>16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	// like in compute_checksum() the folded sum is 0 only if all of its terms are 0, otherwise a zero sum is represented as
+	// 0xFFFF (negative zero), so the result is identical to computing the checksum again
+	return (uint16_t)~sum;
+}
+
+uint16_t update_checksum(uint16_t checksum, uint16_t oldValue, uint16_t newValue)
+{
+	// HC' = ~(~HC + ~m + m')
+	uint32_t sum = (uint16_t)~checksum;
+	sum += (uint16_t)~oldValue;
+	sum += newValue;
+	return finalizeChecksumUpdate(sum);
+}
+
+uint16_t update_checksum(uint16_t checksum, const uint8_t* oldData, const uint8_t* newData, size_t dataLen)
+{
+	uint32_t sum = (uint16_t)~checksum;
+	for (size_t i = 0; i + 1 < dataLen; i += 2)
+	{
+		uint16_t oldValue, newValue;
+		memcpy(&oldValue, oldData + i, sizeof(oldValue));
+		memcpy(&newValue, newData + i, sizeof(newValue));
+		sum += (uint16_t)~oldValue;
+		sum += newValue;
+	}
+
+	return finalizeChecksumUpdate(sum);
+}
+
 
 static const uint32_t FNV_PRIME = 16777619u;
 static const uint32_t OFFSET_BASIS = 2166136261u;
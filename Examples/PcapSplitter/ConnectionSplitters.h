@@ -24,23 +24,23 @@ public:
 	 */
 	int getFileNumber(pcpp::Packet& packet, std::vector<int>& filesToClose)
 	{
-		// hash the 2-tuple and look for it in the flow table
-		uint32_t hash = pcpp::hash2Tuple(&packet);
+		// extract the 2-tuple flow key and look for it in the flow table
+		pcpp::FlowKey flowKey = pcpp::FlowKey::fromPacket(packet).getIPPairKey();
 
 		// if flow isn't found in the flow table
-		if (m_FlowTable.find(hash) == m_FlowTable.end())
+		if (m_FlowTable.find(flowKey) == m_FlowTable.end())
 		{
 			// create a new entry and get a new file number for it
-			m_FlowTable[hash] = getNextFileNumber(filesToClose);
+			m_FlowTable[flowKey] = getNextFileNumber(filesToClose);
 		}
 		else // flow is found in the 2-tuple flow table
 		{
 			// indicate file is being written because this file may not be in the LRU list (and hence closed),
 			// so we need to put it there, open it, and maybe close another file
-			writingToFile(m_FlowTable[hash], filesToClose);
+			writingToFile(m_FlowTable[flowKey], filesToClose);
 		}
 
-		return m_FlowTable[hash];
+		return m_FlowTable[flowKey];
 	}
 };
 
@@ -58,7 +58,7 @@ private:
 
 	// a flow table for saving TCP state per flow. Currently the only data that is saved is whether
 	// the last packet seen on the flow was a TCP SYN packet
-	std::map<uint32_t, bool> m_TcpFlowTable;
+	std::map<pcpp::FlowKey, bool> m_TcpFlowTable;
 
 	/**
 	 * A utility method that takes a packet and returns true if it's a TCP SYN packet
@@ -94,20 +94,23 @@ public:
 	 */
 	int getFileNumber(pcpp::Packet& packet, std::vector<int>& filesToClose)
 	{
-		// hash the 5-tuple and look for it in the flow table
-		uint32_t hash = pcpp::hash5Tuple(&packet);
+		// extract the 5-tuple flow key and look for it in the flow table. All packets that aren't TCP or UDP share
+		// the same (empty) flow key so they're all written to one file
+		pcpp::FlowKey flowKey;
+		if (packet.isPacketOfType(pcpp::TCP) || packet.isPacketOfType(pcpp::UDP))
+			flowKey = pcpp::FlowKey::fromPacket(packet);
 
 		// if flow isn't found in the flow table
-		if (m_FlowTable.find(hash) == m_FlowTable.end())
+		if (m_FlowTable.find(flowKey) == m_FlowTable.end())
 		{
 			// create a new entry and get a new file number for it
-			m_FlowTable[hash] = getNextFileNumber(filesToClose);
+			m_FlowTable[flowKey] = getNextFileNumber(filesToClose);
 
 			// if this is s a TCP packet check whether it's a SYN packet
 			// and save this data in the TCP flow table
 			if (packet.isPacketOfType(pcpp::TCP))
 			{
-				m_TcpFlowTable[hash] = isTcpSyn(packet);
+				m_TcpFlowTable[flowKey] = isTcpSyn(packet);
 			}
 		}
 		else // flow is found in the flow table
@@ -121,28 +124,28 @@ public:
 				//(with the same 5-tuple as the previous one), so assign a new file number to it.
 				// unless the last packet was also SYN, which is an indication of SYN retransmission.
 				// In this case don't assign a new file number
-				if (isSyn && m_TcpFlowTable.find(hash) != m_TcpFlowTable.end() && m_TcpFlowTable[hash] == false)
+				if (isSyn && m_TcpFlowTable.find(flowKey) != m_TcpFlowTable.end() && m_TcpFlowTable[flowKey] == false)
 				{
-					m_FlowTable[hash] = getNextFileNumber(filesToClose);
+					m_FlowTable[flowKey] = getNextFileNumber(filesToClose);
 				}
 				else
 				{
 					// indicate file is being written because this file may not be in the LRU list (and hence closed),
 					// so we need to put it there, open it, and maybe close another file
-					writingToFile(m_FlowTable[hash], filesToClose);
+					writingToFile(m_FlowTable[flowKey], filesToClose);
 				}
 
 				// update the TCP flow table
-				m_TcpFlowTable[hash] = isSyn;
+				m_TcpFlowTable[flowKey] = isSyn;
 			}
 			else
 			{
 				// indicate file is being written because this file may not be in the LRU list (and hence closed),
 				// so we need to put it there, open it, and maybe close another file
-				writingToFile(m_FlowTable[hash], filesToClose);
+				writingToFile(m_FlowTable[flowKey], filesToClose);
 			}
 		}
 
-		return m_FlowTable[hash];
+		return m_FlowTable[flowKey];
 	}
 };
@@ -34,15 +34,15 @@ public:
 			return 0;
 		}
 
-		// hash the 5-tuple and look for it in the flow table
-		uint32_t hash = pcpp::hash5Tuple(&packet);
+		// extract the 5-tuple flow key and look for it in the flow table
+		pcpp::FlowKey flowKey = pcpp::FlowKey::fromPacket(packet);
 
-		if (m_FlowTable.find(hash) != m_FlowTable.end())
+		if (m_FlowTable.find(flowKey) != m_FlowTable.end())
 		{
-			writingToFile(m_FlowTable[hash], filesToClose);
+			writingToFile(m_FlowTable[flowKey], filesToClose);
 
-			// if found it, follow the file number written in the hash record
-			return m_FlowTable[hash];
+			// if found it, follow the file number written in the flow table
+			return m_FlowTable[flowKey];
 		}
 
 		// if it's the first packet seen on this flow, try to guess the server port
@@ -61,21 +61,21 @@ public:
 					// SYN packet
 					if (!tcpLayer->getTcpHeader()->ackFlag)
 					{
-						m_FlowTable[hash] = getFileNumberForValue(getValue(packet, SYN, srcPort, dstPort), filesToClose);
-						return m_FlowTable[hash];
+						m_FlowTable[flowKey] = getFileNumberForValue(getValue(packet, SYN, srcPort, dstPort), filesToClose);
+						return m_FlowTable[flowKey];
 					}
 					// SYN/ACK packet
 					else
 					{
-						m_FlowTable[hash] = getFileNumberForValue(getValue(packet, SYN_ACK, srcPort, dstPort), filesToClose);
-						return m_FlowTable[hash];
+						m_FlowTable[flowKey] = getFileNumberForValue(getValue(packet, SYN_ACK, srcPort, dstPort), filesToClose);
+						return m_FlowTable[flowKey];
 					}
 				}
 				// Other TCP packet
 				else
 				{
-					m_FlowTable[hash] = getFileNumberForValue(getValue(packet, TCP_OTHER, srcPort, dstPort), filesToClose);
-					return m_FlowTable[hash];
+					m_FlowTable[flowKey] = getFileNumberForValue(getValue(packet, TCP_OTHER, srcPort, dstPort), filesToClose);
+					return m_FlowTable[flowKey];
 				}
 			}
 		}
@@ -88,8 +88,8 @@ public:
 			{
 				uint16_t srcPort = ntohs(udpLayer->getUdpHeader()->portSrc);
 				uint16_t dstPort = ntohs(udpLayer->getUdpHeader()->portDst);
-				m_FlowTable[hash] = getFileNumberForValue(getValue(packet, UDP, srcPort, dstPort), filesToClose);
-				return m_FlowTable[hash];
+				m_FlowTable[flowKey] = getFileNumberForValue(getValue(packet, UDP, srcPort, dstPort), filesToClose);
+				return m_FlowTable[flowKey];
 			}
 		}
 
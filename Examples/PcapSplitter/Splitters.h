@@ -10,6 +10,7 @@
 #include <UdpLayer.h>
 #include <DnsLayer.h>
 #include <PacketUtils.h>
+#include <FlowKey.h>
 #include <map>
 #include <algorithm>
 #include <iomanip>
@@ -167,7 +168,7 @@ class ValueBasedSplitter : public SplitterWithMaxFiles
 {
 protected:
 	// A flow table that keeps track of all flows (a flow is usually identified by 5-tuple)
-	std::map<uint32_t, int> m_FlowTable;
+	std::map<pcpp::FlowKey, int> m_FlowTable;
 	// a map between the relevant packet value (e.g client-ip) and the file to write the packet to
 	std::map<uint32_t, int> m_ValueToFileTable;
 
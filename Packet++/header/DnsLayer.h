@@ -8,6 +8,23 @@
 
 /// @file
 
+/**
+ * The maximum number of DNS records (queries, answers, authorities and additional records together) DnsLayer parses. Layers with
+ * more records are probably malformed, so their records aren't parsed at all
+ */
+#define PCPP_DNS_MAX_RESOURCES 300
+
+/**
+ * The number of record offsets DnsLayer keeps inside the layer object. Offsets of further records are kept in an array allocated
+ * on demand
+ */
+#define PCPP_DNS_INLINE_RESOURCE_OFFSETS 16
+
+/**
+ * The size of a buffer that can hold any valid DNS name decoded by DnsLayer#decodeName(), including the terminating null
+ */
+#define PCPP_DNS_NAME_BUFFER_SIZE 256
+
 /**
  * \namespace pcpp
  * \brief The main namespace for the PcapPlusPlus lib
@@ -82,6 +99,30 @@ namespace pcpp
 #pragma pack(pop)
 
 
+	/**
+	 * @struct DnsResourceInfo
+	 * The fields of a DNS record as read directly from the packet by DnsLayer#getResourceInfo(), without creating a DnsQuery or
+	 * DnsResource object
+	 */
+	struct DnsResourceInfo
+	{
+		/** The offset of the record in the layer, which is also the offset of its encoded name. Can be passed to DnsLayer#decodeName() */
+		size_t offsetInLayer;
+		/** The length in bytes of the record's encoded name as it appears in the packet (a compression pointer counts as 2 bytes) */
+		size_t nameLength;
+		/** The DNS type of the record */
+		DnsType dnsType;
+		/** The DNS class of the record */
+		DnsClass dnsClass;
+		/** The TTL of the record. Always 0 for queries */
+		uint32_t ttl;
+		/** A pointer to the record data inside the packet (for example the 4 bytes of the address of a type A record). NULL for queries */
+		const uint8_t* data;
+		/** The length of the record data in bytes. Always 0 for queries */
+		size_t dataLength;
+	};
+
+
 	// forward declarations
 	class DnsQuery;
 	class IDnsResource;
@@ -92,7 +133,10 @@ namespace pcpp
 	/**
 	 * @class DnsLayer
 	 * Represents the DNS protocol layer.<BR>
-	 * CURRENTLY ONLY DNS PARSING IS AVAILABLE. CREATING AND EDITING DNS ATTRIBUTES WILL BE ADDED LATER
+	 * The DnsQuery and DnsResource objects of the layer are created only when one of them is first requested (for example by
+	 * getFirstQuery() or getAnswer()) or when the layer is edited, so parsing a packet doesn't allocate anything for its DNS records.
+	 * Applications that only need to read a few fields of a large number of packets can use getResourceInfo() and decodeName(),
+	 * which read the records directly from the packet through an index of record offsets and never allocate memory
 	 */
 	class DnsLayer : public Layer
 	{
@@ -431,12 +475,51 @@ namespace pcpp
 		 */
 		static inline bool isDnsPort(uint16_t port);
 
+		/**
+		 * Read the fields of a DNS record directly from the packet, without creating DnsQuery or DnsResource objects. Records are
+		 * located through an index of their offsets in the layer which is built on the first call and rebuilt after the layer is edited.
+		 * Notice the index relies on the record counts in the DNS header, so if the counts are changed directly through getDnsHeader()
+		 * the index isn't updated
+		 * @param[in] resType The section of the record: query, answer, authority or additional record
+		 * @param[in] index The index of the record inside its section (0 for the first record of the section)
+		 * @param[out] info The record fields. The data pointer points to the packet, so it's valid only until the layer is edited
+		 * @return True if the record exists and is within the layer bounds, false otherwise
+		 */
+		bool getResourceInfo(DnsResourceType resType, size_t index, DnsResourceInfo& info) const;
+
+		/**
+		 * Decode a DNS name from the packet into a buffer supplied by the caller, following compression pointers, without allocating
+		 * memory. The decoded name is in the same format as returned by IDnsResource#getName() (labels separated by dots, without
+		 * a trailing dot)
+		 * @param[in] nameOffset The offset in the layer of the encoded name, for example DnsResourceInfo#offsetInLayer
+		 * @param[out] result The buffer to write the null-terminated name to. A buffer of ::PCPP_DNS_NAME_BUFFER_SIZE bytes can hold
+		 * any valid name
+		 * @param[in] resultLen The size of the buffer in bytes
+		 * @param[out] decodedNameLen If not NULL, the length of the decoded name (without the terminating null) is written to it
+		 * @return True if the name was decoded successfully. False if the buffer is too small (in which case it holds the part of the
+		 * name that fits it), if the name exceeds the layer bounds or if it has too many compression pointers (probably a loop)
+		 */
+		bool decodeName(size_t nameOffset, char* result, size_t resultLen, size_t* decodedNameLen = NULL) const;
+
 	private:
 		IDnsResource* m_ResourceList;
 		DnsQuery*     m_FirstQuery;
 		DnsResource*  m_FirstAnswer;
 		DnsResource*  m_FirstAuthority;
 		DnsResource*  m_FirstAdditional;
+		bool          m_ResourcesParsed;
+
+		// an index of the offsets of the records in the layer used by getResourceInfo(). It's built lazily and invalidated whenever
+		// the layer is extended or shortened
+		mutable uint16_t  m_ResourceOffsets[PCPP_DNS_INLINE_RESOURCE_OFFSETS];
+		mutable uint16_t* m_ExtraResourceOffsets;
+		mutable size_t    m_NumOfIndexedResources;
+		mutable bool      m_IsResourceIndexValid;
+
+		void initResources();
+		void parseResourcesOnDemand() const;
+		void buildResourceIndex() const;
+		size_t getEncodedNameLength(size_t nameOffset) const;
 
 		IDnsResource* getFirstResource(DnsResourceType resType) const;
 		void setFirstResource(DnsResourceType resType, IDnsResource* resource);
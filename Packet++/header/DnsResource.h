@@ -53,6 +53,10 @@ namespace pcpp
 
 		uint8_t* getRawData() const;
 
+		// setters call this method before writing to the resource data, so a packet that shares its data with copy-on-write clones
+		// copies it first (see Packet#makeWritable())
+		void makeDataWritable();
+
 		void setDnsLayer(DnsLayer* dnsLayer, size_t offsetInLayer);
 
 	public:
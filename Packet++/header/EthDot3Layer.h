@@ -70,7 +70,7 @@ namespace pcpp
 		 * Set source MAC address
 		 * @param sourceMac Source MAC to set
 		 */
-		void setSourceMac(const MacAddress& sourceMac) { sourceMac.copyTo(getEthHeader()->srcMac); }
+		void setSourceMac(const MacAddress& sourceMac) { makePacketWritable(); sourceMac.copyTo(getEthHeader()->srcMac); m_IsModified = true; }
 
 		/**
 		 * Get the destination MAC address
@@ -82,7 +82,7 @@ namespace pcpp
 		 * Set destination MAC address
 		 * @param destMac Destination MAC to set
 		 */
-		void setDestMac(const MacAddress& destMac) { destMac.copyTo(getEthHeader()->dstMac); }
+		void setDestMac(const MacAddress& destMac) { makePacketWritable(); destMac.copyTo(getEthHeader()->dstMac); m_IsModified = true; }
 
 		// implement abstract methods
 
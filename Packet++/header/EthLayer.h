@@ -56,6 +56,8 @@ namespace pcpp
 #define PCPP_ETHERTYPE_MPLS		0x8847
 	/** Point-to-point protocol (PPP) */
 #define PCPP_ETHERTYPE_PPP		0x880B
+	/** IEEE 802.1ad Provider Bridge (Q-in-Q) service VLAN tag */
+#define PCPP_ETHERTYPE_IEEE_802_1AD	0x88A8
 
 
 	/**
@@ -108,7 +110,7 @@ namespace pcpp
 		 * Set source MAC address
 		 * @param sourceMac Source MAC to set
 		 */
-		void setSourceMac(const MacAddress& sourceMac) { sourceMac.copyTo(getEthHeader()->srcMac); }
+		void setSourceMac(const MacAddress& sourceMac) { makePacketWritable(); sourceMac.copyTo(getEthHeader()->srcMac); m_IsModified = true; }
 
 		/**
 		 * Get the destination MAC address
@@ -120,7 +122,7 @@ namespace pcpp
 		 * Set destination MAC address
 		 * @param destMac Destination MAC to set
 		 */
-		void setDestMac(const MacAddress& destMac) { destMac.copyTo(getEthHeader()->dstMac); }
+		void setDestMac(const MacAddress& destMac) { makePacketWritable(); destMac.copyTo(getEthHeader()->dstMac); m_IsModified = true; }
 
 		// implement abstract methods
 
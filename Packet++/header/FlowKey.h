@@ -0,0 +1,260 @@
+#ifndef PACKETPP_FLOW_KEY
+#define PACKETPP_FLOW_KEY
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include "RawPacket.h"
+#include "PacketView.h"
+
+/// @file
+
+/**
+ * The maximum number of nested tunnels pcpp#FlowKey#extractTunnelFlowKeys() decapsulates
+ */
+#define PCPP_FLOW_KEY_MAX_TUNNEL_DEPTH 4
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	class Packet;
+	class Layer;
+	struct TunnelFlowKeys;
+
+	/**
+	 * @class FlowKey
+	 * A compact (40 bytes) value type which identifies a bidirectional flow by its IPv4/IPv6 addresses, transport ports and the
+	 * protocol carried by IP. Unlike pcpp#hash5Tuple() the key keeps the full tuple, so two distinct flows never compare equal
+	 * even when their hash values collide, which makes it suitable as a key of flow tables that hold millions of flows.<BR>
+	 * The key is normalized for direction: the endpoints are stored ordered (address first, then port) so that both directions of
+	 * a connection produce the same key. This means the key doesn't tell which side is the client; that information has to be kept
+	 * elsewhere if needed.<BR>
+	 * Comparison is a plain byte comparison of the object and hash() returns a 64-bit hash of all key fields, so FlowKey can be used
+	 * both in ordered containers (std::map) and in hash tables.<BR>
+	 * A key can be extracted from a pcpp#Packet, from a pcpp#PacketView or directly from raw packet bytes without constructing a
+	 * Packet object
+	 */
+	class FlowKey
+	{
+	public:
+		/**
+		 * A default constructor that creates an invalid (all zeros) key
+		 */
+		FlowKey() { memset(this, 0, sizeof(FlowKey)); }
+
+		/**
+		 * A constructor that creates the key out of a 5-tuple extracted by PacketView#getFiveTuple(). The endpoints are normalized
+		 * so the 5-tuples of both directions of a flow create the same key
+		 * @param[in] fiveTuple The 5-tuple to create the key from
+		 */
+		explicit FlowKey(const PacketFiveTuple& fiveTuple);
+
+		/**
+		 * Extract the flow key of a parsed packet. The key is made of the innermost IPv4/IPv6 layer of the packet and the TCP or UDP
+		 * layer that directly follows it (if exists). For packets that don't carry TCP or UDP (for example ICMP) the ports are zero
+		 * and the protocol is taken from the IP header. Notice that if the packet was parsed lazily, all of its layers are parsed
+		 * by this method
+		 * @param[in] packet The packet to extract the key from
+		 * @return The flow key or an invalid key (see isValid()) if the packet doesn't contain an IPv4 or IPv6 layer
+		 */
+		static FlowKey fromPacket(const Packet& packet);
+
+		/**
+		 * Create a flow key out of a given IP layer and transport layer of a parsed packet. This allows choosing which of the IP
+		 * layers of a tunneled packet the key is made of
+		 * @param[in] ipLayer An IPv4 or IPv6 layer
+		 * @param[in] transportLayer A TCP or UDP layer carried by the IP layer or NULL. If NULL the ports are zero and the protocol
+		 * is taken from the IP header
+		 * @return The flow key or an invalid key (see isValid()) if ipLayer is NULL or isn't an IPv4 or IPv6 layer
+		 */
+		static FlowKey fromLayers(const Layer* ipLayer, const Layer* transportLayer);
+
+		/**
+		 * Extract the flow key of a packet parsed by pcpp#PacketView. Since PacketView doesn't parse tunnels, the key is made of the
+		 * outermost IP header and the TCP, UDP or SCTP header that follows it
+		 * @param[in] packetView The parsed packet view
+		 * @return The flow key or an invalid key (see isValid()) if the packet isn't an IPv4 or IPv6 packet
+		 */
+		static FlowKey fromPacketView(const PacketView& packetView);
+
+		/**
+		 * Extract the flow key directly from raw packet bytes without constructing a pcpp#Packet object. The data is parsed with
+		 * pcpp#PacketView so the same rules as in fromPacketView() apply
+		 * @param[in] data A pointer to the raw packet data
+		 * @param[in] dataLen The length of the raw data in bytes
+		 * @param[in] linkType The link layer type of the raw data. The default is Ethernet
+		 * @return The flow key or an invalid key (see isValid()) if the packet isn't an IPv4 or IPv6 packet
+		 */
+		static FlowKey fromRawData(const uint8_t* data, size_t dataLen, LinkLayerType linkType = LINKTYPE_ETHERNET);
+
+		/**
+		 * Extract the flow key of a raw packet without constructing a pcpp#Packet object. See fromRawData()
+		 * @param[in] rawPacket The raw packet to extract the key from
+		 * @return The flow key or an invalid key (see isValid()) if the packet isn't an IPv4 or IPv6 packet
+		 */
+		static FlowKey fromRawPacket(const RawPacket* rawPacket);
+
+		/**
+		 * Extract both the outer and the innermost flow keys of raw packet bytes in a single pass, without constructing a
+		 * pcpp#Packet object. The outer headers are parsed with pcpp#PacketView and the following tunnels are decapsulated
+		 * (up to #PCPP_FLOW_KEY_MAX_TUNNEL_DEPTH nested tunnels):
+		 * - GTP-U G-PDU messages over UDP port 2152, including the optional sequence number, N-PDU number and extension headers.
+		 *   The tunnel ID is the TEID
+		 * - VXLAN over UDP destination port 4789. The tunnel ID is the VNI
+		 * - GRE version 0 carrying IPv4, IPv6 or transparent Ethernet bridging. The tunnel ID is the GRE key (if present)
+		 * - Enhanced GRE (version 1, PPTP) carrying PPP-encapsulated IPv4 or IPv6. The tunnel ID is the call ID
+		 * - IPv4 or IPv6 directly encapsulated in IPv4 or IPv6 (IP in IP). This tunnel has no ID
+		 *
+		 * GTP-U signalling messages, GRE with other payloads and tunnels whose inner packet isn't IPv4 or IPv6 aren't decapsulated
+		 * @param[in] data A pointer to the raw packet data
+		 * @param[in] dataLen The length of the raw data in bytes
+		 * @param[out] result The extracted flow keys and tunnel information. If the packet isn't tunneled the inner key is equal to
+		 * the outer key
+		 * @param[in] linkType The link layer type of the raw data. The default is Ethernet
+		 * @return True if the outer packet is an IPv4 or IPv6 packet, false otherwise (in which case both keys are invalid)
+		 */
+		static bool extractTunnelFlowKeys(const uint8_t* data, size_t dataLen, TunnelFlowKeys& result, LinkLayerType linkType = LINKTYPE_ETHERNET);
+
+		/**
+		 * Extract both the outer and the innermost flow keys of a raw packet in a single pass. See the other overload of
+		 * extractTunnelFlowKeys()
+		 * @param[in] rawPacket The raw packet to extract the keys from
+		 * @param[out] result The extracted flow keys and tunnel information
+		 * @return True if the outer packet is an IPv4 or IPv6 packet, false otherwise
+		 */
+		static bool extractTunnelFlowKeys(const RawPacket* rawPacket, TunnelFlowKeys& result);
+
+		/**
+		 * @return True if this key was extracted from an IPv4 or IPv6 packet, false if it's the default (all zeros) key
+		 */
+		bool isValid() const { return m_IPVersion != 0; }
+
+		/**
+		 * @return The IP version of the flow: 4, 6 or 0 for an invalid key
+		 */
+		uint8_t getIPVersion() const { return m_IPVersion; }
+
+		/**
+		 * @return The protocol carried by IP as in pcpp#IPProtocolTypes
+		 */
+		uint8_t getProtocol() const { return m_Protocol; }
+
+		/**
+		 * @return The address of the lower endpoint in network byte order. For IPv4 only the first 4 bytes are used
+		 */
+		const uint8_t* getAddressA() const { return m_AddressA; }
+
+		/**
+		 * @return The address of the higher endpoint in network byte order. For IPv4 only the first 4 bytes are used
+		 */
+		const uint8_t* getAddressB() const { return m_AddressB; }
+
+		/**
+		 * @return The port of the lower endpoint in host byte order (0 if the flow isn't TCP, UDP or SCTP)
+		 */
+		uint16_t getPortA() const { return m_PortA; }
+
+		/**
+		 * @return The port of the higher endpoint in host byte order (0 if the flow isn't TCP, UDP or SCTP)
+		 */
+		uint16_t getPortB() const { return m_PortB; }
+
+		/**
+		 * Create a key that identifies only the pair of IP addresses of this flow, meaning the ports and protocol are zeroed.
+		 * This is the FlowKey equivalent of pcpp#hash2Tuple()
+		 * @return The address-pair key
+		 */
+		FlowKey getIPPairKey() const;
+
+		/**
+		 * Calculate a 64-bit hash of the key. The hash mixes all key fields (MurmurHash3 style mixing), so it's well distributed
+		 * in all of its bits and can be used to index hash tables of any power-of-two size. Since the key is normalized, both
+		 * directions of a flow have the same hash
+		 * @return The hash value
+		 */
+		uint64_t hash() const;
+
+		/**
+		 * @return A string representation of the key in the format of "<addressA>:<portA> <-> <addressB>:<portB> proto <protocol>"
+		 */
+		std::string toString() const;
+
+		bool operator==(const FlowKey& other) const { return memcmp(this, &other, sizeof(FlowKey)) == 0; }
+
+		bool operator!=(const FlowKey& other) const { return !(*this == other); }
+
+		bool operator<(const FlowKey& other) const { return memcmp(this, &other, sizeof(FlowKey)) < 0; }
+
+	private:
+		// the fields are laid out without padding so the whole object can be compared and hashed as raw memory
+		uint8_t m_AddressA[16];
+		uint8_t m_AddressB[16];
+		uint16_t m_PortA;
+		uint16_t m_PortB;
+		uint8_t m_IPVersion;
+		uint8_t m_Protocol;
+		uint8_t m_Reserved[2];
+
+		void setEndpoints(const uint8_t* srcAddr, const uint8_t* dstAddr, size_t addrLen, uint16_t srcPort, uint16_t dstPort);
+	};
+
+	/**
+	 * The tunnel types decapsulated by pcpp#FlowKey#extractTunnelFlowKeys()
+	 */
+	enum TunnelType
+	{
+		/** The packet isn't tunneled */
+		NoTunnel,
+		/** GTP-U (GPRS tunneling protocol, user plane) */
+		GtpUTunnel,
+		/** VXLAN */
+		VxlanTunnel,
+		/** GRE, including enhanced GRE (PPTP) */
+		GreTunnel,
+		/** IPv4 or IPv6 encapsulated in IPv4 or IPv6 */
+		IpInIpTunnel
+	};
+
+	/**
+	 * @struct TunnelFlowKeys
+	 * The outer and innermost flow keys of a packet and the tunnel that separates them, as extracted by
+	 * pcpp#FlowKey#extractTunnelFlowKeys()
+	 */
+	struct TunnelFlowKeys
+	{
+		/** The key of the outermost IP flow (for tunneled packets this is the flow of the tunnel endpoints) */
+		FlowKey outerFlowKey;
+		/** The key of the innermost IP flow. Equal to outerFlowKey if the packet isn't tunneled */
+		FlowKey innerFlowKey;
+		/** The type of the innermost tunnel */
+		TunnelType tunnelType;
+		/** The ID of the innermost tunnel in host byte order: GTP-U TEID, VXLAN VNI, GRE key or PPTP call ID */
+		uint32_t tunnelId;
+		/** False if the innermost tunnel doesn't carry an ID (IP in IP, GRE without a key or VXLAN without the I flag) */
+		bool hasTunnelId;
+		/** The number of tunnels that were decapsulated */
+		uint8_t tunnelDepth;
+
+		/**
+		 * A c'tor for this struct that sets the keys to invalid keys and the tunnel type to ::NoTunnel
+		 */
+		TunnelFlowKeys() : outerFlowKey(), innerFlowKey(), tunnelType(NoTunnel), tunnelId(0), hasTunnelId(false), tunnelDepth(0) {}
+	};
+
+	/**
+	 * @struct FlowKeyHash
+	 * A hash functor for using pcpp#FlowKey as a key of hash containers (e.g std::unordered_map)
+	 */
+	struct FlowKeyHash
+	{
+		size_t operator()(const FlowKey& key) const { return (size_t)key.hash(); }
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_FLOW_KEY */
@@ -0,0 +1,535 @@
+#ifndef PACKETPP_FLOW_TABLE
+#define PACKETPP_FLOW_TABLE
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <vector>
+#include "FlowKey.h"
+
+/// @file
+
+/**
+ * The number of entries in each storage chunk of pcpp#FlowTable. Entries are stored in chunks that are never reallocated, so they
+ * keep their address when the table grows
+ */
+#define PCPP_FLOW_TABLE_CHUNK_SIZE 256
+
+/**
+ * The initial number of entries pcpp#FlowTable has room for if no capacity is given
+ */
+#define PCPP_FLOW_TABLE_DEFAULT_CAPACITY 1024
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class FlowTable
+	 * A hash table that maps pcpp#FlowKey to values, designed for flow tables that hold millions of flows and are looked up for every
+	 * packet. It's a drop-in replacement for std::map<FlowKey, TValue>: it supports find(), insert(), operator[], erase() and
+	 * iteration where iterators point to a std::pair whose first member is the key and second member is the value (the iteration
+	 * order is the insertion order rather than the order of the keys).<BR>
+	 * The table uses open addressing with linear probing. The index is a flat array of 8-byte slots holding 32 bits of the key's
+	 * hash and a handle of the entry, so a lookup usually touches a single index cache line and a single entry. The entries
+	 * themselves are stored in fixed-size chunks and are never moved: a handle (see Handle), a pointer or a reference to an entry
+	 * stays valid until the entry is erased, even when the table grows. Erased entries are reused by the following insertions and
+	 * deletion doesn't leave tombstones in the index (backward shift deletion), so the lookup cost doesn't degrade over time.<BR>
+	 * Capacity can be preallocated with reserve() or in the constructor, in which case insertions don't allocate memory until the
+	 * capacity is exceeded. clear() keeps the allocated memory.<BR>
+	 * The live entries are linked in a list, so iterating the table (and clearing or destructing it) costs time proportional to the
+	 * number of entries and not to the capacity, even when a large preallocated table is almost empty. Erasing an entry invalidates
+	 * only the iterators pointing to it, so erase(iter++) can be used while iterating. The table isn't thread-safe
+	 */
+	template<class TValue>
+	class FlowTable
+	{
+	public:
+		/**
+		 * The type of the entries of the table
+		 */
+		typedef std::pair<FlowKey, TValue> value_type;
+
+		/**
+		 * A handle of an entry in the table. It stays valid until the entry is erased
+		 */
+		typedef uint32_t Handle;
+
+		/**
+		 * A handle that doesn't point to any entry
+		 */
+		static const Handle InvalidHandle = 0xFFFFFFFF;
+
+		class const_iterator;
+
+		/**
+		 * @class iterator
+		 * A forward iterator over the entries of the table
+		 */
+		class iterator
+		{
+			friend class FlowTable<TValue>;
+			friend class const_iterator;
+
+		public:
+			iterator() : m_Table(NULL), m_Handle(InvalidHandle) {}
+
+			value_type& operator*() const { return m_Table->at(m_Handle); }
+
+			value_type* operator->() const { return &m_Table->at(m_Handle); }
+
+			iterator& operator++() { m_Handle = m_Table->getNextHandle(m_Handle); return *this; }
+
+			iterator operator++(int) { iterator tmp(*this); ++(*this); return tmp; }
+
+			bool operator==(const iterator& other) const { return m_Handle == other.m_Handle; }
+
+			bool operator!=(const iterator& other) const { return m_Handle != other.m_Handle; }
+
+			/**
+			 * @return The handle of the entry the iterator points to or FlowTable#InvalidHandle for the end iterator
+			 */
+			Handle getHandle() const { return m_Handle; }
+
+		private:
+			FlowTable* m_Table;
+			Handle m_Handle;
+
+			iterator(FlowTable* table, Handle handle) : m_Table(table), m_Handle(handle) {}
+		};
+
+		/**
+		 * @class const_iterator
+		 * A forward iterator over the entries of a const table
+		 */
+		class const_iterator
+		{
+			friend class FlowTable<TValue>;
+
+		public:
+			const_iterator() : m_Table(NULL), m_Handle(InvalidHandle) {}
+
+			const_iterator(const iterator& other) : m_Table(other.m_Table), m_Handle(other.m_Handle) {}
+
+			const value_type& operator*() const { return m_Table->at(m_Handle); }
+
+			const value_type* operator->() const { return &m_Table->at(m_Handle); }
+
+			const_iterator& operator++() { m_Handle = m_Table->getNextHandle(m_Handle); return *this; }
+
+			const_iterator operator++(int) { const_iterator tmp(*this); ++(*this); return tmp; }
+
+			bool operator==(const const_iterator& other) const { return m_Handle == other.m_Handle; }
+
+			bool operator!=(const const_iterator& other) const { return m_Handle != other.m_Handle; }
+
+			/**
+			 * @return The handle of the entry the iterator points to or FlowTable#InvalidHandle for the end iterator
+			 */
+			Handle getHandle() const { return m_Handle; }
+
+		private:
+			const FlowTable* m_Table;
+			Handle m_Handle;
+
+			const_iterator(const FlowTable* table, Handle handle) : m_Table(table), m_Handle(handle) {}
+		};
+
+		/**
+		 * A c'tor that creates an empty table and preallocates room for a number of entries
+		 * @param[in] initialCapacity The number of entries that can be inserted before the table allocates more memory. The default
+		 * is #PCPP_FLOW_TABLE_DEFAULT_CAPACITY
+		 */
+		explicit FlowTable(size_t initialCapacity = PCPP_FLOW_TABLE_DEFAULT_CAPACITY) : m_IndexMask(0), m_FirstHandle(InvalidHandle), m_LastHandle(InvalidHandle), m_Size(0)
+		{
+			reserve(initialCapacity);
+		}
+
+		/**
+		 * A copy c'tor that copies all entries of another table
+		 * @param[in] other The table to copy
+		 */
+		FlowTable(const FlowTable& other) : m_IndexMask(0), m_FirstHandle(InvalidHandle), m_LastHandle(InvalidHandle), m_Size(0)
+		{
+			reserve(other.m_Size);
+			for (const_iterator iter = other.begin(); iter != other.end(); ++iter)
+				insert(*iter);
+		}
+
+		/**
+		 * A d'tor that destructs all entries and frees the table's memory
+		 */
+		~FlowTable()
+		{
+			clear();
+			for (size_t i = 0; i < m_Chunks.size(); i++)
+				::operator delete(m_Chunks[i]);
+		}
+
+		/**
+		 * An assignment operator that replaces the entries of this table with copies of the entries of another table
+		 * @param[in] other The table to copy
+		 * @return A reference to this table
+		 */
+		FlowTable& operator=(const FlowTable& other)
+		{
+			if (this == &other)
+				return *this;
+
+			clear();
+			reserve(other.m_Size);
+			for (const_iterator iter = other.begin(); iter != other.end(); ++iter)
+				insert(*iter);
+
+			return *this;
+		}
+
+		/**
+		 * @return The number of entries in the table
+		 */
+		size_t size() const { return m_Size; }
+
+		/**
+		 * @return True if the table has no entries
+		 */
+		bool empty() const { return m_Size == 0; }
+
+		/**
+		 * @return The number of entries the table can hold without allocating more memory
+		 */
+		size_t capacity() const
+		{
+			size_t indexCapacity = getMaxLoad(m_Index.size());
+			return indexCapacity < m_Links.size() ? indexCapacity : m_Links.size();
+		}
+
+		/**
+		 * Preallocate memory for a number of entries, so inserting them doesn't allocate memory. The table never shrinks
+		 * @param[in] capacity The number of entries to make room for
+		 */
+		void reserve(size_t capacity)
+		{
+			while (m_Links.size() < capacity)
+				addChunk();
+
+			size_t indexSize = (m_Index.empty() ? 16 : m_Index.size());
+			while (getMaxLoad(indexSize) < capacity)
+				indexSize *= 2;
+
+			if (indexSize != m_Index.size())
+				rebuildIndex(indexSize);
+		}
+
+		/**
+		 * Look for an entry by its key
+		 * @param[in] key The key to look for
+		 * @return The handle of the entry or #InvalidHandle if no entry has this key
+		 */
+		Handle findHandle(const FlowKey& key) const
+		{
+			if (m_Size == 0)
+				return InvalidHandle;
+
+			return m_Index[findSlot(key, hashKey(key))].handle;
+		}
+
+		/**
+		 * Look for an entry by its key
+		 * @param[in] key The key to look for
+		 * @return An iterator to the entry or end() if no entry has this key
+		 */
+		iterator find(const FlowKey& key) { return iterator(this, findHandle(key)); }
+
+		/**
+		 * Look for an entry by its key
+		 * @param[in] key The key to look for
+		 * @return An iterator to the entry or end() if no entry has this key
+		 */
+		const_iterator find(const FlowKey& key) const { return const_iterator(this, findHandle(key)); }
+
+		/**
+		 * Insert an entry if no entry with the same key exists
+		 * @param[in] value The entry to insert
+		 * @return A pair of an iterator to the entry with this key and a flag which is true if the entry was inserted or false if
+		 * an entry with the same key already existed (in which case it's not modified)
+		 */
+		std::pair<iterator, bool> insert(const value_type& value)
+		{
+			uint32_t hash = hashKey(value.first);
+			size_t slot = findSlot(value.first, hash);
+			if (m_Index[slot].handle != InvalidHandle)
+				return std::pair<iterator, bool>(iterator(this, m_Index[slot].handle), false);
+
+			if (m_Size + 1 > getMaxLoad(m_Index.size()))
+			{
+				rebuildIndex(m_Index.size() * 2);
+				slot = findSlot(value.first, hash);
+			}
+
+			if (m_FreeHandles.empty())
+				addChunk();
+
+			Handle handle = m_FreeHandles.back();
+			new (getEntry(handle)) value_type(value);
+			m_FreeHandles.pop_back();
+			linkHandle(handle);
+			m_Index[slot].hash = hash;
+			m_Index[slot].handle = handle;
+			m_Size++;
+
+			return std::pair<iterator, bool>(iterator(this, handle), true);
+		}
+
+		/**
+		 * Get the value of a key, inserting a default constructed value if no entry has this key
+		 * @param[in] key The key
+		 * @return A reference to the value
+		 */
+		TValue& operator[](const FlowKey& key)
+		{
+			Handle handle = findHandle(key);
+			if (handle != InvalidHandle)
+				return at(handle).second;
+
+			return insert(value_type(key, TValue())).first->second;
+		}
+
+		/**
+		 * Erase the entry of a key
+		 * @param[in] key The key of the entry to erase
+		 * @return 1 if the entry was erased, 0 if no entry has this key
+		 */
+		size_t erase(const FlowKey& key)
+		{
+			if (m_Size == 0)
+				return 0;
+
+			size_t slot = findSlot(key, hashKey(key));
+			if (m_Index[slot].handle == InvalidHandle)
+				return 0;
+
+			eraseSlot(slot);
+			return 1;
+		}
+
+		/**
+		 * Erase the entry an iterator points to. Other iterators stay valid
+		 * @param[in] pos An iterator to the entry to erase
+		 */
+		void erase(iterator pos)
+		{
+			FlowKey key = pos->first;
+			erase(key);
+		}
+
+		/**
+		 * Erase all entries. The allocated memory is kept for following insertions
+		 */
+		void clear()
+		{
+			if (m_Size == 0)
+				return;
+
+			for (Handle handle = m_FirstHandle; handle != InvalidHandle; handle = m_Links[handle].next)
+				getEntry(handle)->~value_type();
+
+			m_FirstHandle = InvalidHandle;
+			m_LastHandle = InvalidHandle;
+
+			m_FreeHandles.clear();
+			for (size_t i = m_Links.size(); i > 0; i--)
+				m_FreeHandles.push_back((Handle)(i - 1));
+
+			for (size_t i = 0; i < m_Index.size(); i++)
+				m_Index[i].handle = InvalidHandle;
+
+			m_Size = 0;
+		}
+
+		/**
+		 * Get an entry by its handle
+		 * @param[in] handle A valid handle of an entry (returned by findHandle() or iterator#getHandle())
+		 * @return A reference to the entry
+		 */
+		value_type& at(Handle handle) { return *getEntry(handle); }
+
+		/**
+		 * Get an entry by its handle
+		 * @param[in] handle A valid handle of an entry (returned by findHandle() or iterator#getHandle())
+		 * @return A const reference to the entry
+		 */
+		const value_type& at(Handle handle) const { return *getEntry(handle); }
+
+		/**
+		 * Get the handle of the entry that follows a given entry in the iteration order
+		 * @param[in] handle The handle of the current entry
+		 * @return The handle of the next entry or #InvalidHandle if it's the last entry
+		 */
+		Handle getNextHandle(Handle handle) const { return m_Links[handle].next; }
+
+		iterator begin() { return iterator(this, m_FirstHandle); }
+
+		const_iterator begin() const { return const_iterator(this, m_FirstHandle); }
+
+		iterator end() { return iterator(this, InvalidHandle); }
+
+		const_iterator end() const { return const_iterator(this, InvalidHandle); }
+
+	private:
+		struct IndexSlot
+		{
+			// the lower 32 bits of the key's hash, used both for choosing the slot and for skipping mismatching keys
+			uint32_t hash;
+			Handle handle;
+		};
+
+		// the previous and next live entries in the iteration order
+		struct EntryLinks
+		{
+			Handle prev;
+			Handle next;
+		};
+
+		std::vector<IndexSlot> m_Index;
+		size_t m_IndexMask;
+		std::vector<uint8_t*> m_Chunks;
+		std::vector<EntryLinks> m_Links;
+		Handle m_FirstHandle;
+		Handle m_LastHandle;
+		std::vector<Handle> m_FreeHandles;
+		size_t m_Size;
+
+		// the index is kept at most 3/4 full so probe sequences stay short
+		static size_t getMaxLoad(size_t indexSize) { return indexSize - indexSize / 4; }
+
+		static uint32_t hashKey(const FlowKey& key)
+		{
+			uint64_t hash = key.hash();
+			return (uint32_t)(hash ^ (hash >> 32));
+		}
+
+		value_type* getEntry(Handle handle) const
+		{
+			return (value_type*)(m_Chunks[handle / PCPP_FLOW_TABLE_CHUNK_SIZE]) + (handle % PCPP_FLOW_TABLE_CHUNK_SIZE);
+		}
+
+		// find the slot of a key or the empty slot where it should be inserted
+		size_t findSlot(const FlowKey& key, uint32_t hash) const
+		{
+			size_t slot = hash & m_IndexMask;
+			while (m_Index[slot].handle != InvalidHandle)
+			{
+				if (m_Index[slot].hash == hash && getEntry(m_Index[slot].handle)->first == key)
+					return slot;
+
+				slot = (slot + 1) & m_IndexMask;
+			}
+
+			return slot;
+		}
+
+		void eraseSlot(size_t slot)
+		{
+			Handle handle = m_Index[slot].handle;
+			getEntry(handle)->~value_type();
+			unlinkHandle(handle);
+			m_FreeHandles.push_back(handle);
+			m_Size--;
+
+			// backward shift deletion: move back the following entries of the probe sequence that may be stored in the hole, so
+			// lookups never have to skip deleted slots
+			size_t hole = slot;
+			size_t cur = (slot + 1) & m_IndexMask;
+			while (m_Index[cur].handle != InvalidHandle)
+			{
+				size_t home = m_Index[cur].hash & m_IndexMask;
+				if (((cur - home) & m_IndexMask) >= ((cur - hole) & m_IndexMask))
+				{
+					m_Index[hole] = m_Index[cur];
+					hole = cur;
+				}
+
+				cur = (cur + 1) & m_IndexMask;
+			}
+
+			m_Index[hole].handle = InvalidHandle;
+		}
+
+		void linkHandle(Handle handle)
+		{
+			m_Links[handle].prev = m_LastHandle;
+			m_Links[handle].next = InvalidHandle;
+			if (m_LastHandle == InvalidHandle)
+				m_FirstHandle = handle;
+			else
+				m_Links[m_LastHandle].next = handle;
+
+			m_LastHandle = handle;
+		}
+
+		void unlinkHandle(Handle handle)
+		{
+			Handle prev = m_Links[handle].prev;
+			Handle next = m_Links[handle].next;
+			if (prev == InvalidHandle)
+				m_FirstHandle = next;
+			else
+				m_Links[prev].next = next;
+
+			if (next == InvalidHandle)
+				m_LastHandle = prev;
+			else
+				m_Links[next].prev = prev;
+		}
+
+		void rebuildIndex(size_t indexSize)
+		{
+			std::vector<IndexSlot> oldIndex;
+			oldIndex.swap(m_Index);
+
+			IndexSlot emptySlot;
+			emptySlot.hash = 0;
+			emptySlot.handle = InvalidHandle;
+			m_Index.assign(indexSize, emptySlot);
+			m_IndexMask = indexSize - 1;
+
+			// only the index is rebuilt, the entries don't move and their keys aren't rehashed
+			for (size_t i = 0; i < oldIndex.size(); i++)
+			{
+				if (oldIndex[i].handle == InvalidHandle)
+					continue;
+
+				size_t slot = oldIndex[i].hash & m_IndexMask;
+				while (m_Index[slot].handle != InvalidHandle)
+					slot = (slot + 1) & m_IndexMask;
+
+				m_Index[slot] = oldIndex[i];
+			}
+		}
+
+		void addChunk()
+		{
+			size_t firstHandle = m_Links.size();
+			m_Chunks.push_back((uint8_t*)::operator new(PCPP_FLOW_TABLE_CHUNK_SIZE * sizeof(value_type)));
+			EntryLinks unlinked;
+			unlinked.prev = InvalidHandle;
+			unlinked.next = InvalidHandle;
+			m_Links.resize(firstHandle + PCPP_FLOW_TABLE_CHUNK_SIZE, unlinked);
+
+			// the free handles are a stack, push them in reverse order so the lower handles are used first
+			m_FreeHandles.reserve(m_FreeHandles.size() + PCPP_FLOW_TABLE_CHUNK_SIZE);
+			for (size_t i = firstHandle + PCPP_FLOW_TABLE_CHUNK_SIZE; i > firstHandle; i--)
+				m_FreeHandles.push_back((Handle)(i - 1));
+		}
+	};
+
+	template<class TValue>
+	const typename FlowTable<TValue>::Handle FlowTable<TValue>::InvalidHandle;
+
+} // namespace pcpp
+
+#endif /* PACKETPP_FLOW_TABLE */
@@ -58,6 +58,42 @@ namespace pcpp
 	/** Server field */
 #define PCPP_HTTP_SERVER_FIELD				"Server"
 
+	/**
+	 * @struct HttpFieldNames
+	 * Interned names of the popular HTTP fields, for looking them up with TextBasedProtocolMessage#getFieldByName(const HeaderFieldName&, int) const
+	 * without copying or hashing the name on every lookup. Notice these are initialized during static initialization, so they shouldn't be
+	 * used by static initializers of other translation units
+	 */
+	struct HttpFieldNames
+	{
+		/** ::PCPP_HTTP_HOST_FIELD */
+		static const HeaderFieldName Host;
+		/** ::PCPP_HTTP_CONNECTION_FIELD */
+		static const HeaderFieldName Connection;
+		/** ::PCPP_HTTP_USER_AGENT_FIELD */
+		static const HeaderFieldName UserAgent;
+		/** ::PCPP_HTTP_REFERER_FIELD */
+		static const HeaderFieldName Referer;
+		/** ::PCPP_HTTP_ACCEPT_FIELD */
+		static const HeaderFieldName Accept;
+		/** ::PCPP_HTTP_ACCEPT_ENCODING_FIELD */
+		static const HeaderFieldName AcceptEncoding;
+		/** ::PCPP_HTTP_ACCEPT_LANGUAGE_FIELD */
+		static const HeaderFieldName AcceptLanguage;
+		/** ::PCPP_HTTP_COOKIE_FIELD */
+		static const HeaderFieldName Cookie;
+		/** ::PCPP_HTTP_CONTENT_LENGTH_FIELD */
+		static const HeaderFieldName ContentLength;
+		/** ::PCPP_HTTP_CONTENT_ENCODING_FIELD */
+		static const HeaderFieldName ContentEncoding;
+		/** ::PCPP_HTTP_CONTENT_TYPE_FIELD */
+		static const HeaderFieldName ContentType;
+		/** ::PCPP_HTTP_TRANSFER_ENCODING_FIELD */
+		static const HeaderFieldName TransferEncoding;
+		/** ::PCPP_HTTP_SERVER_FIELD */
+		static const HeaderFieldName Server;
+	};
+
 
 
 	// -------- Class HttpMessage -----------------
@@ -98,6 +98,8 @@ namespace pcpp
 		PACKETPP_IPPROTO_NONE = 59,
 		/** IPv6 Destination options		*/
 		PACKETPP_IPPROTO_DSTOPTS = 60,
+		/** Stream Control Transmission Protocol	*/
+		PACKETPP_IPPROTO_SCTP = 132,
 		/** Raw IP packets			*/
 		PACKETPP_IPPROTO_RAW = 255,
 		/** Maximum value */
@@ -465,8 +467,12 @@ namespace pcpp
 		/**
 		 * Set the source IP address
 		 * @param[in] ipAddr The IP address to set
+		 * @param[in] updateChecksums If set to true the IPv4 header checksum and the checksum of the TCP or UDP header carried
+		 * by this layer (which covers the address through the pseudo header) are updated incrementally (RFC 1624), so there is no
+		 * need to call computeCalculateFields() and the cost doesn't depend on the packet size. The existing checksums are assumed
+		 * to be correct. The default value is false
 		 */
-		void setSrcIpAddress(const IPv4Address& ipAddr) { getIPv4Header()->ipSrc = ipAddr.toInt(); }
+		void setSrcIpAddress(const IPv4Address& ipAddr, bool updateChecksums = false);
 
 		/**
 		 * Get the destination IP address in the form of IPv4Address
@@ -477,8 +483,18 @@ namespace pcpp
 		/**
 		 * Set the dest IP address
 		 * @param[in] ipAddr The IP address to set
+		 * @param[in] updateChecksums If set to true the IPv4 header checksum and the TCP or UDP checksum are updated incrementally.
+		 * See setSrcIpAddress(). The default value is false
 		 */
-		void setDstIpAddress(const IPv4Address& ipAddr) { getIPv4Header()->ipDst = ipAddr.toInt(); }
+		void setDstIpAddress(const IPv4Address& ipAddr, bool updateChecksums = false);
+
+		/**
+		 * Set the time-to-live field
+		 * @param[in] ttl The value to set
+		 * @param[in] updateChecksum If set to true the IPv4 header checksum is updated incrementally (RFC 1624) instead of having
+		 * to call computeCalculateFields(). The default value is false
+		 */
+		void setTimeToLive(uint8_t ttl, bool updateChecksum = false);
 
 		/**
 		 * @return True if this packet is a fragment (in sense of IP fragmentation), false otherwise
@@ -606,7 +622,7 @@ namespace pcpp
 	private:
 		int m_NumOfTrailingBytes;
 		int m_TempHeaderExtension;
-		TLVRecordReader<IPv4Option> m_OptionReader;
+		IndexedTLVRecordReader<IPv4Option, uint8_t> m_OptionReader;
 
 		void copyLayerData(const IPv4Layer& other);
 		uint8_t* getOptionsBasePtr() const { return m_Data + sizeof(iphdr); }
@@ -614,6 +630,7 @@ namespace pcpp
 		void adjustOptionsTrailer(size_t totalOptSize);
 		void initLayer();
 		void initLayerInPacket(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet, bool setTotalLenAsDataLen);
+		void setIpAddressAndUpdateChecksums(uint32_t* addrField, uint32_t newAddr);
 	};
 
 
@@ -332,7 +332,7 @@ namespace pcpp
 
 	private:
 
-		TLVRecordReader<IPv6Option> m_OptionReader;
+		IndexedTLVRecordReader<IPv6Option> m_OptionReader;
 	};
 
 
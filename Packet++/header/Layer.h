@@ -76,9 +76,10 @@ namespace pcpp
 		virtual ~Layer();
 
 		/**
-		 * @return A pointer to the next layer in the protocol stack or NULL if the layer is the last one
+		 * @return A pointer to the next layer in the protocol stack or NULL if the layer is the last one. If the layer belongs to a packet
+		 * parsed in lazy mode and the next layer wasn't parsed yet, it's parsed now
 		 */
-		Layer* getNextLayer() const { return m_NextLayer; }
+		Layer* getNextLayer() const { return m_IsNextLayerPending ? parseNextLayerOnDemand() : m_NextLayer; }
 
 		/**
 		 * @return A pointer to the previous layer in the protocol stack or NULL if the layer is the first one
@@ -120,6 +121,21 @@ namespace pcpp
 		 */
 		bool isAllocatedToPacket() const { return m_Packet != NULL; }
 
+		/**
+		 * @return True if the layer was modified since the packet was parsed or since the last call to
+		 * Packet#computeCalculateFields(), false otherwise. See markAsModified()
+		 */
+		bool isModified() const { return m_IsModified; }
+
+		/**
+		 * Mark the layer as modified, so calling Packet#computeCalculateFields() for modified layers only recalculates the fields of
+		 * this layer and of the layers it depends on. Layers are marked automatically when they're extended or shortened, when
+		 * layers are added or removed from the packet, and by layer setters that change fields other calculated fields depend on.
+		 * Changes made directly to the header (for example through IPv4Layer#getIPv4Header()) must be marked with this method, and if
+		 * the packet may share its data with copy-on-write clones, Packet#makeWritable() must be called before making them
+		 */
+		void markAsModified() { m_IsModified = true; }
+
 		/**
 		 * Copy the raw data of this layer to another array
 		 * @param[out] toArr The destination byte array
@@ -159,6 +175,40 @@ namespace pcpp
 		 */
 		virtual OsiModelLayer getOsiModelLayer() const = 0;
 
+
+		// memory management
+
+		/**
+		 * Allocate a layer on the heap. This is the allocation used when creating layers with a plain new expression
+		 * @param[in] size The size in bytes of the layer object
+		 * @return A pointer to the allocated memory
+		 */
+		static void* operator new(size_t size);
+
+		/**
+		 * Allocate a layer that belongs to a packet. If the packet was set with a pcpp#LayerArena the layer is allocated from
+		 * the arena, otherwise (or if the arena can't serve the allocation) the memory of a same-size layer recycled by
+		 * Packet#setRawPacket() is reused if available, or else it's allocated on the heap. This is the allocation
+		 * used by layers when parsing the next layer, for example: new(m_Packet) TcpLayer(...)
+		 * @param[in] size The size in bytes of the layer object
+		 * @param[in] packet The packet the layer belongs to. Can be NULL
+		 * @return A pointer to the allocated memory
+		 */
+		static void* operator new(size_t size, Packet* packet);
+
+		/**
+		 * Free a layer's memory, either by returning it to the arena it was allocated from or to the heap
+		 * @param[in] ptr A pointer to the layer's memory
+		 */
+		static void operator delete(void* ptr);
+
+		/**
+		 * Free a layer's memory in case its c'tor threw an exception. Behaves exactly like operator delete(void*)
+		 * @param[in] ptr A pointer to the layer's memory
+		 * @param[in] packet Ignored
+		 */
+		static void operator delete(void* ptr, Packet* packet);
+
 	protected:
 		uint8_t* m_Data;
 		size_t m_DataLen;
@@ -167,13 +217,15 @@ namespace pcpp
 		Layer* m_NextLayer;
 		Layer* m_PrevLayer;
 		bool m_IsAllocatedInPacket;
+		bool m_IsNextLayerPending;
+		bool m_IsModified;
 
-		Layer() : m_Data(NULL), m_DataLen(0), m_Packet(NULL), m_Protocol(UnknownProtocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false) { }
+		Layer() : m_Data(NULL), m_DataLen(0), m_Packet(NULL), m_Protocol(UnknownProtocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false), m_IsNextLayerPending(false), m_IsModified(false) { }
 
 		Layer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) :
 			m_Data(data), m_DataLen(dataLen),
 			m_Packet(packet), m_Protocol(UnknownProtocol),
-			m_NextLayer(NULL), m_PrevLayer(prevLayer), m_IsAllocatedInPacket(false) {}
+			m_NextLayer(NULL), m_PrevLayer(prevLayer), m_IsAllocatedInPacket(false), m_IsNextLayerPending(false), m_IsModified(false) {}
 
 		// Copy c'tor
 		Layer(const Layer& other);
@@ -182,8 +234,16 @@ namespace pcpp
 		void setNextLayer(Layer* nextLayer) { m_NextLayer = nextLayer; }
 		void setPrevLayer(Layer* prevLayer) { m_PrevLayer = prevLayer; }
 
+		// setters call this method before writing to the layer data, so a packet that shares its data with copy-on-write clones
+		// copies it first (see Packet#makeWritable())
+		void makePacketWritable();
+
 		virtual bool extendLayer(int offsetInLayer, size_t numOfBytesToExtend);
 		virtual bool shortenLayer(int offsetInLayer, size_t numOfBytesToShorten);
+
+	private:
+		Layer* parseNextLayerOnDemand() const;
+		bool isAllocatedOnHeap() const;
 	};
 
 } // namespace pcpp
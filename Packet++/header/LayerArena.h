@@ -0,0 +1,114 @@
+#ifndef PACKETPP_LAYER_ARENA
+#define PACKETPP_LAYER_ARENA
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/// @file
+
+/**
+ * The default size in bytes of each slab allocated by pcpp#LayerArena
+ */
+#define PCPP_LAYER_ARENA_DEFAULT_SLAB_SIZE 4096
+
+/**
+ * The alignment in bytes of every allocation served by pcpp#LayerArena
+ */
+#define PCPP_LAYER_ARENA_ALIGNMENT 16
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @class LayerArena
+	 * A bump allocator that pcpp#Packet can use for the layers it creates while parsing a raw packet, instead of allocating
+	 * each layer separately on the heap. Memory is taken from a list of fixed-size slabs which are allocated once and kept
+	 * for the lifetime of the arena. Freeing a layer only decrements a counter of live allocations; once this counter drops to
+	 * zero (which typically happens when the packet is destructed or re-parsed with Packet#setRawPacket()) the whole arena is
+	 * rewound in one shot and the slabs are reused for the next packet.<BR>
+	 * A single arena can be shared by several Packet instances (for example one arena per capture thread), in which case it's
+	 * rewound only when all layers allocated from it were freed. Please notice:
+	 * - The arena isn't thread-safe. It should be used by one thread at a time
+	 * - The arena must outlive all layers allocated from it, including layers that were detached from their packet
+	 * - Allocations larger than the slab size can't be served by the arena. In this case the layer is allocated on the heap
+	 */
+	class LayerArena
+	{
+	public:
+		/**
+		 * A c'tor for this class
+		 * @param[in] slabSize The size in bytes of each slab. Default is ::PCPP_LAYER_ARENA_DEFAULT_SLAB_SIZE
+		 * @param[in] numOfSlabsToPreallocate The number of slabs to allocate upfront. More slabs are allocated on demand.
+		 * Default is 1
+		 */
+		LayerArena(size_t slabSize = PCPP_LAYER_ARENA_DEFAULT_SLAB_SIZE, size_t numOfSlabsToPreallocate = 1);
+
+		/**
+		 * A d'tor for this class. Frees all slabs. An error is printed to log if there are still live allocations
+		 */
+		~LayerArena();
+
+		/**
+		 * Allocate a memory chunk from the arena
+		 * @param[in] size The requested size in bytes
+		 * @return A pointer to the allocated memory aligned to ::PCPP_LAYER_ARENA_ALIGNMENT, or NULL if the requested size is
+		 * larger than the slab size
+		 */
+		void* allocate(size_t size);
+
+		/**
+		 * Return a memory chunk previously allocated by allocate(). The memory isn't reused until all live allocations are
+		 * returned, at which point the arena is rewound
+		 * @param[in] ptr A pointer previously returned by allocate()
+		 */
+		void deallocate(void* ptr);
+
+		/**
+		 * Rewind the arena so all slabs can be reused. This happens automatically when the last live allocation is returned,
+		 * so calling this method is rarely needed
+		 * @return True if the arena was rewound or false if there are still live allocations (in which case the arena isn't
+		 * changed and an error is printed to log)
+		 */
+		bool reset();
+
+		/**
+		 * @return The number of allocations currently in use
+		 */
+		size_t getNumOfLiveAllocations() const { return m_NumOfLiveAllocations; }
+
+		/**
+		 * @return The size in bytes of each slab
+		 */
+		size_t getSlabSize() const { return m_SlabSize; }
+
+		/**
+		 * @return The number of slabs currently allocated by the arena
+		 */
+		size_t getNumOfSlabs() const { return m_Slabs.size(); }
+
+		/**
+		 * @return The total number of allocations served by the arena since it was created
+		 */
+		uint64_t getTotalNumOfAllocations() const { return m_TotalNumOfAllocations; }
+
+	private:
+		std::vector<uint8_t*> m_Slabs;
+		size_t m_SlabSize;
+		size_t m_CurSlab;
+		size_t m_CurOffset;
+		size_t m_NumOfLiveAllocations;
+		uint64_t m_TotalNumOfAllocations;
+
+		// the arena isn't copyable
+		LayerArena(const LayerArena& other);
+		LayerArena& operator=(const LayerArena& other);
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_LAYER_ARENA */
@@ -60,7 +60,7 @@ namespace pcpp
 		 * Set the TTL value
 		 * @param[in] ttl The TTL value to set
 		 */
-		void setTTL(uint8_t ttl) { getMplsHeader()->ttl = ttl; }
+		void setTTL(uint8_t ttl) { makePacketWritable(); getMplsHeader()->ttl = ttl; }
 
 		/**
 		 * Get an indication whether the next layer is also be a MPLS label or not
@@ -0,0 +1,246 @@
+#ifndef PACKETPP_NEXT_LAYER_REGISTRY
+#define PACKETPP_NEXT_LAYER_REGISTRY
+
+#include "ProtocolType.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/**
+ * The maximum number of different parsers that can be registered in a single dispatch table of pcpp#NextLayerRegistry
+ */
+#define PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS 32
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	class Layer;
+	class Packet;
+
+	/**
+	 * A function that parses the payload of a layer as a certain protocol. It's called by the layer's parseNextLayer() with the payload
+	 * of the layer, and should allocate the new layer with new(packet) (see Layer#operator new(size_t, Packet*)). Layers that own
+	 * the next protocol's selector (for example the ports of UdpLayer) can be reached through prevLayer
+	 * @param[in] data A pointer to the payload of the previous layer
+	 * @param[in] dataLen The payload length in bytes
+	 * @param[in] prevLayer The layer whose payload is parsed
+	 * @param[in] packet The packet the layers belong to
+	 * @return The new layer or NULL if the data isn't of this parser's protocol, in which case the next parser registered to the same
+	 * key is tried
+	 */
+	typedef Layer* (*NextLayerParser)(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
+
+	/**
+	 * @class NextLayerRegistry
+	 * A singleton that maps the selectors of next protocols (TCP and UDP ports, EtherTypes and IP protocol numbers) to the parsers
+	 * of these protocols. Each dispatch table is a flat array indexed by the selector value whose entries are bit masks of the
+	 * parsers registered to this value, so finding the candidate parsers of a packet is a single array access instead of a chain of
+	 * port comparisons. Parsers can be registered and unregistered at runtime, which allows classifying a protocol on a non-standard
+	 * port (see registerProtocol()) or disabling the parsing of protocols the application isn't interested in (see
+	 * unregisterProtocol()). Payloads that no registered parser accepts are parsed as pcpp#PayloadLayer.<BR>
+	 * The built-in application protocols over TCP and UDP and the built-in protocols over Ethernet, VLAN and Linux cooked capture are
+	 * registered when the registry is created. The IP protocol table is empty by default: IPv4Layer and IPv6Layer parse the built-in
+	 * IP protocols themselves (since the two differ in the way they do it) and use the table only for parsers registered by the user,
+	 * which take precedence over the built-in parsing. Registering parseAsPayload() to an IP protocol disables its parsing.<BR>
+	 * If more than one parser is registered to a key they're tried in the order of their slots in the table: a parser takes the first
+	 * free slot when it's first registered to the table, and its slot is freed when it's unregistered from all keys. This means the
+	 * built-in parsers are tried before parsers registered by the user, unless they were unregistered.<BR>
+	 * The registry isn't thread-safe: parsers should be registered and unregistered while no packets are being parsed
+	 */
+	class NextLayerRegistry
+	{
+	public:
+		/**
+		 * The dispatch tables of the registry
+		 */
+		enum DispatchTable
+		{
+			/** Parsers of TCP payloads, keyed by TCP port */
+			TcpPortTable,
+			/** Parsers of UDP payloads, keyed by UDP port */
+			UdpPortTable,
+			/** Parsers of Ethernet, VLAN and Linux cooked capture payloads, keyed by EtherType */
+			EtherTypeTable,
+			/** Parsers of IPv4 and IPv6 payloads, keyed by IP protocol number (see pcpp#IPProtocolTypes) */
+			IPProtocolTable,
+			/** The number of dispatch tables */
+			NumOfDispatchTables
+		};
+
+		/**
+		 * Which of the ports of a packet should be matched against the ports a parser is registered to. Relevant only for the TCP
+		 * and UDP port tables
+		 */
+		enum PortMatch
+		{
+			/** The parser is tried if either the source or the destination port matches */
+			MatchSrcOrDstPort,
+			/** The parser is tried only if the source port matches (for example HTTP responses) */
+			MatchSrcPort,
+			/** The parser is tried only if the destination port matches (for example HTTP requests) */
+			MatchDstPort
+		};
+
+		/**
+		 * @return The registry singleton. The built-in parsers are registered when it's first accessed
+		 */
+		static NextLayerRegistry& getInstance()
+		{
+			static NextLayerRegistry instance;
+			return instance;
+		}
+
+		/**
+		 * Register a parser to a key of a dispatch table
+		 * @param[in] table The dispatch table
+		 * @param[in] key The port, EtherType or IP protocol number to register the parser to. IP protocol numbers must be lower than 256
+		 * @param[in] parser The parser
+		 * @param[in] protocol The protocol (or protocols) the parser creates. It's used for finding the parser by protocol in
+		 * registerProtocol(), unregisterProtocol() and isProtocolRegistered(). The default is ::UnknownProtocol
+		 * @param[in] portMatch Which of the ports should be matched against the key. Ignored for the EtherType and IP protocol tables.
+		 * The default is to match either port
+		 * @return True if the parser was registered or false if the key is out of range or the table has no free slot for a new parser.
+		 * Registering a parser to a key it's already registered to does nothing and returns true
+		 */
+		bool registerParser(DispatchTable table, uint16_t key, NextLayerParser parser, ProtocolType protocol = UnknownProtocol, PortMatch portMatch = MatchSrcOrDstPort);
+
+		/**
+		 * Register the parser(s) of a protocol to another key, for example to classify DNS over a non-standard UDP port. The protocol
+		 * must already be registered to the table (for example by the built-in parsers), each parser creating this protocol is
+		 * registered to the key with the same port matching it was registered with
+		 * @param[in] table The dispatch table
+		 * @param[in] key The port, EtherType or IP protocol number to register the protocol to
+		 * @param[in] protocol The protocol
+		 * @return True if the protocol was registered or false if no parser of this protocol is registered in the table
+		 */
+		bool registerProtocol(DispatchTable table, uint16_t key, ProtocolType protocol);
+
+		/**
+		 * Unregister a parser from a key of a dispatch table
+		 * @param[in] table The dispatch table
+		 * @param[in] key The key to unregister the parser from
+		 * @param[in] parser The parser
+		 * @return True if the parser was registered to the key, false otherwise
+		 */
+		bool unregisterParser(DispatchTable table, uint16_t key, NextLayerParser parser);
+
+		/**
+		 * Unregister the parsers of a protocol from a single key of a dispatch table
+		 * @param[in] table The dispatch table
+		 * @param[in] key The key to unregister the protocol from
+		 * @param[in] protocol The protocol. Parsers creating any of the protocols in this bit mask are unregistered
+		 * @return True if a parser of the protocol was registered to the key, false otherwise
+		 */
+		bool unregisterProtocol(DispatchTable table, uint16_t key, ProtocolType protocol);
+
+		/**
+		 * Unregister the parsers of a protocol from all keys of a dispatch table, which disables the parsing of this protocol.
+		 * For example unregisterProtocol(NextLayerRegistry::UdpPortTable, DNS) makes all DNS traffic parsed as pcpp#PayloadLayer
+		 * @param[in] table The dispatch table
+		 * @param[in] protocol The protocol. Parsers creating any of the protocols in this bit mask are unregistered
+		 * @return True if a parser of the protocol was registered, false otherwise
+		 */
+		bool unregisterProtocol(DispatchTable table, ProtocolType protocol);
+
+		/**
+		 * Unregister all parsers of a key of a dispatch table
+		 * @param[in] table The dispatch table
+		 * @param[in] key The key
+		 */
+		void unregisterKey(DispatchTable table, uint16_t key);
+
+		/**
+		 * @param[in] table The dispatch table
+		 * @param[in] key The key
+		 * @param[in] protocol The protocol
+		 * @return True if a parser creating any of the protocols in this bit mask is registered to the key, false otherwise
+		 */
+		bool isProtocolRegistered(DispatchTable table, uint16_t key, ProtocolType protocol) const;
+
+		/**
+		 * Remove all parsers registered by the user and restore the built-in parsers that were unregistered
+		 */
+		void resetToDefault();
+
+		/**
+		 * Parse a payload using the parsers registered to a key. Used by layers with a single next protocol selector (EtherType,
+		 * IP protocol)
+		 * @param[in] table The dispatch table
+		 * @param[in] key The key of the payload's protocol
+		 * @param[in] data A pointer to the payload
+		 * @param[in] dataLen The payload length in bytes
+		 * @param[in] prevLayer The layer whose payload is parsed
+		 * @param[in] packet The packet the layers belong to
+		 * @return The layer created by the first parser that accepted the payload or NULL if none did
+		 */
+		Layer* parseNextLayer(DispatchTable table, uint16_t key, uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) const
+		{
+			const uint32_t* keyMasks = m_KeyMasks[table];
+			if (keyMasks == NULL || (table == IPProtocolTable && key > 0xff) || keyMasks[key] == 0)
+				return NULL;
+
+			return parseByMasks(table, keyMasks[key], keyMasks[key], data, dataLen, prevLayer, packet);
+		}
+
+		/**
+		 * Parse a TCP or UDP payload using the parsers registered to its source and destination ports
+		 * @param[in] table The dispatch table (TcpPortTable or UdpPortTable)
+		 * @param[in] srcPort The source port in host byte order
+		 * @param[in] dstPort The destination port in host byte order
+		 * @param[in] data A pointer to the payload
+		 * @param[in] dataLen The payload length in bytes
+		 * @param[in] prevLayer The layer whose payload is parsed
+		 * @param[in] packet The packet the layers belong to
+		 * @return The layer created by the first parser that accepted the payload or NULL if none did
+		 */
+		Layer* parseNextLayer(DispatchTable table, uint16_t srcPort, uint16_t dstPort, uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) const
+		{
+			const uint32_t* keyMasks = m_KeyMasks[table];
+			if (keyMasks == NULL || (keyMasks[srcPort] | keyMasks[dstPort]) == 0)
+				return NULL;
+
+			return parseByMasks(table, keyMasks[srcPort], keyMasks[dstPort], data, dataLen, prevLayer, packet);
+		}
+
+		/**
+		 * A parser that parses any payload as pcpp#PayloadLayer. Registering it to a key whose protocol is parsed by the layer itself
+		 * (for example an IP protocol) disables the parsing of this protocol
+		 */
+		static Layer* parseAsPayload(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
+
+	private:
+		struct ParserSlot
+		{
+			NextLayerParser parser;
+			ProtocolType protocol;
+			PortMatch portMatch;
+			// the number of keys the parser is registered to. The slot is free when it's 0
+			size_t numOfKeys;
+		};
+
+		// a bit mask of parser slots per key. The tables are allocated on the first registration
+		uint32_t* m_KeyMasks[NumOfDispatchTables];
+		ParserSlot m_Parsers[NumOfDispatchTables][PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS];
+
+		NextLayerRegistry();
+		~NextLayerRegistry();
+
+		// the registry is a singleton, it can't be copied
+		NextLayerRegistry(const NextLayerRegistry& other);
+		NextLayerRegistry& operator=(const NextLayerRegistry& other);
+
+		Layer* parseByMasks(DispatchTable table, uint32_t srcMask, uint32_t dstMask, uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) const;
+		bool isKeyValid(DispatchTable table, uint16_t key) const;
+		void unregisterSlotFromKey(DispatchTable table, uint16_t key, int slot);
+		void clear();
+		void registerBuiltInParsers();
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_NEXT_LAYER_REGISTRY */
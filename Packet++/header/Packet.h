@@ -3,10 +3,16 @@
 
 #include "RawPacket.h"
 #include "Layer.h"
+#include "LayerArena.h"
 #include <vector>
 
 /// @file
 
+/**
+ * The maximum number of layer objects a pcpp#Packet keeps for reuse after its raw packet is replaced
+ */
+#define PCPP_PACKET_MAX_RECYCLED_LAYERS 16
+
 /**
  * \namespace pcpp
  * \brief The main namespace for the PcapPlusPlus lib
@@ -33,6 +39,16 @@ namespace pcpp
 		uint64_t m_ProtocolTypes;
 		size_t m_MaxPacketLen;
 		bool m_FreeRawPacket;
+		LayerArena* m_LayerArena;
+		ProtocolType m_ParseUntil;
+		OsiModelLayer m_ParseUntilLayer;
+		bool m_LazyParsing;
+		void* m_RecycledLayers[PCPP_PACKET_MAX_RECYCLED_LAYERS];
+		size_t m_NumOfRecycledLayers;
+		uint64_t m_NumOfLayerAllocations;
+		uint64_t m_NumOfRecycledLayerAllocations;
+		// the number of packets sharing the raw packet (see the copy-on-write constructor) or NULL if it isn't shared
+		mutable long* m_SharedRawDataRefCount;
 
 	public:
 
@@ -40,8 +56,10 @@ namespace pcpp
 		 * A constructor for creating a new packet. Very useful when creating packets.
 		 * When using this constructor an empty raw buffer is allocated (with the size of maxPacketLen) and a new RawPacket is created
 		 * @param[in] maxPacketLen The expected packet length in bytes
+		 * @param[in] headroom The number of free bytes to reserve in front of the packet data. Layers inserted at (or close to) the
+		 * beginning of the packet use this space instead of shifting the whole packet. See reserveHeadroom(). The default is 0
 		 */
-		Packet(size_t maxPacketLen = 1);
+		Packet(size_t maxPacketLen = 1, size_t headroom = 0);
 
 		/**
 		 * A constructor for creating a packet out of already allocated RawPacket. Very useful when parsing packets that came from the network.
@@ -56,8 +74,15 @@ namespace pcpp
 		 * @param[in] parseUntilLayer Optional parameter. Parse the packet until you reach a certain layer in the OSI model (inclusive). Can be useful for cases when you need to
 		 * parse only up to a certain OSI layer (for example transport layer) and want to avoid the performance impact and memory consumption of parsing the whole packet.
 		 * Default value is ::OsiModelLayerUnknown which means don't take this parameter into account
+		 * @param[in] layerArena Optional parameter. A pcpp#LayerArena to allocate the parsed layers from instead of allocating each
+		 * of them on the heap. The arena is owned by the user and must outlive all layers allocated from it. Default value is NULL which
+		 * means layers are allocated on the heap
+		 * @param[in] lazyParsing Optional parameter. If set to true only the first layer is parsed in the constructor and the rest of the
+		 * layers are parsed on demand, only as deep as the user asks for: when calling Layer#getNextLayer() on the last parsed layer,
+		 * getLayerOfType(), isPacketOfType(), getLastLayer(), etc. Parsed layers are kept, so each layer is parsed only once. Any method that
+		 * modifies the packet parses all of the remaining layers first. Default value is false which means all layers are parsed in the constructor
 		 */
-		Packet(RawPacket* rawPacket, bool freeRawPacket = false, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown);
+		Packet(RawPacket* rawPacket, bool freeRawPacket = false, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown, LayerArena* layerArena = NULL, bool lazyParsing = false);
 
 		/**
 		 * A constructor for creating a packet out of already allocated RawPacket. Very useful when parsing packets that came from the network.
@@ -86,14 +111,33 @@ namespace pcpp
 		 * class, for example layers that were added by addLayer() or insertLayer() ). In addition it frees the raw packet if it was allocated by
 		 * this instance (meaning if it was allocated by this instance constructor)
 		 */
-		virtual ~Packet() { destructPacketData(); }
+		virtual ~Packet() { destructPacketData(); freeRecycledLayers(); }
 
 		/**
 		 * A copy constructor for this class. This copy constructor copies all the raw data and re-create all layers. So when the original Packet
-		 * is being freed, no data will be lost in the copied instance
+		 * is being freed, no data will be lost in the copied instance. Layers of the copied instance are always allocated on the heap, even if
+		 * the original packet uses a pcpp#LayerArena
 		 * @param[in] other The instance to copy from
 		 */
-		Packet(const Packet& other) { copyDataFrom(other); }
+		Packet(const Packet& other) : m_NumOfRecycledLayers(0), m_NumOfLayerAllocations(0), m_NumOfRecycledLayerAllocations(0), m_SharedRawDataRefCount(NULL) { copyDataFrom(other); }
+
+		/**
+		 * A constructor for creating a copy-on-write clone of a packet. The clone shares the raw packet of the other packet instead of copying
+		 * it, and its layers are parsed lazily from the shared data, so a clone that is only read costs no data copy and creates only the
+		 * layers its user looks at. The shared raw packet is reference counted and freed (if it was owned by the packet it was cloned from)
+		 * when the last packet sharing it is freed.<BR>
+		 * The first call to a method that modifies the data of a packet that shares its raw packet (insertLayer(), removeLayer(),
+		 * Layer#extendLayer(), computeCalculateFields(), layer setters that call Layer#markAsModified(), etc.) copies the raw packet for
+		 * that packet only (see makeWritable()). Changes made directly to the layer data (for example through Layer#getData() or
+		 * IPv4Layer#getIPv4Header()) can't be detected, so makeWritable() must be called before making them.<BR>
+		 * Several threads may clone the same packet at the same time (for example to fan it out to several analyzers), and the packet and its
+		 * clones can be read, modified and freed by different threads since the reference count is created and updated atomically. The
+		 * packet that is cloned must not be modified or freed while other threads clone it. If the other packet doesn't own its raw packet,
+		 * the raw packet must not be changed or freed while it's shared
+		 * @param[in] other The packet to clone
+		 * @param[in] copyOnWrite If set to false the packet is fully copied, the same as the copy constructor
+		 */
+		Packet(const Packet& other, bool copyOnWrite);
 
 		/**
 		 * Assignment operator overloading. It first frees all layers allocated by this instance (Notice: it doesn't free layers that weren't allocated by this
@@ -104,6 +148,23 @@ namespace pcpp
 		 */
 		Packet& operator=(const Packet& other);
 
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+		/**
+		 * A move constructor for this class. The raw packet and all layers of the other packet are taken over without copying the data or
+		 * re-parsing the layers, and the other packet is left empty (without a raw packet and layers)
+		 * @param[in] other The instance to move from
+		 */
+		Packet(Packet&& other);
+
+		/**
+		 * Move assignment operator. It first frees all layers allocated by this instance and the raw packet if it's owned by this instance
+		 * (the same as operator=(const Packet&)). Then the raw packet and layers of the other packet are taken over without copying, and
+		 * the other packet is left empty
+		 * @param[in] other The instance to move from
+		 */
+		Packet& operator=(Packet&& other);
+#endif
+
 		/**
 		 * Get a pointer to the Packet's RawPacket
 		 * @return A pointer to the Packet's RawPacket
@@ -111,15 +172,43 @@ namespace pcpp
 		RawPacket* getRawPacket() const { return m_RawPacket; }
 
 		/**
-		 * Set a RawPacket and re-construct all packet layers
+		 * Set a RawPacket and re-construct all packet layers. The memory of the layers of the previous raw packet is recycled: layers allocated
+		 * on the heap are destructed but their memory is kept (up to ::PCPP_PACKET_MAX_RECYCLED_LAYERS layers) and reused for new layers of the
+		 * same size, which saves a delete+new pair per layer when consecutive packets have the same protocol stack. Layers allocated from a
+		 * pcpp#LayerArena are returned to the arena as usual. See getNumOfRecycledLayerAllocations() for the recycle hit rate
 		 * @param[in] rawPacket Raw packet to set
 		 * @param[in] freeRawPacket A flag indicating if the destructor should also call the raw packet destructor or not
 		 * @param[in] parseUntil Parse the packet until it reaches this protocol. Can be useful for cases when you need to parse only up to a certain layer and want to avoid the
 		 * performance impact and memory consumption of parsing the whole packet. Default value is ::UnknownProtocol which means don't take this parameter into account
 		 * @param[in] parseUntilLayer Parse the packet until certain layer in OSI model. Can be useful for cases when you need to parse only up to a certain layer and want to avoid the
 		 * performance impact and memory consumption of parsing the whole packet. Default value is ::OsiModelLayerUnknown which means don't take this parameter into account
+		 * @param[in] layerArena A pcpp#LayerArena to allocate the parsed layers from instead of allocating each of them on the heap. The arena
+		 * is owned by the user and must outlive all layers allocated from it. Default value is NULL which means layers are allocated on the heap
+		 * @param[in] lazyParsing If set to true only the first layer is parsed and the rest of the layers are parsed on demand. Please refer to
+		 * the constructor documentation for more details. Default value is false which means all layers are parsed
+		 */
+		void setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown, LayerArena* layerArena = NULL, bool lazyParsing = false);
+
+		/**
+		 * @return The pcpp#LayerArena parsed layers are allocated from or NULL if layers are allocated on the heap
+		 */
+		LayerArena* getLayerArena() const { return m_LayerArena; }
+
+		/**
+		 * @return True if this packet's layers are parsed on demand or false if they're all parsed when the raw packet is set
+		 */
+		bool isLazyParsing() const { return m_LazyParsing; }
+
+		/**
+		 * @return The number of layers this packet allocated while parsing since it was created
+		 */
+		uint64_t getNumOfLayerAllocations() const { return m_NumOfLayerAllocations; }
+
+		/**
+		 * @return The number of layer allocations (out of getNumOfLayerAllocations()) that were served by recycling the memory of a
+		 * layer of a previous raw packet instead of allocating new memory
 		 */
-		void setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil = UnknownProtocol, OsiModelLayer parseUntilLayer = OsiModelLayerUnknown);
+		uint64_t getNumOfRecycledLayerAllocations() const { return m_NumOfRecycledLayerAllocations; }
 
 		/**
 		 * Get a pointer to the Packet's RawPacket in a read-only manner
@@ -127,6 +216,25 @@ namespace pcpp
 		 */
 		RawPacket* getRawPacketReadOnly() const { return m_RawPacket; }
 
+		/**
+		 * @return True if the raw packet of this packet is shared with copy-on-write clones (see Packet(const Packet&, bool)), meaning
+		 * makeWritable() will copy the raw packet. Once all of the other packets sharing the raw packet are destructed or made writable
+		 * this packet is its only owner and false is returned
+		 */
+		bool isRawDataShared() const;
+
+		/**
+		 * Make sure the raw packet of this packet isn't shared with copy-on-write clones, so the packet data can be modified. If the raw
+		 * packet is shared it's copied (with its headroom) and the layers of this packet are set to point to the copy. If all of the
+		 * other packets which shared the raw packet released it, this packet becomes its only owner without copying it. Otherwise nothing
+		 * is done. The methods of the packet and of its layers that modify the packet (field setters, adding or removing layers, options,
+		 * records or header fields, computeCalculateFields()) call this method. It has to be called explicitly only before writing to layer
+		 * data directly: through Layer#getData(), a header pointer (for example EthLayer#getEthHeader()), an option or record object which
+		 * points into the layer (for example the value setters of DhcpOption or PPPoEDiscoveryLayer#PPPoETag), or the raw packet returned
+		 * by getRawPacket()
+		 */
+		void makeWritable();
+
 		/**
 		 * Get a pointer to the first (lowest) layer in the packet
 		 * @return A pointer to the first (lowest) layer in the packet
@@ -134,10 +242,15 @@ namespace pcpp
 		Layer* getFirstLayer() const { return m_FirstLayer; }
 
 		/**
-		 * Get a pointer to the last (highest) layer in the packet
+		 * Get a pointer to the last (highest) layer in the packet. In lazy parsing mode all of the remaining layers are parsed first
 		 * @return A pointer to the last (highest) layer in the packet
 		 */
-		Layer* getLastLayer() const { return m_LastLayer; }
+		Layer* getLastLayer() const
+		{
+			if (m_LastLayer != NULL && m_LastLayer->m_IsNextLayerPending)
+				const_cast<Packet*>(this)->parseRemainingLayers();
+			return m_LastLayer;
+		}
 
 		/**
 		 * Add a new layer as the last layer in the packet. This method gets a pointer to the new layer as a parameter
@@ -148,7 +261,7 @@ namespace pcpp
 		 * @return True if everything went well or false otherwise (an appropriate error log message will be printed in
 		 * such cases)
 		 */
-		bool addLayer(Layer* newLayer, bool ownInPacket = false) { return insertLayer(m_LastLayer, newLayer, ownInPacket); }
+		bool addLayer(Layer* newLayer, bool ownInPacket = false) { return insertLayer(getLastLayer(), newLayer, ownInPacket); }
 
 		/**
 		 * Insert a new layer after an existing layer in the packet. This method gets a pointer to the new layer as a
@@ -274,17 +387,39 @@ namespace pcpp
 		TLayer* getPrevLayerOfType(Layer* startLayer) const;
 
 		/**
-		 * Check whether the packet contains a certain protocol
+		 * Check whether the packet contains a certain protocol. In lazy parsing mode layers are parsed until the protocol is found
 		 * @param[in] protocolType The protocol type to search
 		 * @return True if the packet contains the protocol, false otherwise
 		 */
-		bool isPacketOfType(ProtocolType protocolType) const { return m_ProtocolTypes & protocolType; }
+		bool isPacketOfType(ProtocolType protocolType) const
+		{
+			if ((m_ProtocolTypes & protocolType) == 0 && m_LastLayer != NULL && m_LastLayer->m_IsNextLayerPending)
+				return const_cast<Packet*>(this)->isPacketOfTypeOnDemand(protocolType);
+			return m_ProtocolTypes & protocolType;
+		}
 
 		/**
 		 * Each layer can have fields that can be calculate automatically from other fields using Layer#computeCalculateFields(). This method forces all layers to calculate these
 		 * fields values
+		 * @param[in] modifiedLayersOnly If set to true only the layers that need it are recalculated: layers marked as modified
+		 * (see Layer#markAsModified()), all the layers below them (whose next protocol, length and checksum fields depend on the layers
+		 * they carry) and transport layers directly above a modified layer (whose checksum covers the IP pseudo header). For
+		 * example after rewriting the MAC addresses only the Ethernet layer is recalculated. Notice that changes made directly to
+		 * headers aren't tracked and must be marked with Layer#markAsModified(). The default value is false which means all layers
+		 * are recalculated
 		 */
-		void computeCalculateFields();
+		void computeCalculateFields(bool modifiedLayersOnly = false);
+
+		/**
+		 * Make sure there are at least headroom free bytes in front of the packet data, like the headroom of mbufs. When a layer is
+		 * inserted and the data before it is shorter than the data after it (for example a tunnel header pushed in front of the packet,
+		 * or a VLAN tag or MPLS label inserted after the Ethernet header) the data before it is moved into the headroom, so the cost
+		 * depends on the header size and not on the packet size. Removing such layers (decapsulation) returns the space to the headroom.
+		 * If the current headroom is smaller than requested the raw data is reallocated and copied once
+		 * @param[in] headroom The number of free bytes to reserve
+		 * @return True if the headroom is available, false if reallocation failed
+		 */
+		bool reserveHeadroom(size_t headroom);
 
 		/**
 		 * Each layer can print a string representation of the layer most important data using Layer#toString(). This method aggregates this string from all layers and
@@ -303,19 +438,28 @@ namespace pcpp
 
 	private:
 		void copyDataFrom(const Packet& other);
+		void moveDataFrom(Packet& other);
+		void releaseRawPacket();
 
-		void destructPacketData();
+		void destructPacketData(bool recycleLayers = false);
+		void recycleLayer(Layer* layer);
+		void freeRecycledLayers();
 
 		bool extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExtend);
 		bool shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToShorten);
 
-		void reallocateRawData(size_t newSize);
+		bool reallocateRawData(size_t newSize, size_t headroom);
 
 		bool removeLayer(Layer* layer, bool tryToDelete);
 
 		std::string printPacketInfo(bool timeAsLocalTime) const;
 
 		Layer* createFirstLayer(LinkLayerType linkType);
+
+		void parseNextLayerOnDemand();
+		void parseRemainingLayers();
+		bool isPacketOfTypeOnDemand(ProtocolType protocolType);
+		void addPacketTrailerLayer();
 	}; // class Packet
 
 
@@ -2,6 +2,7 @@
 #define PACKETPP_PACKET_UTILS
 
 #include "Packet.h"
+#include "PacketView.h"
 
 /// @file
 
@@ -15,11 +16,14 @@ namespace pcpp
 	/**
 	 * A method that is given a packet and calculates a hash value by the packet's 5-tuple. Supports IPv4, IPv6,
 	 * TCP and UDP. For packets which doesn't have 5-tuple (for example: packets which aren't IPv4/6 or aren't
-	 * TCP/UDP) the value of 0 will be returned
+	 * TCP/UDP) the value of 0 will be returned. The ports are taken from the innermost TCP/UDP layer
 	 * @param[in] packet The packet to calculate hash for
+	 * @param[in] useInnerTuple By default the IP addresses are taken from the outermost IP layer, so all packets of a tunnel (for
+	 * example GTP-U or VXLAN) whose inner flows use the same ports get the same hash. If this flag is set the addresses are taken
+	 * from the IP layer that carries the innermost TCP/UDP layer, meaning tunneled packets are hashed by their inner 5-tuple
 	 * @return The hash value calculated for this packet or 0 if the packet doesn't contain 5-tuple
 	 */
-	uint32_t hash5Tuple(Packet* packet);
+	uint32_t hash5Tuple(Packet* packet, bool useInnerTuple = false);
 
 	/**
 	 * A method that is given a packet and calculates a hash value by the packet's 2-tuple (IP src + IP dst). Supports
@@ -29,6 +33,202 @@ namespace pcpp
 	 */
 	uint32_t hash2Tuple(Packet* packet);
 
+	/**
+	 * The maximum RSS key length in bytes supported by pcpp#ToeplitzHash (the key length of Intel XL710 NICs)
+	 */
+#define PCPP_TOEPLITZ_MAX_KEY_LEN 52
+
+	/**
+	 * The maximum input length in bytes pcpp#ToeplitzHash can hash: an IPv6 4-tuple (2 addresses and 2 ports)
+	 */
+#define PCPP_TOEPLITZ_MAX_INPUT_LEN 36
+
+	/**
+	 * @class ToeplitzHash
+	 * An implementation of the Toeplitz hash function which is used by NICs for Receive Side Scaling (RSS). It calculates the
+	 * same hash a NIC calculates for a certain key, so packets captured by devices without RSS (for example PcapLiveDevice or
+	 * RawSocketDevice) can be steered in software to worker threads exactly like a multi-queue DpdkDevice distributes them between
+	 * RX queues.<BR>
+	 * The hash input follows the RSS specification: source IP, destination IP and optionally source port and destination port,
+	 * all in network byte order. With the default key (0x6d5a repeated, which is also the default key of DpdkDevice) the hash is
+	 * symmetric, meaning both directions of a connection get the same hash value.<BR>
+	 * Setting a key pre-calculates a lookup table of 256 entries per input byte, so hashing costs one table lookup and one XOR per
+	 * input byte instead of 32 operations per input bit. The table is part of the object (about 36KB) so an instance should be
+	 * created once and shared: all hashing methods are const and may be called concurrently from multiple threads
+	 */
+	class ToeplitzHash
+	{
+	public:
+		/**
+		 * The symmetric RSS key (0x6d5a repeated). With this key both directions of a flow get the same hash value
+		 */
+		static const uint8_t SymmetricKey[40];
+
+		/**
+		 * The RSS key from the Microsoft RSS specification, which is the default key of many NIC drivers. This key isn't symmetric
+		 */
+		static const uint8_t MicrosoftKey[40];
+
+		/**
+		 * A c'tor that creates an instance with the symmetric key (ToeplitzHash#SymmetricKey)
+		 */
+		ToeplitzHash();
+
+		/**
+		 * A c'tor that creates an instance with a user-defined key. If the key is invalid (see setKey()) the symmetric key is used
+		 * @param[in] key The RSS key
+		 * @param[in] keyLen The key length in bytes
+		 */
+		ToeplitzHash(const uint8_t* key, size_t keyLen);
+
+		/**
+		 * Replace the RSS key and re-calculate the lookup table. Notice this method isn't thread-safe with the hashing methods
+		 * @param[in] key The RSS key
+		 * @param[in] keyLen The key length in bytes. Must be between 8 and ::PCPP_TOEPLITZ_MAX_KEY_LEN. A key of N bytes can hash
+		 * inputs of up to N-4 bytes, so 40 bytes are needed for IPv6 4-tuples
+		 * @return True if the key was set or false if the key is NULL or its length is out of bounds
+		 */
+		bool setKey(const uint8_t* key, size_t keyLen);
+
+		/**
+		 * @return The current RSS key
+		 */
+		const uint8_t* getKey() const { return m_Key; }
+
+		/**
+		 * @return The current RSS key length in bytes
+		 */
+		size_t getKeyLen() const { return m_KeyLen; }
+
+		/**
+		 * Calculate the hash of an arbitrary input using the lookup table
+		 * @param[in] data The input data
+		 * @param[in] dataLen The input length in bytes. Bytes beyond the maximum input length of the key (key length minus 4,
+		 * but no more than ::PCPP_TOEPLITZ_MAX_INPUT_LEN) are ignored
+		 * @return The hash value
+		 */
+		uint32_t hash(const uint8_t* data, size_t dataLen) const;
+
+		/**
+		 * Calculate the Toeplitz hash of an input bit by bit, without a lookup table. This is the straightforward algorithm from the
+		 * RSS specification and is much slower than hash(), it's mostly useful for verification and for one-time calculations
+		 * @param[in] key The RSS key
+		 * @param[in] keyLen The key length in bytes
+		 * @param[in] data The input data
+		 * @param[in] dataLen The input length in bytes. Bytes beyond the key length minus 4 are ignored
+		 * @return The hash value
+		 */
+		static uint32_t hashBitByBit(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t dataLen);
+
+		/**
+		 * Calculate the hash of an IPv4 2-tuple
+		 * @param[in] srcIP The source IPv4 address in network byte order
+		 * @param[in] dstIP The destination IPv4 address in network byte order
+		 * @return The hash value
+		 */
+		uint32_t hashIPv4(uint32_t srcIP, uint32_t dstIP) const;
+
+		/**
+		 * Calculate the hash of an IPv4 4-tuple
+		 * @param[in] srcIP The source IPv4 address in network byte order
+		 * @param[in] dstIP The destination IPv4 address in network byte order
+		 * @param[in] srcPort The source port in host byte order
+		 * @param[in] dstPort The destination port in host byte order
+		 * @return The hash value
+		 */
+		uint32_t hashIPv4(uint32_t srcIP, uint32_t dstIP, uint16_t srcPort, uint16_t dstPort) const;
+
+		/**
+		 * Calculate the hash of an IPv6 2-tuple
+		 * @param[in] srcIP The source IPv6 address (16 bytes in network byte order)
+		 * @param[in] dstIP The destination IPv6 address (16 bytes in network byte order)
+		 * @return The hash value
+		 */
+		uint32_t hashIPv6(const uint8_t* srcIP, const uint8_t* dstIP) const;
+
+		/**
+		 * Calculate the hash of an IPv6 4-tuple
+		 * @param[in] srcIP The source IPv6 address (16 bytes in network byte order)
+		 * @param[in] dstIP The destination IPv6 address (16 bytes in network byte order)
+		 * @param[in] srcPort The source port in host byte order
+		 * @param[in] dstPort The destination port in host byte order
+		 * @return The hash value
+		 */
+		uint32_t hashIPv6(const uint8_t* srcIP, const uint8_t* dstIP, uint16_t srcPort, uint16_t dstPort) const;
+
+		/**
+		 * Calculate the hash of a packet parsed by pcpp#PacketView, like a NIC would for its outermost IP header. The 4-tuple is
+		 * hashed for TCP, UDP and SCTP packets that aren't IP fragments (if includePorts is true), the 2-tuple for any other
+		 * IPv4/IPv6 packet
+		 * @param[in] packetView The parsed packet
+		 * @param[in] includePorts Hash the 4-tuple when the packet has ports. If false only the 2-tuple is hashed. Default is true
+		 * @return The hash value or 0 if the packet isn't IPv4 or IPv6
+		 */
+		uint32_t hashPacket(const PacketView& packetView, bool includePorts = true) const;
+
+		/**
+		 * Calculate the hash of a parsed packet. The rules are the same as in the PacketView version of this method: the first IP
+		 * layer of the packet is used, together with the TCP or UDP layer that directly follows it
+		 * @param[in] packet The packet to calculate the hash for
+		 * @param[in] includePorts Hash the 4-tuple when the packet has ports. If false only the 2-tuple is hashed. Default is true
+		 * @return The hash value or 0 if the packet isn't IPv4 or IPv6
+		 */
+		uint32_t hashPacket(Packet* packet, bool includePorts = true) const;
+
+		/**
+		 * Calculate the hash of a burst of packets that were already parsed, for example by pcpp#parsePacketBurst()
+		 * @param[in] packetViews An array of parsed packets
+		 * @param[in] count The number of packets in the array
+		 * @param[out] hashes An array of at least count values which will be filled with the hash of each packet
+		 * @param[in] includePorts Hash the 4-tuple when a packet has ports. Default is true
+		 */
+		void hashBurst(const PacketView* packetViews, size_t count, uint32_t* hashes, bool includePorts = true) const;
+
+		/**
+		 * Calculate the hash of a burst of raw packets, for example the packets returned from a single call to
+		 * PcapLiveDevice#getNextPackets() or DpdkDevice#receivePackets(). Each packet is parsed with pcpp#PacketView and the
+		 * packet data is software-prefetched ::PCPP_PACKET_BURST_PREFETCH_DISTANCE packets ahead. This is a template so arrays
+		 * of any RawPacket descendant can be passed as is
+		 * @param[in] rawPackets An array of raw packets. The hash of NULL entries is 0
+		 * @param[in] count The number of packets in the array
+		 * @param[out] hashes An array of at least count values which will be filled with the hash of each packet
+		 * @param[in] includePorts Hash the 4-tuple when a packet has ports. Default is true
+		 */
+		template<class TRawPacket>
+		void hashBurst(TRawPacket* const* rawPackets, size_t count, uint32_t* hashes, bool includePorts = true) const
+		{
+			for (size_t i = 0; i < count && i < PCPP_PACKET_BURST_PREFETCH_DISTANCE; i++)
+			{
+				if (rawPackets[i] != NULL)
+					PCPP_PREFETCH(rawPackets[i]->getRawData());
+			}
+
+			PacketView packetView;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (i + 2 * PCPP_PACKET_BURST_PREFETCH_DISTANCE < count)
+					PCPP_PREFETCH(rawPackets[i + 2 * PCPP_PACKET_BURST_PREFETCH_DISTANCE]);
+				if (i + PCPP_PACKET_BURST_PREFETCH_DISTANCE < count && rawPackets[i + PCPP_PACKET_BURST_PREFETCH_DISTANCE] != NULL)
+					PCPP_PREFETCH(rawPackets[i + PCPP_PACKET_BURST_PREFETCH_DISTANCE]->getRawData());
+
+				packetView.parse(rawPackets[i]);
+				hashes[i] = hashPacket(packetView, includePorts);
+			}
+		}
+
+	private:
+		uint8_t m_Key[PCPP_TOEPLITZ_MAX_KEY_LEN];
+		size_t m_KeyLen;
+		uint32_t m_Table[PCPP_TOEPLITZ_MAX_INPUT_LEN][256];
+
+		// hash 4 input bytes which are located at a certain offset of the hash input. Table rows beyond the maximum input length of
+		// the key are zeroed so these bytes are ignored without any bounds check
+		uint32_t hash4Bytes(const uint8_t* data, size_t inputOffset) const
+		{
+			return m_Table[inputOffset][data[0]] ^ m_Table[inputOffset + 1][data[1]] ^ m_Table[inputOffset + 2][data[2]] ^ m_Table[inputOffset + 3][data[3]];
+		}
+	};
+
 } // namespace pcpp
 
 #endif /* PACKETPP_PACKET_UTILS */
@@ -0,0 +1,392 @@
+#ifndef PACKETPP_PACKET_VIEW
+#define PACKETPP_PACKET_VIEW
+
+#include <stdint.h>
+#include <stddef.h>
+#include "EndianPortable.h"
+#include "ProtocolType.h"
+#include "RawPacket.h"
+#include "EthLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "IcmpLayer.h"
+#include "PointerVector.h"
+
+/// @file
+
+/**
+ * The value returned by pcpp#PacketView offset getters when the requested header doesn't exist in the packet
+ */
+#define PCPP_PACKET_VIEW_NO_OFFSET 0xFFFF
+
+/**
+ * The maximum number of VLAN tags pcpp#PacketView walks through before it stops parsing
+ */
+#define PCPP_PACKET_VIEW_MAX_VLAN_TAGS 4
+
+/**
+ * The maximum number of MPLS labels pcpp#PacketView walks through before it stops parsing
+ */
+#define PCPP_PACKET_VIEW_MAX_MPLS_LABELS 8
+
+/**
+ * The maximum number of IPv6 extension headers pcpp#PacketView walks through before it stops parsing
+ */
+#define PCPP_PACKET_VIEW_MAX_IPV6_EXTENSIONS 8
+
+/**
+ * The number of packets pcpp#parsePacketBurst() looks ahead when prefetching packet data. The packet objects themselves are
+ * prefetched twice as far ahead
+ */
+#define PCPP_PACKET_BURST_PREFETCH_DISTANCE 4
+
+/**
+ * Software-prefetch the cache line that contains a certain address for reading. Compiles to nothing on unsupported compilers
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define PCPP_PREFETCH(addr) __builtin_prefetch((const void*)(addr), 0, 3)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define PCPP_PREFETCH(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#else
+#define PCPP_PREFETCH(addr)
+#endif
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @struct sctphdr
+	 * Represents the SCTP common header
+	 */
+#pragma pack(push,1)
+	struct sctphdr {
+		/** Source port */
+		uint16_t portSrc;
+		/** Destination port */
+		uint16_t portDst;
+		/** Verification tag */
+		uint32_t verificationTag;
+		/** CRC32c checksum of the entire SCTP packet */
+		uint32_t checksum;
+	};
+#pragma pack(pop)
+
+
+	/**
+	 * @struct PacketFiveTuple
+	 * The 5-tuple of an IPv4/IPv6 packet as extracted by PacketView#getFiveTuple(). This is a plain struct which can be stored in
+	 * arrays without any construction cost
+	 */
+	struct PacketFiveTuple
+	{
+		/** Source IP address in network byte order. For IPv4 only the first 4 bytes are used and the rest are zeroed */
+		uint8_t srcIP[16];
+		/** Destination IP address in network byte order. For IPv4 only the first 4 bytes are used and the rest are zeroed */
+		uint8_t dstIP[16];
+		/** Source port in host byte order, 0 if the transport protocol isn't TCP, UDP or SCTP */
+		uint16_t srcPort;
+		/** Destination port in host byte order, 0 if the transport protocol isn't TCP, UDP or SCTP */
+		uint16_t dstPort;
+		/** IP version: 4, 6 or 0 if the packet isn't IP */
+		uint8_t ipVersion;
+		/** The protocol carried by IP as in pcpp#IPProtocolTypes */
+		uint8_t protocol;
+	};
+
+
+	/**
+	 * @class PacketView
+	 * A lightweight, read-only view of a raw packet which holds only the offsets of the packet headers and a bitmap of the protocols
+	 * it contains. Unlike pcpp#Packet it doesn't create a Layer object per protocol: the raw data is walked once in a single
+	 * non-virtual pass and the result is stored inside the object itself, so a PacketView can live on the stack, be reused for
+	 * many packets and never allocates memory. This makes it suitable for fast paths that only need to look at protocol headers,
+	 * for example inside DPDK or PF_RING receive callbacks.<BR>
+	 * The following protocols are recognized:
+	 * - L2: Ethernet II, any number (up to ::PCPP_PACKET_VIEW_MAX_VLAN_TAGS) of IEEE 802.1Q / 802.1ad (Q-in-Q) VLAN tags, MPLS label
+	 *   stacks (up to ::PCPP_PACKET_VIEW_MAX_MPLS_LABELS). Raw IP link types (packets that start with an IP header) are supported as well
+	 * - L3: IPv4 and IPv6 including IPv6 extension headers (Hop-By-Hop, Routing, Destination, Authentication and Fragmentation)
+	 * - L4: TCP, UDP, ICMP and SCTP
+	 *
+	 * Like pcpp#Packet, the transport layer of IP fragments isn't parsed. Application layer protocols aren't identified, the view
+	 * only points to the first byte after the transport header (see getPayload()). SCTP has no pcpp#ProtocolType so it isn't
+	 * reflected in the protocol bitmap, but its header can be accessed with getSctpHeader().<BR>
+	 * The view points to the raw data, so the raw packet must outlive it and any change to the raw data requires parsing it again
+	 */
+	class PacketView
+	{
+	public:
+		/**
+		 * A c'tor that creates an empty view. Use parse() to fill it
+		 */
+		PacketView() { clear(); }
+
+		/**
+		 * A c'tor that creates a view of a raw packet
+		 * @param[in] rawPacket A pointer to the raw packet to parse
+		 */
+		PacketView(const RawPacket* rawPacket) { parse(rawPacket); }
+
+		/**
+		 * A c'tor that creates a view of a raw buffer
+		 * @param[in] data A pointer to the raw data
+		 * @param[in] dataLen The raw data length in bytes
+		 * @param[in] linkType The link layer type of the raw data. Default is pcpp#LINKTYPE_ETHERNET
+		 */
+		PacketView(const uint8_t* data, size_t dataLen, LinkLayerType linkType = LINKTYPE_ETHERNET) { parse(data, dataLen, linkType); }
+
+		/**
+		 * Parse a raw packet into this view. Previous content of the view is discarded
+		 * @param[in] rawPacket A pointer to the raw packet to parse
+		 * @return True if at least the first (link) layer was recognized, false otherwise
+		 */
+		bool parse(const RawPacket* rawPacket);
+
+		/**
+		 * Parse a raw buffer into this view. Previous content of the view is discarded
+		 * @param[in] data A pointer to the raw data
+		 * @param[in] dataLen The raw data length in bytes
+		 * @param[in] linkType The link layer type of the raw data. Supported types are pcpp#LINKTYPE_ETHERNET, pcpp#LINKTYPE_RAW,
+		 * pcpp#LINKTYPE_DLT_RAW1 and pcpp#LINKTYPE_DLT_RAW2. Default is pcpp#LINKTYPE_ETHERNET
+		 * @return True if at least the first (link) layer was recognized, false otherwise
+		 */
+		bool parse(const uint8_t* data, size_t dataLen, LinkLayerType linkType = LINKTYPE_ETHERNET);
+
+		/**
+		 * Reset the view to an empty state
+		 */
+		void clear();
+
+		/**
+		 * @return A pointer to the raw data this view points to or NULL if the view is empty
+		 */
+		uint8_t* getData() const { return m_Data; }
+
+		/**
+		 * @return The length in bytes of the raw data this view points to
+		 */
+		size_t getDataLen() const { return m_DataLen; }
+
+		/**
+		 * @return A bitmap of all protocols found in the packet
+		 */
+		ProtocolType getProtocolTypes() const { return m_ProtocolTypes; }
+
+		/**
+		 * Check whether the packet contains a certain protocol
+		 * @param[in] protocolType The protocol type to search
+		 * @return True if the packet contains the protocol, false otherwise
+		 */
+		bool isPacketOfType(ProtocolType protocolType) const { return (m_ProtocolTypes & protocolType) != 0; }
+
+		/**
+		 * @return The offset of the link layer header or ::PCPP_PACKET_VIEW_NO_OFFSET if the packet doesn't start with an Ethernet header
+		 */
+		uint16_t getL2Offset() const { return m_L2Offset; }
+
+		/**
+		 * @return The offset of the (outermost) IPv4/IPv6 header or ::PCPP_PACKET_VIEW_NO_OFFSET if the packet isn't IP
+		 */
+		uint16_t getL3Offset() const { return m_L3Offset; }
+
+		/**
+		 * @return The offset of the transport header, i.e the first byte after the IPv4 header or after the last IPv6 extension
+		 * header, or ::PCPP_PACKET_VIEW_NO_OFFSET if the packet isn't IP or is an IP fragment
+		 */
+		uint16_t getL4Offset() const { return m_L4Offset; }
+
+		/**
+		 * @return The offset of the first byte after the TCP/UDP/SCTP header or ::PCPP_PACKET_VIEW_NO_OFFSET if the packet doesn't
+		 * contain one of these protocols
+		 */
+		uint16_t getL7Offset() const { return m_L7Offset; }
+
+		/**
+		 * @return The EtherType of the L3 protocol, i.e the EtherType that follows the Ethernet header, VLAN tags and MPLS labels (in host
+		 * byte order). For MPLS packets the EtherType is deduced from the IP version. 0 if the packet doesn't start with an Ethernet header
+		 */
+		uint16_t getEtherType() const { return m_EtherType; }
+
+		/**
+		 * @return The number of VLAN tags found in the packet
+		 */
+		uint8_t getVlanTagCount() const { return m_VlanTagCount; }
+
+		/**
+		 * @return The VLAN ID of the outermost VLAN tag or 0 if the packet has no VLAN tags
+		 */
+		uint16_t getOuterVlanId() const { return m_OuterVlanId; }
+
+		/**
+		 * @return The number of MPLS labels found in the packet
+		 */
+		uint8_t getMplsLabelCount() const { return m_MplsLabelCount; }
+
+		/**
+		 * @return The protocol carried by IP (e.g TCP, UDP, etc.) as in pcpp#IPProtocolTypes. For IPv6 this is the next header value of
+		 * the last extension header. 0 if the packet isn't IP
+		 */
+		uint8_t getIPProtocol() const { return m_IPProtocol; }
+
+		/**
+		 * @return True if the packet is an IPv4 fragment or an IPv6 packet that contains a fragmentation header
+		 */
+		bool isFragment() const { return m_IsFragment; }
+
+		/**
+		 * @return The length in bytes of the IP datagram, which is the IPv4 total length or the IPv6 header length plus the IPv6 payload
+		 * length, bounded by the captured length. 0 if the packet isn't IP
+		 */
+		size_t getIPDatagramLen() const { return m_IPDatagramLen; }
+
+		/**
+		 * @return A pointer to the Ethernet header or NULL if the packet doesn't start with an Ethernet header
+		 */
+		ether_header* getEthHeader() const { return m_L2Offset != PCPP_PACKET_VIEW_NO_OFFSET ? (ether_header*)(m_Data + m_L2Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the (outermost) IPv4 header or NULL if the packet isn't IPv4
+		 */
+		iphdr* getIPv4Header() const { return (m_ProtocolTypes & IPv4) ? (iphdr*)(m_Data + m_L3Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the (outermost) IPv6 header or NULL if the packet isn't IPv6
+		 */
+		ip6_hdr* getIPv6Header() const { return (m_ProtocolTypes & IPv6) ? (ip6_hdr*)(m_Data + m_L3Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the TCP header or NULL if the packet isn't TCP
+		 */
+		tcphdr* getTcpHeader() const { return (m_ProtocolTypes & TCP) ? (tcphdr*)(m_Data + m_L4Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the UDP header or NULL if the packet isn't UDP
+		 */
+		udphdr* getUdpHeader() const { return (m_ProtocolTypes & UDP) ? (udphdr*)(m_Data + m_L4Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the ICMP header or NULL if the packet isn't ICMP
+		 */
+		icmphdr* getIcmpHeader() const { return (m_ProtocolTypes & ICMP) ? (icmphdr*)(m_Data + m_L4Offset) : NULL; }
+
+		/**
+		 * @return A pointer to the SCTP common header or NULL if the packet isn't SCTP
+		 */
+		sctphdr* getSctpHeader() const { return m_IsSctp ? (sctphdr*)(m_Data + m_L4Offset) : NULL; }
+
+		/**
+		 * @return The source port of a TCP, UDP or SCTP packet (in host byte order) or 0 for any other packet
+		 */
+		uint16_t getSrcPort() const { return m_L7Offset != PCPP_PACKET_VIEW_NO_OFFSET ? be16toh(*(uint16_t*)(m_Data + m_L4Offset)) : 0; }
+
+		/**
+		 * @return The destination port of a TCP, UDP or SCTP packet (in host byte order) or 0 for any other packet
+		 */
+		uint16_t getDstPort() const { return m_L7Offset != PCPP_PACKET_VIEW_NO_OFFSET ? be16toh(*(uint16_t*)(m_Data + m_L4Offset + 2)) : 0; }
+
+		/**
+		 * @return A pointer to the first byte after the TCP/UDP/SCTP header or NULL if the packet doesn't contain one of these protocols
+		 */
+		uint8_t* getPayload() const { return m_L7Offset != PCPP_PACKET_VIEW_NO_OFFSET ? m_Data + m_L7Offset : NULL; }
+
+		/**
+		 * @return The length in bytes of the data after the TCP/UDP/SCTP header until the end of the IP datagram (packet trailers are
+		 * excluded) or 0 if the packet doesn't contain one of these protocols
+		 */
+		size_t getPayloadLen() const;
+
+		/**
+		 * Extract the 5-tuple of the packet
+		 * @param[out] fiveTuple The struct to fill. It's fully written in any case, so it doesn't need to be initialized
+		 * @return True if the packet is IPv4 or IPv6, false otherwise (in which case the struct is zeroed)
+		 */
+		bool getFiveTuple(PacketFiveTuple& fiveTuple) const;
+
+	private:
+		uint8_t* m_Data;
+		size_t m_DataLen;
+		ProtocolType m_ProtocolTypes;
+		size_t m_IPDatagramLen;
+		uint16_t m_L2Offset;
+		uint16_t m_L3Offset;
+		uint16_t m_L4Offset;
+		uint16_t m_L7Offset;
+		uint16_t m_EtherType;
+		uint16_t m_OuterVlanId;
+		uint8_t m_VlanTagCount;
+		uint8_t m_MplsLabelCount;
+		uint8_t m_IPProtocol;
+		bool m_IsFragment;
+		bool m_IsSctp;
+
+		void parseIPv4(size_t offset);
+		void parseIPv6(size_t offset);
+		void parseTransport(size_t offset);
+	};
+
+	/**
+	 * Parse a burst of raw packets into an array of views, for example the packets returned from a single call to
+	 * DpdkDevice#receivePackets(). The parse loop doesn't make any virtual call and software-prefetches the data of the packets
+	 * ::PCPP_PACKET_BURST_PREFETCH_DISTANCE places ahead, so the memory latency of the next packets is hidden behind parsing the
+	 * current ones. This is a template so arrays of any RawPacket descendant (such as MBufRawPacket) can be passed as is
+	 * @param[in] rawPackets An array of raw packets. NULL entries are allowed, their view is cleared
+	 * @param[in] count The number of packets in the array
+	 * @param[out] views An array of at least count views which will be filled with the parse results
+	 * @param[out] fiveTuples An optional array of at least count structs which will be filled with the 5-tuple of each packet. Default
+	 * is NULL which means 5-tuples aren't extracted
+	 * @return The number of packets whose link layer was recognized (see PacketView#parse())
+	 */
+	template<class TRawPacket>
+	size_t parsePacketBurst(TRawPacket* const* rawPackets, size_t count, PacketView* views, PacketFiveTuple* fiveTuples = NULL)
+	{
+		for (size_t i = 0; i < count && i < PCPP_PACKET_BURST_PREFETCH_DISTANCE; i++)
+		{
+			if (rawPackets[i] != NULL)
+				PCPP_PREFETCH(rawPackets[i]->getRawData());
+		}
+
+		size_t numOfParsedPackets = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			// the packet objects are prefetched further ahead since their data pointer is needed to prefetch the data
+			if (i + 2 * PCPP_PACKET_BURST_PREFETCH_DISTANCE < count)
+				PCPP_PREFETCH(rawPackets[i + 2 * PCPP_PACKET_BURST_PREFETCH_DISTANCE]);
+			if (i + PCPP_PACKET_BURST_PREFETCH_DISTANCE < count && rawPackets[i + PCPP_PACKET_BURST_PREFETCH_DISTANCE] != NULL)
+				PCPP_PREFETCH(rawPackets[i + PCPP_PACKET_BURST_PREFETCH_DISTANCE]->getRawData());
+
+			if (views[i].parse(rawPackets[i]))
+				numOfParsedPackets++;
+
+			if (fiveTuples != NULL)
+				views[i].getFiveTuple(fiveTuples[i]);
+		}
+
+		return numOfParsedPackets;
+	}
+
+	/**
+	 * Parse a vector of raw packets into an array of views. Please refer to the array version of parsePacketBurst() for more details
+	 * @param[in] rawPackets A vector of raw packets, for example pcpp#RawPacketVector or pcpp#MBufRawPacketVector
+	 * @param[out] views An array of at least rawPackets.size() views which will be filled with the parse results
+	 * @param[out] fiveTuples An optional array of at least rawPackets.size() structs which will be filled with the 5-tuple of each
+	 * packet. Default is NULL which means 5-tuples aren't extracted
+	 * @return The number of packets whose link layer was recognized
+	 */
+	template<class TRawPacket>
+	size_t parsePacketBurst(const PointerVector<TRawPacket>& rawPackets, PacketView* views, PacketFiveTuple* fiveTuples = NULL)
+	{
+		if (rawPackets.size() == 0)
+			return 0;
+
+		return parsePacketBurst(&(*rawPackets.begin()), rawPackets.size(), views, fiveTuples);
+	}
+
+} // namespace pcpp
+
+#endif /* PACKETPP_PACKET_VIEW */
@@ -215,7 +215,10 @@ namespace pcpp
 	 * @class RawPacket
 	 * This class holds the packet as raw (not parsed) data. The data is held as byte array. In addition to the data itself
 	 * every instance also holds a timestamp representing the time the packet was received by the NIC.
-	 * RawPacket instance isn't read only. The user can change the packet data, add or remove data, etc.
+	 * RawPacket instance isn't read only. The user can change the packet data, add or remove data, etc.<BR>
+	 * Like mbufs, the data may be preceded by free space in the same buffer (headroom, see reallocateData(size_t, size_t)). Data
+	 * inserted near the beginning of the packet (a VLAN tag, an MPLS label or a tunnel header) or removed from it can then be handled by
+	 * moving the data pointer instead of shifting the whole packet (see insertDataUsingHeadroom() and removeDataUsingHeadroom())
 	 */
 	class RawPacket
 	{
@@ -227,8 +230,14 @@ namespace pcpp
 		bool m_DeleteRawDataAtDestructor;
 		bool m_RawPacketSet;
 		LinkLayerType m_LinkLayerType;
+		// the number of free bytes in front of m_RawData. The buffer starts at m_RawData - m_Headroom
+		size_t m_Headroom;
+		// the number of free bytes known to be available after the data (a lower bound, 0 if unknown)
+		size_t m_Tailroom;
 		void init(bool deleteRawDataAtDestructor = true);
+		void freeRawData();
 		void copyDataFrom(const RawPacket& other, bool allocateData = true);
+		void moveDataFrom(RawPacket& other);
 	public:
 		/**
 		 * A constructor that receives a pointer to the raw data (allocated elsewhere). This constructor is usually used when packet
@@ -285,6 +294,45 @@ namespace pcpp
 		 */
 		RawPacket& operator=(const RawPacket& other);
 
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+		/**
+		 * A move constructor. The raw data buffer of the other instance is taken over without copying it (see adoptRawData()) and the other
+		 * instance is left empty. If the other instance is of a derived type which manages its own buffer (for example pcpp#MBufRawPacket)
+		 * the data is copied instead
+		 * @param[in] other The instance to move from
+		 */
+		RawPacket(RawPacket&& other);
+
+		/**
+		 * Move assignment operator. The raw data of this instance is freed (if owned by it) and the raw data buffer of the other instance is
+		 * taken over without copying it. If the other instance is of a derived type which manages its own buffer the data is copied instead
+		 * @param[in] other The instance to move from
+		 */
+		RawPacket& operator=(RawPacket&& other);
+#endif
+
+		/**
+		 * Take over the raw data buffer of another raw packet without copying it. The current raw data is freed first (if owned by this
+		 * instance). All of the other instance's attributes (data, length, timestamp, link layer type, headroom and data ownership) are moved
+		 * to this instance and the other instance is left empty, as if clear() was called but without freeing the data. This is the way to
+		 * hand a packet buffer between raw packets, devices and queues without a memcpy
+		 * @param[in] other The raw packet to take the buffer from
+		 * @return True if the buffer was adopted or false if the other raw packet is of a type whose buffer can't be moved to this instance
+		 * (for example a pcpp#MBufRawPacket, whose data lives inside an mbuf)
+		 */
+		virtual bool adoptRawData(RawPacket& other);
+
+		/**
+		 * Give up the ownership of the raw data buffer and return it to the caller, who becomes responsible for freeing it (using delete[]).
+		 * The instance is left empty, as if clear() was called but without freeing the data
+		 * @param[out] headroom If not NULL, it's set to the headroom of the buffer (see getHeadroom()), meaning the buffer was allocated
+		 * starting headroom bytes before the returned pointer. If NULL and the buffer has headroom, the data is moved to the beginning
+		 * of the buffer so the returned pointer can be freed directly
+		 * @return A pointer to the raw data or NULL if the raw data isn't owned by this instance (it was set with deleteRawDataAtDestructor
+		 * set to false) or can't be released (for example the data of a pcpp#MBufRawPacket)
+		 */
+		virtual uint8_t* releaseRawData(size_t* headroom = NULL);
+
 		/**
 		 * @return RawPacket object type. Each derived class should return a different value
 		 */
@@ -411,11 +459,54 @@ namespace pcpp
 		 * Re-allocate raw packet buffer meaning add size to it without losing the current packet data. This method allocates the required buffer size as instructed
 		 * by the use and then copies the raw data from the current allocated buffer to the new one. This method can become useful if the user wants to insert or
 		 * append data to the raw data, and the previous allocated buffer is too small, so the user wants to allocate a larger buffer and get RawPacket instance to
-		 * point to it
+		 * point to it. The current headroom is kept
 		 * @param[in] newBufferLength The new buffer length as required by the user. The method is responsible to allocate the memory
 		 * @return True if data was reallocated successfully, false otherwise
 		 */
 		virtual bool reallocateData(size_t newBufferLength);
+
+		/**
+		 * Re-allocate the raw packet buffer with free space (headroom) in front of the data, like the headroom of mbufs. The data is copied
+		 * once to a new buffer of headroom + newBufferLength bytes, so later insertions near the beginning of the packet (see
+		 * insertDataUsingHeadroom()) only move the data pointer instead of shifting the whole packet
+		 * @param[in] newBufferLength The length of the buffer after the headroom, meaning the data length plus the required tailroom. Must be
+		 * at least the current data length
+		 * @param[in] headroom The number of free bytes to reserve in front of the data
+		 * @return True if data was reallocated successfully, false otherwise
+		 */
+		virtual bool reallocateData(size_t newBufferLength, size_t headroom);
+
+		/**
+		 * @return The number of free bytes in front of the data that can be used by insertDataUsingHeadroom()
+		 */
+		size_t getHeadroom() const { return m_Headroom; }
+
+		/**
+		 * @return The number of free bytes known to be available after the data. It's known only for buffers allocated by reallocateData(), for
+		 * buffers set by the user it's 0 and the user is responsible for the buffer size
+		 */
+		size_t getTailroom() const { return m_Tailroom; }
+
+		/**
+		 * Insert new data at some index of the current data by moving the data before this index back into the headroom. The cost is
+		 * proportional to atIndex rather than to the packet length, so for example pushing a tunnel header at index 0 or a VLAN tag after the
+		 * MAC addresses doesn't touch the rest of the packet. Notice this changes the raw data pointer (getRawData())
+		 * @param[in] atIndex The index to insert the new data to
+		 * @param[in] dataToInsert A pointer to the new data to insert. If NULL the new bytes are left as is
+		 * @param[in] dataToInsertLen Length in bytes of dataToInsert
+		 * @return True if the data was inserted or false if the headroom is smaller than dataToInsertLen or the index is out of bounds
+		 */
+		virtual bool insertDataUsingHeadroom(int atIndex, const uint8_t* dataToInsert, size_t dataToInsertLen);
+
+		/**
+		 * Remove certain number of bytes from the current raw data by moving the data before them forward and returning the space to the
+		 * headroom. The cost is proportional to atIndex, so removing an outer header (decapsulation) doesn't touch the rest of the packet.
+		 * Notice this changes the raw data pointer (getRawData())
+		 * @param[in] atIndex The index to start removing bytes from
+		 * @param[in] numOfBytesToRemove Number of bytes to remove
+		 * @return True if all bytes were removed successfully, or false if atIndex+numOfBytesToRemove is out-of-bounds of the raw data buffer
+		 */
+		virtual bool removeDataUsingHeadroom(int atIndex, size_t numOfBytesToRemove);
 	};
 
 } // namespace pcpp
@@ -9,6 +9,11 @@
  * See detailed explanation of the TLS/SSL protocol support in PcapPlusPlus in SSLLayer.h
  */
 
+/**
+ * The size of a buffer that can hold the MD5 digest of a JA3 or JA3S fingerprint as a hex string, including the terminating null
+ */
+#define PCPP_SSL_FINGERPRINT_MD5_BUFFER_SIZE 33
+
 /**
  * \namespace pcpp
  * \brief The main namespace for the PcapPlusPlus lib
@@ -400,13 +405,50 @@ public:
 	template<class TExtension>
 	TExtension* getExtensionOfType() const;
 
+	/**
+	 * Calculate the JA3 fingerprint of the client (see https://github.com/salesforce/ja3) and write it into a buffer supplied
+	 * by the caller. The fingerprint is made of the handshake version, the cipher-suites, the extension types, the elliptic curves
+	 * and the elliptic curve point formats of the message. GREASE values (RFC 8701) are ignored. The fingerprint is calculated by
+	 * walking over the raw message, no extension or cipher-suite objects are created and no memory is allocated
+	 * @param[out] buffer The buffer to write the null-terminated fingerprint string to
+	 * @param[in] bufferLen The size of the buffer in bytes
+	 * @param[out] fingerprintLen If not NULL, the length of the fingerprint string (without the terminating null) is written to it
+	 * @return True if the fingerprint was written successfully, false if the buffer is too small or the message is too short to
+	 * contain the cipher-suite list
+	 */
+	bool getJA3Fingerprint(char* buffer, size_t bufferLen, size_t* fingerprintLen = NULL) const;
+
+	/**
+	 * Calculate the MD5 digest of the JA3 fingerprint of the client (see getJA3Fingerprint()) without allocating memory
+	 * @param[out] buffer The buffer to write the digest to as a null-terminated string of 32 lowercase hex digits. Must be at least
+	 * ::PCPP_SSL_FINGERPRINT_MD5_BUFFER_SIZE bytes long
+	 * @param[in] bufferLen The size of the buffer in bytes
+	 * @return True if the digest was written successfully, false if the buffer is too small or the message is too short to
+	 * contain the cipher-suite list
+	 */
+	bool getJA3FingerprintMD5(char* buffer, size_t bufferLen) const;
+
+	/**
+	 * Get the host name in the server name indication (SNI) extension of the message without creating extension objects and
+	 * without allocating memory
+	 * @param[out] buffer The buffer to copy the null-terminated host name to
+	 * @param[in] bufferLen The size of the buffer in bytes
+	 * @param[out] serverNameLen If not NULL, the length of the host name (without the terminating null) is written to it
+	 * @return True if the host name was copied, false if the message doesn't have a valid SNI extension or if the buffer is too
+	 * small for the host name
+	 */
+	bool getServerName(char* buffer, size_t bufferLen, size_t* serverNameLen = NULL) const;
+
 	// implement abstract methods
 
 	std::string toString() const;
 
 private:
-	PointerVector<SSLExtension> m_ExtensionList;
+	// the extension objects are created only when one of the extension getters is first called
+	mutable PointerVector<SSLExtension> m_ExtensionList;
+	mutable bool m_ExtensionsParsed;
 
+	void parseExtensions() const;
 };
 
 
@@ -507,12 +549,39 @@ public:
 	template<class TExtension>
 	TExtension* getExtensionOfType() const;
 
+	/**
+	 * Calculate the JA3S fingerprint of the server (see https://github.com/salesforce/ja3) and write it into a buffer supplied
+	 * by the caller. The fingerprint is made of the handshake version, the selected cipher-suite and the extension types of the
+	 * message. GREASE values (RFC 8701) are ignored. The fingerprint is calculated by walking over the raw message, no extension
+	 * or cipher-suite objects are created and no memory is allocated
+	 * @param[out] buffer The buffer to write the null-terminated fingerprint string to
+	 * @param[in] bufferLen The size of the buffer in bytes
+	 * @param[out] fingerprintLen If not NULL, the length of the fingerprint string (without the terminating null) is written to it
+	 * @return True if the fingerprint was written successfully, false if the buffer is too small or the message is too short to
+	 * contain the cipher-suite
+	 */
+	bool getJA3SFingerprint(char* buffer, size_t bufferLen, size_t* fingerprintLen = NULL) const;
+
+	/**
+	 * Calculate the MD5 digest of the JA3S fingerprint of the server (see getJA3SFingerprint()) without allocating memory
+	 * @param[out] buffer The buffer to write the digest to as a null-terminated string of 32 lowercase hex digits. Must be at least
+	 * ::PCPP_SSL_FINGERPRINT_MD5_BUFFER_SIZE bytes long
+	 * @param[in] bufferLen The size of the buffer in bytes
+	 * @return True if the digest was written successfully, false if the buffer is too small or the message is too short to
+	 * contain the cipher-suite
+	 */
+	bool getJA3SFingerprintMD5(char* buffer, size_t bufferLen) const;
+
 	// implement abstract methods
 
 	std::string toString() const;
 
 private:
-	PointerVector<SSLExtension> m_ExtensionList;
+	// the extension objects are created only when one of the extension getters is first called
+	mutable PointerVector<SSLExtension> m_ExtensionList;
+	mutable bool m_ExtensionsParsed;
+
+	void parseExtensions() const;
 };
 
 
@@ -916,6 +985,8 @@ public:
 template<class TExtension>
 TExtension* SSLClientHelloMessage::getExtensionOfType() const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -930,6 +1001,8 @@ TExtension* SSLClientHelloMessage::getExtensionOfType() const
 template<class TExtension>
 TExtension* SSLServerHelloMessage::getExtensionOfType() const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -66,6 +66,68 @@ namespace pcpp
 /** Record-Route field */
 #define PCPP_SIP_RECORD_ROUTE_FIELD        "Record-Route"
 
+	/**
+	 * @struct SipFieldNames
+	 * Interned names of the popular SIP fields, for looking them up with TextBasedProtocolMessage#getFieldByName(const HeaderFieldName&, int) const
+	 * without copying or hashing the name on every lookup. Notice these are initialized during static initialization, so they shouldn't be
+	 * used by static initializers of other translation units
+	 */
+	struct SipFieldNames
+	{
+		/** ::PCPP_SIP_FROM_FIELD */
+		static const HeaderFieldName From;
+		/** ::PCPP_SIP_TO_FIELD */
+		static const HeaderFieldName To;
+		/** ::PCPP_SIP_VIA_FIELD */
+		static const HeaderFieldName Via;
+		/** ::PCPP_SIP_CALL_ID_FIELD */
+		static const HeaderFieldName CallID;
+		/** ::PCPP_SIP_CONTENT_TYPE_FIELD */
+		static const HeaderFieldName ContentType;
+		/** ::PCPP_SIP_CONTENT_LENGTH_FIELD */
+		static const HeaderFieldName ContentLength;
+		/** ::PCPP_SIP_CONTENT_DISPOSITION_FIELD */
+		static const HeaderFieldName ContentDisposition;
+		/** ::PCPP_SIP_CONTENT_ENCODING_FIELD */
+		static const HeaderFieldName ContentEncoding;
+		/** ::PCPP_SIP_CONTENT_LANGUAGE_FIELD */
+		static const HeaderFieldName ContentLanguage;
+		/** ::PCPP_SIP_CSEQ_FIELD */
+		static const HeaderFieldName CSeq;
+		/** ::PCPP_SIP_CONTACT_FIELD */
+		static const HeaderFieldName Contact;
+		/** ::PCPP_SIP_MAX_FORWARDS_FIELD */
+		static const HeaderFieldName MaxForwards;
+		/** ::PCPP_SIP_USER_AGENT_FIELD */
+		static const HeaderFieldName UserAgent;
+		/** ::PCPP_SIP_ACCEPT_FIELD */
+		static const HeaderFieldName Accept;
+		/** ::PCPP_SIP_ACCEPT_ENCODING_FIELD */
+		static const HeaderFieldName AcceptEncoding;
+		/** ::PCPP_SIP_ACCEPT_LANGUAGE_FIELD */
+		static const HeaderFieldName AcceptLanguage;
+		/** ::PCPP_SIP_ALLOW_FIELD */
+		static const HeaderFieldName Allow;
+		/** ::PCPP_SIP_AUTHORIZATION_FIELD */
+		static const HeaderFieldName Authorization;
+		/** ::PCPP_SIP_DATE_FIELD */
+		static const HeaderFieldName Date;
+		/** ::PCPP_SIP_MIME_VERSION_FIELD */
+		static const HeaderFieldName MimeVersion;
+		/** ::PCPP_SIP_REASON_FIELD */
+		static const HeaderFieldName Reason;
+		/** ::PCPP_SIP_SUPPORTED_FIELD */
+		static const HeaderFieldName Supported;
+		/** ::PCPP_SIP_SERVER_FIELD */
+		static const HeaderFieldName Server;
+		/** ::PCPP_SIP_WWW_AUTHENTICATE_FIELD */
+		static const HeaderFieldName WwwAuthenticate;
+		/** ::PCPP_SIP_RETRY_AFTER_FIELD */
+		static const HeaderFieldName RetryAfter;
+		/** ::PCPP_SIP_RECORD_ROUTE_FIELD */
+		static const HeaderFieldName RecordRoute;
+	};
+
 
 	/**
 	 * @class SipLayer
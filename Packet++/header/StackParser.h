@@ -0,0 +1,582 @@
+#ifndef PACKETPP_STACK_PARSER
+#define PACKETPP_STACK_PARSER
+
+#include "Packet.h"
+#include "EthLayer.h"
+#include "VlanLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "EndianPortable.h"
+
+/// @file
+
+/**
+ * The maximum number of layers in the stack of a pcpp#StackParser
+ */
+#define PCPP_STACK_PARSER_MAX_LAYERS 6
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * The kinds of values a layer of a pcpp#StackParser stack is selected by, meaning the field of the previous layer that tells
+	 * which protocol comes next
+	 */
+	enum StackSelectorType
+	{
+		/** The previous layer has no next protocol (for example a non-first IPv4 fragment), no layer can follow it */
+		StackSelectorNone,
+		/** The layer is the first layer of the packet, the selector is the link layer type of the raw packet */
+		StackSelectorLinkType,
+		/** The selector is an EtherType */
+		StackSelectorEtherType,
+		/** The selector is an IP protocol number (see pcpp#IPProtocolTypes) */
+		StackSelectorIPProtocol
+	};
+
+	/**
+	 * @struct StackEnd
+	 * An empty type that marks the unused layer slots of a pcpp#StackParser. The unused slots must be the last ones
+	 */
+	struct StackEnd {};
+
+	/**
+	 * @struct StackLayerTraits
+	 * Describes how pcpp#StackParser validates and binds the header of a layer type without creating the layer. It's specialized
+	 * for EthLayer, VlanLayer, IPv4Layer, IPv6Layer, TcpLayer and UdpLayer, and may be specialized by the user for other layers.
+	 * A specialization has to provide:
+	 * - HeaderType: the struct of the layer's header, returned by StackParser#getHeader()
+	 * - static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* data): whether the layer is the next
+	 *   layer of a previous layer whose next protocol is the given selector. data points to at least one byte of the layer
+	 * - static size_t getHeaderLen(const uint8_t* data, size_t& dataLen): validate the header and return its length, or 0 if the
+	 *   data isn't a valid header of the layer. dataLen may be decreased if the layer is shorter than the remaining data (for
+	 *   example because of the IPv4 total length)
+	 * - static StackSelectorType getNextSelector(const uint8_t* data, size_t headerLen, uint16_t& selector): return the kind of
+	 *   selector of the next layer and set its value
+	 */
+	template<class TLayer>
+	struct StackLayerTraits;
+
+	/**
+	 * Binds an Ethernet II header. Frames whose EtherType field holds a length (IEEE 802.3) don't match
+	 */
+	template<>
+	struct StackLayerTraits<EthLayer>
+	{
+		typedef ether_header HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* /* data */)
+		{
+			return selectorType == StackSelectorLinkType && selector == LINKTYPE_ETHERNET;
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (dataLen < sizeof(ether_header))
+				return 0;
+
+			// the same rule Packet uses to tell Ethernet II from IEEE 802.3
+			uint16_t etherType = be16toh(((const ether_header*)data)->etherType);
+			return (etherType > 0x5dc || etherType == 0) ? sizeof(ether_header) : 0;
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* data, size_t /* headerLen */, uint16_t& selector)
+		{
+			selector = be16toh(((const ether_header*)data)->etherType);
+			return StackSelectorEtherType;
+		}
+	};
+
+	/**
+	 * Binds an 802.1Q VLAN tag
+	 */
+	template<>
+	struct StackLayerTraits<VlanLayer>
+	{
+		typedef vlan_header HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* /* data */)
+		{
+			return selectorType == StackSelectorEtherType && selector == PCPP_ETHERTYPE_VLAN;
+		}
+
+		static size_t getHeaderLen(const uint8_t* /* data */, size_t& dataLen)
+		{
+			return dataLen >= sizeof(vlan_header) ? sizeof(vlan_header) : 0;
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* data, size_t /* headerLen */, uint16_t& selector)
+		{
+			selector = be16toh(((const vlan_header*)data)->etherType);
+			return StackSelectorEtherType;
+		}
+	};
+
+	/**
+	 * Binds an IPv4 header including its options. The data of the following layers is limited to the IPv4 total length. No layer
+	 * can follow a fragment (Packet parses the payload of fragments as PayloadLayer)
+	 */
+	template<>
+	struct StackLayerTraits<IPv4Layer>
+	{
+		typedef iphdr HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* data)
+		{
+			switch (selectorType)
+			{
+			case StackSelectorLinkType:
+				return (selector == LINKTYPE_RAW || selector == LINKTYPE_DLT_RAW1 || selector == LINKTYPE_DLT_RAW2) && (data[0] & 0xf0) == 0x40;
+			case StackSelectorEtherType:
+				return selector == PCPP_ETHERTYPE_IP;
+			case StackSelectorIPProtocol:
+				return selector == PACKETPP_IPPROTO_IPIP && (data[0] & 0xf0) == 0x40;
+			default:
+				return false;
+			}
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (!IPv4Layer::isDataValid(data, dataLen))
+				return 0;
+
+			const iphdr* ipHdr = (const iphdr*)data;
+			size_t headerLen = ipHdr->internetHeaderLength * 4;
+			if (headerLen > dataLen)
+				return 0;
+
+			// a total length of 0 usually means TCP Segmentation Offload, in this case the captured length is used
+			size_t totalLen = be16toh(ipHdr->totalLength);
+			if (totalLen < dataLen && totalLen != 0)
+				dataLen = (totalLen > headerLen ? totalLen : headerLen);
+
+			return headerLen;
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* data, size_t /* headerLen */, uint16_t& selector)
+		{
+			const iphdr* ipHdr = (const iphdr*)data;
+			if ((ipHdr->fragmentOffset & htobe16(0x1FFF | (PCPP_IP_MORE_FRAGMENTS << 8))) != 0)
+				return StackSelectorNone;
+
+			selector = ipHdr->protocol;
+			return StackSelectorIPProtocol;
+		}
+	};
+
+	/**
+	 * Binds an IPv6 header. The data of the following layers is limited to the IPv6 payload length. Packets with IPv6 extension
+	 * headers don't match, so they're parsed by the generic Packet parsing which handles the extensions
+	 */
+	template<>
+	struct StackLayerTraits<IPv6Layer>
+	{
+		typedef ip6_hdr HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* data)
+		{
+			switch (selectorType)
+			{
+			case StackSelectorLinkType:
+				return (selector == LINKTYPE_RAW || selector == LINKTYPE_DLT_RAW1 || selector == LINKTYPE_DLT_RAW2) && (data[0] & 0xf0) == 0x60;
+			case StackSelectorEtherType:
+				return selector == PCPP_ETHERTYPE_IPV6;
+			case StackSelectorIPProtocol:
+				return selector == PACKETPP_IPPROTO_IPIP && (data[0] & 0xf0) == 0x60;
+			default:
+				return false;
+			}
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			if (!IPv6Layer::isDataValid(data, dataLen))
+				return 0;
+
+			const ip6_hdr* ipHdr = (const ip6_hdr*)data;
+			switch (ipHdr->nextHeader)
+			{
+			case PACKETPP_IPPROTO_HOPOPTS:
+			case PACKETPP_IPPROTO_ROUTING:
+			case PACKETPP_IPPROTO_FRAGMENT:
+			case PACKETPP_IPPROTO_AH:
+			case PACKETPP_IPPROTO_DSTOPTS:
+				return 0;
+			default:
+				break;
+			}
+
+			size_t totalLen = sizeof(ip6_hdr) + be16toh(ipHdr->payloadLength);
+			if (totalLen < dataLen)
+				dataLen = totalLen;
+
+			return sizeof(ip6_hdr);
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* data, size_t /* headerLen */, uint16_t& selector)
+		{
+			selector = ((const ip6_hdr*)data)->nextHeader;
+			return StackSelectorIPProtocol;
+		}
+	};
+
+	/**
+	 * Binds a TCP header including its options. The stack can't continue after TCP, the rest of the data is the stack's payload
+	 */
+	template<>
+	struct StackLayerTraits<TcpLayer>
+	{
+		typedef tcphdr HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* /* data */)
+		{
+			return selectorType == StackSelectorIPProtocol && selector == PACKETPP_IPPROTO_TCP;
+		}
+
+		static size_t getHeaderLen(const uint8_t* data, size_t& dataLen)
+		{
+			return TcpLayer::isDataValid(data, dataLen) ? ((const tcphdr*)data)->dataOffset * 4 : 0;
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* /* data */, size_t /* headerLen */, uint16_t& /* selector */)
+		{
+			return StackSelectorNone;
+		}
+	};
+
+	/**
+	 * Binds a UDP header. The stack can't continue after UDP, the rest of the data is the stack's payload
+	 */
+	template<>
+	struct StackLayerTraits<UdpLayer>
+	{
+		typedef udphdr HeaderType;
+
+		static bool follows(StackSelectorType selectorType, uint16_t selector, const uint8_t* /* data */)
+		{
+			return selectorType == StackSelectorIPProtocol && selector == PACKETPP_IPPROTO_UDP;
+		}
+
+		static size_t getHeaderLen(const uint8_t* /* data */, size_t& dataLen)
+		{
+			return dataLen >= sizeof(udphdr) ? sizeof(udphdr) : 0;
+		}
+
+		static StackSelectorType getNextSelector(const uint8_t* /* data */, size_t /* headerLen */, uint16_t& /* selector */)
+		{
+			return StackSelectorNone;
+		}
+	};
+
+	/**
+	 * @struct StackLayerBinder
+	 * Matches a layer of a pcpp#StackParser stack against the data at the current offset and advances the offset past its header.
+	 * Used internally by StackParser
+	 */
+	template<class TLayer>
+	struct StackLayerBinder
+	{
+		static bool bind(const uint8_t* data, size_t& dataLen, size_t& offset, StackSelectorType& selectorType, uint16_t& selector)
+		{
+			const uint8_t* layerData = data + offset;
+			size_t layerDataLen = dataLen - offset;
+			if (layerDataLen == 0 || !StackLayerTraits<TLayer>::follows(selectorType, selector, layerData))
+				return false;
+
+			size_t headerLen = StackLayerTraits<TLayer>::getHeaderLen(layerData, layerDataLen);
+			if (headerLen == 0)
+				return false;
+
+			dataLen = offset + layerDataLen;
+			selectorType = StackLayerTraits<TLayer>::getNextSelector(layerData, headerLen, selector);
+			offset += headerLen;
+			return true;
+		}
+	};
+
+	/**
+	 * An unused layer slot always matches
+	 */
+	template<>
+	struct StackLayerBinder<StackEnd>
+	{
+		static bool bind(const uint8_t* /* data */, size_t& /* dataLen */, size_t& /* offset */, StackSelectorType& /* selectorType */, uint16_t& /* selector */)
+		{
+			return true;
+		}
+	};
+
+	/**
+	 * @struct StackParserLayerAt
+	 * The type of the layer at index N of a pcpp#StackParser stack. Used internally by StackParser
+	 */
+	template<int N, class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt;
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<0, T1, T2, T3, T4, T5, T6> { typedef T1 type; };
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<1, T1, T2, T3, T4, T5, T6> { typedef T2 type; };
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<2, T1, T2, T3, T4, T5, T6> { typedef T3 type; };
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<3, T1, T2, T3, T4, T5, T6> { typedef T4 type; };
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<4, T1, T2, T3, T4, T5, T6> { typedef T5 type; };
+
+	template<class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserLayerAt<5, T1, T2, T3, T4, T5, T6> { typedef T6 type; };
+
+	/**
+	 * @struct StackParserIndexOf
+	 * The index of the first layer of type TLayer in a pcpp#StackParser stack. Using a layer type that isn't part of the stack
+	 * fails to compile. Used internally by StackParser
+	 */
+	template<class TLayer, class T1, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserIndexOf
+	{
+		enum { value = 1 + StackParserIndexOf<TLayer, T2, T3, T4, T5, T6, StackEnd>::value };
+	};
+
+	template<class TLayer, class T2, class T3, class T4, class T5, class T6>
+	struct StackParserIndexOf<TLayer, TLayer, T2, T3, T4, T5, T6>
+	{
+		enum { value = 0 };
+	};
+
+	template<class TLayer>
+	struct StackParserIndexOf<TLayer, StackEnd, StackEnd, StackEnd, StackEnd, StackEnd, StackEnd>
+	{
+	};
+
+	/**
+	 * @struct StackParserIsLayer
+	 * 1 for layer types and 0 for pcpp#StackEnd. Used internally by StackParser to count the layers of a stack
+	 */
+	template<class TLayer>
+	struct StackParserIsLayer { enum { value = 1 }; };
+
+	template<>
+	struct StackParserIsLayer<StackEnd> { enum { value = 0 }; };
+
+	/**
+	 * @class StackParser
+	 * A parser specialized at compile time for a fixed sequence of protocol headers, for example
+	 * StackParser<EthLayer, VlanLayer, IPv6Layer, UdpLayer>. Probes that see only a few protocol stacks can use it to bind the
+	 * headers of a packet without creating layer objects, without virtual calls and without allocating memory: parse() walks the
+	 * stack once, checks that each header is valid and that it's selected by the previous one (EtherType, IP protocol) exactly like
+	 * the generic pcpp#Packet parsing would, and records the header offsets. The typed accessors (getHeader<N>() and
+	 * getLayerHeader<TLayer>()) are resolved at compile time to the header struct of the layer, so hot loops using them are fully
+	 * inlined.<BR>
+	 * If the packet doesn't match the stack the parser falls back to the generic Packet parsing, available through getPacket(). The
+	 * fallback Packet object is created on the first mismatch and reused afterwards (together with its recycled layers, see
+	 * Packet#setRawPacket()). When the packet does match, getPacket() parses it generically on demand.<BR>
+	 * The stack describes a prefix of the packet: protocols after the last layer of the stack (for example HTTP after TCP) are
+	 * ignored and their data is the payload of the stack (see getPayload()). The built-in stack layers are EthLayer, VlanLayer,
+	 * IPv4Layer, IPv6Layer, TcpLayer and UdpLayer; other layers can be added by specializing pcpp#StackLayerTraits. Notice that
+	 * parsers registered in pcpp#NextLayerRegistry don't affect the matching.<BR>
+	 * Up to #PCPP_STACK_PARSER_MAX_LAYERS layers are supported, unused template parameters default to pcpp#StackEnd.
+	 * The parser keeps a pointer to the raw packet, which must stay valid as long as the headers are accessed. It isn't copyable
+	 */
+	template<class T1, class T2 = StackEnd, class T3 = StackEnd, class T4 = StackEnd, class T5 = StackEnd, class T6 = StackEnd>
+	class StackParser
+	{
+	public:
+		/**
+		 * The number of layers in the stack
+		 */
+		enum
+		{
+			NumOfLayers = StackParserIsLayer<T1>::value + StackParserIsLayer<T2>::value + StackParserIsLayer<T3>::value +
+				StackParserIsLayer<T4>::value + StackParserIsLayer<T5>::value + StackParserIsLayer<T6>::value
+		};
+
+		/**
+		 * @struct LayerAt
+		 * The layer type (LayerType) and header type (HeaderType) of the layer at index N of the stack
+		 */
+		template<int N>
+		struct LayerAt
+		{
+			typedef typename StackParserLayerAt<N, T1, T2, T3, T4, T5, T6>::type LayerType;
+			typedef typename StackLayerTraits<LayerType>::HeaderType HeaderType;
+		};
+
+		/**
+		 * A c'tor that creates a parser that didn't parse any packet yet
+		 */
+		StackParser() : m_RawPacket(NULL), m_Data(NULL), m_DataLen(0), m_IsMatched(false), m_Packet(NULL), m_IsPacketParsed(false)
+		{
+			memset(m_Offsets, 0, sizeof(m_Offsets));
+		}
+
+		/**
+		 * A d'tor for this class, frees the fallback Packet object if it was created. The raw packet isn't freed
+		 */
+		~StackParser() { delete m_Packet; }
+
+		/**
+		 * Match a raw packet against the stack and bind its headers. If the packet doesn't match, it's parsed by the generic Packet
+		 * parsing (see getPacket())
+		 * @param[in] rawPacket The raw packet to parse. It's not copied so it must stay valid as long as this parser uses it
+		 * @return True if the packet matches the stack, false otherwise
+		 */
+		bool parse(RawPacket* rawPacket)
+		{
+			m_RawPacket = rawPacket;
+			m_IsMatched = false;
+			m_IsPacketParsed = false;
+
+			if (rawPacket == NULL || rawPacket->getRawDataLen() <= 0)
+			{
+				m_Data = NULL;
+				m_DataLen = 0;
+				return false;
+			}
+
+			m_Data = (uint8_t*)rawPacket->getRawData();
+			size_t dataLen = (size_t)rawPacket->getRawDataLen();
+			size_t offset = 0;
+			StackSelectorType selectorType = StackSelectorLinkType;
+			uint16_t selector = (uint16_t)rawPacket->getLinkLayerType();
+
+			m_IsMatched =
+				bindLayer<T1>(0, dataLen, offset, selectorType, selector) &&
+				bindLayer<T2>(1, dataLen, offset, selectorType, selector) &&
+				bindLayer<T3>(2, dataLen, offset, selectorType, selector) &&
+				bindLayer<T4>(3, dataLen, offset, selectorType, selector) &&
+				bindLayer<T5>(4, dataLen, offset, selectorType, selector) &&
+				bindLayer<T6>(5, dataLen, offset, selectorType, selector);
+
+			if (m_IsMatched)
+			{
+				m_Offsets[NumOfLayers] = offset;
+				m_DataLen = dataLen;
+			}
+			else
+				parsePacket();
+
+			return m_IsMatched;
+		}
+
+		/**
+		 * @return True if the last parsed packet matches the stack, false otherwise
+		 */
+		bool isMatched() const { return m_IsMatched; }
+
+		/**
+		 * @return The raw packet that was last parsed or NULL if no packet was parsed
+		 */
+		RawPacket* getRawPacket() const { return m_RawPacket; }
+
+		/**
+		 * Get the header of the layer at index N of the stack. The header type is resolved at compile time, for example
+		 * getHeader<2>() of StackParser<EthLayer, VlanLayer, IPv4Layer, TcpLayer> returns an iphdr pointer. Must be called only if
+		 * the packet matches the stack (see isMatched())
+		 * @return A pointer to the header in the raw packet data
+		 */
+		template<int N>
+		typename LayerAt<N>::HeaderType* getHeader() const
+		{
+			return (typename LayerAt<N>::HeaderType*)(m_Data + m_Offsets[N]);
+		}
+
+		/**
+		 * Get the header of the first layer of type TLayer in the stack, for example getLayerHeader<TcpLayer>() returns a tcphdr
+		 * pointer. The layer's index is resolved at compile time, using a layer type that isn't part of the stack fails to compile.
+		 * Must be called only if the packet matches the stack (see isMatched())
+		 * @return A pointer to the header in the raw packet data
+		 */
+		template<class TLayer>
+		typename StackLayerTraits<TLayer>::HeaderType* getLayerHeader() const
+		{
+			return (typename StackLayerTraits<TLayer>::HeaderType*)(m_Data + m_Offsets[StackParserIndexOf<TLayer, T1, T2, T3, T4, T5, T6>::value]);
+		}
+
+		/**
+		 * @return The length in bytes of the header of the layer at index N of the stack, including options. Must be called only if
+		 * the packet matches the stack
+		 */
+		template<int N>
+		size_t getHeaderLen() const { return m_Offsets[N + 1] - m_Offsets[N]; }
+
+		/**
+		 * @return The offset in the raw packet data of the header of the layer at index N of the stack. Must be called only if the
+		 * packet matches the stack
+		 */
+		template<int N>
+		size_t getHeaderOffset() const { return m_Offsets[N]; }
+
+		/**
+		 * @return A pointer to the data after the last header of the stack or NULL if the packet doesn't match the stack
+		 */
+		uint8_t* getPayload() const { return m_IsMatched ? m_Data + m_Offsets[NumOfLayers] : NULL; }
+
+		/**
+		 * @return The length of the data after the last header of the stack, limited by the IP total length or payload length if
+		 * the stack contains an IP layer. 0 if the packet doesn't match the stack
+		 */
+		size_t getPayloadLen() const { return m_IsMatched ? m_DataLen - m_Offsets[NumOfLayers] : 0; }
+
+		/**
+		 * Get the last parsed packet as a generically parsed Packet object. If the packet didn't match the stack it was already
+		 * parsed by parse(), otherwise it's parsed on the first call to this method
+		 * @return The parsed packet or NULL if no packet was parsed
+		 */
+		Packet* getPacket()
+		{
+			if (m_RawPacket == NULL)
+				return NULL;
+
+			if (!m_IsPacketParsed)
+				parsePacket();
+
+			return m_Packet;
+		}
+
+	private:
+		RawPacket* m_RawPacket;
+		uint8_t* m_Data;
+		size_t m_DataLen;
+		// the header offsets of the layers. The entry after the last layer is the offset of the payload
+		size_t m_Offsets[PCPP_STACK_PARSER_MAX_LAYERS + 1];
+		bool m_IsMatched;
+		Packet* m_Packet;
+		bool m_IsPacketParsed;
+
+		// the parser isn't copyable
+		StackParser(const StackParser& other);
+		StackParser& operator=(const StackParser& other);
+
+		template<class TLayer>
+		bool bindLayer(int index, size_t& dataLen, size_t& offset, StackSelectorType& selectorType, uint16_t& selector)
+		{
+			m_Offsets[index] = offset;
+			return StackLayerBinder<TLayer>::bind(m_Data, dataLen, offset, selectorType, selector);
+		}
+
+		void parsePacket()
+		{
+			if (m_Packet == NULL)
+				m_Packet = new Packet(m_RawPacket, false);
+			else
+				m_Packet->setRawPacket(m_RawPacket, false);
+
+			m_IsPacketParsed = true;
+		}
+	};
+
+} // namespace pcpp
+
+#endif /* PACKETPP_STACK_PARSER */
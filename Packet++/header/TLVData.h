@@ -339,6 +339,118 @@ namespace pcpp
 	};
 
 
+	/**
+	 * @class IndexedTLVRecordReader
+	 * A TLVRecordReader that indexes the records by type, so finding a record by type (see getTLVRecord()) is a single array
+	 * access instead of going over the records from the start. The index is a fixed array that holds the offset of the first record
+	 * of each type, and is built by going over all records once on the first lookup. Like the record count, the index is cached,
+	 * which implies that if records are added or removed it's the user's responsibility to call changeTLVRecordCount() or
+	 * invalidateIndex(), after which the index is rebuilt on the next lookup. Since the offsets are relative to the TLV data byte
+	 * stream the index stays valid if the stream is moved to another place in memory.<BR>
+	 * The class gets 2 template arguments: the record class (derived from TLVRecord) and the type used to store offsets, which
+	 * should be large enough for the maximum length of the TLV data byte stream (for example uint8_t for the 40 bytes of TCP
+	 * options). Records at offsets the offset type can't hold aren't indexed, and lookups fall back to going over the records
+	 */
+	template<typename TLVRecordType, typename OffsetType = uint16_t>
+	class IndexedTLVRecordReader : public TLVRecordReader<TLVRecordType>
+	{
+	private:
+		// the offset of the first record of each type plus 1, or 0 if there is no record of this type
+		mutable OffsetType m_RecordOffsets[256];
+		mutable bool m_IsIndexValid;
+
+		bool buildIndex(uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
+		{
+			memset(m_RecordOffsets, 0, sizeof(m_RecordOffsets));
+
+			TLVRecordType curRec = this->getFirstTLVRecord(tlvDataBasePtr, tlvDataLen);
+			while (!curRec.isNull())
+			{
+				size_t offset = curRec.getRecordBasePtr() - tlvDataBasePtr;
+				if ((OffsetType)(offset + 1) != offset + 1)
+					return false;
+
+				if (m_RecordOffsets[curRec.getType()] == 0)
+					m_RecordOffsets[curRec.getType()] = (OffsetType)(offset + 1);
+
+				curRec = this->getNextTLVRecord(curRec, tlvDataBasePtr, tlvDataLen);
+			}
+
+			m_IsIndexValid = true;
+			return true;
+		}
+
+	public:
+
+		/**
+		 * A default c'tor for this class
+		 */
+		IndexedTLVRecordReader() : m_IsIndexValid(false) { }
+
+		/**
+		 * A copy c'tor for this class. The index is copied as well since it's relative to the TLV data byte stream
+		 * @param[in] other The IndexedTLVRecordReader instance to copy from
+		 */
+		IndexedTLVRecordReader(const IndexedTLVRecordReader& other) : TLVRecordReader<TLVRecordType>(other)
+		{
+			m_IsIndexValid = other.m_IsIndexValid;
+			if (m_IsIndexValid)
+				memcpy(m_RecordOffsets, other.m_RecordOffsets, sizeof(m_RecordOffsets));
+		}
+
+		/**
+		 * Overload of the assignment operator for this class
+		 * @param[in] other The IndexedTLVRecordReader instance to assign
+		 */
+		IndexedTLVRecordReader& operator=(const IndexedTLVRecordReader& other)
+		{
+			TLVRecordReader<TLVRecordType>::operator=(other);
+			m_IsIndexValid = other.m_IsIndexValid;
+			if (m_IsIndexValid)
+				memcpy(m_RecordOffsets, other.m_RecordOffsets, sizeof(m_RecordOffsets));
+			return *this;
+		}
+
+		/**
+		 * Search for the first TLV record that corresponds to a given record type (the 'T' in __Type__-Length-Value) using the
+		 * index. The index is built on the first call
+		 * @param[in] recordType The record type to search for
+		 * @param[in] tlvDataBasePtr A pointer to the TLV data byte stream
+		 * @param[in] tlvDataLen The TLV data byte stream length
+		 * @return An instance of type TLVRecordType that contains the result record. If record was not found a logical
+		 * NULL instance of TLVRecordType will be returned, meaning TLVRecordType.isNull() will return true
+		 */
+		TLVRecordType getTLVRecord(uint8_t recordType, uint8_t* tlvDataBasePtr, size_t tlvDataLen) const
+		{
+			if (!m_IsIndexValid && !buildIndex(tlvDataBasePtr, tlvDataLen))
+				return TLVRecordReader<TLVRecordType>::getTLVRecord(recordType, tlvDataBasePtr, tlvDataLen);
+
+			TLVRecordType resRec(NULL); // for NRVO optimization
+			if (m_RecordOffsets[recordType] != 0)
+				resRec.assign(tlvDataBasePtr + m_RecordOffsets[recordType] - 1);
+
+			return resRec;
+		}
+
+		/**
+		 * Update the cached record count (see TLVRecordReader#changeTLVRecordCount()) and invalidate the index, since the records
+		 * were added or removed
+		 * @param[in] changedBy Number of records that were added or removed
+		 */
+		void changeTLVRecordCount(int changedBy)
+		{
+			TLVRecordReader<TLVRecordType>::changeTLVRecordCount(changedBy);
+			m_IsIndexValid = false;
+		}
+
+		/**
+		 * Invalidate the index so it's rebuilt on the next lookup. Should be called if the records were modified in a way that
+		 * changed their types or offsets
+		 */
+		void invalidateIndex() { m_IsIndexValid = false; }
+	};
+
+
 	/**
 	 * @class TLVRecordBuilder
 	 * A base class for building Type-Length-Value (TLV) records. This builder receives the record parameters in its c'tor,
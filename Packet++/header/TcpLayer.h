@@ -320,6 +320,61 @@ namespace pcpp
 	};
 
 
+	/** The maximum number of SACK blocks that fit in the TCP options space */
+#define PCPP_TCP_MAX_SACK_BLOCKS 4
+
+	/**
+	 * @struct TcpSackBlock
+	 * A block of data received by the sender of a ::PCPP_TCPOPT_SACK option
+	 */
+	struct TcpSackBlock
+	{
+		/** The first sequence number of the block in host byte order */
+		uint32_t leftEdge;
+		/** The sequence number immediately following the last sequence number of the block in host byte order */
+		uint32_t rightEdge;
+	};
+
+	/**
+	 * @struct TcpStandardOptions
+	 * The values of the standard TCP options of a packet (MSS, window scale, SACK permitted, SACK and timestamps), as returned by
+	 * TcpLayer#getStandardTcpOptions(). All values are in host byte order
+	 */
+	struct TcpStandardOptions
+	{
+		/** True if the packet contains a valid ::TCPOPT_MSS option */
+		bool hasMss;
+		/** The maximum segment size, valid only if hasMss is true */
+		uint16_t mss;
+		/** True if the packet contains a valid ::PCPP_TCPOPT_WINDOW option */
+		bool hasWindowScale;
+		/** The window scale shift count, valid only if hasWindowScale is true */
+		uint8_t windowScale;
+		/** True if the packet contains a ::TCPOPT_SACK_PERM option */
+		bool isSackPermitted;
+		/** True if the packet contains a valid ::PCPP_TCPOPT_TIMESTAMP option */
+		bool hasTimestamp;
+		/** The timestamp value (TSval), valid only if hasTimestamp is true */
+		uint32_t timestampValue;
+		/** The timestamp echo reply (TSecr), valid only if hasTimestamp is true */
+		uint32_t timestampEchoReply;
+		/** The number of blocks in the ::PCPP_TCPOPT_SACK option or 0 if the packet doesn't contain it */
+		uint8_t numOfSackBlocks;
+		/** The blocks of the ::PCPP_TCPOPT_SACK option. Only the first numOfSackBlocks blocks are valid */
+		TcpSackBlock sackBlocks[PCPP_TCP_MAX_SACK_BLOCKS];
+
+		/**
+		 * A c'tor that sets all options as missing
+		 */
+		TcpStandardOptions() { clear(); }
+
+		/**
+		 * Set all options as missing
+		 */
+		void clear() { memset(this, 0, sizeof(TcpStandardOptions)); }
+	};
+
+
 	/**
 	 * @class TcpLayer
 	 * Represents a TCP (Transmission Control Protocol) protocol layer
@@ -367,7 +422,36 @@ namespace pcpp
 		tcphdr* getTcpHeader() const { return (tcphdr*)m_Data; }
 
 		/**
-		 * Get a TCP option by type
+		 * @return The source port in host byte order
+		 */
+		uint16_t getSrcPort() const;
+
+		/**
+		 * @return The destination port in host byte order
+		 */
+		uint16_t getDstPort() const;
+
+		/**
+		 * Set the source port
+		 * @param[in] port The port to set in host byte order
+		 * @param[in] updateChecksum If set to true @ref tcphdr#headerChecksum is updated incrementally (RFC 1624) instead of having
+		 * to call computeCalculateFields(), so the cost doesn't depend on the segment size. The existing checksum is assumed to be
+		 * correct. The default value is false
+		 */
+		void setSrcPort(uint16_t port, bool updateChecksum = false);
+
+		/**
+		 * Set the destination port
+		 * @param[in] port The port to set in host byte order
+		 * @param[in] updateChecksum If set to true @ref tcphdr#headerChecksum is updated incrementally. See setSrcPort(). The
+		 * default value is false
+		 */
+		void setDstPort(uint16_t port, bool updateChecksum = false);
+
+		/**
+		 * Get a TCP option by type. The options are indexed by type on the first call, so consequent calls don't go over the
+		 * options. Notice the index is updated when options are added or removed using this class, but not if the option data is
+		 * modified directly
 		 * @param[in] option TCP option type to retrieve
 		 * @return An TcpOption object that contains the first option that matches this type, or logical NULL
 		 * (TcpOption#isNull() == true) if no such option found
@@ -394,6 +478,14 @@ namespace pcpp
 		 */
 		size_t getTcpOptionCount() const;
 
+		/**
+		 * Get the values of all standard TCP options (MSS, window scale, SACK permitted, SACK and timestamps) in a single pass over
+		 * the options. This is cheaper than looking up each option separately when several of them are needed, for example for
+		 * TCP analytics. Options whose length doesn't match their type are treated as missing
+		 * @param[out] options The struct to fill. Options that don't exist in the packet are marked as missing
+		 */
+		void getStandardTcpOptions(TcpStandardOptions& options) const;
+
 		/**
 		 * Add a new TCP option at the end of the layer (after the last TCP option)
 		 * @param[in] optionBuilder A TcpOptionBuilder object that contains the TCP option data to be added
@@ -468,9 +560,11 @@ namespace pcpp
 
 	private:
 
-		TLVRecordReader<TcpOption> m_OptionReader;
+		IndexedTLVRecordReader<TcpOption, uint8_t> m_OptionReader;
 		int m_NumOfTrailingBytes;
 
+		void setPort(uint16_t* portField, uint16_t port, bool updateChecksum);
+
 		void initLayer();
 		uint8_t* getOptionsBasePtr() const { return m_Data + sizeof(tcphdr); }
 		TcpOption addTcpOptionAt(const TcpOptionBuilder& optionBuilder, int offset);
@@ -3,9 +3,13 @@
 
 #include "Packet.h"
 #include "IpAddress.h"
+#include "FlowKey.h"
+#include "FlowTable.h"
+#include "TimerWheel.h"
 #include "PointerVector.h"
 #include <map>
 #include <list>
+#include <vector>
 #include <time.h>
 
 
@@ -19,7 +23,7 @@
  * - Support TCP retransmission
  * - Support out-of-order packets
  * - Support missing TCP data
- * - TCP connections can end "naturally" (by FIN/RST packets) or manually by the user
+ * - TCP connections can end "naturally" (by FIN/RST packets), manually by the user or after being idle for a configurable timeout
  * - Support callbacks for new TCP data, connection start and connection end
  *
  * __Logic Description:__
@@ -32,6 +36,8 @@
  * - If the packet data matches these criteria a callback is being invoked. This callback is supplied by the user in the creation of the pcpp#TcpReassembly instance. This callback contains
  *   the new data (of course), but also information about the connection (5-tuple, 4-byte hash key describing the connection, etc.) and also a pointer to a "user cookie", meaning a pointer to
  *   a structure provided by the user during the creation of the pcpp#TcpReassembly instance
+ * - Data that arrives in order isn't copied: the data in the callback points directly to the TCP payload inside the packet's pcpp#RawPacket buffer (after the part that was already seen,
+ *   in case of a partial retransmission). So a connection whose packets arrive in order is reassembled without any copy of its data
  * - If the data in this packet isn't new, it's being ignored
  * - If the data in this packet isn't expected (meaning this packet came out-of-order), then the data is being queued internally and will be sent to the user when its turn arrives
  *   (meaning, after the data before arrives)
@@ -39,7 +45,8 @@
  *   queued data will be sent to the user, but the string "[X bytes missing]" will be added to the message sent in the callback
  * - pcpp#TcpReassembly supports 2 more callbacks - one is invoked when a new TCP connection is first seen and the other when it's ended (either by a FIN/RST packet or manually by the user).
  *   Both of these callbacks contain data about the connection (5-tuple, 4-byte hash key describing the connection, etc.) and also a pointer to a "user cookie", meaning a pointer to a
- *   structure provided by the user during the creation of the pcpp#TcpReassembly instance. The end connection callback also provides the reason for closing it ("naturally" or manually)
+ *   structure provided by the user during the creation of the pcpp#TcpReassembly instance. The end connection callback also provides the reason for closing it ("naturally", manually or
+ *   by idle timeout)
  *
  * __Basic Usage and APIs:__
  * - pcpp#TcpReassembly c'tor - Create an instance, provide the callbacks and the user cookie to the instance
@@ -57,13 +64,43 @@
  * Cleaning of memory can be performed automatically (the default behavior) by pcpp#TcpReassembly#reassemblePacket() or manually by calling pcpp#TcpReassembly#purgeClosedConnections in the user code.
  * Automatic cleaning is performed once per second.
  *
+ * Time is measured by the timestamps of the packets fed to pcpp#TcpReassembly rather than by the system clock, so the delay and the idle timeout behave the same when a capture file
+ * is replayed and when packets are captured live. The current time is the latest packet timestamp seen (in seconds). It doesn't move while no packets arrive, so when the traffic stops (for example at the end of a
+ * capture file or during a quiet period of a live capture) the user can move it with pcpp#TcpReassembly#advanceTime() to expire idle connections and purge closed ones. Expiry is managed by a
+ * pcpp#TimerWheel, so its cost is O(1) per connection regardless of the number of open connections and it doesn't allocate memory.
+ *
  * The struct pcpp#TcpReassemblyConfiguration allows to setup the parameters of cleanup. Following parameters are supported:
  * - pcpp#TcpReassemblyConfiguration#doNotRemoveConnInfo - if this member is set to false the automatic cleanup mode is applied
  * - pcpp#TcpReassemblyConfiguration#closedConnectionDelay - the value of delay expressed in seconds. The minimum value is 1
  * - pcpp#TcpReassemblyConfiguration#maxNumToClean - to avoid performance overhead when the cleanup is being performed, this parameter is used. It defines the maximum number of items to be removed per one call of pcpp#TcpReassembly#purgeClosedConnections
+ * - pcpp#TcpReassemblyConfiguration#idleTimeout - the number of seconds after which a connection with no new packets is closed with a reason of pcpp#TcpReassembly#TcpReassemblyConnectionClosedByTimeout.
+ *   0 (the default) means connections never time out
+ *
+ * Out-of-order data is copied into blocks of a memory pool shared by all connections and kept per side in a list sorted by sequence, so buffering and delivering it takes O(1) per
+ * segment when segments arrive in increasing order (which is the common case). The pool keeps its memory for reuse until the pcpp#TcpReassembly instance is destructed. The amount
+ * of buffered out-of-order data can be bounded by the limits below. They count the pool memory the data takes rather than its length: each buffered segment takes a fragment
+ * descriptor and as many blocks of PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE bytes as its data needs, so a 1 byte segment takes the same memory as a segment which fills a block:
+ * - pcpp#TcpReassemblyConfiguration#maxOutOfOrderBytesPerConnection - when a connection exceeds it, the side the new data belongs to (or the other side if this side has no
+ *   buffered data) stops waiting for its missing data: its buffered data is sent to the user up to the next gap, preceded by the "[X bytes missing]" string
+ * - pcpp#TcpReassemblyConfiguration#maxOutOfOrderBytes - when all connections together exceed it, the side that buffered the oldest out-of-order data stops waiting for its
+ *   missing data in the same way, until the total is within the limit
+ * The default for both is 0 which means no limit
+ *
+ * TcpReassemblyConfiguration also sets which IP layer of tunneled packets (for example GTP-U, VXLAN or GRE) identifies the connection:
+ * - pcpp#TcpReassemblyConfiguration#useInnerTuple - if set to true the connection is identified by the IP layer that carries the TCP layer (the inner packet of the tunnel) instead of the outermost IP layer
+ *
+ * Connections are kept in pcpp#FlowTable hash tables keyed by the connection's pcpp#FlowKey, so classifying a packet to its connection takes constant time regardless of the number of
+ * open connections. The tables have room for 1024 connections by default and grow when needed, the initial room can be set by:
+ * - pcpp#TcpReassemblyConfiguration#connectionTableCapacity - the number of connections to preallocate room for. Setting it to the expected number of concurrent connections avoids
+ *   memory allocations and rehashing while the traffic is processed
  *
  */
 
+/**
+ * The size in bytes of the data blocks out-of-order TCP data is stored in. Segments larger than a block are stored in a chain of blocks
+ */
+#define PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE 2048
+
 /**
  * @namespace pcpp
  * @brief The main namespace for the PcapPlusPlus lib
@@ -85,8 +122,8 @@ struct ConnectionData
 	uint16_t srcPort;
 	/** Destination TCP/UDP port */
 	uint16_t dstPort;
-	/** A 4-byte hash key representing the connection */
-	uint32_t flowKey;
+	/** A key that identifies the connection, the same for both directions of the connection */
+	FlowKey flowKey;
 	/** Start TimeStamp of the connection */
 	timeval startTime;
 	/** End TimeStamp of the connection */
@@ -95,7 +132,7 @@ struct ConnectionData
 	/**
 	 * A c'tor for this struct that basically zeros all members
 	 */
-	ConnectionData() : srcIP(NULL), dstIP(NULL), srcPort(0), dstPort(0), flowKey(0), startTime(), endTime()  {}
+	ConnectionData() : srcIP(NULL), dstIP(NULL), srcPort(0), dstPort(0), flowKey(), startTime(), endTime()  {}
 
 	/**
 	 * A d'tor for this strcut. Notice it frees the memory of srcIP and dstIP members
@@ -148,7 +185,10 @@ class TcpReassembly;
 /**
  * @class TcpStreamData
  * When following a TCP connection each packet may contain a piece of the data transferred between the client and the server. This class represents these pieces: each instance of it
- * contains a piece of data, usually extracted from a single packet, as well as information about the connection
+ * contains a piece of data, usually extracted from a single packet, as well as information about the connection.
+ * The data isn't owned by this class and is valid only until the pcpp#TcpReassembly#OnTcpMessageReady callback returns. Data that arrived in order points directly into the buffer of
+ * the packet that carried it, while data that was queued out-of-order points into memory owned by pcpp#TcpReassembly which is reused afterwards, so a user that needs the data
+ * after the callback returns must copy it
  */
 class TcpStreamData
 {
@@ -166,7 +206,7 @@ public:
 
 	/**
 	 * A getter for the data buffer
-	 * @return A pointer to the buffer
+	 * @return A pointer to the buffer. It's valid only during the pcpp#TcpReassembly#OnTcpMessageReady callback the data was delivered in
 	 */
 	const uint8_t* getData() const { return m_Data; }
 
@@ -208,14 +248,49 @@ struct TcpReassemblyConfiguration
 	 */
 	uint32_t maxNumToClean;
 
+	/** The flag indicating whether connections of tunneled packets are identified by their inner tuple. If it's false (the default) the IP addresses of a connection are taken
+	 * from the outermost IP layer of the packet. If it's true they're taken from the IP layer that carries the TCP layer, so each inner TCP connection of a tunnel (for example
+	 * GTP-U, VXLAN or GRE) is reassembled separately and is reported with its inner addresses. The connection's ports are always taken from the innermost TCP layer
+	 */
+	bool useInnerTuple;
+
+	/** The number of connections TcpReassembly preallocates room for in its connection tables. Connections beyond this number are still handled, but adding them
+	 * may allocate memory. If the value is set to 0 then TcpReassembly should use the default value (#PCPP_FLOW_TABLE_DEFAULT_CAPACITY)
+	 */
+	size_t connectionTableCapacity;
+
+	/** The number of seconds after which a connection that had no new packets is closed. The connection ends with a reason of TcpReassembly#TcpReassemblyConnectionClosedByTimeout and its
+	 * information is removed after closedConnectionDelay like any closed connection. Packets with no payload (other than SYN, FIN or RST packets) don't count as activity. If the value is
+	 * set to 0 connections never time out
+	 */
+	uint32_t idleTimeout;
+
+	/** The maximum number of bytes of memory the out-of-order data of a connection (both of its sides) may take. The memory of a segment is the size of the pool blocks its data is
+	 * stored in plus the size of its descriptor, so it's at least PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE bytes regardless of the segment's length. When it's exceeded, data is
+	 * sent to the user as if the data before it is missing. If the value is set to 0 there's no limit
+	 */
+	size_t maxOutOfOrderBytesPerConnection;
+
+	/** The maximum number of bytes of memory the out-of-order data of all connections together may take, counted the same as maxOutOfOrderBytesPerConnection. When it's exceeded, data of the connection that buffered the oldest out-of-order
+	 * data is sent to the user as if the data before it is missing. If the value is set to 0 there's no limit
+	 */
+	size_t maxOutOfOrderBytes;
+
 	/**
 	 * A c'tor for this struct
 	 * @param[in] removeConnInfo The flag indicating whether to remove the connection data after a connection is closed. The default is true
 	 * @param[in] closedConnectionDelay How long the closed connections will not be cleaned up. The value is expressed in seconds. If it's set to 0 the default value will be used. The default is 5.
 	 * @param[in] maxNumToClean The maximum number of items to be cleaned up per one call of purgeClosedConnections. If it's set to 0 the default value will be used. The default is 30.
+	 * @param[in] useInnerTuple The flag indicating whether connections of tunneled packets are identified by their inner tuple. The default is false
+	 * @param[in] connectionTableCapacity The number of connections to preallocate room for. If it's set to 0 the default value will be used. The default is 0
+	 * @param[in] idleTimeout The number of seconds after which a connection with no new packets is closed. If it's set to 0 connections never time out. The default is 0
+	 * @param[in] maxOutOfOrderBytesPerConnection The maximum number of bytes of memory the out-of-order data of a connection may take. If it's set to 0 there's no limit. The default is 0
+	 * @param[in] maxOutOfOrderBytes The maximum number of bytes of memory the out-of-order data of all connections together may take. If it's set to 0 there's no limit. The default is 0
 	 */
-	TcpReassemblyConfiguration(bool removeConnInfo = true, uint32_t closedConnectionDelay = 5, uint32_t maxNumToClean = 30) :
-		removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean)
+	TcpReassemblyConfiguration(bool removeConnInfo = true, uint32_t closedConnectionDelay = 5, uint32_t maxNumToClean = 30, bool useInnerTuple = false, size_t connectionTableCapacity = 0, uint32_t idleTimeout = 0,
+			size_t maxOutOfOrderBytesPerConnection = 0, size_t maxOutOfOrderBytes = 0) :
+		removeConnInfo(removeConnInfo), closedConnectionDelay(closedConnectionDelay), maxNumToClean(maxNumToClean), useInnerTuple(useInnerTuple), connectionTableCapacity(connectionTableCapacity),
+		idleTimeout(idleTimeout), maxOutOfOrderBytesPerConnection(maxOutOfOrderBytesPerConnection), maxOutOfOrderBytes(maxOutOfOrderBytes)
 	{
 	}
 };
@@ -237,7 +312,9 @@ public:
 		/** Connection ended because of FIN or RST packet */
 		TcpReassemblyConnectionClosedByFIN_RST,
 		/** Connection ended manually by the user */
-		TcpReassemblyConnectionClosedManually
+		TcpReassemblyConnectionClosedManually,
+		/** Connection ended because no packets arrived on it for the configured idle timeout */
+		TcpReassemblyConnectionClosedByTimeout
 	};
 
 	/**
@@ -303,15 +380,16 @@ public:
 	};
 
 	/**
-	 * The type for storing the connection information
+	 * The type for storing the connection information. It's a pcpp#FlowTable which has the same interface as std::map<FlowKey, ConnectionData>,
+	 * except that iteration isn't ordered by the flow key
 	 */
-	typedef std::map<uint32_t, ConnectionData> ConnectionInfoList;
+	typedef FlowTable<ConnectionData> ConnectionInfoList;
 
 	/**
 	 * @typedef OnTcpMessageReady
 	 * A callback invoked when new data arrives on a connection
 	 * @param[in] side The side this data belongs to (MachineA->MachineB or vice versa). The value is 0 or 1 where 0 is the first side seen in the connection and 1 is the second side seen
-	 * @param[in] tcpData The TCP data itself + connection information
+	 * @param[in] tcpData The TCP data itself + connection information. The data is valid only until the callback returns (see pcpp#TcpStreamData)
 	 * @param[in] userCookie A pointer to the cookie provided by the user in TcpReassembly c'tor (or NULL if no cookie provided)
 	 */
 	typedef void (*OnTcpMessageReady)(int side, const TcpStreamData& tcpData, void* userCookie);
@@ -368,9 +446,9 @@ public:
 	/**
 	 * Close a connection manually. If the connection doesn't exist or already closed an error log is printed. This method will cause the TcpReassembly#OnTcpConnectionEnd to be invoked with
 	 * a reason of TcpReassembly#TcpReassemblyConnectionClosedManually
-	 * @param[in] flowKey A 4-byte hash key representing the connection. Can be taken from a ConnectionData instance
+	 * @param[in] flowKey The key of the connection. Can be taken from a ConnectionData instance
 	 */
-	void closeConnection(uint32_t flowKey);
+	void closeConnection(const FlowKey& flowKey);
 
 	/**
 	 * Close all open connections manually. This method will cause the TcpReassembly#OnTcpConnectionEnd to be invoked for each connection with a reason of
@@ -392,21 +470,92 @@ public:
 	int isConnectionOpen(const ConnectionData& connection) const;
 
 	/**
-	 * Clean up the closed connections from the memory
+	 * Clean up the closed connections from the memory. Only connections that were closed at least closedConnectionDelay seconds before the current time (the latest packet timestamp or
+	 * the time given to advanceTime()) are cleaned up
 	 * @param[in] maxNumToClean The maximum number of items to be cleaned up per one call. This parameter, when its value is not zero, overrides the value that was set by the constructor.
 	 * @return The number of cleared items
 	 */
 	uint32_t purgeClosedConnections(uint32_t maxNumToClean = 0);
 
+	/**
+	 * Move the current time forward without feeding a packet. Connections idle for longer than idleTimeout are closed with a reason of
+	 * TcpReassembly#TcpReassemblyConnectionClosedByTimeout, and if automatic cleanup is enabled the closed connections whose delay has passed are
+	 * cleaned up, the same as when a packet with this timestamp arrives. Useful for running expiry from a timer when no packets arrive, or after the last
+	 * packet of a capture file. A time that isn't later than the current time (in seconds) is ignored
+	 * @param[in] currentTime The new current time, for example the system time when packets are captured live or the timestamp of the last packet plus
+	 * the time to wait
+	 */
+	void advanceTime(const timespec& currentTime);
+
+	/**
+	 * @return The number of bytes of memory taken by the out-of-order data currently buffered by all connections, which is the amount
+	 * TcpReassemblyConfiguration#maxOutOfOrderBytes is compared to
+	 */
+	size_t getOutOfOrderBytes() const { return m_OutOfOrderBytes; }
+
 private:
+	struct TcpReassemblyData;
+
+	struct TcpFragmentBlock
+	{
+		TcpFragmentBlock* next;
+		uint8_t data[PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE];
+	};
+
 	struct TcpFragment
 	{
 		uint32_t sequence;
 		size_t dataLength;
-		uint8_t* data;
+		// the data is stored in a chain of pool blocks
+		TcpFragmentBlock* blocks;
+		// the links of the side's fragment list, which is sorted by sequence
+		TcpFragment* next;
+		TcpFragment* prev;
+		// the links of the list of the fragments of all connections, which is sorted by the time they were buffered
+		TcpFragment* newer;
+		TcpFragment* older;
+		TcpReassemblyData* connection;
+		int sideIndex;
+	};
+
+	struct TcpFragmentList
+	{
+		TcpFragment* head;
+		TcpFragment* tail;
+		size_t count;
 
-		TcpFragment() { sequence = 0; dataLength = 0; data = NULL; }
-		~TcpFragment() { if (data != NULL) delete [] data; }
+		TcpFragmentList() { head = NULL; tail = NULL; count = 0; }
+
+		size_t size() const { return count; }
+	};
+
+	// a pool of fragments and data blocks which are allocated in slabs and reused, shared by all connections
+	class TcpFragmentPool
+	{
+	public:
+		TcpFragmentPool() : m_FreeFragments(NULL), m_FreeBlocks(NULL) {}
+		~TcpFragmentPool();
+
+		TcpFragment* allocateFragment(const uint8_t* data, size_t dataLength);
+		void freeFragment(TcpFragment* fragment);
+
+		// returns the number of bytes of pool memory a fragment with dataLength bytes of data takes: its blocks and its descriptor
+		static size_t getFragmentMemorySize(size_t dataLength);
+
+		// returns a pointer to the fragment's data, which is copied to buffer if it spans more than one block
+		const uint8_t* getFragmentData(const TcpFragment* fragment, std::vector<uint8_t>& buffer) const;
+
+		// copies the fragment's data to dest which must have room for the fragment's dataLength bytes
+		void copyFragmentData(const TcpFragment* fragment, uint8_t* dest) const;
+
+	private:
+		std::vector<TcpFragment*> m_FragmentSlabs;
+		std::vector<TcpFragmentBlock*> m_BlockSlabs;
+		TcpFragment* m_FreeFragments;
+		TcpFragmentBlock* m_FreeBlocks;
+
+		TcpFragmentPool(const TcpFragmentPool& other);
+		TcpFragmentPool& operator=(const TcpFragmentPool& other);
 	};
 
 	struct TcpOneSideData
@@ -414,7 +563,7 @@ private:
 		IPAddress* srcIP;
 		uint16_t srcPort;
 		uint32_t sequence;
-		PointerVector<TcpFragment> tcpFragmentList;
+		TcpFragmentList tcpFragmentList;
 		bool gotFinOrRst;
 
 		void setSrcIP(IPAddress* sourrcIP);
@@ -430,12 +579,29 @@ private:
 		int prevSide;
 		TcpOneSideData twoSides[2];
 		ConnectionData connData;
+		uint64_t lastActivity;
+		// the number of bytes of pool memory taken by the out-of-order data of both sides
+		size_t outOfOrderBytes;
+		// out-of-order data that isn't stored in a single pool block, or follows missing data, is coalesced into this buffer before it's sent to the user
+		std::vector<uint8_t> dataBuffer;
+
+		TcpReassemblyData() { numOfSides = 0; prevSide = -1; lastActivity = 0; outOfOrderBytes = 0; }
+	};
+
+	// the timer data is the handle of the connection in m_ConnectionList
+	typedef TimerWheel<uint32_t> ConnectionTimers;
+
+	struct ConnectionEntry
+	{
+		// NULL if the connection is closed
+		TcpReassemblyData* data;
+		// while the connection is open it's scheduled in m_IdleTimers (if idle timeout is enabled), when it's closed it's scheduled in m_ClosedTimers
+		ConnectionTimers::Timer timer;
 
-		TcpReassemblyData() { numOfSides = 0; prevSide = -1; }
+		ConnectionEntry() : data(NULL) {}
 	};
-	
-	typedef std::map<uint32_t, TcpReassemblyData *> ConnectionList;
-	typedef std::map<time_t, std::list<uint32_t> > CleanupList;
+
+	typedef FlowTable<ConnectionEntry> ConnectionList;
 
 	OnTcpMessageReady m_OnMessageReadyCallback;
 	OnTcpConnectionStart m_OnConnStart;
@@ -443,21 +609,40 @@ private:
 	void* m_UserCookie;
 	ConnectionList m_ConnectionList;
 	ConnectionInfoList m_ConnectionInfo;
-	CleanupList m_CleanupList;
+	ConnectionTimers m_IdleTimers;
+	ConnectionTimers m_ClosedTimers;
 	bool m_RemoveConnInfo;
 	uint32_t m_ClosedConnectionDelay;
 	uint32_t m_MaxNumToClean;
-	time_t m_PurgeTimepoint;
+	bool m_UseInnerTuple;
+	uint32_t m_IdleTimeout;
+	uint64_t m_CurrentTime;
+	TcpFragmentPool m_FragmentPool;
+	TcpFragment* m_OldestFragment;
+	TcpFragment* m_NewestFragment;
+	size_t m_OutOfOrderBytes;
+	size_t m_MaxOutOfOrderBytesPerConnection;
+	size_t m_MaxOutOfOrderBytes;
 
 	void checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyData, int sideIndex, bool cleanWholeFragList);
 
+	void deliverInOrderFragments(TcpReassemblyData* tcpReassemblyData, int sideIndex);
+
+	void deliverFirstFragmentAfterMissingData(TcpReassemblyData* tcpReassemblyData, int sideIndex);
+
+	void insertFragment(TcpReassemblyData* tcpReassemblyData, int sideIndex, uint32_t sequence, const uint8_t* data, size_t dataLength);
+
+	void removeFragment(TcpFragment* fragment);
+
+	void enforceOutOfOrderLimits(TcpReassemblyData* tcpReassemblyData, int sideIndex);
+
 	std::string prepareMissingDataMessage(uint32_t missingDataLen);
 
-	void handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int sideIndex, uint32_t flowKey);
+	void handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int sideIndex, const FlowKey& flowKey);
 
-	void closeConnectionInternal(uint32_t flowKey, ConnectionEndReason reason);
+	void closeConnectionInternal(FlowKey flowKey, ConnectionEndReason reason);
 
-	void insertIntoCleanupList(uint32_t flowKey);
+	void insertIntoCleanupList(ConnectionEntry& connection);
 };
 
 }
@@ -2,6 +2,7 @@
 #define PACKETPP_TEXT_BASED_PROTOCOL_LAYER
 
 #include <map>
+#include <string>
 #include "Layer.h"
 
 /// @file
@@ -12,9 +13,76 @@ namespace pcpp
 /** End of header */
 #define PCPP_END_OF_TEXT_BASED_PROTOCOL_HEADER ""
 
+/** The number of buckets in the field name index of TextBasedProtocolMessage. Must be a power of 2 */
+#define PCPP_TEXT_BASED_PROTOCOL_FIELD_INDEX_SIZE 32
+
 class TextBasedProtocolMessage;
 
 
+// -------- Class HeaderFieldName -----------------
+
+
+/**
+ * @class HeaderFieldName
+ * A header field name used for looking up fields in TextBasedProtocolMessage#getFieldByName(). The object doesn't copy the name, it
+ * only keeps a pointer to it along with its length and its case-insensitive hash, which is calculated once when the object is created.
+ * This allows creating interned constants for frequently looked-up fields (see for example pcpp#HttpFieldNames and pcpp#SipFieldNames)
+ * so that looking them up doesn't require copying, lowercasing or hashing the name again. Notice the name data must outlive the object
+ */
+class HeaderFieldName
+{
+public:
+	/**
+	 * A c'tor that creates the object from a null-terminated string
+	 * @param[in] name The field name. Only the pointer is kept
+	 */
+	explicit HeaderFieldName(const char* name);
+
+	/**
+	 * A c'tor that creates the object from a name that isn't necessarily null-terminated
+	 * @param[in] name A pointer to the field name. Only the pointer is kept
+	 * @param[in] nameLen The name length in bytes
+	 */
+	HeaderFieldName(const char* name, size_t nameLen);
+
+	/**
+	 * @return A pointer to the name (not necessarily null-terminated)
+	 */
+	const char* getName() const { return m_Name; }
+
+	/**
+	 * @return The name length in bytes
+	 */
+	size_t getNameLen() const { return m_NameLen; }
+
+	/**
+	 * @return The case-insensitive hash of the name
+	 */
+	uint32_t getHash() const { return m_Hash; }
+
+	/**
+	 * Calculate a case-insensitive hash of a field name, meaning names that differ only in ASCII letter case have the same hash
+	 * @param[in] name A pointer to the name
+	 * @param[in] nameLen The name length in bytes
+	 * @return The hash value
+	 */
+	static uint32_t calculateHash(const char* name, size_t nameLen);
+
+	/**
+	 * Compare this name to another name ignoring ASCII letter case
+	 * @param[in] name A pointer to the other name
+	 * @param[in] nameLen The length of the other name in bytes
+	 * @return True if the names are equal, false otherwise
+	 */
+	bool equals(const char* name, size_t nameLen) const;
+
+private:
+	const char* m_Name;
+	size_t m_NameLen;
+	uint32_t m_Hash;
+};
+
+
 // -------- Class HeaderField -----------------
 
 
@@ -65,6 +133,30 @@ public:
 	 */
 	std::string getFieldValue() const;
 
+	/**
+	 * Get the field name without copying it. Notice the returned pointer points to the message data and is invalidated when the
+	 * message is modified
+	 * @return A pointer to the field name, which isn't null-terminated (see getFieldNameLen()), or NULL for the end-of-header field
+	 */
+	const char* getFieldNamePtr() const;
+
+	/**
+	 * @return The field name length in bytes (0 for the end-of-header field)
+	 */
+	size_t getFieldNameLen() const { return (m_FieldNameSize == (size_t)-1 ? 0 : m_FieldNameSize); }
+
+	/**
+	 * Get the field value without copying it. Notice the returned pointer points to the message data and is invalidated when the
+	 * message is modified
+	 * @return A pointer to the field value, which isn't null-terminated (see getFieldValueLen()), or NULL if the field has no value
+	 */
+	const char* getFieldValuePtr() const;
+
+	/**
+	 * @return The field value length in bytes (0 if the field has no value)
+	 */
+	size_t getFieldValueLen() const { return (m_ValueOffsetInMessage == -1 ? 0 : m_FieldValueSize); }
+
 	/**
 	 * A setter for field value
 	 * @param[in] newValue The new value to set to the field. Old value will be deleted
@@ -95,6 +187,9 @@ private:
 	size_t m_FieldValueSize;
 	size_t m_FieldSize;
 	HeaderField* m_NextField;
+	// the next field in the same bucket of the message's field name index, and the case-insensitive hash of the field name
+	HeaderField* m_NextFieldInBucket;
+	uint32_t m_FieldNameHash;
 	bool m_IsEndOfHeaderField;
 	char m_NameValueSeperator;
 	bool m_SpacesAllowedBetweenNameAndValue;
@@ -124,7 +219,18 @@ public:
 	 * The default value is 0 (get the first appearance of the field name as appears on the packet)
 	 * @return A pointer to an HeaderField instance, or NULL if field doesn't exist
 	 */
-	HeaderField* getFieldByName(std::string fieldName, int index = 0) const;
+	HeaderField* getFieldByName(const std::string& fieldName, int index = 0) const;
+
+	/**
+	 * Get a pointer to a header field by name without copying the name. The fields are indexed by the case-insensitive hash of their
+	 * names when the message is parsed, so the lookup doesn't allocate memory or go over all fields. Using the interned field names
+	 * (for example pcpp#HttpFieldNames#ContentLength) also saves hashing the name on every lookup
+	 * @param[in] fieldName The field name. The search is case insensitive
+	 * @param[in] index Optional parameter. If the field name appears more than once, this parameter will indicate which field to get.
+	 * The default value is 0 (get the first appearance of the field name as appears on the packet)
+	 * @return A pointer to an HeaderField instance, or NULL if field doesn't exist
+	 */
+	HeaderField* getFieldByName(const HeaderFieldName& fieldName, int index = 0) const;
 
 	/**
 	 * @return A pointer to the first header field exists in this message, or NULL if no such field exists
@@ -206,7 +312,7 @@ public:
 	 * The default value is 0 (remove the first appearance of the field name as appears on the packet)
 	 * @return True if the field was removed successfully, or false otherwise (for example: if fieldName doesn't exist in the message, or if the removal failed)
 	 */
-	bool removeField(std::string fieldName, int index = 0);
+	bool removeField(const std::string& fieldName, int index = 0);
 
 	/**
 	 * Indicate whether the header is complete (ending with end-of-header "\r\n\r\n" or "\n\n") or spread over more packets
@@ -233,7 +339,7 @@ public:
 
 protected:
 	TextBasedProtocolMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet);
-	TextBasedProtocolMessage() : m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0) {}
+	TextBasedProtocolMessage();
 
 	// copy c'tor
 	TextBasedProtocolMessage(const TextBasedProtocolMessage& other);
@@ -251,7 +357,13 @@ protected:
 	HeaderField* m_FieldList;
 	HeaderField* m_LastField;
 	int m_FieldsOffset;
-	std::multimap<std::string, HeaderField*> m_FieldNameToFieldMap;
+	// a hash index of the fields by the case-insensitive hash of their names. The fields in each bucket are linked in the order
+	// they were parsed or added to the message
+	HeaderField* m_FieldNameIndex[PCPP_TEXT_BASED_PROTOCOL_FIELD_INDEX_SIZE];
+
+private:
+	void addFieldToIndex(HeaderField* field);
+	void removeFieldFromIndex(HeaderField* field);
 };
 
 
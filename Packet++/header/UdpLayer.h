@@ -59,6 +59,33 @@ namespace pcpp
 		 */
 		udphdr* getUdpHeader() const { return (udphdr*)m_Data; }
 
+		/**
+		 * @return The source port in host byte order
+		 */
+		uint16_t getSrcPort() const;
+
+		/**
+		 * @return The destination port in host byte order
+		 */
+		uint16_t getDstPort() const;
+
+		/**
+		 * Set the source port
+		 * @param[in] port The port to set in host byte order
+		 * @param[in] updateChecksum If set to true @ref udphdr#headerChecksum is updated incrementally (RFC 1624) instead of having
+		 * to call computeCalculateFields(), so the cost doesn't depend on the datagram size. The existing checksum is assumed to be
+		 * correct. A zero checksum (meaning no checksum) is left as is. The default value is false
+		 */
+		void setSrcPort(uint16_t port, bool updateChecksum = false);
+
+		/**
+		 * Set the destination port
+		 * @param[in] port The port to set in host byte order
+		 * @param[in] updateChecksum If set to true @ref udphdr#headerChecksum is updated incrementally. See setSrcPort(). The
+		 * default value is false
+		 */
+		void setDstPort(uint16_t port, bool updateChecksum = false);
+
 		/**
 		 * Calculate the checksum from header and data and possibly write the result to @ref udphdr#headerChecksum
 		 * @param[in] writeResultToPacket If set to true then checksum result will be written to @ref udphdr#headerChecksum
@@ -87,6 +114,9 @@ namespace pcpp
 		std::string toString() const;
 
 		OsiModelLayer getOsiModelLayer() const { return OsiModelTransportLayer; }
+
+	private:
+		void setPort(uint16_t* portField, uint16_t port, bool updateChecksum);
 	};
 
 } // namespace pcpp
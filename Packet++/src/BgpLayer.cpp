@@ -42,15 +42,15 @@ BgpLayer* BgpLayer::parseBgpLayer(uint8_t* data, size_t dataLen, Layer* prevLaye
   switch (bgpHeader->messageType)
   {
   case 1: // OPEN
-    return new BgpOpenMessageLayer(data, dataLen, prevLayer, packet);
+    return new(packet) BgpOpenMessageLayer(data, dataLen, prevLayer, packet);
   case 2: // UPDATE
-    return new BgpUpdateMessageLayer(data, dataLen, prevLayer, packet);
+    return new(packet) BgpUpdateMessageLayer(data, dataLen, prevLayer, packet);
   case 3: // NOTIFICATION
-    return new BgpNotificationMessageLayer(data, dataLen, prevLayer, packet);
+    return new(packet) BgpNotificationMessageLayer(data, dataLen, prevLayer, packet);
   case 4: // KEEPALIVE
-    return new BgpKeepaliveMessageLayer(data, dataLen, prevLayer, packet);
+    return new(packet) BgpKeepaliveMessageLayer(data, dataLen, prevLayer, packet);
   case 5: // ROUTE-REFRESH
-    return new BgpRouteRefreshMessageLayer(data, dataLen, prevLayer, packet);
+    return new(packet) BgpRouteRefreshMessageLayer(data, dataLen, prevLayer, packet);
   default:
     return NULL;
   }
@@ -102,6 +102,7 @@ void BgpLayer::computeCalculateFields()
 
 void BgpLayer::setBgpFields(size_t messageLen)
 {
+  makePacketWritable();
   bgp_common_header* bgpHdr = getBasicHeader();
   memset(bgpHdr->marker, 0xff, 16*sizeof(uint8_t));
   bgpHdr->messageType = (uint8_t)getBgpMessageType();
@@ -193,6 +194,7 @@ size_t BgpOpenMessageLayer::optionalParamsToByteArray(const std::vector<optional
 
 void BgpOpenMessageLayer::setBgpId(const IPv4Address& newBgpId)
 {
+  makePacketWritable();
   if (!newBgpId.isValid())
   {
     return;
@@ -261,6 +263,7 @@ size_t BgpOpenMessageLayer::getOptionalParametersLength()
 
 bool BgpOpenMessageLayer::setOptionalParameters(const std::vector<optional_parameter>& optionalParameters)
 {
+  makePacketWritable();
   uint8_t newOptionalParamsData[1500];
   size_t newOptionalParamsDataLen = optionalParamsToByteArray(optionalParameters, newOptionalParamsData, 1500);
   size_t curOptionalParamsDataLen = getOptionalParametersLength();
@@ -553,6 +556,7 @@ size_t BgpUpdateMessageLayer::getPathAttributesLength() const
 
 bool BgpUpdateMessageLayer::setWithdrawnRoutes(const std::vector<prefix_and_ip>& withdrawnRoutes)
 {
+  makePacketWritable();
   uint8_t newWithdrawnRoutesData[1500];
   size_t newWithdrawnRoutesDataLen = prefixAndIPDataToByteArray(withdrawnRoutes, newWithdrawnRoutesData, 1500);
   size_t curWithdrawnRoutesDataLen = getWithdrawnRoutesLength();
@@ -625,6 +629,7 @@ void BgpUpdateMessageLayer::getPathAttributes(std::vector<path_attribute>& pathA
 
 bool BgpUpdateMessageLayer::setPathAttributes(const std::vector<path_attribute>& pathAttributes)
 {
+  makePacketWritable();
   uint8_t newPathAttributesData[1500];
   size_t newPathAttributesDataLen = pathAttributesToByteArray(pathAttributes, newPathAttributesData, 1500);
   size_t curPathAttributesDataLen = getPathAttributesLength();
@@ -701,6 +706,7 @@ void BgpUpdateMessageLayer::getNetworkLayerReachabilityInfo(std::vector<prefix_a
 
 bool BgpUpdateMessageLayer::setNetworkLayerReachabilityInfo(const std::vector<prefix_and_ip>& nlri)
 {
+  makePacketWritable();
   uint8_t newNlriData[1500];
   size_t newNlriDataLen = prefixAndIPDataToByteArray(nlri, newNlriData, 1500);
   size_t curNlriDataLen = getNetworkLayerReachabilityInfoLength();
@@ -817,6 +823,7 @@ std::string BgpNotificationMessageLayer::getNotificationDataAsHexString() const
 
 bool BgpNotificationMessageLayer::setNotificationData(const uint8_t* newNotificationData, size_t newNotificationDataLen)
 {
+  makePacketWritable();
   if (newNotificationData == NULL)
   {
     newNotificationDataLen = 0;
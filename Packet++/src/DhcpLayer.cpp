@@ -78,6 +78,7 @@ IPv4Address DhcpLayer::getClientIpAddress() const
 
 void DhcpLayer::setClientIpAddress(const IPv4Address& addr)
 {
+	makePacketWritable();
 	getDhcpHeader()->clientIpAddress = addr.toInt();
 }
 
@@ -88,6 +89,7 @@ IPv4Address DhcpLayer::getServerIpAddress() const
 
 void DhcpLayer::setServerIpAddress(const IPv4Address& addr)
 {
+	makePacketWritable();
 	getDhcpHeader()->serverIpAddress = addr.toInt();
 }
 
@@ -98,6 +100,7 @@ IPv4Address DhcpLayer::getYourIpAddress() const
 
 void DhcpLayer::setYourIpAddress(const IPv4Address& addr)
 {
+	makePacketWritable();
 	getDhcpHeader()->yourIpAddress = addr.toInt();
 }
 
@@ -108,6 +111,7 @@ IPv4Address DhcpLayer::getGatewayIpAddress() const
 
 void DhcpLayer::setGatewayIpAddress(const IPv4Address& addr)
 {
+	makePacketWritable();
 	getDhcpHeader()->gatewayIpAddress = addr.toInt();
 }
 
@@ -124,6 +128,7 @@ MacAddress DhcpLayer::getClientHardwareAddress() const
 
 void DhcpLayer::setClientHardwareAddress(const MacAddress& addr)
 {
+	makePacketWritable();
 	dhcp_header* hdr = getDhcpHeader();
 	hdr->hardwareType = 1; // Ethernet
 	hdr->hardwareAddressLength = 6; // MAC address length
@@ -224,6 +229,7 @@ DhcpMessageType DhcpLayer::getMesageType() const
 
 bool DhcpLayer::setMesageType(DhcpMessageType msgType)
 {
+	makePacketWritable();
 	if (msgType == DHCP_UNKNOWN_MSG_TYPE)
 		return false;
 
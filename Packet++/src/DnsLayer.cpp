@@ -16,14 +16,8 @@ DnsLayer::DnsLayer(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* pack
 	: Layer(data, dataLen, prevLayer, packet)
 {
 	m_Protocol = DNS;
-	m_ResourceList = NULL;
-
-	m_FirstQuery = NULL;
-	m_FirstAnswer = NULL;
-	m_FirstAuthority = NULL;
-	m_FirstAdditional = NULL;
-
-	parseResources();
+	m_ExtraResourceOffsets = NULL;
+	initResources();
 }
 
 DnsLayer::DnsLayer()
@@ -33,27 +27,15 @@ DnsLayer::DnsLayer()
 	m_Data = new uint8_t[headerLen];
 	memset(m_Data, 0, headerLen);
 	m_Protocol = DNS;
-
-	m_ResourceList = NULL;
-
-	m_FirstQuery = NULL;
-	m_FirstAnswer = NULL;
-	m_FirstAuthority = NULL;
-	m_FirstAdditional = NULL;
+	m_ExtraResourceOffsets = NULL;
+	initResources();
 }
 
 DnsLayer::DnsLayer(const DnsLayer& other) : Layer(other)
 {
 	m_Protocol = DNS;
-
-	m_ResourceList = NULL;
-
-	m_FirstQuery = NULL;
-	m_FirstAnswer = NULL;
-	m_FirstAuthority = NULL;
-	m_FirstAdditional = NULL;
-
-	parseResources();
+	m_ExtraResourceOffsets = NULL;
+	initResources();
 }
 
 DnsLayer& DnsLayer::operator=(const DnsLayer& other)
@@ -68,14 +50,7 @@ DnsLayer& DnsLayer::operator=(const DnsLayer& other)
 		curResource = temp;
 	}
 
-	m_ResourceList = NULL;
-
-	m_FirstQuery = NULL;
-	m_FirstAnswer = NULL;
-	m_FirstAuthority = NULL;
-	m_FirstAdditional = NULL;
-
-	parseResources();
+	initResources();
 
 	return (*this);
 }
@@ -89,6 +64,34 @@ DnsLayer::~DnsLayer()
 		delete curResource;
 		curResource = nextResource;
 	}
+
+	delete [] m_ExtraResourceOffsets;
+}
+
+void DnsLayer::initResources()
+{
+	m_ResourceList = NULL;
+
+	m_FirstQuery = NULL;
+	m_FirstAnswer = NULL;
+	m_FirstAuthority = NULL;
+	m_FirstAdditional = NULL;
+
+	// the resource objects are created only when they're first needed, see parseResourcesOnDemand()
+	m_ResourcesParsed = false;
+
+	m_NumOfIndexedResources = 0;
+	m_IsResourceIndexValid = false;
+}
+
+void DnsLayer::parseResourcesOnDemand() const
+{
+	if (m_ResourcesParsed)
+		return;
+
+	DnsLayer* nonConstThis = const_cast<DnsLayer*>(this);
+	nonConstThis->m_ResourcesParsed = true;
+	nonConstThis->parseResources();
 }
 
 bool DnsLayer::extendLayer(int offsetInLayer, size_t numOfBytesToExtend, IDnsResource* resource)
@@ -96,6 +99,8 @@ bool DnsLayer::extendLayer(int offsetInLayer, size_t numOfBytesToExtend, IDnsRes
 	if (!Layer::extendLayer(offsetInLayer, numOfBytesToExtend))
 		return false;
 
+	m_IsResourceIndexValid = false;
+
 	IDnsResource* curResource = resource->getNextResource();
 	while (curResource != NULL)
 	{
@@ -111,6 +116,8 @@ bool DnsLayer::shortenLayer(int offsetInLayer, size_t numOfBytesToShorten, IDnsR
 	if (!Layer::shortenLayer(offsetInLayer, numOfBytesToShorten))
 		return false;
 
+	m_IsResourceIndexValid = false;
+
 	IDnsResource* curResource = resource->getNextResource();
 	while (curResource != NULL)
 	{
@@ -133,10 +140,10 @@ void DnsLayer::parseResources()
 
 	uint32_t numOfOtherResources = numOfQuestions + numOfAnswers + numOfAuthority + numOfAdditional;
 
-	if (numOfOtherResources > 300)
+	if (numOfOtherResources > PCPP_DNS_MAX_RESOURCES)
 	{
-		LOG_ERROR("DNS layer contains more than 300 resources, probably a bad packet. "
-				"Skipping parsing DNS resources");
+		LOG_ERROR("DNS layer contains more than %d resources, probably a bad packet. "
+				"Skipping parsing DNS resources", PCPP_DNS_MAX_RESOURCES);
 		return;
 	}
 
@@ -235,6 +242,7 @@ IDnsResource* DnsLayer::getResourceByName(IDnsResource* startFrom, size_t resour
 
 DnsQuery* DnsLayer::getQuery(const std::string& name, bool exactMatch) const
 {
+	parseResourcesOnDemand();
 	uint16_t numOfQueries = be16toh(getDnsHeader()->numberOfQuestions);
 	IDnsResource* res = getResourceByName(m_FirstQuery, numOfQueries, name, exactMatch);
 	if (res != NULL)
@@ -245,6 +253,7 @@ DnsQuery* DnsLayer::getQuery(const std::string& name, bool exactMatch) const
 
 DnsQuery* DnsLayer::getFirstQuery() const
 {
+	parseResourcesOnDemand();
 	return m_FirstQuery;
 }
 
@@ -268,6 +277,7 @@ size_t DnsLayer::getQueryCount() const
 DnsResource* DnsLayer::getAnswer(const std::string& name, bool exactMatch) const
 {
 	uint16_t numOfAnswers = be16toh(getDnsHeader()->numberOfAnswers);
+	parseResourcesOnDemand();
 	IDnsResource* res = getResourceByName(m_FirstAnswer, numOfAnswers, name, exactMatch);
 	if (res != NULL)
 		return dynamic_cast<DnsResource*>(res);
@@ -276,6 +286,7 @@ DnsResource* DnsLayer::getAnswer(const std::string& name, bool exactMatch) const
 
 DnsResource* DnsLayer::getFirstAnswer() const
 {
+	parseResourcesOnDemand();
 	return m_FirstAnswer;
 }
 
@@ -298,6 +309,7 @@ size_t DnsLayer::getAnswerCount() const
 DnsResource* DnsLayer::getAuthority(const std::string& name, bool exactMatch) const
 {
 	uint16_t numOfAuthorities = be16toh(getDnsHeader()->numberOfAuthority);
+	parseResourcesOnDemand();
 	IDnsResource* res = getResourceByName(m_FirstAuthority, numOfAuthorities, name, exactMatch);
 	if (res != NULL)
 		return dynamic_cast<DnsResource*>(res);
@@ -306,6 +318,7 @@ DnsResource* DnsLayer::getAuthority(const std::string& name, bool exactMatch) co
 
 DnsResource* DnsLayer::getFirstAuthority() const
 {
+	parseResourcesOnDemand();
 	return m_FirstAuthority;
 }
 
@@ -328,6 +341,7 @@ size_t DnsLayer::getAuthorityCount() const
 DnsResource* DnsLayer::getAdditionalRecord(const std::string& name, bool exactMatch) const
 {
 	uint16_t numOfAdditionalRecords = be16toh(getDnsHeader()->numberOfAdditional);
+	parseResourcesOnDemand();
 	IDnsResource* res = getResourceByName(m_FirstAdditional, numOfAdditionalRecords, name, exactMatch);
 	if (res != NULL)
 		return dynamic_cast<DnsResource*>(res);
@@ -336,6 +350,7 @@ DnsResource* DnsLayer::getAdditionalRecord(const std::string& name, bool exactMa
 
 DnsResource* DnsLayer::getFirstAdditionalRecord() const
 {
+	parseResourcesOnDemand();
 	return m_FirstAdditional;
 }
 
@@ -401,6 +416,8 @@ std::string DnsLayer::toString() const
 
 IDnsResource* DnsLayer::getFirstResource(DnsResourceType resType) const
 {
+	parseResourcesOnDemand();
+
 	switch (resType)
 	{
 	case DnsQueryType:
@@ -456,6 +473,8 @@ void DnsLayer::setFirstResource(DnsResourceType resType, IDnsResource* resource)
 DnsResource* DnsLayer::addResource(DnsResourceType resType, const std::string& name, DnsType dnsType, DnsClass dnsClass,
 		uint32_t ttl, IDnsResourceData* data)
 {
+	parseResourcesOnDemand();
+
 	// create new query on temporary buffer
 	uint8_t newResourceRawData[256];
 	memset(newResourceRawData, 0, sizeof(newResourceRawData));
@@ -542,6 +561,8 @@ DnsResource* DnsLayer::addResource(DnsResourceType resType, const std::string& n
 
 DnsQuery* DnsLayer::addQuery(const std::string& name, DnsType dnsType, DnsClass dnsClass)
 {
+	parseResourcesOnDemand();
+
 	// create new query on temporary buffer
 	uint8_t newQueryRawData[256];
 	DnsQuery* newQuery = new DnsQuery(newQueryRawData);
@@ -783,6 +804,8 @@ bool DnsLayer::removeResource(IDnsResource* resourceToRemove)
 		return false;
 	}
 
+	parseResourcesOnDemand();
+
 	// find the resource preceding resourceToRemove
 	IDnsResource* prevResource = m_ResourceList;
 
@@ -837,4 +860,199 @@ bool DnsLayer::removeResource(IDnsResource* resourceToRemove)
 	return true;
 }
 
+size_t DnsLayer::getEncodedNameLength(size_t nameOffset) const
+{
+	size_t curOffset = nameOffset;
+	while (curOffset < m_DataLen)
+	{
+		uint8_t labelLength = m_Data[curOffset];
+
+		// end of name
+		if (labelLength == 0)
+			return curOffset + 1 - nameOffset;
+
+		// a compression pointer always ends the name
+		if ((labelLength & 0xc0) == 0xc0)
+		{
+			if (curOffset + sizeof(uint16_t) > m_DataLen)
+				return 0;
+
+			return curOffset + sizeof(uint16_t) - nameOffset;
+		}
+
+		curOffset += labelLength + 1;
+	}
+
+	// name exceeds the layer bounds
+	return 0;
+}
+
+void DnsLayer::buildResourceIndex() const
+{
+	m_NumOfIndexedResources = 0;
+	m_IsResourceIndexValid = true;
+
+	size_t numOfQueries = getQueryCount();
+	size_t numOfResources = numOfQueries + getAnswerCount() + getAuthorityCount() + getAdditionalRecordCount();
+	if (numOfResources > PCPP_DNS_MAX_RESOURCES)
+		return;
+
+	size_t offsetInLayer = sizeof(dnshdr);
+	for (size_t i = 0; i < numOfResources; i++)
+	{
+		size_t nameLength = getEncodedNameLength(offsetInLayer);
+		if (nameLength == 0)
+			return;
+
+		// DNS type and class
+		size_t resourceSize = nameLength + 2*sizeof(uint16_t);
+
+		// records other than queries also have TTL, data length and data
+		if (i >= numOfQueries)
+		{
+			size_t dataLengthOffset = offsetInLayer + resourceSize + sizeof(uint32_t);
+			if (dataLengthOffset + sizeof(uint16_t) > m_DataLen)
+				return;
+
+			resourceSize += sizeof(uint32_t) + sizeof(uint16_t) + be16toh(*(uint16_t*)(m_Data + dataLengthOffset));
+		}
+
+		// stop at the first record that is out of bounds, like parseResources() does
+		if (offsetInLayer + resourceSize > m_DataLen || offsetInLayer > 0xffff)
+			return;
+
+		if (i < PCPP_DNS_INLINE_RESOURCE_OFFSETS)
+			m_ResourceOffsets[i] = (uint16_t)offsetInLayer;
+		else
+		{
+			if (m_ExtraResourceOffsets == NULL)
+				m_ExtraResourceOffsets = new uint16_t[PCPP_DNS_MAX_RESOURCES - PCPP_DNS_INLINE_RESOURCE_OFFSETS];
+			m_ExtraResourceOffsets[i - PCPP_DNS_INLINE_RESOURCE_OFFSETS] = (uint16_t)offsetInLayer;
+		}
+
+		m_NumOfIndexedResources++;
+		offsetInLayer += resourceSize;
+	}
+}
+
+bool DnsLayer::getResourceInfo(DnsResourceType resType, size_t index, DnsResourceInfo& info) const
+{
+	// records are ordered in the layer by section: queries, answers, authorities and then additional records
+	size_t firstIndexOfType = 0;
+	size_t numOfResourcesOfType = 0;
+	switch (resType)
+	{
+	case DnsQueryType:
+		numOfResourcesOfType = getQueryCount();
+		break;
+	case DnsAnswerType:
+		firstIndexOfType = getQueryCount();
+		numOfResourcesOfType = getAnswerCount();
+		break;
+	case DnsAuthorityType:
+		firstIndexOfType = getQueryCount() + getAnswerCount();
+		numOfResourcesOfType = getAuthorityCount();
+		break;
+	case DnsAdditionalType:
+		firstIndexOfType = getQueryCount() + getAnswerCount() + getAuthorityCount();
+		numOfResourcesOfType = getAdditionalRecordCount();
+		break;
+	default:
+		return false;
+	}
+
+	if (index >= numOfResourcesOfType)
+		return false;
+
+	if (!m_IsResourceIndexValid)
+		buildResourceIndex();
+
+	size_t resourceIndex = firstIndexOfType + index;
+	if (resourceIndex >= m_NumOfIndexedResources)
+		return false;
+
+	size_t offsetInLayer = (resourceIndex < PCPP_DNS_INLINE_RESOURCE_OFFSETS ?
+			m_ResourceOffsets[resourceIndex] : m_ExtraResourceOffsets[resourceIndex - PCPP_DNS_INLINE_RESOURCE_OFFSETS]);
+
+	// the bounds of the record were verified when the index was built
+	info.offsetInLayer = offsetInLayer;
+	info.nameLength = getEncodedNameLength(offsetInLayer);
+
+	const uint8_t* fields = m_Data + offsetInLayer + info.nameLength;
+	info.dnsType = (DnsType)be16toh(*(uint16_t*)fields);
+	info.dnsClass = (DnsClass)be16toh(*(uint16_t*)(fields + sizeof(uint16_t)));
+
+	if (resType == DnsQueryType)
+	{
+		info.ttl = 0;
+		info.data = NULL;
+		info.dataLength = 0;
+	}
+	else
+	{
+		info.ttl = be32toh(*(uint32_t*)(fields + 2*sizeof(uint16_t)));
+		info.dataLength = be16toh(*(uint16_t*)(fields + 2*sizeof(uint16_t) + sizeof(uint32_t)));
+		info.data = fields + 3*sizeof(uint16_t) + sizeof(uint32_t);
+	}
+
+	return true;
+}
+
+bool DnsLayer::decodeName(size_t nameOffset, char* result, size_t resultLen, size_t* decodedNameLen) const
+{
+	if (result == NULL || resultLen == 0)
+		return false;
+
+	size_t decodedLength = 0;
+	size_t curOffset = nameOffset;
+	int numOfPointers = 0;
+	result[0] = 0;
+
+	while (true)
+	{
+		if (curOffset >= m_DataLen)
+			return false;
+
+		uint8_t labelLength = m_Data[curOffset];
+		if (labelLength == 0)
+			break;
+
+		// a pointer to another place in the layer. Limit the number of pointers followed so pointer loops terminate
+		if ((labelLength & 0xc0) == 0xc0)
+		{
+			if (curOffset + sizeof(uint16_t) > m_DataLen || ++numOfPointers > 20)
+				return false;
+
+			size_t pointedOffset = (labelLength & 0x3f)*256 + m_Data[curOffset + 1];
+			if (pointedOffset < sizeof(dnshdr) || pointedOffset >= m_DataLen)
+				return false;
+
+			curOffset = pointedOffset;
+			continue;
+		}
+
+		if (curOffset + labelLength + 1 > m_DataLen)
+			return false;
+
+		// the label, a dot before it if it's not the first one and the terminating null must fit the buffer
+		size_t separatorLength = (decodedLength > 0 ? 1 : 0);
+		if (decodedLength + separatorLength + labelLength + 1 > resultLen)
+			return false;
+
+		if (separatorLength > 0)
+			result[decodedLength++] = '.';
+
+		memcpy(result + decodedLength, m_Data + curOffset + 1, labelLength);
+		decodedLength += labelLength;
+		result[decodedLength] = 0;
+
+		curOffset += labelLength + 1;
+	}
+
+	if (decodedNameLen != NULL)
+		*decodedNameLen = decodedLength;
+
+	return true;
+}
+
 } // namespace pcpp
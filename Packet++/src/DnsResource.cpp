@@ -31,6 +31,12 @@ uint8_t* IDnsResource::getRawData() const
 	return m_DnsLayer->m_Data + m_OffsetInLayer;
 }
 
+void IDnsResource::makeDataWritable()
+{
+	if (m_DnsLayer != NULL)
+		m_DnsLayer->makePacketWritable();
+}
+
 size_t IDnsResource::decodeName(const char* encodedName, char* result, int iteration)
 {
 	size_t encodedNameLength = 0;
@@ -194,6 +200,7 @@ DnsType IDnsResource::getDnsType() const
 
 void IDnsResource::setDnsType(DnsType newType)
 {
+	makeDataWritable();
 	uint16_t newTypeAsInt = htobe16((uint16_t)newType);
 	memcpy(getRawData() + m_NameLength, &newTypeAsInt, sizeof(uint16_t));
 }
@@ -206,12 +213,14 @@ DnsClass IDnsResource::getDnsClass() const
 
 void IDnsResource::setDnsClass(DnsClass newClass)
 {
+	makeDataWritable();
 	uint16_t newClassAsInt = htobe16((uint16_t)newClass);
 	memcpy(getRawData() + m_NameLength + sizeof(uint16_t), &newClassAsInt, sizeof(uint16_t));
 }
 
 bool IDnsResource::setName(const std::string& newName)
 {
+	makeDataWritable();
 	char encodedName[256];
 	size_t encodedNameLen = 0;
 	encodeName(newName, encodedName, encodedNameLen);
@@ -266,6 +275,7 @@ uint32_t DnsResource::getTTL() const
 
 void DnsResource::setTTL(uint32_t newTTL)
 {
+	makeDataWritable();
 	newTTL = htobe32(newTTL);
 	memcpy(getRawData() + m_NameLength + 2*sizeof(uint16_t), &newTTL, sizeof(uint32_t));
 }
@@ -321,6 +331,7 @@ size_t DnsResource::getDataOffset() const
 
 bool DnsResource::setData(IDnsResourceData* data)
 {
+	makeDataWritable();
 	// convert data to byte array according to the DNS type
 	size_t dataLength = 0;
 	uint8_t dataAsByteArr[256];
@@ -431,6 +442,7 @@ uint16_t DnsResource::getCustomDnsClass() const
 
 void DnsResource::setCustomDnsClass(uint16_t customValue)
 {
+	makeDataWritable();
 	memcpy(getRawData() + m_NameLength + sizeof(uint16_t), &customValue, sizeof(uint16_t));
 }
 
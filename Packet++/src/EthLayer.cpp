@@ -4,6 +4,7 @@
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "ArpLayer.h"
 #include "VlanLayer.h"
 #include "PPPoELayer.h"
@@ -38,36 +39,9 @@ void EthLayer::parseNextLayer()
 	uint8_t* payload = m_Data + sizeof(ether_header);
 	size_t payloadLen = m_DataLen - sizeof(ether_header);
 
-	switch (be16toh(hdr->etherType))
-	{
-	case PCPP_ETHERTYPE_IP:
-		m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
-		break;
-	case PCPP_ETHERTYPE_IPV6:
-		m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
-		break;
-	case PCPP_ETHERTYPE_ARP:
-		m_NextLayer = new ArpLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_VLAN:
-		m_NextLayer = new VlanLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_PPPOES:
-		m_NextLayer = new PPPoESessionLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_PPPOED:
-		m_NextLayer = new PPPoEDiscoveryLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_MPLS:
-		m_NextLayer = new MplsLayer(payload, payloadLen, this, m_Packet);
-		break;
-	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
-	}
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::EtherTypeTable, be16toh(hdr->etherType), payload, payloadLen, this, m_Packet);
+	if (m_NextLayer == NULL)
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 }
 
 void EthLayer::computeCalculateFields()
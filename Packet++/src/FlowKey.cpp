@@ -0,0 +1,441 @@
+#include "FlowKey.h"
+#include "Packet.h"
+#include "IpAddress.h"
+#include "EthLayer.h"
+#include "VxlanLayer.h"
+#include "PPPoELayer.h"
+#include <sstream>
+
+namespace pcpp
+{
+
+// rotate a 64-bit value left
+#define PCPP_FLOW_KEY_ROTL64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+// GTP-U port and the message type of GTP-U packets that carry user data (G-PDU)
+#define PCPP_FLOW_KEY_GTPU_PORT 2152
+#define PCPP_FLOW_KEY_GTPU_GPDU 0xFF
+
+// the EtherType of Ethernet frames carried by GRE (transparent Ethernet bridging)
+#define PCPP_FLOW_KEY_GRE_ETHERNET 0x6558
+
+FlowKey::FlowKey(const PacketFiveTuple& fiveTuple)
+{
+	memset(this, 0, sizeof(FlowKey));
+
+	if (fiveTuple.ipVersion != 4 && fiveTuple.ipVersion != 6)
+		return;
+
+	m_IPVersion = fiveTuple.ipVersion;
+	m_Protocol = fiveTuple.protocol;
+	setEndpoints(fiveTuple.srcIP, fiveTuple.dstIP, (m_IPVersion == 4 ? 4 : 16), fiveTuple.srcPort, fiveTuple.dstPort);
+}
+
+void FlowKey::setEndpoints(const uint8_t* srcAddr, const uint8_t* dstAddr, size_t addrLen, uint16_t srcPort, uint16_t dstPort)
+{
+	// order the endpoints by address and then by port, so both directions of the flow get the same key
+	int cmp = memcmp(srcAddr, dstAddr, addrLen);
+	if (cmp > 0 || (cmp == 0 && srcPort > dstPort))
+	{
+		const uint8_t* tmpAddr = srcAddr;
+		srcAddr = dstAddr;
+		dstAddr = tmpAddr;
+		uint16_t tmpPort = srcPort;
+		srcPort = dstPort;
+		dstPort = tmpPort;
+	}
+
+	memcpy(m_AddressA, srcAddr, addrLen);
+	memcpy(m_AddressB, dstAddr, addrLen);
+	m_PortA = srcPort;
+	m_PortB = dstPort;
+}
+
+FlowKey FlowKey::fromPacket(const Packet& packet)
+{
+	// look for the innermost IP layer and the TCP/UDP layer directly above it. Stop at ICMP because ICMP error messages carry
+	// the IP header of the packet that caused the error, which doesn't belong to this flow
+	Layer* ipLayer = NULL;
+	Layer* transportLayer = NULL;
+	for (Layer* curLayer = packet.getFirstLayer(); curLayer != NULL; curLayer = curLayer->getNextLayer())
+	{
+		ProtocolType protocol = curLayer->getProtocol();
+		if (protocol == IPv4 || protocol == IPv6)
+		{
+			ipLayer = curLayer;
+			transportLayer = NULL;
+		}
+		else if ((protocol == TCP || protocol == UDP) && ipLayer != NULL && curLayer->getPrevLayer() == ipLayer)
+			transportLayer = curLayer;
+		else if (protocol == ICMP)
+			break;
+	}
+
+	return fromLayers(ipLayer, transportLayer);
+}
+
+FlowKey FlowKey::fromLayers(const Layer* ipLayer, const Layer* transportLayer)
+{
+	FlowKey key;
+
+	if (ipLayer == NULL || (ipLayer->getProtocol() != IPv4 && ipLayer->getProtocol() != IPv6))
+		return key;
+
+	if (transportLayer != NULL && transportLayer->getProtocol() != TCP && transportLayer->getProtocol() != UDP)
+		transportLayer = NULL;
+
+	// TCP and UDP headers both start with the source and destination ports
+	uint16_t srcPort = 0;
+	uint16_t dstPort = 0;
+	if (transportLayer != NULL)
+	{
+		srcPort = be16toh(((udphdr*)transportLayer->getData())->portSrc);
+		dstPort = be16toh(((udphdr*)transportLayer->getData())->portDst);
+	}
+
+	if (ipLayer->getProtocol() == IPv4)
+	{
+		iphdr* ipHdr = ((IPv4Layer*)ipLayer)->getIPv4Header();
+		key.m_IPVersion = 4;
+		key.m_Protocol = ipHdr->protocol;
+		key.setEndpoints((uint8_t*)&ipHdr->ipSrc, (uint8_t*)&ipHdr->ipDst, sizeof(ipHdr->ipSrc), srcPort, dstPort);
+	}
+	else
+	{
+		ip6_hdr* ipHdr = ((IPv6Layer*)ipLayer)->getIPv6Header();
+		key.m_IPVersion = 6;
+		key.m_Protocol = ipHdr->nextHeader;
+		key.setEndpoints(ipHdr->ipSrc, ipHdr->ipDst, sizeof(ipHdr->ipSrc), srcPort, dstPort);
+	}
+
+	// the IPv6 next header field may point to an extension header, take the protocol from the transport layer instead
+	if (transportLayer != NULL)
+		key.m_Protocol = (transportLayer->getProtocol() == TCP ? (uint8_t)PACKETPP_IPPROTO_TCP : (uint8_t)PACKETPP_IPPROTO_UDP);
+
+	return key;
+}
+
+FlowKey FlowKey::fromPacketView(const PacketView& packetView)
+{
+	PacketFiveTuple fiveTuple;
+	packetView.getFiveTuple(fiveTuple);
+	return FlowKey(fiveTuple);
+}
+
+FlowKey FlowKey::fromRawData(const uint8_t* data, size_t dataLen, LinkLayerType linkType)
+{
+	PacketView packetView;
+	packetView.parse(data, dataLen, linkType);
+	return fromPacketView(packetView);
+}
+
+FlowKey FlowKey::fromRawPacket(const RawPacket* rawPacket)
+{
+	PacketView packetView;
+	packetView.parse(rawPacket);
+	return fromPacketView(packetView);
+}
+
+// Locate the inner packet of a GTP-U, VXLAN, GRE or IP in IP tunnel whose outer headers were parsed by packetView. Returns false if the
+// packet doesn't carry a supported tunnel or if the tunnel headers are truncated
+static bool decapsulateTunnel(const PacketView& packetView, const uint8_t*& innerData, size_t& innerDataLen, LinkLayerType& innerLinkType,
+		TunnelType& tunnelType, uint32_t& tunnelId, bool& hasTunnelId)
+{
+	hasTunnelId = false;
+	tunnelId = 0;
+
+	if (packetView.getIPProtocol() == PACKETPP_IPPROTO_UDP && packetView.getL7Offset() != PCPP_PACKET_VIEW_NO_OFFSET)
+	{
+		const uint8_t* payload = packetView.getPayload();
+		size_t payloadLen = packetView.getPayloadLen();
+
+		if (packetView.getSrcPort() == PCPP_FLOW_KEY_GTPU_PORT || packetView.getDstPort() == PCPP_FLOW_KEY_GTPU_PORT)
+		{
+			// only GTPv1 (version 1, protocol type 1) G-PDU messages carry user data
+			if (payloadLen < 8 || (payload[0] & 0xF0) != 0x30 || payload[1] != PCPP_FLOW_KEY_GTPU_GPDU)
+				return false;
+
+			size_t headerLen = 8;
+
+			// the sequence number, N-PDU number and next extension type fields exist if any of the E, S or PN flags is set
+			if (payload[0] & 0x07)
+			{
+				headerLen += 4;
+				if (headerLen > payloadLen)
+					return false;
+
+				// each extension header starts with its length in units of 4 bytes and ends with the type of the next extension
+				uint8_t nextExtType = ((payload[0] & 0x04) ? payload[11] : 0);
+				while (nextExtType != 0)
+				{
+					if (headerLen >= payloadLen)
+						return false;
+
+					size_t extLen = payload[headerLen] * 4;
+					if (extLen == 0 || headerLen + extLen > payloadLen)
+						return false;
+
+					nextExtType = payload[headerLen + extLen - 1];
+					headerLen += extLen;
+				}
+			}
+
+			tunnelType = GtpUTunnel;
+			tunnelId = be32toh(*(uint32_t*)(payload + 4));
+			hasTunnelId = true;
+			innerData = payload + headerLen;
+			innerDataLen = payloadLen - headerLen;
+			innerLinkType = LINKTYPE_RAW;
+			return true;
+		}
+
+		if (VxlanLayer::isVxlanPort(packetView.getDstPort()))
+		{
+			if (payloadLen < sizeof(vxlan_header))
+				return false;
+
+			// the VNI is valid only if the I flag is set
+			tunnelType = VxlanTunnel;
+			hasTunnelId = ((payload[0] & 0x08) != 0);
+			if (hasTunnelId)
+				tunnelId = ((uint32_t)payload[4] << 16) | ((uint32_t)payload[5] << 8) | payload[6];
+			innerData = payload + sizeof(vxlan_header);
+			innerDataLen = payloadLen - sizeof(vxlan_header);
+			innerLinkType = LINKTYPE_ETHERNET;
+			return true;
+		}
+
+		return false;
+	}
+
+	if (packetView.getL4Offset() == PCPP_PACKET_VIEW_NO_OFFSET)
+		return false;
+
+	const uint8_t* l4Data = packetView.getData() + packetView.getL4Offset();
+	size_t l4Len = packetView.getL3Offset() + packetView.getIPDatagramLen() - packetView.getL4Offset();
+
+	// IP in IP: the inner IP header directly follows the outer one
+	if (packetView.getIPProtocol() == PACKETPP_IPPROTO_IPIP || packetView.getIPProtocol() == PACKETPP_IPPROTO_IPV6)
+	{
+		tunnelType = IpInIpTunnel;
+		innerData = l4Data;
+		innerDataLen = l4Len;
+		innerLinkType = LINKTYPE_RAW;
+		return true;
+	}
+
+	if (packetView.getIPProtocol() != PACKETPP_IPPROTO_GRE)
+		return false;
+
+	const uint8_t* greData = l4Data;
+	size_t greLen = l4Len;
+	if (greLen < 4)
+		return false;
+
+	uint8_t version = greData[1] & 0x07;
+	uint16_t protocol = be16toh(*(uint16_t*)(greData + 2));
+	size_t headerLen = 4;
+
+	if (version == 0)
+	{
+		// the optional fields are ordered: checksum + reserved (C flag), key (K flag) and sequence number (S flag)
+		if (greData[0] & 0x80)
+			headerLen += 4;
+		if (greData[0] & 0x20)
+		{
+			if (headerLen + 4 > greLen)
+				return false;
+			tunnelId = be32toh(*(uint32_t*)(greData + headerLen));
+			hasTunnelId = true;
+			headerLen += 4;
+		}
+		if (greData[0] & 0x10)
+			headerLen += 4;
+	}
+	else if (version == 1)
+	{
+		// enhanced GRE always has the key field, which holds the payload length and the call ID. It's followed by the optional
+		// sequence number (S flag) and acknowledgment number (A flag)
+		if (!(greData[0] & 0x20) || greLen < 8)
+			return false;
+		tunnelId = be16toh(*(uint16_t*)(greData + 6));
+		hasTunnelId = true;
+		headerLen = 8;
+		if (greData[0] & 0x10)
+			headerLen += 4;
+		if (greData[1] & 0x80)
+			headerLen += 4;
+	}
+	else
+		return false;
+
+	if (headerLen > greLen)
+		return false;
+
+	innerData = greData + headerLen;
+	innerDataLen = greLen - headerLen;
+
+	switch (protocol)
+	{
+	case PCPP_ETHERTYPE_IP:
+	case PCPP_ETHERTYPE_IPV6:
+		innerLinkType = LINKTYPE_RAW;
+		break;
+	case PCPP_FLOW_KEY_GRE_ETHERNET:
+		innerLinkType = LINKTYPE_ETHERNET;
+		break;
+	case PCPP_ETHERTYPE_PPP:
+	{
+		// the PPP address and control fields may be omitted, and the protocol field may be compressed to a single (odd) byte
+		if (innerDataLen >= 2 && innerData[0] == 0xFF && innerData[1] == 0x03)
+		{
+			innerData += 2;
+			innerDataLen -= 2;
+		}
+
+		if (innerDataLen < 1)
+			return false;
+
+		uint16_t pppProtocol = innerData[0];
+		size_t pppProtocolLen = 1;
+		if (!(pppProtocol & 0x01))
+		{
+			if (innerDataLen < 2)
+				return false;
+			pppProtocol = (uint16_t)((pppProtocol << 8) | innerData[1]);
+			pppProtocolLen = 2;
+		}
+
+		if (pppProtocol != PCPP_PPP_IP && pppProtocol != PCPP_PPP_IPV6)
+			return false;
+
+		innerData += pppProtocolLen;
+		innerDataLen -= pppProtocolLen;
+		innerLinkType = LINKTYPE_RAW;
+		break;
+	}
+	default:
+		return false;
+	}
+
+	tunnelType = GreTunnel;
+	return true;
+}
+
+bool FlowKey::extractTunnelFlowKeys(const uint8_t* data, size_t dataLen, TunnelFlowKeys& result, LinkLayerType linkType)
+{
+	result = TunnelFlowKeys();
+
+	PacketView packetView;
+	packetView.parse(data, dataLen, linkType);
+	result.outerFlowKey = fromPacketView(packetView);
+	if (!result.outerFlowKey.isValid())
+		return false;
+
+	result.innerFlowKey = result.outerFlowKey;
+
+	for (int depth = 0; depth < PCPP_FLOW_KEY_MAX_TUNNEL_DEPTH; depth++)
+	{
+		const uint8_t* innerData = NULL;
+		size_t innerDataLen = 0;
+		LinkLayerType innerLinkType = LINKTYPE_RAW;
+		TunnelType tunnelType = NoTunnel;
+		uint32_t tunnelId = 0;
+		bool hasTunnelId = false;
+		if (!decapsulateTunnel(packetView, innerData, innerDataLen, innerLinkType, tunnelType, tunnelId, hasTunnelId))
+			break;
+
+		PacketView innerPacketView;
+		innerPacketView.parse(innerData, innerDataLen, innerLinkType);
+		FlowKey innerFlowKey = fromPacketView(innerPacketView);
+		if (!innerFlowKey.isValid())
+			break;
+
+		result.innerFlowKey = innerFlowKey;
+		result.tunnelType = tunnelType;
+		result.tunnelId = tunnelId;
+		result.hasTunnelId = hasTunnelId;
+		result.tunnelDepth++;
+		packetView = innerPacketView;
+	}
+
+	return true;
+}
+
+bool FlowKey::extractTunnelFlowKeys(const RawPacket* rawPacket, TunnelFlowKeys& result)
+{
+	if (rawPacket == NULL || rawPacket->getRawDataLen() <= 0)
+	{
+		result = TunnelFlowKeys();
+		return false;
+	}
+
+	return extractTunnelFlowKeys(rawPacket->getRawData(), (size_t)rawPacket->getRawDataLen(), result, rawPacket->getLinkLayerType());
+}
+
+FlowKey FlowKey::getIPPairKey() const
+{
+	FlowKey key;
+	if (!isValid())
+		return key;
+
+	key.m_IPVersion = m_IPVersion;
+	key.setEndpoints(m_AddressA, m_AddressB, sizeof(m_AddressA), 0, 0);
+	return key;
+}
+
+uint64_t FlowKey::hash() const
+{
+	// MurmurHash3 (x64) style mixing of the five 64-bit words that make up the key, followed by its 64-bit finalizer
+	const uint64_t c1 = 0x87c37b91114253d5ULL;
+	const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+	uint64_t h = 0x9e3779b97f4a7c15ULL;
+	const uint8_t* keyData = (const uint8_t*)this;
+	for (size_t i = 0; i < sizeof(FlowKey); i += sizeof(uint64_t))
+	{
+		uint64_t k;
+		memcpy(&k, keyData + i, sizeof(k));
+		k *= c1;
+		k = PCPP_FLOW_KEY_ROTL64(k, 31);
+		k *= c2;
+		h ^= k;
+		h = PCPP_FLOW_KEY_ROTL64(h, 27);
+		h = h * 5 + 0x52dce729;
+	}
+
+	h ^= sizeof(FlowKey);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+std::string FlowKey::toString() const
+{
+	if (!isValid())
+		return "Invalid flow key";
+
+	std::string addrA, addrB;
+	if (m_IPVersion == 4)
+	{
+		uint32_t addrAInt, addrBInt;
+		memcpy(&addrAInt, m_AddressA, sizeof(addrAInt));
+		memcpy(&addrBInt, m_AddressB, sizeof(addrBInt));
+		addrA = IPv4Address(addrAInt).toString();
+		addrB = IPv4Address(addrBInt).toString();
+	}
+	else
+	{
+		addrA = "[" + IPv6Address((uint8_t*)m_AddressA).toString() + "]";
+		addrB = "[" + IPv6Address((uint8_t*)m_AddressB).toString() + "]";
+	}
+
+	std::ostringstream stream;
+	stream << addrA << ":" << m_PortA << " <-> " << addrB << ":" << m_PortB << " proto " << (int)m_Protocol;
+	return stream.str();
+}
+
+} // namespace pcpp
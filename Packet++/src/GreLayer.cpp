@@ -139,6 +139,7 @@ bool GreLayer::getSequenceNumber(uint32_t& seqNumber) const
 
 bool GreLayer::setSequenceNumber(uint32_t seqNumber)
 {
+	makePacketWritable();
 	gre_basic_header* header = (gre_basic_header*)m_Data;
 
 	bool needToExtendLayer = false;
@@ -166,6 +167,7 @@ bool GreLayer::setSequenceNumber(uint32_t seqNumber)
 
 bool GreLayer::unsetSequenceNumber()
 {
+	makePacketWritable();
 	gre_basic_header* header = (gre_basic_header*)m_Data;
 
 	if (header->sequenceNumBit == 0)
@@ -202,25 +204,25 @@ void GreLayer::parseNextLayer()
 	{
 	case PCPP_ETHERTYPE_IP:
 		m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	case PCPP_ETHERTYPE_IPV6:
 		m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	case PCPP_ETHERTYPE_VLAN:
-		m_NextLayer = new VlanLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) VlanLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PCPP_ETHERTYPE_MPLS:
-		m_NextLayer = new MplsLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) MplsLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PCPP_ETHERTYPE_PPP:
-		m_NextLayer = new PPP_PPTPLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PPP_PPTPLayer(payload, payloadLen, this, m_Packet);
 		break;
 	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 	}
 }
 
@@ -273,6 +275,7 @@ bool GREv0Layer::getChecksum(uint16_t& checksum)
 
 bool GREv0Layer::setChecksum(uint16_t checksum)
 {
+	makePacketWritable();
 	gre_basic_header* header = getGreHeader();
 
 	bool needToExtendLayer = false;
@@ -307,6 +310,7 @@ bool GREv0Layer::setChecksum(uint16_t checksum)
 
 bool GREv0Layer::unsetChecksum()
 {
+	makePacketWritable();
 	gre_basic_header* header = getGreHeader();
 
 	if (header->checksumBit == 0)
@@ -366,6 +370,7 @@ bool GREv0Layer::getKey(uint32_t& key) const
 
 bool GREv0Layer::setKey(uint32_t key)
 {
+	makePacketWritable();
 	gre_basic_header* header = getGreHeader();
 
 	bool needToExtendLayer = false;
@@ -393,6 +398,7 @@ bool GREv0Layer::setKey(uint32_t key)
 
 bool GREv0Layer::unsetKey()
 {
+	makePacketWritable();
 	gre_basic_header* header = getGreHeader();
 
 	if (header->keyBit == 0)
@@ -472,6 +478,7 @@ bool GREv1Layer::getAcknowledgmentNum(uint32_t& ackNum) const
 
 bool GREv1Layer::setAcknowledgmentNum(uint32_t ackNum)
 {
+	makePacketWritable();
 	bool needToExtendLayer = false;
 
 	gre1_header* header = getGreHeader();
@@ -496,6 +503,7 @@ bool GREv1Layer::setAcknowledgmentNum(uint32_t ackNum)
 
 bool GREv1Layer::unsetAcknowledgmentNum()
 {
+	makePacketWritable();
 	gre1_header* header = getGreHeader();
 
 	if (header->ackSequenceNumBit == 0)
@@ -563,16 +571,16 @@ void PPP_PPTPLayer::parseNextLayer()
 	{
 	case PCPP_PPP_IP:
 		m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	case PCPP_PPP_IPV6:
 		m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	}
 }
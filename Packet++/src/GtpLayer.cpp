@@ -236,6 +236,7 @@ bool GtpV1Layer::getSequenceNumber(uint16_t& seqNumber) const
 
 bool GtpV1Layer::setSequenceNumber(const uint16_t seqNumber)
 {
+	makePacketWritable();
 	// get GTP header
 	gtpv1_header* header = getHeader();
 	if (header == NULL)
@@ -288,6 +289,7 @@ bool GtpV1Layer::getNpduNumber(uint8_t& npduNum) const
 
 bool GtpV1Layer::setNpduNumber(const uint8_t npduNum)
 {
+	makePacketWritable();
 	// get GTP header
 	gtpv1_header* header = getHeader();
 	if (header == NULL)
@@ -352,6 +354,7 @@ GtpV1Layer::GtpExtension GtpV1Layer::getNextExtension() const
 
 GtpV1Layer::GtpExtension GtpV1Layer::addExtension(uint8_t extensionType, uint16_t extensionContent)
 {
+	makePacketWritable();
 	// get GTP header
 	gtpv1_header* header = getHeader();
 	if (header == NULL)
@@ -594,18 +597,18 @@ void GtpV1Layer::parseNextLayer()
 	if (subProto >= 0x45 && subProto <= 0x4e)
 	{
 		m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 	}
 	else if ((subProto & 0xf0) == 0x60)
 	{
 		m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 	}
 	else
 	{
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 	}
 }
 
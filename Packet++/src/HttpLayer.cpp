@@ -10,6 +10,21 @@
 namespace pcpp
 {
 
+const HeaderFieldName HttpFieldNames::Host(PCPP_HTTP_HOST_FIELD);
+const HeaderFieldName HttpFieldNames::Connection(PCPP_HTTP_CONNECTION_FIELD);
+const HeaderFieldName HttpFieldNames::UserAgent(PCPP_HTTP_USER_AGENT_FIELD);
+const HeaderFieldName HttpFieldNames::Referer(PCPP_HTTP_REFERER_FIELD);
+const HeaderFieldName HttpFieldNames::Accept(PCPP_HTTP_ACCEPT_FIELD);
+const HeaderFieldName HttpFieldNames::AcceptEncoding(PCPP_HTTP_ACCEPT_ENCODING_FIELD);
+const HeaderFieldName HttpFieldNames::AcceptLanguage(PCPP_HTTP_ACCEPT_LANGUAGE_FIELD);
+const HeaderFieldName HttpFieldNames::Cookie(PCPP_HTTP_COOKIE_FIELD);
+const HeaderFieldName HttpFieldNames::ContentLength(PCPP_HTTP_CONTENT_LENGTH_FIELD);
+const HeaderFieldName HttpFieldNames::ContentEncoding(PCPP_HTTP_CONTENT_ENCODING_FIELD);
+const HeaderFieldName HttpFieldNames::ContentType(PCPP_HTTP_CONTENT_TYPE_FIELD);
+const HeaderFieldName HttpFieldNames::TransferEncoding(PCPP_HTTP_TRANSFER_ENCODING_FIELD);
+const HeaderFieldName HttpFieldNames::Server(PCPP_HTTP_SERVER_FIELD);
+
+
 
 // -------- Class HttpMessage -----------------
 
@@ -27,7 +42,7 @@ HeaderField* HttpMessage::addField(const std::string& fieldName, const std::stri
 
 HeaderField* HttpMessage::addField(const HeaderField& newField)
 {
-	if (getFieldByName(newField.getFieldName()) != NULL)
+	if (getFieldByName(HeaderFieldName(newField.getFieldNamePtr(), newField.getFieldNameLen())) != NULL)
 	{
 		LOG_ERROR("Field '%s' already exists!",newField.getFieldName().c_str());
 		return NULL;
@@ -49,7 +64,7 @@ HeaderField* HttpMessage::insertField(HeaderField* prevField, const std::string&
 
 HeaderField* HttpMessage::insertField(HeaderField* prevField, const HeaderField& newField)
 {
-	if (getFieldByName(newField.getFieldName()) != NULL)
+	if (getFieldByName(HeaderFieldName(newField.getFieldNamePtr(), newField.getFieldNameLen())) != NULL)
 	{
 		LOG_ERROR("Field '%s' already exists!",newField.getFieldName().c_str());
 		return NULL;
@@ -97,7 +112,7 @@ HttpRequestLayer& HttpRequestLayer::operator=(const HttpRequestLayer& other)
 
 std::string HttpRequestLayer::getUrl() const
 {
-	HeaderField* hostField = getFieldByName(PCPP_HTTP_HOST_FIELD);
+	HeaderField* hostField = getFieldByName(HttpFieldNames::Host);
 	if (hostField == NULL)
 		return m_FirstLine->getUri();
 
@@ -381,6 +396,7 @@ void HttpRequestFirstLine::parseVersion()
 
 bool HttpRequestFirstLine::setMethod(HttpRequestLayer::HttpMethod newMethod)
 {
+	m_HttpRequest->makePacketWritable();
 	if (newMethod == HttpRequestLayer::HttpMethodUnknown)
 	{
 		LOG_ERROR("Requested method is HttpMethodUnknown");
@@ -432,6 +448,7 @@ std::string HttpRequestFirstLine::getUri() const
 
 bool HttpRequestFirstLine::setUri(std::string newUri)
 {
+	m_HttpRequest->makePacketWritable();
 	// make sure the new URI begins with "/"
 	if (newUri.compare(0, 1, "/") != 0)
 		newUri = "/" + newUri;
@@ -468,6 +485,7 @@ bool HttpRequestFirstLine::setUri(std::string newUri)
 
 void HttpRequestFirstLine::setVersion(HttpVersion newVersion)
 {
+	m_HttpRequest->makePacketWritable();
 	if (m_VersionOffset == -1)
 		return;
 
@@ -701,8 +719,7 @@ HeaderField* HttpResponseLayer::setContentLength(int contentLength, const std::s
 {
 	char contentLengthAsString[20];
 	snprintf (contentLengthAsString, sizeof(contentLengthAsString), "%d",contentLength);
-	std::string contentLengthFieldName(PCPP_HTTP_CONTENT_LENGTH_FIELD);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
+	HeaderField* contentLengthField = getFieldByName(HttpFieldNames::ContentLength);
 	if (contentLengthField == NULL)
 	{
 		HeaderField* prevField = getFieldByName(prevFieldName);
@@ -716,9 +733,7 @@ HeaderField* HttpResponseLayer::setContentLength(int contentLength, const std::s
 
 int HttpResponseLayer::getContentLength() const
 {
-	std::string contentLengthFieldName(PCPP_HTTP_CONTENT_LENGTH_FIELD);
-	std::transform(contentLengthFieldName.begin(), contentLengthFieldName.end(), contentLengthFieldName.begin(), ::tolower);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
+	HeaderField* contentLengthField = getFieldByName(HttpFieldNames::ContentLength);
 	if (contentLengthField != NULL)
 		return atoi(contentLengthField->getFieldValue().c_str());
 	return 0;
@@ -786,6 +801,7 @@ std::string HttpResponseFirstLine::getStatusCodeString() const
 
 bool HttpResponseFirstLine::setStatusCode(HttpResponseLayer::HttpResponseStatusCode newStatusCode, std::string statusCodeString)
 {
+	m_HttpResponse->makePacketWritable();
 	if (newStatusCode == HttpResponseLayer::HttpStatusCodeUnknown)
 	{
 		LOG_ERROR("Requested status code is HttpStatusCodeUnknown");
@@ -839,6 +855,7 @@ bool HttpResponseFirstLine::setStatusCode(HttpResponseLayer::HttpResponseStatusC
 
 void HttpResponseFirstLine::setVersion(HttpVersion newVersion)
 {
+	m_HttpResponse->makePacketWritable();
 	if (newVersion == HttpVersionUnknown)
 		return;
 
@@ -3,6 +3,7 @@
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "UdpLayer.h"
 #include "TcpLayer.h"
 #include "IcmpLayer.h"
@@ -255,60 +256,65 @@ void IPv4Layer::parseNextLayer()
 	// TODO: assuming first fragment contains at least L4 header, what if it's not true?
 	if (isFragment())
 	{
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		return;
 	}
 
+	// parsers registered by the user to this IP protocol take precedence over the built-in parsing
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::IPProtocolTable, ipHdr->protocol, payload, payloadLen, this, m_Packet);
+	if (m_NextLayer != NULL)
+		return;
+
 	switch (ipHdr->protocol)
 	{
 	case PACKETPP_IPPROTO_UDP:
 		if (payloadLen >= sizeof(udphdr))
-			m_NextLayer = new UdpLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) UdpLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PACKETPP_IPPROTO_TCP:
 		m_NextLayer = TcpLayer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new TcpLayer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) TcpLayer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	case PACKETPP_IPPROTO_ICMP:
-		m_NextLayer = new IcmpLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) IcmpLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PACKETPP_IPPROTO_IPIP:
 		ipVersion = *payload >> 4;
 		if (ipVersion == 4)
-			m_NextLayer = new IPv4Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet);
 		else if (ipVersion == 6)
-			m_NextLayer = new IPv6Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet);
 		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PACKETPP_IPPROTO_GRE:
 		greVer = GreLayer::getGREVersion(payload, payloadLen);
 		if (greVer == GREv0)
-			m_NextLayer = new GREv0Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) GREv0Layer(payload, payloadLen, this, m_Packet);
 		else if (greVer == GREv1)
-			m_NextLayer = new GREv1Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) GREv1Layer(payload, payloadLen, this, m_Packet);
 		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PACKETPP_IPPROTO_IGMP:
 		igmpVer = IgmpLayer::getIGMPVerFromData(payload, be16toh(getIPv4Header()->totalLength) - hdrLen, igmpQuery);
 		if (igmpVer == IGMPv1)
-			m_NextLayer = new IgmpV1Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IgmpV1Layer(payload, payloadLen, this, m_Packet);
 		else if (igmpVer == IGMPv2)
-			m_NextLayer = new IgmpV2Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IgmpV2Layer(payload, payloadLen, this, m_Packet);
 		else if (igmpVer == IGMPv3)
 		{
 			if (igmpQuery)
-				m_NextLayer = new IgmpV3QueryLayer(payload, payloadLen, this, m_Packet);
+				m_NextLayer = new(m_Packet) IgmpV3QueryLayer(payload, payloadLen, this, m_Packet);
 			else
-				m_NextLayer = new IgmpV3ReportLayer(payload, payloadLen, this, m_Packet);
+				m_NextLayer = new(m_Packet) IgmpV3ReportLayer(payload, payloadLen, this, m_Packet);
 		}
 		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 	}
 }
 
@@ -350,6 +356,75 @@ void IPv4Layer::computeCalculateFields()
 	ipHdr->headerChecksum = htobe16(compute_checksum(&scalar, 1));
 }
 
+void IPv4Layer::setSrcIpAddress(const IPv4Address& ipAddr, bool updateChecksums)
+{
+	makePacketWritable();
+	if (updateChecksums)
+		setIpAddressAndUpdateChecksums(&getIPv4Header()->ipSrc, ipAddr.toInt());
+	else
+	{
+		getIPv4Header()->ipSrc = ipAddr.toInt();
+		m_IsModified = true;
+	}
+}
+
+void IPv4Layer::setDstIpAddress(const IPv4Address& ipAddr, bool updateChecksums)
+{
+	makePacketWritable();
+	if (updateChecksums)
+		setIpAddressAndUpdateChecksums(&getIPv4Header()->ipDst, ipAddr.toInt());
+	else
+	{
+		getIPv4Header()->ipDst = ipAddr.toInt();
+		m_IsModified = true;
+	}
+}
+
+void IPv4Layer::setIpAddressAndUpdateChecksums(uint32_t* addrField, uint32_t newAddr)
+{
+	iphdr* ipHdr = getIPv4Header();
+	uint32_t oldAddr = *addrField;
+	*addrField = newAddr;
+	ipHdr->headerChecksum = update_checksum(ipHdr->headerChecksum, (uint8_t*)&oldAddr, (uint8_t*)&newAddr, sizeof(uint32_t));
+
+	// the address is also covered by the TCP/UDP checksum through the pseudo header. Only the first fragment carries the
+	// TCP/UDP header
+	if (isFragment() && !isFirstFragment())
+		return;
+
+	size_t hdrLen = ipHdr->internetHeaderLength * 4;
+	uint16_t* l4Checksum = NULL;
+	if (ipHdr->protocol == PACKETPP_IPPROTO_TCP && m_DataLen >= hdrLen + sizeof(tcphdr))
+		l4Checksum = &((tcphdr*)(m_Data + hdrLen))->headerChecksum;
+	else if (ipHdr->protocol == PACKETPP_IPPROTO_UDP && m_DataLen >= hdrLen + sizeof(udphdr))
+	{
+		// a zero UDP checksum means the checksum isn't used
+		udphdr* udpHdr = (udphdr*)(m_Data + hdrLen);
+		if (udpHdr->headerChecksum != 0)
+			l4Checksum = &udpHdr->headerChecksum;
+	}
+
+	if (l4Checksum != NULL)
+		*l4Checksum = update_checksum(*l4Checksum, (uint8_t*)&oldAddr, (uint8_t*)&newAddr, sizeof(uint32_t));
+}
+
+void IPv4Layer::setTimeToLive(uint8_t ttl, bool updateChecksum)
+{
+	makePacketWritable();
+	iphdr* ipHdr = getIPv4Header();
+
+	// the TTL and the protocol share a 16-bit word of the header
+	uint16_t oldWord, newWord;
+	memcpy(&oldWord, &ipHdr->timeToLive, sizeof(oldWord));
+	ipHdr->timeToLive = ttl;
+	memcpy(&newWord, &ipHdr->timeToLive, sizeof(newWord));
+
+	if (updateChecksum)
+		ipHdr->headerChecksum = update_checksum(ipHdr->headerChecksum, oldWord, newWord);
+	else
+		m_IsModified = true;
+}
+
 bool IPv4Layer::isFragment() const
 {
 	return ((getFragmentFlags() & PCPP_IP_MORE_FRAGMENTS) != 0 || getFragmentOffset() != 0);
@@ -3,6 +3,7 @@
 #include "IPv6Layer.h"
 #include "IPv4Layer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "UdpLayer.h"
 #include "TcpLayer.h"
 #include "GreLayer.h"
@@ -204,7 +205,7 @@ void IPv6Layer::parseNextLayer()
 	{
 		if (m_LastExtension->getExtensionType() == IPv6Extension::IPv6Fragmentation)
 		{
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 			return;
 		}
 
@@ -215,40 +216,45 @@ void IPv6Layer::parseNextLayer()
 		nextHdr = getIPv6Header()->nextHeader;
 	}
 
+	// parsers registered by the user to this IP protocol take precedence over the built-in parsing
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::IPProtocolTable, nextHdr, payload, payloadLen, this, m_Packet);
+	if (m_NextLayer != NULL)
+		return;
+
 	switch (nextHdr)
 	{
 	case PACKETPP_IPPROTO_UDP:
-		m_NextLayer = new UdpLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) UdpLayer(payload, payloadLen, this, m_Packet);
 		break;
 	case PACKETPP_IPPROTO_TCP:
 		m_NextLayer = TcpLayer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new TcpLayer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) TcpLayer(payload, payloadLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 		break;
 	case PACKETPP_IPPROTO_IPIP:
 	{
 		uint8_t ipVersion = *payload >> 4;
 		if (ipVersion == 4 && IPv4Layer::isDataValid(payload, payloadLen))
-			m_NextLayer = new IPv4Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet);
 		else if (ipVersion == 6 && IPv6Layer::isDataValid(payload, payloadLen))
-			m_NextLayer = new IPv6Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet);
 		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	}
 	case PACKETPP_IPPROTO_GRE:
 	{
 		ProtocolType greVer = GreLayer::getGREVersion(payload, payloadLen);
 		if (greVer == GREv0)
-			m_NextLayer = new GREv0Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) GREv0Layer(payload, payloadLen, this, m_Packet);
 		else if (greVer == GREv1)
-			m_NextLayer = new GREv1Layer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) GREv1Layer(payload, payloadLen, this, m_Packet);
 		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		break;
 	}
 	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 		return;
 	}
 }
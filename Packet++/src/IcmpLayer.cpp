@@ -56,6 +56,7 @@ bool IcmpLayer::isMessageOfType(IcmpMessageType type) const
 
 bool IcmpLayer::cleanIcmpLayer()
 {
+	makePacketWritable();
 	// remove all layers after
 
 	if (m_Packet != NULL)
@@ -574,12 +575,12 @@ void IcmpLayer::parseNextLayer()
 	case ICMP_REDIRECT:
 	case ICMP_PARAM_PROBLEM:
 		m_NextLayer = IPv4Layer::isDataValid(m_Data + headerLen, m_DataLen - headerLen)
-			? static_cast<Layer*>(new IPv4Layer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet));
+			? static_cast<Layer*>(new(m_Packet) IPv4Layer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet))
+			: static_cast<Layer*>(new(m_Packet) PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet));
 		return;
 	default:
 		if (m_DataLen > headerLen)
-			m_NextLayer = new PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
 		return;
 	}
 }
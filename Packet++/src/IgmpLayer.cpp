@@ -29,6 +29,7 @@ IgmpLayer::IgmpLayer(IgmpType type, const IPv4Address& groupAddr, uint8_t maxRes
 
 void IgmpLayer::setGroupAddress(const IPv4Address& groupAddr)
 {
+	makePacketWritable();
 	igmp_header* hdr = getIgmpHeader();
 	hdr->groupAddress = groupAddr.toInt();
 }
@@ -48,6 +49,7 @@ IgmpType IgmpLayer::getType() const
 
 void IgmpLayer::setType(IgmpType type)
 {
+	makePacketWritable();
 	if (type == IgmpType_Unknown)
 		return;
 
@@ -2,19 +2,97 @@
 
 #include "Layer.h"
 #include <string.h>
+#include <new>
 #include "Logger.h"
 #include "Packet.h"
+#include "LayerArena.h"
 
 namespace pcpp
 {
 
+// every layer allocation is prefixed with the arena it was allocated from (or NULL for heap allocations) so it can be
+// returned to the right place when deleted, and with the allocation size so the memory can be recycled by Packet.
+// The prefix size keeps the layer object aligned like the allocation itself
+#define PCPP_LAYER_ALLOC_PREFIX_SIZE PCPP_LAYER_ARENA_ALIGNMENT
+
+struct LayerAllocPrefix
+{
+	LayerArena* arena;
+	size_t size;
+};
+
+static inline LayerAllocPrefix* getLayerAllocPrefix(const void* ptr)
+{
+	return (LayerAllocPrefix*)((uint8_t*)ptr - PCPP_LAYER_ALLOC_PREFIX_SIZE);
+}
+
+void* Layer::operator new(size_t size)
+{
+	uint8_t* mem = (uint8_t*)::operator new(size + PCPP_LAYER_ALLOC_PREFIX_SIZE);
+	LayerAllocPrefix* prefix = (LayerAllocPrefix*)mem;
+	prefix->arena = NULL;
+	prefix->size = size;
+	return mem + PCPP_LAYER_ALLOC_PREFIX_SIZE;
+}
+
+void* Layer::operator new(size_t size, Packet* packet)
+{
+	if (packet == NULL)
+		return Layer::operator new(size);
+
+	packet->m_NumOfLayerAllocations++;
+
+	if (packet->m_LayerArena != NULL)
+	{
+		uint8_t* mem = (uint8_t*)packet->m_LayerArena->allocate(size + PCPP_LAYER_ALLOC_PREFIX_SIZE);
+		if (mem != NULL)
+		{
+			LayerAllocPrefix* prefix = (LayerAllocPrefix*)mem;
+			prefix->arena = packet->m_LayerArena;
+			prefix->size = size;
+			return mem + PCPP_LAYER_ALLOC_PREFIX_SIZE;
+		}
+	}
+
+	// reuse the memory of a layer of the same size that was recycled when the packet's previous raw packet was replaced
+	for (size_t i = 0; i < packet->m_NumOfRecycledLayers; i++)
+	{
+		void* recycled = packet->m_RecycledLayers[i];
+		if (getLayerAllocPrefix(recycled)->size == size)
+		{
+			packet->m_RecycledLayers[i] = packet->m_RecycledLayers[--packet->m_NumOfRecycledLayers];
+			packet->m_NumOfRecycledLayerAllocations++;
+			return recycled;
+		}
+	}
+
+	return Layer::operator new(size);
+}
+
+void Layer::operator delete(void* ptr)
+{
+	if (ptr == NULL)
+		return;
+
+	LayerAllocPrefix* prefix = getLayerAllocPrefix(ptr);
+	if (prefix->arena != NULL)
+		prefix->arena->deallocate(prefix);
+	else
+		::operator delete(prefix);
+}
+
+void Layer::operator delete(void* ptr, Packet* /*packet*/)
+{
+	Layer::operator delete(ptr);
+}
+
 Layer::~Layer()
 {
 	if (!isAllocatedToPacket())
 		delete [] m_Data;
 }
 
-Layer::Layer(const Layer& other) : m_Packet(NULL), m_Protocol(other.m_Protocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false)
+Layer::Layer(const Layer& other) : m_Packet(NULL), m_Protocol(other.m_Protocol), m_NextLayer(NULL), m_PrevLayer(NULL), m_IsAllocatedInPacket(false), m_IsNextLayerPending(false), m_IsModified(false)
 {
 	m_DataLen = other.getHeaderLen();
 	m_Data = new uint8_t[other.m_DataLen];
@@ -36,11 +114,33 @@ Layer& Layer::operator=(const Layer& other)
 	m_PrevLayer = NULL;
 	m_Data = new uint8_t[other.m_DataLen];
 	m_IsAllocatedInPacket = false;
+	m_IsNextLayerPending = false;
+	m_IsModified = false;
 	memcpy(m_Data, other.m_Data, other.m_DataLen);
 
 	return *this;
 }
 
+bool Layer::isAllocatedOnHeap() const
+{
+	return getLayerAllocPrefix(this)->arena == NULL;
+}
+
+Layer* Layer::parseNextLayerOnDemand() const
+{
+	// in lazy parsing mode only the last parsed layer of the packet can have a pending next layer
+	if (m_Packet != NULL)
+		m_Packet->parseNextLayerOnDemand();
+
+	return m_NextLayer;
+}
+
+void Layer::makePacketWritable()
+{
+	if (m_Packet != NULL)
+		m_Packet->makeWritable();
+}
+
 void Layer::copyData(uint8_t* toArr) const
 {
 	memcpy(toArr, m_Data, m_DataLen);
@@ -0,0 +1,87 @@
+#define LOG_MODULE PacketLogModuleLayer
+
+#include "LayerArena.h"
+#include "Logger.h"
+
+namespace pcpp
+{
+
+LayerArena::LayerArena(size_t slabSize, size_t numOfSlabsToPreallocate) :
+	m_CurSlab(0), m_CurOffset(0), m_NumOfLiveAllocations(0), m_TotalNumOfAllocations(0)
+{
+	// round the slab size up so every chunk starting on a slab boundary stays aligned
+	m_SlabSize = (slabSize + PCPP_LAYER_ARENA_ALIGNMENT - 1) & ~((size_t)PCPP_LAYER_ARENA_ALIGNMENT - 1);
+	if (m_SlabSize == 0)
+		m_SlabSize = PCPP_LAYER_ARENA_DEFAULT_SLAB_SIZE;
+
+	for (size_t i = 0; i < numOfSlabsToPreallocate; i++)
+		m_Slabs.push_back(new uint8_t[m_SlabSize]);
+}
+
+LayerArena::~LayerArena()
+{
+	if (m_NumOfLiveAllocations > 0)
+	{
+		LOG_ERROR("Layer arena is destroyed while %d allocations are still in use", (int)m_NumOfLiveAllocations);
+	}
+
+	for (std::vector<uint8_t*>::iterator iter = m_Slabs.begin(); iter != m_Slabs.end(); iter++)
+	{
+		delete [] *iter;
+	}
+}
+
+void* LayerArena::allocate(size_t size)
+{
+	size_t alignedSize = (size + PCPP_LAYER_ARENA_ALIGNMENT - 1) & ~((size_t)PCPP_LAYER_ARENA_ALIGNMENT - 1);
+	if (alignedSize > m_SlabSize || alignedSize == 0)
+		return NULL;
+
+	// current slab is exhausted - move to the next one and allocate it if needed
+	if (m_CurSlab >= m_Slabs.size() || m_CurOffset + alignedSize > m_SlabSize)
+	{
+		if (m_CurSlab < m_Slabs.size())
+			m_CurSlab++;
+
+		if (m_CurSlab >= m_Slabs.size())
+			m_Slabs.push_back(new uint8_t[m_SlabSize]);
+
+		m_CurOffset = 0;
+	}
+
+	void* result = m_Slabs[m_CurSlab] + m_CurOffset;
+	m_CurOffset += alignedSize;
+	m_NumOfLiveAllocations++;
+	m_TotalNumOfAllocations++;
+	return result;
+}
+
+void LayerArena::deallocate(void* ptr)
+{
+	if (ptr == NULL || m_NumOfLiveAllocations == 0)
+		return;
+
+	m_NumOfLiveAllocations--;
+
+	// all memory was returned, rewind the arena
+	if (m_NumOfLiveAllocations == 0)
+	{
+		m_CurSlab = 0;
+		m_CurOffset = 0;
+	}
+}
+
+bool LayerArena::reset()
+{
+	if (m_NumOfLiveAllocations > 0)
+	{
+		LOG_ERROR("Cannot reset layer arena, %d allocations are still in use", (int)m_NumOfLiveAllocations);
+		return false;
+	}
+
+	m_CurSlab = 0;
+	m_CurOffset = 0;
+	return true;
+}
+
+} // namespace pcpp
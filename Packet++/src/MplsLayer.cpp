@@ -33,6 +33,7 @@ bool MplsLayer::isBottomOfStack() const
 
 void MplsLayer::setBottomOfStack(bool val)
 {
+	makePacketWritable();
 	if (!val)
 		getMplsHeader()->misc &= 0xFE;
 	else
@@ -46,6 +47,7 @@ uint8_t MplsLayer::getExperimentalUseValue() const
 
 bool MplsLayer::setExperimentalUseValue(uint8_t val)
 {
+	makePacketWritable();
 	// exp value is only 3 bits
 	if (val > 7)
 	{
@@ -73,6 +75,7 @@ uint32_t MplsLayer::getMplsLabel() const
 
 bool MplsLayer::setMplsLabel(uint32_t label)
 {
+	makePacketWritable();
 	if (label > 0xFFFFF)
 	{
 		LOG_ERROR("MPLS label mustn't exceed 20 bits which is the value %d. Got a parameter with the value %d", 0xFFFFF, label);
@@ -111,7 +114,7 @@ void MplsLayer::parseNextLayer()
 
 	if (!isBottomOfStack())
 	{
-		m_NextLayer = new MplsLayer(payload, payloadLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) MplsLayer(payload, payloadLen, this, m_Packet);
 		return;
 	}
 
@@ -120,16 +123,16 @@ void MplsLayer::parseNextLayer()
 	{
 		case 4:
 			m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-				? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-				: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+				? static_cast<Layer*>(new(m_Packet) IPv4Layer(payload, payloadLen, this, m_Packet))
+				: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 			break;
 		case 6:
 			m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-				? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-				: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
+				? static_cast<Layer*>(new(m_Packet) IPv6Layer(payload, payloadLen, this, m_Packet))
+				: static_cast<Layer*>(new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet));
 			break;
 		default:
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+			m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 	}
 }
 
@@ -0,0 +1,491 @@
+#define LOG_MODULE PacketLogModuleLayer
+
+#include "NextLayerRegistry.h"
+#include "Logger.h"
+#include "EthLayer.h"
+#include "ArpLayer.h"
+#include "VlanLayer.h"
+#include "PPPoELayer.h"
+#include "MplsLayer.h"
+#include "IPv4Layer.h"
+#include "IPv6Layer.h"
+#include "TcpLayer.h"
+#include "UdpLayer.h"
+#include "PayloadLayer.h"
+#include "HttpLayer.h"
+#include "SSLLayer.h"
+#include "SipLayer.h"
+#include "BgpLayer.h"
+#include "DhcpLayer.h"
+#include "VxlanLayer.h"
+#include "DnsLayer.h"
+#include "RadiusLayer.h"
+#include "GtpLayer.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace pcpp
+{
+
+// ---------------------------------
+// built-in parsers over EtherType
+// ---------------------------------
+
+static Layer* parseIPv4OverEtherType(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (!IPv4Layer::isDataValid(data, dataLen))
+		return NULL;
+
+	return new(packet) IPv4Layer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseIPv6OverEtherType(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (!IPv6Layer::isDataValid(data, dataLen))
+		return NULL;
+
+	return new(packet) IPv6Layer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseArp(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) ArpLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseVlan(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) VlanLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parsePPPoESession(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) PPPoESessionLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parsePPPoEDiscovery(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) PPPoEDiscoveryLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseMpls(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) MplsLayer(data, dataLen, prevLayer, packet);
+}
+
+// ---------------------------------
+// built-in parsers over TCP
+// ---------------------------------
+
+static Layer* parseHttpRequest(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (HttpRequestFirstLine::parseMethod((char*)data, dataLen) == HttpRequestLayer::HttpMethodUnknown)
+		return NULL;
+
+	return new(packet) HttpRequestLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseHttpResponse(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (HttpResponseFirstLine::parseStatusCode((char*)data, dataLen) == HttpResponseLayer::HttpStatusCodeUnknown)
+		return NULL;
+
+	return new(packet) HttpResponseLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseSSL(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	// the ports were already matched by the registry
+	if (!SSLLayer::IsSSLMessage(0, 0, data, dataLen, true))
+		return NULL;
+
+	return SSLLayer::createSSLMessage(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseSipOverTcp(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (SipRequestFirstLine::parseMethod((char*)data, dataLen) != SipRequestLayer::SipMethodUnknown)
+		return new(packet) SipRequestLayer(data, dataLen, prevLayer, packet);
+
+	if (SipResponseFirstLine::parseStatusCode((char*)data, dataLen) != SipResponseLayer::SipStatusCodeUnknown)
+		return new(packet) SipResponseLayer(data, dataLen, prevLayer, packet);
+
+	return NULL;
+}
+
+static Layer* parseBgp(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return BgpLayer::parseBgpLayer(data, dataLen, prevLayer, packet);
+}
+
+// ---------------------------------
+// built-in parsers over UDP
+// ---------------------------------
+
+static Layer* parseDhcp(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	// DHCP uses port 67 for the server and 68 for the client (or 67 for a relay agent)
+	UdpLayer* udpLayer = (UdpLayer*)prevLayer;
+	uint16_t portSrc = udpLayer->getSrcPort();
+	uint16_t portDst = udpLayer->getDstPort();
+	if (!((portSrc == 68 && portDst == 67) || (portSrc == 67 && portDst == 68) || (portSrc == 67 && portDst == 67)))
+		return NULL;
+
+	return new(packet) DhcpLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseVxlan(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) VxlanLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseDns(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (dataLen < sizeof(dnshdr))
+		return NULL;
+
+	return new(packet) DnsLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseSipOverUdp(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (SipRequestFirstLine::parseMethod((char*)data, dataLen) != SipRequestLayer::SipMethodUnknown)
+		return new(packet) SipRequestLayer(data, dataLen, prevLayer, packet);
+
+	if (SipResponseFirstLine::parseStatusCode((char*)data, dataLen) != SipResponseLayer::SipStatusCodeUnknown
+			&& SipResponseFirstLine::parseVersion((char*)data, dataLen) != "")
+		return new(packet) SipResponseLayer(data, dataLen, prevLayer, packet);
+
+	return NULL;
+}
+
+static Layer* parseRadius(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (!RadiusLayer::isDataValid(data, dataLen))
+		return NULL;
+
+	return new(packet) RadiusLayer(data, dataLen, prevLayer, packet);
+}
+
+static Layer* parseGtpV1(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	if (!GtpV1Layer::isGTPv1(data, dataLen))
+		return NULL;
+
+	return new(packet) GtpV1Layer(data, dataLen, prevLayer, packet);
+}
+
+// ---------------------------------
+// NextLayerRegistry methods
+// ---------------------------------
+
+// the number of keys of each dispatch table
+static const size_t DispatchTableSizes[NextLayerRegistry::NumOfDispatchTables] = { 65536, 65536, 65536, 256 };
+
+NextLayerRegistry::NextLayerRegistry()
+{
+	memset(m_KeyMasks, 0, sizeof(m_KeyMasks));
+	memset(m_Parsers, 0, sizeof(m_Parsers));
+	registerBuiltInParsers();
+}
+
+NextLayerRegistry::~NextLayerRegistry()
+{
+	clear();
+}
+
+void NextLayerRegistry::clear()
+{
+	for (int table = 0; table < NumOfDispatchTables; table++)
+	{
+		free(m_KeyMasks[table]);
+		m_KeyMasks[table] = NULL;
+	}
+
+	memset(m_Parsers, 0, sizeof(m_Parsers));
+}
+
+void NextLayerRegistry::registerBuiltInParsers()
+{
+	// the order of registration is the order in which parsers registered to the same key are tried
+
+	static const uint16_t etherTypes[] = { PCPP_ETHERTYPE_IP, PCPP_ETHERTYPE_IPV6, PCPP_ETHERTYPE_ARP, PCPP_ETHERTYPE_VLAN,
+			PCPP_ETHERTYPE_PPPOES, PCPP_ETHERTYPE_PPPOED, PCPP_ETHERTYPE_MPLS };
+	static const NextLayerParser etherTypeParsers[] = { parseIPv4OverEtherType, parseIPv6OverEtherType, parseArp, parseVlan,
+			parsePPPoESession, parsePPPoEDiscovery, parseMpls };
+	static const ProtocolType etherTypeProtocols[] = { IPv4, IPv6, ARP, VLAN, PPPoESession, PPPoEDiscovery, MPLS };
+	for (size_t i = 0; i < sizeof(etherTypes)/sizeof(etherTypes[0]); i++)
+		registerParser(EtherTypeTable, etherTypes[i], etherTypeParsers[i], etherTypeProtocols[i]);
+
+	static const uint16_t httpPorts[] = { 80, 8080 };
+	for (size_t i = 0; i < sizeof(httpPorts)/sizeof(httpPorts[0]); i++)
+		registerParser(TcpPortTable, httpPorts[i], parseHttpRequest, HTTPRequest, MatchDstPort);
+	for (size_t i = 0; i < sizeof(httpPorts)/sizeof(httpPorts[0]); i++)
+		registerParser(TcpPortTable, httpPorts[i], parseHttpResponse, HTTPResponse, MatchSrcPort);
+
+	static const uint16_t sslPorts[] = { 443, 261, 448, 465, 563, 614, 636, 989, 990, 992, 993, 994, 995 };
+	for (size_t i = 0; i < sizeof(sslPorts)/sizeof(sslPorts[0]); i++)
+		registerParser(TcpPortTable, sslPorts[i], parseSSL, SSL);
+
+	static const uint16_t sipPorts[] = { 5060, 5061 };
+	for (size_t i = 0; i < sizeof(sipPorts)/sizeof(sipPorts[0]); i++)
+		registerParser(TcpPortTable, sipPorts[i], parseSipOverTcp, SIP, MatchDstPort);
+
+	registerParser(TcpPortTable, 179, parseBgp, BGP);
+
+	registerParser(UdpPortTable, 67, parseDhcp, DHCP);
+	registerParser(UdpPortTable, 68, parseDhcp, DHCP);
+
+	registerParser(UdpPortTable, 4789, parseVxlan, VXLAN, MatchDstPort);
+
+	static const uint16_t dnsPorts[] = { 53, 5353, 5355 };
+	for (size_t i = 0; i < sizeof(dnsPorts)/sizeof(dnsPorts[0]); i++)
+		registerParser(UdpPortTable, dnsPorts[i], parseDns, DNS);
+
+	for (size_t i = 0; i < sizeof(sipPorts)/sizeof(sipPorts[0]); i++)
+		registerParser(UdpPortTable, sipPorts[i], parseSipOverUdp, SIP);
+
+	static const uint16_t radiusPorts[] = { 1812, 1813, 3799 };
+	for (size_t i = 0; i < sizeof(radiusPorts)/sizeof(radiusPorts[0]); i++)
+		registerParser(UdpPortTable, radiusPorts[i], parseRadius, Radius);
+
+	// GTP-U and GTP-C
+	registerParser(UdpPortTable, 2152, parseGtpV1, GTPv1);
+	registerParser(UdpPortTable, 2123, parseGtpV1, GTPv1);
+}
+
+void NextLayerRegistry::resetToDefault()
+{
+	clear();
+	registerBuiltInParsers();
+}
+
+bool NextLayerRegistry::isKeyValid(DispatchTable table, uint16_t key) const
+{
+	if (table < 0 || table >= NumOfDispatchTables)
+	{
+		LOG_ERROR("Unknown dispatch table %d", (int)table);
+		return false;
+	}
+
+	if ((size_t)key >= DispatchTableSizes[table])
+	{
+		LOG_ERROR("Key %d is out of the range of the dispatch table", (int)key);
+		return false;
+	}
+
+	return true;
+}
+
+bool NextLayerRegistry::registerParser(DispatchTable table, uint16_t key, NextLayerParser parser, ProtocolType protocol, PortMatch portMatch)
+{
+	if (parser == NULL)
+	{
+		LOG_ERROR("Parser is NULL");
+		return false;
+	}
+
+	if (!isKeyValid(table, key))
+		return false;
+
+	// port matching is meaningless for keys other than ports
+	if (table != TcpPortTable && table != UdpPortTable)
+		portMatch = MatchSrcOrDstPort;
+
+	// a parser occupies one slot per port matching. Find its slot or the first free one
+	int slot = -1;
+	int freeSlot = -1;
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+	{
+		ParserSlot& curSlot = m_Parsers[table][i];
+		if (curSlot.numOfKeys == 0)
+		{
+			if (freeSlot < 0)
+				freeSlot = i;
+		}
+		else if (curSlot.parser == parser && curSlot.portMatch == portMatch)
+		{
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot < 0)
+	{
+		if (freeSlot < 0)
+		{
+			LOG_ERROR("Cannot register more than %d parsers in a dispatch table", PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS);
+			return false;
+		}
+
+		slot = freeSlot;
+		m_Parsers[table][slot].parser = parser;
+		m_Parsers[table][slot].protocol = protocol;
+		m_Parsers[table][slot].portMatch = portMatch;
+	}
+
+	if (m_KeyMasks[table] == NULL)
+	{
+		// calloc leaves the pages of the table that are never written to untouched
+		m_KeyMasks[table] = (uint32_t*)calloc(DispatchTableSizes[table], sizeof(uint32_t));
+		if (m_KeyMasks[table] == NULL)
+		{
+			LOG_ERROR("Couldn't allocate dispatch table");
+			return false;
+		}
+	}
+
+	uint32_t slotBit = (uint32_t)1 << slot;
+	if ((m_KeyMasks[table][key] & slotBit) == 0)
+	{
+		m_KeyMasks[table][key] |= slotBit;
+		m_Parsers[table][slot].numOfKeys++;
+	}
+
+	return true;
+}
+
+bool NextLayerRegistry::registerProtocol(DispatchTable table, uint16_t key, ProtocolType protocol)
+{
+	if (!isKeyValid(table, key))
+		return false;
+
+	// registering a parser with the same port matching reuses its slot, so no slots are added while iterating
+	bool found = false;
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+	{
+		ParserSlot& slot = m_Parsers[table][i];
+		if (slot.numOfKeys > 0 && (slot.protocol & protocol) != 0)
+		{
+			registerParser(table, key, slot.parser, slot.protocol, slot.portMatch);
+			found = true;
+		}
+	}
+
+	if (!found)
+		LOG_ERROR("No parser of the requested protocol is registered in the dispatch table");
+
+	return found;
+}
+
+void NextLayerRegistry::unregisterSlotFromKey(DispatchTable table, uint16_t key, int slot)
+{
+	uint32_t slotBit = (uint32_t)1 << slot;
+	if (m_KeyMasks[table] == NULL || (m_KeyMasks[table][key] & slotBit) == 0)
+		return;
+
+	m_KeyMasks[table][key] &= ~slotBit;
+	m_Parsers[table][slot].numOfKeys--;
+}
+
+bool NextLayerRegistry::unregisterParser(DispatchTable table, uint16_t key, NextLayerParser parser)
+{
+	if (!isKeyValid(table, key) || m_KeyMasks[table] == NULL)
+		return false;
+
+	bool found = false;
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+	{
+		if (m_Parsers[table][i].parser == parser && (m_KeyMasks[table][key] & ((uint32_t)1 << i)) != 0)
+		{
+			unregisterSlotFromKey(table, key, i);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool NextLayerRegistry::unregisterProtocol(DispatchTable table, uint16_t key, ProtocolType protocol)
+{
+	if (!isKeyValid(table, key) || m_KeyMasks[table] == NULL)
+		return false;
+
+	bool found = false;
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+	{
+		if ((m_Parsers[table][i].protocol & protocol) != 0 && (m_KeyMasks[table][key] & ((uint32_t)1 << i)) != 0)
+		{
+			unregisterSlotFromKey(table, key, i);
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+bool NextLayerRegistry::unregisterProtocol(DispatchTable table, ProtocolType protocol)
+{
+	if (!isKeyValid(table, 0) || m_KeyMasks[table] == NULL)
+		return false;
+
+	uint32_t slotsToRemove = 0;
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+	{
+		if (m_Parsers[table][i].numOfKeys > 0 && (m_Parsers[table][i].protocol & protocol) != 0)
+		{
+			slotsToRemove |= (uint32_t)1 << i;
+			m_Parsers[table][i].numOfKeys = 0;
+		}
+	}
+
+	if (slotsToRemove == 0)
+		return false;
+
+	for (size_t key = 0; key < DispatchTableSizes[table]; key++)
+		m_KeyMasks[table][key] &= ~slotsToRemove;
+
+	return true;
+}
+
+void NextLayerRegistry::unregisterKey(DispatchTable table, uint16_t key)
+{
+	if (!isKeyValid(table, key) || m_KeyMasks[table] == NULL)
+		return;
+
+	for (int i = 0; i < PCPP_NEXT_LAYER_REGISTRY_MAX_PARSERS; i++)
+		unregisterSlotFromKey(table, key, i);
+}
+
+bool NextLayerRegistry::isProtocolRegistered(DispatchTable table, uint16_t key, ProtocolType protocol) const
+{
+	if (table < 0 || table >= NumOfDispatchTables || (size_t)key >= DispatchTableSizes[table] || m_KeyMasks[table] == NULL)
+		return false;
+
+	uint32_t keyMask = m_KeyMasks[table][key];
+	for (int i = 0; keyMask != 0; i++, keyMask >>= 1)
+	{
+		if ((keyMask & 1) != 0 && (m_Parsers[table][i].protocol & protocol) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+Layer* NextLayerRegistry::parseByMasks(DispatchTable table, uint32_t srcMask, uint32_t dstMask, uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) const
+{
+	// for tables keyed by a single value srcMask and dstMask are the same
+	uint32_t candidates = srcMask | dstMask;
+	for (int i = 0; candidates != 0; i++, candidates >>= 1)
+	{
+		if ((candidates & 1) == 0)
+			continue;
+
+		const ParserSlot& slot = m_Parsers[table][i];
+		uint32_t slotBit = (uint32_t)1 << i;
+		if ((slot.portMatch == MatchSrcPort && (srcMask & slotBit) == 0) || (slot.portMatch == MatchDstPort && (dstMask & slotBit) == 0))
+			continue;
+
+		Layer* nextLayer = slot.parser(data, dataLen, prevLayer, packet);
+		if (nextLayer != NULL)
+			return nextLayer;
+	}
+
+	return NULL;
+}
+
+Layer* NextLayerRegistry::parseAsPayload(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet)
+{
+	return new(packet) PayloadLayer(data, dataLen, prevLayer, packet);
+}
+
+} // namespace pcpp
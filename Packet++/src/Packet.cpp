@@ -16,6 +16,7 @@
 #include <sstream>
 #ifdef _MSC_VER
 #include <time.h>
+#include <intrin.h>
 #include "SystemUtils.h"
 #endif
 
@@ -23,90 +24,202 @@
 namespace pcpp
 {
 
-Packet::Packet(size_t maxPacketLen) :
+// the reference count of a raw packet shared by copy-on-write clones is updated atomically since clones may be used by different threads
+static inline long incrementSharedRefCount(long* refCount)
+{
+#ifdef _MSC_VER
+	return _InterlockedIncrement(refCount);
+#else
+	return __sync_add_and_fetch(refCount, 1);
+#endif
+}
+
+static inline long decrementSharedRefCount(long* refCount)
+{
+#ifdef _MSC_VER
+	return _InterlockedDecrement(refCount);
+#else
+	return __sync_sub_and_fetch(refCount, 1);
+#endif
+}
+
+static inline long* loadSharedRefCount(long* const* refCountPtr)
+{
+#ifdef _MSC_VER
+	long* refCount = *(long* const volatile*)refCountPtr;
+	_ReadWriteBarrier();
+	return refCount;
+#else
+	return __atomic_load_n(refCountPtr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline long getSharedRefCount(const long* refCount)
+{
+#ifdef _MSC_VER
+	long value = *(const volatile long*)refCount;
+	_ReadWriteBarrier();
+	return value;
+#else
+	return __atomic_load_n(refCount, __ATOMIC_ACQUIRE);
+#endif
+}
+
+// set the reference count pointer if it's still NULL, and return the pointer it had before
+static inline long* setSharedRefCountIfNull(long** refCountPtr, long* refCount)
+{
+#ifdef _MSC_VER
+	return (long*)_InterlockedCompareExchangePointer((void* volatile*)refCountPtr, refCount, NULL);
+#else
+	return __sync_val_compare_and_swap(refCountPtr, (long*)NULL, refCount);
+#endif
+}
+
+Packet::Packet(size_t maxPacketLen, size_t headroom) :
 	m_RawPacket(NULL),
 	m_FirstLayer(NULL),
 	m_LastLayer(NULL),
 	m_ProtocolTypes(UnknownProtocol),
 	m_MaxPacketLen(maxPacketLen),
-	m_FreeRawPacket(true)
+	m_FreeRawPacket(true),
+	m_LayerArena(NULL),
+	m_ParseUntil(UnknownProtocol),
+	m_ParseUntilLayer(OsiModelLayerUnknown),
+	m_LazyParsing(false),
+	m_NumOfRecycledLayers(0),
+	m_NumOfLayerAllocations(0),
+	m_NumOfRecycledLayerAllocations(0),
+	m_SharedRawDataRefCount(NULL)
 {
 	timeval time;
 	gettimeofday(&time, NULL);
-	uint8_t* data = new uint8_t[maxPacketLen];
-	memset(data, 0, maxPacketLen);
-	m_RawPacket = new RawPacket(data, 0, time, true, LINKTYPE_ETHERNET);
+	m_RawPacket = new RawPacket(NULL, 0, time, true, LINKTYPE_ETHERNET);
+	m_RawPacket->reallocateData(maxPacketLen, headroom);
 }
 
-void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+void Packet::setRawPacket(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer, LayerArena* layerArena, bool lazyParsing)
 {
-	destructPacketData();
+	destructPacketData(true);
 
+	m_LayerArena = layerArena;
+	m_ParseUntil = parseUntil;
+	m_ParseUntilLayer = parseUntilLayer;
+	m_LazyParsing = lazyParsing;
 	m_FirstLayer = NULL;
 	m_LastLayer = NULL;
 	m_ProtocolTypes = UnknownProtocol;
-	m_MaxPacketLen = rawPacket->getRawDataLen();
+	m_MaxPacketLen = 0;
 	m_FreeRawPacket = freeRawPacket;
 	m_RawPacket = rawPacket;
 	if (m_RawPacket == NULL)
 		return;
 
+	m_MaxPacketLen = rawPacket->getRawDataLen() + rawPacket->getTailroom();
+
 	LinkLayerType linkType = m_RawPacket->getLinkLayerType();
 
 	m_FirstLayer = createFirstLayer(linkType);
+	if (m_FirstLayer == NULL)
+		return;
 
-	m_LastLayer = m_FirstLayer;
-	Layer* curLayer = m_FirstLayer;
-	while (curLayer != NULL && (curLayer->getProtocol() & parseUntil) == 0 && curLayer->getOsiModelLayer() <= parseUntilLayer)
+	m_FirstLayer->m_IsAllocatedInPacket = true;
+
+	if (m_FirstLayer->getOsiModelLayer() > parseUntilLayer)
 	{
-		m_ProtocolTypes |= curLayer->getProtocol();
-		curLayer->parseNextLayer();
-		curLayer->m_IsAllocatedInPacket = true;
-		curLayer = curLayer->getNextLayer();
-		if (curLayer != NULL)
-			m_LastLayer = curLayer;
+		delete m_FirstLayer;
+		m_FirstLayer = NULL;
+		return;
 	}
 
-	if (curLayer != NULL && (curLayer->getProtocol() & parseUntil) != 0)
+	m_LastLayer = m_FirstLayer;
+	m_ProtocolTypes |= m_FirstLayer->getProtocol();
+	if ((m_FirstLayer->getProtocol() & parseUntil) != 0)
+		return;
+
+	m_FirstLayer->m_IsNextLayerPending = true;
+
+	// in lazy mode the rest of the layers are parsed on demand
+	if (!m_LazyParsing)
+		parseRemainingLayers();
+}
+
+void Packet::parseNextLayerOnDemand()
+{
+	Layer* curLayer = m_LastLayer;
+	if (curLayer == NULL || !curLayer->m_IsNextLayerPending)
+		return;
+
+	curLayer->m_IsNextLayerPending = false;
+	curLayer->parseNextLayer();
+
+	Layer* nextLayer = curLayer->m_NextLayer;
+	if (nextLayer == NULL)
 	{
-		m_ProtocolTypes |= curLayer->getProtocol();
-		curLayer->m_IsAllocatedInPacket = true;
+		if (m_ParseUntil == UnknownProtocol && m_ParseUntilLayer == OsiModelLayerUnknown)
+			addPacketTrailerLayer();
+
+		return;
 	}
 
-	if (curLayer != NULL &&  curLayer->getOsiModelLayer() > parseUntilLayer)
+	nextLayer->m_IsAllocatedInPacket = true;
+
+	if (nextLayer->getOsiModelLayer() > m_ParseUntilLayer)
 	{
-		m_LastLayer = curLayer->getPrevLayer();
-		delete curLayer;
-		m_LastLayer->m_NextLayer = NULL;
+		delete nextLayer;
+		curLayer->m_NextLayer = NULL;
+		return;
 	}
 
-	if (m_LastLayer != NULL && parseUntil == UnknownProtocol && parseUntilLayer == OsiModelLayerUnknown)
+	m_LastLayer = nextLayer;
+	m_ProtocolTypes |= nextLayer->getProtocol();
+	if ((nextLayer->getProtocol() & m_ParseUntil) == 0)
+		nextLayer->m_IsNextLayerPending = true;
+}
+
+void Packet::parseRemainingLayers()
+{
+	while (m_LastLayer != NULL && m_LastLayer->m_IsNextLayerPending)
+		parseNextLayerOnDemand();
+}
+
+bool Packet::isPacketOfTypeOnDemand(ProtocolType protocolType)
+{
+	while ((m_ProtocolTypes & protocolType) == 0 && m_LastLayer != NULL && m_LastLayer->m_IsNextLayerPending)
+		parseNextLayerOnDemand();
+
+	return m_ProtocolTypes & protocolType;
+}
+
+void Packet::addPacketTrailerLayer()
+{
+	// find if there is data left in the raw packet that doesn't belong to any layer. In that case it's probably a packet trailer.
+	// create a PacketTrailerLayer layer and add it at the end of the packet
+	int trailerLen = (int)((m_RawPacket->getRawData() + m_RawPacket->getRawDataLen()) - (m_LastLayer->getData() + m_LastLayer->getDataLen()));
+	if (trailerLen > 0)
 	{
-		// find if there is data left in the raw packet that doesn't belong to any layer. In that case it's probably a packet trailer.
-		// create a PacketTrailerLayer layer and add it at the end of the packet
-		int trailerLen = (int)((m_RawPacket->getRawData() + m_RawPacket->getRawDataLen()) - (m_LastLayer->getData() + m_LastLayer->getDataLen()));
-		if (trailerLen > 0)
-		{
-			PacketTrailerLayer* trailerLayer = new PacketTrailerLayer(
-					(uint8_t*)(m_LastLayer->getData() + m_LastLayer->getDataLen()),
-					trailerLen,
-					m_LastLayer,
-					this);
-
-			trailerLayer->m_IsAllocatedInPacket = true;
-			m_LastLayer->setNextLayer(trailerLayer);
-			m_LastLayer = trailerLayer;
-			m_ProtocolTypes |= trailerLayer->getProtocol();
-		}
+		PacketTrailerLayer* trailerLayer = new(this) PacketTrailerLayer(
+				(uint8_t*)(m_LastLayer->getData() + m_LastLayer->getDataLen()),
+				trailerLen,
+				m_LastLayer,
+				this);
+
+		trailerLayer->m_IsAllocatedInPacket = true;
+		m_LastLayer->setNextLayer(trailerLayer);
+		m_LastLayer = trailerLayer;
+		m_ProtocolTypes |= trailerLayer->getProtocol();
 	}
 }
 
-Packet::Packet(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer)
+Packet::Packet(RawPacket* rawPacket, bool freeRawPacket, ProtocolType parseUntil, OsiModelLayer parseUntilLayer, LayerArena* layerArena, bool lazyParsing)
 {
 	m_FreeRawPacket = false;
 	m_RawPacket = NULL;
 	m_FirstLayer = NULL;
-	setRawPacket(rawPacket, freeRawPacket, parseUntil, parseUntilLayer);
+	m_NumOfRecycledLayers = 0;
+	m_NumOfLayerAllocations = 0;
+	m_NumOfRecycledLayerAllocations = 0;
+	m_SharedRawDataRefCount = NULL;
+	setRawPacket(rawPacket, freeRawPacket, parseUntil, parseUntilLayer, layerArena, lazyParsing);
 }
 
 Packet::Packet(RawPacket* rawPacket, ProtocolType parseUntil)
@@ -114,6 +227,10 @@ Packet::Packet(RawPacket* rawPacket, ProtocolType parseUntil)
 	m_FreeRawPacket = false;
 	m_RawPacket = NULL;
 	m_FirstLayer = NULL;
+	m_NumOfRecycledLayers = 0;
+	m_NumOfLayerAllocations = 0;
+	m_NumOfRecycledLayerAllocations = 0;
+	m_SharedRawDataRefCount = NULL;
 	setRawPacket(rawPacket, false, parseUntil, OsiModelLayerUnknown);
 }
 
@@ -122,24 +239,154 @@ Packet::Packet(RawPacket* rawPacket, OsiModelLayer parseUntilLayer)
 	m_FreeRawPacket = false;
 	m_RawPacket = NULL;
 	m_FirstLayer = NULL;
+	m_NumOfRecycledLayers = 0;
+	m_NumOfLayerAllocations = 0;
+	m_NumOfRecycledLayerAllocations = 0;
+	m_SharedRawDataRefCount = NULL;
 	setRawPacket(rawPacket, false, UnknownProtocol, parseUntilLayer);
 }
 
-void Packet::destructPacketData()
+void Packet::destructPacketData(bool recycleLayers)
 {
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != NULL)
 	{
-		Layer* nextLayer = curLayer->getNextLayer();
+		// use the next layer pointer directly so layers that weren't parsed yet (in lazy mode) aren't parsed now
+		Layer* nextLayer = curLayer->m_NextLayer;
 		if (curLayer->m_IsAllocatedInPacket)
-			delete curLayer;
+		{
+			if (recycleLayers)
+				recycleLayer(curLayer);
+			else
+				delete curLayer;
+		}
 		curLayer = nextLayer;
 	}
 
-	if (m_RawPacket != NULL && m_FreeRawPacket)
+	releaseRawPacket();
+}
+
+void Packet::releaseRawPacket()
+{
+	if (m_SharedRawDataRefCount != NULL)
+	{
+		// the last packet sharing the raw packet frees it
+		if (decrementSharedRefCount(m_SharedRawDataRefCount) == 0)
+		{
+			delete m_SharedRawDataRefCount;
+			if (m_FreeRawPacket)
+				delete m_RawPacket;
+		}
+
+		m_SharedRawDataRefCount = NULL;
+	}
+	else if (m_RawPacket != NULL && m_FreeRawPacket)
 	{
 		delete m_RawPacket;
 	}
+
+	m_RawPacket = NULL;
+}
+
+Packet::Packet(const Packet& other, bool copyOnWrite) :
+	m_RawPacket(NULL),
+	m_FirstLayer(NULL),
+	m_FreeRawPacket(false),
+	m_NumOfRecycledLayers(0),
+	m_NumOfLayerAllocations(0),
+	m_NumOfRecycledLayerAllocations(0),
+	m_SharedRawDataRefCount(NULL)
+{
+	if (!copyOnWrite || other.m_RawPacket == NULL)
+	{
+		copyDataFrom(other);
+		return;
+	}
+
+	// the layers aren't copied, they're parsed lazily from the shared data so only the layers the user looks at are created
+	setRawPacket(other.m_RawPacket, other.m_FreeRawPacket, UnknownProtocol, OsiModelLayerUnknown, NULL, true);
+
+	// the reference count is created by the first clone (with a count of 1 for the other packet). Several threads may clone the same
+	// packet at once, so it's published with a compare-and-swap and a thread that loses the race uses the winner's count
+	long* sharedRefCount = loadSharedRefCount(&other.m_SharedRawDataRefCount);
+	if (sharedRefCount == NULL)
+	{
+		long* newRefCount = new long(1);
+		sharedRefCount = setSharedRefCountIfNull(&other.m_SharedRawDataRefCount, newRefCount);
+		if (sharedRefCount == NULL)
+			sharedRefCount = newRefCount;
+		else
+			delete newRefCount;
+	}
+
+	incrementSharedRefCount(sharedRefCount);
+	m_SharedRawDataRefCount = sharedRefCount;
+}
+
+bool Packet::isRawDataShared() const
+{
+	long* sharedRefCount = loadSharedRefCount(&m_SharedRawDataRefCount);
+	return sharedRefCount != NULL && getSharedRefCount(sharedRefCount) > 1;
+}
+
+void Packet::makeWritable()
+{
+	if (m_SharedRawDataRefCount == NULL)
+		return;
+
+	// all of the other packets which shared the raw packet released it, so this packet owns it and can keep it. No other packet
+	// can take a share meanwhile since that requires cloning this packet, which mustn't be done while it's modified
+	if (getSharedRefCount(m_SharedRawDataRefCount) == 1)
+	{
+		delete m_SharedRawDataRefCount;
+		m_SharedRawDataRefCount = NULL;
+		return;
+	}
+
+	RawPacket* sharedRawPacket = m_RawPacket;
+	bool freeSharedRawPacket = m_FreeRawPacket;
+	long* sharedRefCount = m_SharedRawDataRefCount;
+
+	// copy the shared raw packet and set all data pointers in layers to the copy
+	m_RawPacket = new RawPacket(*sharedRawPacket);
+	m_FreeRawPacket = true;
+	m_SharedRawDataRefCount = NULL;
+	m_MaxPacketLen = m_RawPacket->getRawDataLen() + m_RawPacket->getTailroom();
+
+	const uint8_t* sharedData = sharedRawPacket->getRawData();
+	uint8_t* newData = (uint8_t*)m_RawPacket->getRawData();
+	for (Layer* curLayer = m_FirstLayer; curLayer != NULL; curLayer = curLayer->m_NextLayer)
+		curLayer->m_Data = newData + (curLayer->m_Data - sharedData);
+
+	// other packets may have released their share meanwhile, so this packet may be the last one sharing the raw packet
+	if (decrementSharedRefCount(sharedRefCount) == 0)
+	{
+		delete sharedRefCount;
+		if (freeSharedRawPacket)
+			delete sharedRawPacket;
+	}
+}
+
+void Packet::recycleLayer(Layer* layer)
+{
+	// layers allocated from an arena are cheap to allocate, and keeping them would prevent the arena from rewinding
+	if (m_NumOfRecycledLayers >= PCPP_PACKET_MAX_RECYCLED_LAYERS || !layer->isAllocatedOnHeap())
+	{
+		delete layer;
+		return;
+	}
+
+	// destruct the layer but keep its memory, Layer::operator new(size_t, Packet*) will reuse it
+	layer->~Layer();
+	m_RecycledLayers[m_NumOfRecycledLayers++] = layer;
+}
+
+void Packet::freeRecycledLayers()
+{
+	for (size_t i = 0; i < m_NumOfRecycledLayers; i++)
+		Layer::operator delete(m_RecycledLayers[i]);
+
+	m_NumOfRecycledLayers = 0;
 }
 
 Packet& Packet::operator=(const Packet& other)
@@ -151,17 +398,73 @@ Packet& Packet::operator=(const Packet& other)
 	return *this;
 }
 
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+Packet::Packet(Packet&& other) : m_NumOfRecycledLayers(0), m_NumOfLayerAllocations(0), m_NumOfRecycledLayerAllocations(0), m_SharedRawDataRefCount(NULL)
+{
+	moveDataFrom(other);
+}
+
+Packet& Packet::operator=(Packet&& other)
+{
+	if (this == &other)
+		return *this;
+
+	destructPacketData();
+
+	moveDataFrom(other);
+
+	return *this;
+}
+#endif
+
+void Packet::moveDataFrom(Packet& other)
+{
+	m_RawPacket = other.m_RawPacket;
+	m_FreeRawPacket = other.m_FreeRawPacket;
+	m_FirstLayer = other.m_FirstLayer;
+	m_LastLayer = other.m_LastLayer;
+	m_ProtocolTypes = other.m_ProtocolTypes;
+	m_MaxPacketLen = other.m_MaxPacketLen;
+	m_LayerArena = other.m_LayerArena;
+	m_ParseUntil = other.m_ParseUntil;
+	m_ParseUntilLayer = other.m_ParseUntilLayer;
+	m_LazyParsing = other.m_LazyParsing;
+	m_SharedRawDataRefCount = other.m_SharedRawDataRefCount;
+
+	// the layers keep a pointer to their packet. Use the next layer pointer directly so layers that weren't parsed yet (in lazy mode)
+	// aren't parsed now
+	for (Layer* curLayer = m_FirstLayer; curLayer != NULL; curLayer = curLayer->m_NextLayer)
+		curLayer->m_Packet = this;
+
+	// the recycled layers stay with the other packet, which is left empty
+	other.m_RawPacket = NULL;
+	other.m_FreeRawPacket = false;
+	other.m_FirstLayer = NULL;
+	other.m_LastLayer = NULL;
+	other.m_ProtocolTypes = UnknownProtocol;
+	other.m_MaxPacketLen = 0;
+	other.m_LayerArena = NULL;
+	other.m_SharedRawDataRefCount = NULL;
+}
+
 void Packet::copyDataFrom(const Packet& other)
 {
 	m_RawPacket = new RawPacket(*(other.m_RawPacket));
 	m_FreeRawPacket = true;
-	m_MaxPacketLen = other.m_MaxPacketLen;
+	m_LayerArena = NULL;
+	m_ParseUntil = UnknownProtocol;
+	m_ParseUntilLayer = OsiModelLayerUnknown;
+	m_LazyParsing = false;
+	// the copied raw data keeps the headroom and tailroom of the other raw packet
+	m_MaxPacketLen = m_RawPacket->getRawDataLen() + m_RawPacket->getTailroom();
 	m_ProtocolTypes = other.m_ProtocolTypes;
 	m_FirstLayer = createFirstLayer(m_RawPacket->getLinkLayerType());
 	m_LastLayer = m_FirstLayer;
 	Layer* curLayer = m_FirstLayer;
 	while (curLayer != NULL)
 	{
+		// the other packet may not be fully parsed (in lazy mode) so collect the protocols while parsing
+		m_ProtocolTypes |= curLayer->getProtocol();
 		curLayer->parseNextLayer();
 		curLayer->m_IsAllocatedInPacket = true;
 		curLayer = curLayer->getNextLayer();
@@ -170,20 +473,19 @@ void Packet::copyDataFrom(const Packet& other)
 	}
 }
 
-void Packet::reallocateRawData(size_t newSize)
+bool Packet::reallocateRawData(size_t newSize, size_t headroom)
 {
 	LOG_DEBUG("Allocating packet to new size: %d", (int)newSize);
 
-	// allocate a new array with size newSize
-	m_MaxPacketLen = newSize;
-
 	// set the new array to RawPacket
-	if (!m_RawPacket->reallocateData(m_MaxPacketLen))
+	if (!m_RawPacket->reallocateData(newSize, headroom))
 	{
-		LOG_ERROR("Couldn't reallocate data of raw packet to %d bytes", (int)m_MaxPacketLen);
-		return;
+		LOG_ERROR("Couldn't reallocate data of raw packet to %d bytes", (int)newSize);
+		return false;
 	}
 
+	m_MaxPacketLen = newSize;
+
 	// set all data pointers in layers to the new array address
 	const uint8_t* dataPtr = m_RawPacket->getRawData();
 
@@ -195,10 +497,29 @@ void Packet::reallocateRawData(size_t newSize)
 		dataPtr += curLayer->getHeaderLen();
 		curLayer = curLayer->getNextLayer();
 	}
+
+	return true;
+}
+
+bool Packet::reserveHeadroom(size_t headroom)
+{
+	makeWritable();
+
+	if (m_RawPacket->getHeadroom() >= headroom)
+		return true;
+
+	size_t newSize = m_MaxPacketLen;
+	if (newSize < (size_t)m_RawPacket->getRawDataLen())
+		newSize = m_RawPacket->getRawDataLen();
+
+	return reallocateRawData(newSize, headroom);
 }
 
 bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 {
+	parseRemainingLayers();
+	makeWritable();
+
 	if (newLayer == NULL)
 	{
 		LOG_ERROR("Layer to add is NULL");
@@ -218,20 +539,33 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 	}
 
 	size_t newLayerHeaderLen = newLayer->getHeaderLen();
-	if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen)
-	{
-		// reallocate to maximum value of: twice the max size of the packet or max size + new required length
-		if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen*2)
-			reallocateRawData(m_RawPacket->getRawDataLen() + newLayerHeaderLen + m_MaxPacketLen);
-		else
-			reallocateRawData(m_MaxPacketLen*2);
-	}
-
-	// insert layer data to raw packet
 	int indexToInsertData = 0;
 	if (prevLayer != NULL)
 		indexToInsertData = prevLayer->m_Data + prevLayer->getHeaderLen() - m_RawPacket->getRawData();
-	m_RawPacket->insertData(indexToInsertData, newLayer->m_Data, newLayerHeaderLen);
+
+	// if there is enough headroom and the data before the new layer is shorter than the data after it, move the data before it into
+	// the headroom. This way pushing a header at the beginning of the packet doesn't depend on the packet size. Appending a layer
+	// at the end of the packet doesn't move any data so it always uses the space after the data
+	if (m_RawPacket->getHeadroom() >= newLayerHeaderLen && indexToInsertData < m_RawPacket->getRawDataLen() - indexToInsertData &&
+			m_RawPacket->insertDataUsingHeadroom(indexToInsertData, newLayer->m_Data, newLayerHeaderLen))
+	{
+		// the buffer space after the data didn't change but it's now counted from an earlier data pointer
+		m_MaxPacketLen += newLayerHeaderLen;
+	}
+	else
+	{
+		if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen)
+		{
+			// reallocate to maximum value of: twice the max size of the packet or max size + new required length
+			if (m_RawPacket->getRawDataLen() + newLayerHeaderLen > m_MaxPacketLen*2)
+				reallocateRawData(m_RawPacket->getRawDataLen() + newLayerHeaderLen + m_MaxPacketLen, m_RawPacket->getHeadroom());
+			else
+				reallocateRawData(m_MaxPacketLen*2, m_RawPacket->getHeadroom());
+		}
+
+		// insert layer data to raw packet
+		m_RawPacket->insertData(indexToInsertData, newLayer->m_Data, newLayerHeaderLen);
+	}
 
 	//delete previous layer data
 	delete[] newLayer->m_Data;
@@ -258,6 +592,7 @@ bool Packet::insertLayer(Layer* prevLayer, Layer* newLayer, bool ownInPacket)
 
 	// assign layer with this packet only
 	newLayer->m_Packet = this;
+	newLayer->m_IsModified = true;
 
 	// Set flag to indicate if new layer is allocated to packet.
 	if(ownInPacket)
@@ -375,6 +710,9 @@ Layer* Packet::detachLayer(ProtocolType layerType, int index)
 
 bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 {
+	parseRemainingLayers();
+	makeWritable();
+
 	if (layer == NULL)
 	{
 		LOG_ERROR("Layer is NULL");
@@ -404,10 +742,21 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 	uint8_t* layerOldData = new uint8_t[layerOldDataSize];
 	memcpy(layerOldData, layer->m_Data, layerOldDataSize);
 
-	// remove data from raw packet
+	// remove data from raw packet. If the data before the layer is shorter than the data after it, move it forward and return the space
+	// to the headroom, so removing outer headers doesn't depend on the packet size
 	size_t numOfBytesToRemove = headerLen;
 	int indexOfDataToRemove = layer->m_Data - m_RawPacket->getRawData();
-	if (!m_RawPacket->removeData(indexOfDataToRemove, numOfBytesToRemove))
+	bool dataRemoved;
+	if (indexOfDataToRemove < m_RawPacket->getRawDataLen() - (indexOfDataToRemove + (int)numOfBytesToRemove))
+	{
+		dataRemoved = m_RawPacket->removeDataUsingHeadroom(indexOfDataToRemove, numOfBytesToRemove);
+		if (dataRemoved)
+			m_MaxPacketLen -= numOfBytesToRemove;
+	}
+	else
+		dataRemoved = m_RawPacket->removeData(indexOfDataToRemove, numOfBytesToRemove);
+
+	if (!dataRemoved)
 	{
 		LOG_ERROR("Couldn't remove data from packet");
 		delete [] layerOldData;
@@ -420,6 +769,12 @@ bool Packet::removeLayer(Layer* layer, bool tryToDelete)
 	if (layer->m_NextLayer != NULL)
 		layer->m_NextLayer->setPrevLayer(layer->m_PrevLayer);
 
+	// the layers around the removed layer depend on it
+	if (layer->m_PrevLayer != NULL)
+		layer->m_PrevLayer->m_IsModified = true;
+	if (layer->m_NextLayer != NULL)
+		layer->m_NextLayer->m_IsModified = true;
+
 	// take care of head and tail ptrs
 	if (m_FirstLayer == layer)
 		m_FirstLayer = layer->m_NextLayer;
@@ -512,6 +867,9 @@ Layer* Packet::getLayerOfType(ProtocolType layerType, int index) const
 
 bool Packet::extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExtend)
 {
+	parseRemainingLayers();
+	makeWritable();
+
 	if (layer == NULL)
 	{
 		LOG_ERROR("Layer is NULL");
@@ -529,9 +887,9 @@ bool Packet::extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExt
 	{
 		// reallocate to maximum value of: twice the max size of the packet or max size + new required length
 		if (m_RawPacket->getRawDataLen() + numOfBytesToExtend > m_MaxPacketLen*2)
-			reallocateRawData(m_RawPacket->getRawDataLen() + numOfBytesToExtend + m_MaxPacketLen);
+			reallocateRawData(m_RawPacket->getRawDataLen() + numOfBytesToExtend + m_MaxPacketLen, m_RawPacket->getHeadroom());
 		else
-			reallocateRawData(m_MaxPacketLen*2);
+			reallocateRawData(m_MaxPacketLen*2, m_RawPacket->getHeadroom());
 	}
 
 	// insert layer data to raw packet
@@ -567,11 +925,15 @@ bool Packet::extendLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToExt
 		curLayer = curLayer->getNextLayer();
 	}
 
+	layer->m_IsModified = true;
 	return true;
 }
 
 bool Packet::shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToShorten)
 {
+	parseRemainingLayers();
+	makeWritable();
+
 	if (layer == NULL)
 	{
 		LOG_ERROR("Layer is NULL");
@@ -618,18 +980,37 @@ bool Packet::shortenLayer(Layer* layer, int offsetInLayer, size_t numOfBytesToSh
 		curLayer = curLayer->getNextLayer();
 	}
 
+	layer->m_IsModified = true;
 	return true;
 }
 
-void Packet::computeCalculateFields()
+void Packet::computeCalculateFields(bool modifiedLayersOnly)
 {
-	// calculated fields should be calculated from top layer to bottom layer
+	makeWritable();
 
+	// layers that weren't parsed yet can't be modified and nothing below them depends on them being parsed
+	if (!modifiedLayersOnly)
+		parseRemainingLayers();
+
+	// calculated fields should be calculated from top layer to bottom layer. Once a layer is recalculated all layers below it
+	// are recalculated too, since their lengths, next protocol fields and checksums depend on the layers they carry
+
+	bool recalculateRest = !modifiedLayersOnly;
 	Layer* curLayer = m_LastLayer;
 	while (curLayer != NULL)
 	{
-		curLayer->computeCalculateFields();
-		curLayer = curLayer->getPrevLayer();
+		Layer* prevLayer = curLayer->getPrevLayer();
+		if (!recalculateRest)
+		{
+			recalculateRest = curLayer->m_IsModified ||
+				(curLayer->getOsiModelLayer() == OsiModelTransportLayer && prevLayer != NULL && prevLayer->m_IsModified);
+		}
+
+		if (recalculateRest)
+			curLayer->computeCalculateFields();
+
+		curLayer->m_IsModified = false;
+		curLayer = prevLayer;
 	}
 }
 
@@ -697,19 +1078,19 @@ Layer* Packet::createFirstLayer(LinkLayerType linkType)
 			uint16_t ethTypeOrLength = be16toh(*(uint16_t*)(rawData + 12));
 			if (ethTypeOrLength <= (uint16_t)0x5dc && ethTypeOrLength != 0)
 			{
-				return new EthDot3Layer((uint8_t*)rawData, rawDataLen, this);
+				return new(this) EthDot3Layer((uint8_t*)rawData, rawDataLen, this);
 			}
 		}
 		
-		return new EthLayer((uint8_t*)rawData, rawDataLen, this);
+		return new(this) EthLayer((uint8_t*)rawData, rawDataLen, this);
 	}
 	else if (linkType == LINKTYPE_LINUX_SLL)
 	{
-		return new SllLayer((uint8_t*)rawData, rawDataLen, this);
+		return new(this) SllLayer((uint8_t*)rawData, rawDataLen, this);
 	}
 	else if (linkType == LINKTYPE_NULL)
 	{
-		return new NullLoopbackLayer((uint8_t*)rawData, rawDataLen, this);
+		return new(this) NullLoopbackLayer((uint8_t*)rawData, rawDataLen, this);
 	}
 	else if (linkType == LINKTYPE_RAW || linkType == LINKTYPE_DLT_RAW1 || linkType == LINKTYPE_DLT_RAW2)
 	{
@@ -717,23 +1098,23 @@ Layer* Packet::createFirstLayer(LinkLayerType linkType)
 		if (ipVer == 0x40)
 		{
 			return IPv4Layer::isDataValid(rawData, rawDataLen)
-				? static_cast<Layer*>(new IPv4Layer((uint8_t*)rawData, rawDataLen, NULL, this))
-				: static_cast<Layer*>(new PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this));
+				? static_cast<Layer*>(new(this) IPv4Layer((uint8_t*)rawData, rawDataLen, NULL, this))
+				: static_cast<Layer*>(new(this) PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this));
 		}
 		else if (ipVer == 0x60)
 		{
 			return IPv6Layer::isDataValid(rawData, rawDataLen)
-				? static_cast<Layer*>(new IPv6Layer((uint8_t*)rawData, rawDataLen, NULL, this))
-				: static_cast<Layer*>(new PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this));
+				? static_cast<Layer*>(new(this) IPv6Layer((uint8_t*)rawData, rawDataLen, NULL, this))
+				: static_cast<Layer*>(new(this) PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this));
 		}
 		else
 		{
-			return new PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this);
+			return new(this) PayloadLayer((uint8_t*)rawData, rawDataLen, NULL, this);
 		}
 	}
 
 	// unknown link type
-	return new EthLayer((uint8_t*)rawData, rawDataLen, this);
+	return new(this) EthLayer((uint8_t*)rawData, rawDataLen, this);
 }
 
 std::string Packet::toString(bool timeAsLocalTime)
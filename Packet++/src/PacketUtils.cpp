@@ -5,11 +5,12 @@
 #include "IPv6Layer.h"
 #include "TcpLayer.h"
 #include "UdpLayer.h"
+#include "EndianPortable.h"
 
 namespace pcpp
 {
 
-uint32_t hash5Tuple(Packet* packet)
+uint32_t hash5Tuple(Packet* packet, bool useInnerTuple)
 {
 	if (!packet->isPacketOfType(IPv4) && !packet->isPacketOfType(IPv6))
 		return 0;
@@ -25,18 +26,37 @@ uint32_t hash5Tuple(Packet* packet)
 	uint16_t portSrc = 0;
 	uint16_t portDst = 0;
 	int srcPosition = 0;
+	Layer* transportLayer = NULL;
 
 	TcpLayer* tcpLayer = packet->getLayerOfType<TcpLayer>(true); // lookup in reverse order
 	if (tcpLayer != NULL)
 	{
 		portSrc = tcpLayer->getTcpHeader()->portSrc;
 		portDst = tcpLayer->getTcpHeader()->portDst;
+		transportLayer = tcpLayer;
 	}
 	else
 	{
 		UdpLayer* udpLayer = packet->getLayerOfType<UdpLayer>(true);
 		portSrc = udpLayer->getUdpHeader()->portSrc;
 		portDst = udpLayer->getUdpHeader()->portDst;
+		transportLayer = udpLayer;
+	}
+
+	// by default the addresses are taken from the outermost IP layer. In inner tuple mode they're taken from the IP layer that
+	// carries the transport layer, which for tunneled packets is the IP layer of the inner packet
+	IPv4Layer* ipv4Layer = NULL;
+	IPv6Layer* ipv6Layer = NULL;
+	Layer* innerIPLayer = (useInnerTuple ? transportLayer->getPrevLayer() : NULL);
+	if (innerIPLayer != NULL && innerIPLayer->getProtocol() == IPv4)
+		ipv4Layer = (IPv4Layer*)innerIPLayer;
+	else if (innerIPLayer != NULL && innerIPLayer->getProtocol() == IPv6)
+		ipv6Layer = (IPv6Layer*)innerIPLayer;
+	else
+	{
+		ipv4Layer = packet->getLayerOfType<IPv4Layer>();
+		if (ipv4Layer == NULL)
+			ipv6Layer = packet->getLayerOfType<IPv6Layer>();
 	}
 
 	if (portDst < portSrc)
@@ -48,7 +68,6 @@ uint32_t hash5Tuple(Packet* packet)
 	vec[1 - srcPosition].len = 2;
 
 
-	IPv4Layer* ipv4Layer = packet->getLayerOfType<IPv4Layer>();
 	if (ipv4Layer != NULL)
 	{
 		if (portSrc == portDst && ipv4Layer->getIPv4Header()->ipDst < ipv4Layer->getIPv4Header()->ipSrc)
@@ -63,7 +82,6 @@ uint32_t hash5Tuple(Packet* packet)
 	}
 	else
 	{
-		IPv6Layer* ipv6Layer = packet->getLayerOfType<IPv6Layer>();
 		if (portSrc == portDst && (uint64_t)ipv6Layer->getIPv6Header()->ipDst < (uint64_t)ipv6Layer->getIPv6Header()->ipSrc)
 			srcPosition = 1;
 
@@ -115,4 +133,192 @@ uint32_t hash2Tuple(Packet* packet)
 	return pcpp::fnv_hash(vec, 2);
 }
 
+const uint8_t ToeplitzHash::SymmetricKey[40] = {
+	0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+	0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+	0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+	0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+	0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A, 0x6D, 0x5A,
+};
+
+const uint8_t ToeplitzHash::MicrosoftKey[40] = {
+	0x6D, 0x5A, 0x56, 0xDA, 0x25, 0x5B, 0x0E, 0xC2,
+	0x41, 0x67, 0x25, 0x3D, 0x43, 0xA3, 0x8F, 0xB0,
+	0xD0, 0xCA, 0x2B, 0xCB, 0xAE, 0x7B, 0x30, 0xB4,
+	0x77, 0xCB, 0x2D, 0xA3, 0x80, 0x30, 0xF2, 0x0C,
+	0x6A, 0x42, 0xB7, 0x3B, 0xBE, 0xAC, 0x01, 0xFA,
+};
+
+ToeplitzHash::ToeplitzHash()
+{
+	setKey(SymmetricKey, sizeof(SymmetricKey));
+}
+
+ToeplitzHash::ToeplitzHash(const uint8_t* key, size_t keyLen)
+{
+	if (!setKey(key, keyLen))
+		setKey(SymmetricKey, sizeof(SymmetricKey));
+}
+
+bool ToeplitzHash::setKey(const uint8_t* key, size_t keyLen)
+{
+	if (key == NULL || keyLen < 8 || keyLen > PCPP_TOEPLITZ_MAX_KEY_LEN)
+		return false;
+
+	memcpy(m_Key, key, keyLen);
+	m_KeyLen = keyLen;
+	size_t maxInputLen = keyLen - 4;
+	if (maxInputLen > PCPP_TOEPLITZ_MAX_INPUT_LEN)
+		maxInputLen = PCPP_TOEPLITZ_MAX_INPUT_LEN;
+
+	memset(m_Table, 0, sizeof(m_Table));
+
+	// input bit j of byte i is XORed with the 32 key bits that start at key bit i*8+j. Since XOR is linear, the contribution of a
+	// whole input byte is the XOR of the contributions of its set bits, which is pre-calculated for all 256 byte values
+	for (size_t i = 0; i < maxInputLen; i++)
+	{
+		uint64_t keyWindow = ((uint64_t)key[i] << 32) | ((uint64_t)key[i+1] << 24) | ((uint64_t)key[i+2] << 16) | ((uint64_t)key[i+3] << 8) | key[i+4];
+
+		uint32_t bitKeys[8];
+		for (int j = 0; j < 8; j++)
+			bitKeys[j] = (uint32_t)(keyWindow >> (8 - j));
+
+		for (int value = 0; value < 256; value++)
+		{
+			uint32_t result = 0;
+			for (int j = 0; j < 8; j++)
+			{
+				if (value & (0x80 >> j))
+					result ^= bitKeys[j];
+			}
+
+			m_Table[i][value] = result;
+		}
+	}
+
+	return true;
+}
+
+uint32_t ToeplitzHash::hash(const uint8_t* data, size_t dataLen) const
+{
+	if (dataLen > PCPP_TOEPLITZ_MAX_INPUT_LEN)
+		dataLen = PCPP_TOEPLITZ_MAX_INPUT_LEN;
+
+	uint32_t result = 0;
+	for (size_t i = 0; i < dataLen; i++)
+		result ^= m_Table[i][data[i]];
+
+	return result;
+}
+
+uint32_t ToeplitzHash::hashBitByBit(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t dataLen)
+{
+	if (key == NULL || keyLen < 4)
+		return 0;
+
+	if (dataLen > keyLen - 4)
+		dataLen = keyLen - 4;
+
+	uint32_t result = 0;
+	uint32_t keyBits = ((uint32_t)key[0] << 24) | ((uint32_t)key[1] << 16) | ((uint32_t)key[2] << 8) | key[3];
+	size_t nextKeyBit = 32;
+
+	for (size_t i = 0; i < dataLen; i++)
+	{
+		for (int bit = 7; bit >= 0; bit--)
+		{
+			if (data[i] & (1 << bit))
+				result ^= keyBits;
+
+			// shift the 32-bit key window one bit to the left
+			keyBits = (keyBits << 1) | ((key[nextKeyBit / 8] >> (7 - nextKeyBit % 8)) & 1);
+			nextKeyBit++;
+		}
+	}
+
+	return result;
+}
+
+uint32_t ToeplitzHash::hashIPv4(uint32_t srcIP, uint32_t dstIP) const
+{
+	return hash4Bytes((uint8_t*)&srcIP, 0) ^ hash4Bytes((uint8_t*)&dstIP, 4);
+}
+
+uint32_t ToeplitzHash::hashIPv4(uint32_t srcIP, uint32_t dstIP, uint16_t srcPort, uint16_t dstPort) const
+{
+	uint8_t ports[4] = { (uint8_t)(srcPort >> 8), (uint8_t)srcPort, (uint8_t)(dstPort >> 8), (uint8_t)dstPort };
+	return hash4Bytes((uint8_t*)&srcIP, 0) ^ hash4Bytes((uint8_t*)&dstIP, 4) ^ hash4Bytes(ports, 8);
+}
+
+uint32_t ToeplitzHash::hashIPv6(const uint8_t* srcIP, const uint8_t* dstIP) const
+{
+	return hash4Bytes(srcIP, 0) ^ hash4Bytes(srcIP + 4, 4) ^ hash4Bytes(srcIP + 8, 8) ^ hash4Bytes(srcIP + 12, 12) ^
+		hash4Bytes(dstIP, 16) ^ hash4Bytes(dstIP + 4, 20) ^ hash4Bytes(dstIP + 8, 24) ^ hash4Bytes(dstIP + 12, 28);
+}
+
+uint32_t ToeplitzHash::hashIPv6(const uint8_t* srcIP, const uint8_t* dstIP, uint16_t srcPort, uint16_t dstPort) const
+{
+	uint8_t ports[4] = { (uint8_t)(srcPort >> 8), (uint8_t)srcPort, (uint8_t)(dstPort >> 8), (uint8_t)dstPort };
+	return hashIPv6(srcIP, dstIP) ^ hash4Bytes(ports, 32);
+}
+
+uint32_t ToeplitzHash::hashPacket(const PacketView& packetView, bool includePorts) const
+{
+	// PacketView sets the L7 offset only for TCP, UDP and SCTP packets that aren't fragments
+	bool hasPorts = includePorts && packetView.getL7Offset() != PCPP_PACKET_VIEW_NO_OFFSET;
+
+	iphdr* ipv4Header = packetView.getIPv4Header();
+	if (ipv4Header != NULL)
+	{
+		if (hasPorts)
+			return hashIPv4(ipv4Header->ipSrc, ipv4Header->ipDst, packetView.getSrcPort(), packetView.getDstPort());
+		return hashIPv4(ipv4Header->ipSrc, ipv4Header->ipDst);
+	}
+
+	ip6_hdr* ipv6Header = packetView.getIPv6Header();
+	if (ipv6Header != NULL)
+	{
+		if (hasPorts)
+			return hashIPv6(ipv6Header->ipSrc, ipv6Header->ipDst, packetView.getSrcPort(), packetView.getDstPort());
+		return hashIPv6(ipv6Header->ipSrc, ipv6Header->ipDst);
+	}
+
+	return 0;
+}
+
+uint32_t ToeplitzHash::hashPacket(Packet* packet, bool includePorts) const
+{
+	Layer* ipLayer = packet->getFirstLayer();
+	while (ipLayer != NULL && ipLayer->getProtocol() != IPv4 && ipLayer->getProtocol() != IPv6)
+		ipLayer = ipLayer->getNextLayer();
+
+	if (ipLayer == NULL)
+		return 0;
+
+	// TCP and UDP headers both start with the source and destination ports
+	udphdr* portsHeader = NULL;
+	Layer* transportLayer = ipLayer->getNextLayer();
+	if (includePorts && transportLayer != NULL && (transportLayer->getProtocol() == TCP || transportLayer->getProtocol() == UDP))
+		portsHeader = (udphdr*)transportLayer->getData();
+
+	if (ipLayer->getProtocol() == IPv4)
+	{
+		iphdr* ipv4Header = ((IPv4Layer*)ipLayer)->getIPv4Header();
+		if (portsHeader != NULL)
+			return hashIPv4(ipv4Header->ipSrc, ipv4Header->ipDst, be16toh(portsHeader->portSrc), be16toh(portsHeader->portDst));
+		return hashIPv4(ipv4Header->ipSrc, ipv4Header->ipDst);
+	}
+
+	ip6_hdr* ipv6Header = ((IPv6Layer*)ipLayer)->getIPv6Header();
+	if (portsHeader != NULL)
+		return hashIPv6(ipv6Header->ipSrc, ipv6Header->ipDst, be16toh(portsHeader->portSrc), be16toh(portsHeader->portDst));
+	return hashIPv6(ipv6Header->ipSrc, ipv6Header->ipDst);
+}
+
+void ToeplitzHash::hashBurst(const PacketView* packetViews, size_t count, uint32_t* hashes, bool includePorts) const
+{
+	for (size_t i = 0; i < count; i++)
+		hashes[i] = hashPacket(packetViews[i], includePorts);
+}
+
 }  // namespace pcpp
@@ -0,0 +1,303 @@
+#include "PacketView.h"
+#include "VlanLayer.h"
+#include "IPv6Extensions.h"
+#include <string.h>
+
+// the size of a single MPLS label stack entry
+#define PCPP_MPLS_LABEL_LEN 4
+
+namespace pcpp
+{
+
+void PacketView::clear()
+{
+	m_Data = NULL;
+	m_DataLen = 0;
+	m_ProtocolTypes = UnknownProtocol;
+	m_IPDatagramLen = 0;
+	m_L2Offset = PCPP_PACKET_VIEW_NO_OFFSET;
+	m_L3Offset = PCPP_PACKET_VIEW_NO_OFFSET;
+	m_L4Offset = PCPP_PACKET_VIEW_NO_OFFSET;
+	m_L7Offset = PCPP_PACKET_VIEW_NO_OFFSET;
+	m_EtherType = 0;
+	m_OuterVlanId = 0;
+	m_VlanTagCount = 0;
+	m_MplsLabelCount = 0;
+	m_IPProtocol = 0;
+	m_IsFragment = false;
+	m_IsSctp = false;
+}
+
+bool PacketView::parse(const RawPacket* rawPacket)
+{
+	if (rawPacket == NULL || rawPacket->getRawDataLen() <= 0)
+	{
+		clear();
+		return false;
+	}
+
+	return parse(rawPacket->getRawData(), (size_t)rawPacket->getRawDataLen(), rawPacket->getLinkLayerType());
+}
+
+bool PacketView::parse(const uint8_t* data, size_t dataLen, LinkLayerType linkType)
+{
+	clear();
+
+	if (data == NULL || dataLen == 0)
+		return false;
+
+	m_Data = (uint8_t*)data;
+	m_DataLen = dataLen;
+
+	if (linkType == LINKTYPE_RAW || linkType == LINKTYPE_DLT_RAW1 || linkType == LINKTYPE_DLT_RAW2)
+	{
+		uint8_t ipVer = data[0] & 0xf0;
+		if (ipVer == 0x40)
+			parseIPv4(0);
+		else if (ipVer == 0x60)
+			parseIPv6(0);
+
+		return m_ProtocolTypes != UnknownProtocol;
+	}
+
+	if (linkType != LINKTYPE_ETHERNET || dataLen < sizeof(ether_header))
+		return false;
+
+	// IEEE 802.3 frames have a length field instead of EtherType. Their payload isn't parsed (see Packet#createFirstLayer())
+	uint16_t etherType = be16toh(((ether_header*)data)->etherType);
+	if (etherType <= (uint16_t)0x5dc && etherType != 0)
+	{
+		m_ProtocolTypes = EthernetDot3;
+		m_L2Offset = 0;
+		return true;
+	}
+
+	m_ProtocolTypes = Ethernet;
+	m_L2Offset = 0;
+	size_t offset = sizeof(ether_header);
+
+	// skip all VLAN tags
+	while ((etherType == PCPP_ETHERTYPE_VLAN || etherType == PCPP_ETHERTYPE_IEEE_802_1AD) && m_VlanTagCount < PCPP_PACKET_VIEW_MAX_VLAN_TAGS)
+	{
+		if (dataLen < offset + sizeof(vlan_header))
+			return true;
+
+		vlan_header* vlanHeader = (vlan_header*)(data + offset);
+		if (m_VlanTagCount == 0)
+			m_OuterVlanId = be16toh(vlanHeader->vlan) & 0xFFF;
+
+		m_VlanTagCount++;
+		m_ProtocolTypes |= VLAN;
+		etherType = be16toh(vlanHeader->etherType);
+		offset += sizeof(vlan_header);
+	}
+
+	// skip the MPLS label stack. The protocol after the bottom of the stack is deduced by the IP version
+	if (etherType == PCPP_ETHERTYPE_MPLS)
+	{
+		m_ProtocolTypes |= MPLS;
+		etherType = 0;
+		while (m_MplsLabelCount < PCPP_PACKET_VIEW_MAX_MPLS_LABELS && dataLen >= offset + PCPP_MPLS_LABEL_LEN)
+		{
+			bool bottomOfStack = (data[offset + 2] & 0x01) != 0;
+			m_MplsLabelCount++;
+			offset += PCPP_MPLS_LABEL_LEN;
+			if (!bottomOfStack)
+				continue;
+
+			if (dataLen > offset)
+			{
+				uint8_t ipVer = data[offset] & 0xf0;
+				if (ipVer == 0x40)
+					etherType = PCPP_ETHERTYPE_IP;
+				else if (ipVer == 0x60)
+					etherType = PCPP_ETHERTYPE_IPV6;
+			}
+
+			break;
+		}
+	}
+
+	m_EtherType = etherType;
+
+	switch (etherType)
+	{
+	case PCPP_ETHERTYPE_IP:
+		parseIPv4(offset);
+		break;
+	case PCPP_ETHERTYPE_IPV6:
+		parseIPv6(offset);
+		break;
+	case PCPP_ETHERTYPE_ARP:
+		if (dataLen > offset)
+			m_ProtocolTypes |= ARP;
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+void PacketView::parseIPv4(size_t offset)
+{
+	if (!IPv4Layer::isDataValid(m_Data + offset, m_DataLen - offset))
+		return;
+
+	iphdr* ipHdr = (iphdr*)(m_Data + offset);
+	size_t hdrLen = ipHdr->internetHeaderLength * 4;
+
+	// if totalLength is 0 this usually means TCP Segmentation Offload (TSO). In this case the captured length is used
+	size_t datagramLen = m_DataLen - offset;
+	size_t totalLen = be16toh(ipHdr->totalLength);
+	if (totalLen != 0 && totalLen < datagramLen)
+		datagramLen = totalLen;
+
+	m_ProtocolTypes |= IPv4;
+	m_L3Offset = (uint16_t)offset;
+	m_IPDatagramLen = datagramLen;
+	m_IPProtocol = ipHdr->protocol;
+	m_IsFragment = (ipHdr->fragmentOffset & htobe16(0x1FFF | (PCPP_IP_MORE_FRAGMENTS << 8))) != 0;
+
+	if (m_IsFragment || datagramLen <= hdrLen)
+		return;
+
+	parseTransport(offset + hdrLen);
+}
+
+void PacketView::parseIPv6(size_t offset)
+{
+	if (!IPv6Layer::isDataValid(m_Data + offset, m_DataLen - offset))
+		return;
+
+	ip6_hdr* ipHdr = (ip6_hdr*)(m_Data + offset);
+
+	// a payload length of 0 means a jumbo payload (or TSO), in this case the captured length is used
+	size_t datagramLen = m_DataLen - offset;
+	size_t totalLen = sizeof(ip6_hdr) + be16toh(ipHdr->payloadLength);
+	if (ipHdr->payloadLength != 0 && totalLen < datagramLen)
+		datagramLen = totalLen;
+
+	m_ProtocolTypes |= IPv6;
+	m_L3Offset = (uint16_t)offset;
+	m_IPDatagramLen = datagramLen;
+
+	// walk through the extension headers. Offsets can't overflow 16 bits: an extension is at most 2KB long and the number of
+	// extensions is bounded
+	uint8_t nextHdr = ipHdr->nextHeader;
+	size_t curOffset = sizeof(ip6_hdr);
+	for (int i = 0; i < PCPP_PACKET_VIEW_MAX_IPV6_EXTENSIONS; i++)
+	{
+		size_t extLen = 0;
+		switch (nextHdr)
+		{
+		case PACKETPP_IPPROTO_HOPOPTS:
+		case PACKETPP_IPPROTO_ROUTING:
+		case PACKETPP_IPPROTO_DSTOPTS:
+			if (curOffset + 2 > datagramLen)
+				break;
+			extLen = (m_Data[offset + curOffset + 1] + 1) * 8;
+			break;
+		case PACKETPP_IPPROTO_AH:
+			if (curOffset + 2 > datagramLen)
+				break;
+			extLen = (m_Data[offset + curOffset + 1] + 2) * 4;
+			break;
+		case PACKETPP_IPPROTO_FRAGMENT:
+			extLen = sizeof(IPv6FragmentationHeader::ipv6_frag_header);
+			m_IsFragment = true;
+			break;
+		default:
+			break;
+		}
+
+		if (extLen == 0 || curOffset + extLen > datagramLen)
+			break;
+
+		nextHdr = m_Data[offset + curOffset];
+		curOffset += extLen;
+	}
+
+	m_IPProtocol = nextHdr;
+
+	if (m_IsFragment || datagramLen <= curOffset)
+		return;
+
+	parseTransport(offset + curOffset);
+}
+
+void PacketView::parseTransport(size_t offset)
+{
+	m_L4Offset = (uint16_t)offset;
+
+	uint8_t* l4Data = m_Data + offset;
+	size_t l4Len = m_L3Offset + m_IPDatagramLen - offset;
+
+	switch (m_IPProtocol)
+	{
+	case PACKETPP_IPPROTO_TCP:
+		if (TcpLayer::isDataValid(l4Data, l4Len))
+		{
+			m_ProtocolTypes |= TCP;
+			m_L7Offset = (uint16_t)(offset + ((tcphdr*)l4Data)->dataOffset * 4);
+		}
+		break;
+	case PACKETPP_IPPROTO_UDP:
+		if (l4Len >= sizeof(udphdr))
+		{
+			m_ProtocolTypes |= UDP;
+			m_L7Offset = (uint16_t)(offset + sizeof(udphdr));
+		}
+		break;
+	case PACKETPP_IPPROTO_SCTP:
+		if (l4Len >= sizeof(sctphdr))
+		{
+			m_IsSctp = true;
+			m_L7Offset = (uint16_t)(offset + sizeof(sctphdr));
+		}
+		break;
+	case PACKETPP_IPPROTO_ICMP:
+		if (l4Len >= sizeof(icmphdr))
+			m_ProtocolTypes |= ICMP;
+		break;
+	default:
+		break;
+	}
+}
+
+size_t PacketView::getPayloadLen() const
+{
+	if (m_L7Offset == PCPP_PACKET_VIEW_NO_OFFSET)
+		return 0;
+
+	return m_L3Offset + m_IPDatagramLen - m_L7Offset;
+}
+
+bool PacketView::getFiveTuple(PacketFiveTuple& fiveTuple) const
+{
+	memset(&fiveTuple, 0, sizeof(PacketFiveTuple));
+
+	if (m_ProtocolTypes & IPv4)
+	{
+		iphdr* ipHdr = (iphdr*)(m_Data + m_L3Offset);
+		memcpy(fiveTuple.srcIP, &ipHdr->ipSrc, sizeof(ipHdr->ipSrc));
+		memcpy(fiveTuple.dstIP, &ipHdr->ipDst, sizeof(ipHdr->ipDst));
+		fiveTuple.ipVersion = 4;
+	}
+	else if (m_ProtocolTypes & IPv6)
+	{
+		ip6_hdr* ipHdr = (ip6_hdr*)(m_Data + m_L3Offset);
+		memcpy(fiveTuple.srcIP, ipHdr->ipSrc, sizeof(ipHdr->ipSrc));
+		memcpy(fiveTuple.dstIP, ipHdr->ipDst, sizeof(ipHdr->ipDst));
+		fiveTuple.ipVersion = 6;
+	}
+	else
+		return false;
+
+	fiveTuple.protocol = m_IPProtocol;
+	fiveTuple.srcPort = getSrcPort();
+	fiveTuple.dstPort = getDstPort();
+	return true;
+}
+
+} // namespace pcpp
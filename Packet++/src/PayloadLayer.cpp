@@ -31,6 +31,7 @@ PayloadLayer::PayloadLayer(const std::string& payloadAsHexStream)
 
 void PayloadLayer::setPayload(const uint8_t* newPayload, size_t newPayloadLength)
 {
+	makePacketWritable();
 	if (newPayloadLength < m_DataLen)
 	{
 		// shorten payload layer
@@ -86,6 +86,7 @@ std::string RadiusLayer::getAuthenticatorValue() const
 
 void RadiusLayer::setAuthenticatorValue(const std::string& authValue)
 {
+	makePacketWritable();
 	hexStringToByteArray(authValue, getRadiusHeader()->authenticator, 16);
 }
 
@@ -16,6 +16,19 @@ void RawPacket::init(bool deleteRawDataAtDestructor)
 	m_DeleteRawDataAtDestructor = deleteRawDataAtDestructor;
 	m_RawPacketSet = false;
 	m_LinkLayerType = LINKTYPE_ETHERNET;
+	m_Headroom = 0;
+	m_Tailroom = 0;
+}
+
+void RawPacket::freeRawData()
+{
+	// the buffer starts at the beginning of the headroom
+	if (m_RawData != NULL)
+		delete[] (m_RawData - m_Headroom);
+
+	m_RawData = NULL;
+	m_Headroom = 0;
+	m_Tailroom = 0;
 }
 
 RawPacket::RawPacket(const uint8_t* pRawData, int rawDataLen, timeval timestamp, bool deleteRawDataAtDestructor, LinkLayerType layerType)
@@ -41,13 +54,15 @@ RawPacket::~RawPacket()
 {
 	if (m_DeleteRawDataAtDestructor)
 	{
-		delete[] m_RawData;
+		freeRawData();
 	}
 }
 
 RawPacket::RawPacket(const RawPacket& other)
 {
 	m_RawData = NULL;
+	m_Headroom = 0;
+	m_Tailroom = 0;
 	copyDataFrom(other, true);
 }
 
@@ -55,8 +70,7 @@ RawPacket& RawPacket::operator=(const RawPacket& other)
 {
 	if (this != &other)
 	{
-		if (m_RawData != NULL)
-			delete [] m_RawData;
+		freeRawData();
 
 		m_RawPacketSet = false;
 
@@ -66,6 +80,100 @@ RawPacket& RawPacket::operator=(const RawPacket& other)
 	return *this;
 }
 
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+RawPacket::RawPacket(RawPacket&& other)
+{
+	init();
+
+	// derived raw packets manage their own buffers, so they can only be copied into a base instance
+	if (other.getObjectType() == 0)
+		moveDataFrom(other);
+	else
+		copyDataFrom(other, true);
+}
+
+RawPacket& RawPacket::operator=(RawPacket&& other)
+{
+	if (this == &other)
+		return *this;
+
+	if (other.getObjectType() != 0)
+		return *this = static_cast<const RawPacket&>(other);
+
+	if (m_DeleteRawDataAtDestructor)
+		freeRawData();
+
+	moveDataFrom(other);
+	return *this;
+}
+#endif
+
+void RawPacket::moveDataFrom(RawPacket& other)
+{
+	m_RawData = other.m_RawData;
+	m_RawDataLen = other.m_RawDataLen;
+	m_FrameLength = other.m_FrameLength;
+	m_TimeStamp = other.m_TimeStamp;
+	m_DeleteRawDataAtDestructor = other.m_DeleteRawDataAtDestructor;
+	m_RawPacketSet = other.m_RawPacketSet;
+	m_LinkLayerType = other.m_LinkLayerType;
+	m_Headroom = other.m_Headroom;
+	m_Tailroom = other.m_Tailroom;
+
+	// leave the other instance empty without freeing the buffer it no longer owns
+	other.m_RawData = NULL;
+	other.m_RawDataLen = 0;
+	other.m_FrameLength = 0;
+	other.m_DeleteRawDataAtDestructor = true;
+	other.m_RawPacketSet = false;
+	other.m_Headroom = 0;
+	other.m_Tailroom = 0;
+}
+
+bool RawPacket::adoptRawData(RawPacket& other)
+{
+	if (this == &other)
+		return true;
+
+	if (other.getObjectType() != 0)
+	{
+		LOG_ERROR("Cannot adopt the raw data of a raw packet of type %d", (int)other.getObjectType());
+		return false;
+	}
+
+	if (m_DeleteRawDataAtDestructor)
+		freeRawData();
+
+	moveDataFrom(other);
+	return true;
+}
+
+uint8_t* RawPacket::releaseRawData(size_t* headroom)
+{
+	if (!m_DeleteRawDataAtDestructor || m_RawData == NULL)
+	{
+		LOG_ERROR("Raw data isn't owned by this raw packet, cannot release it");
+		return NULL;
+	}
+
+	uint8_t* rawData = m_RawData;
+	if (headroom != NULL)
+		*headroom = m_Headroom;
+	else if (m_Headroom > 0)
+	{
+		rawData = m_RawData - m_Headroom;
+		memmove(rawData, m_RawData, m_RawDataLen);
+	}
+
+	m_RawData = NULL;
+	m_RawDataLen = 0;
+	m_FrameLength = 0;
+	m_RawPacketSet = false;
+	m_Headroom = 0;
+	m_Tailroom = 0;
+	return rawData;
+}
+
 
 void RawPacket::copyDataFrom(const RawPacket& other, bool allocateData)
 {
@@ -76,8 +184,11 @@ void RawPacket::copyDataFrom(const RawPacket& other, bool allocateData)
 
 	if (allocateData)
 	{
+		// keep the headroom and tailroom of the other packet so the copy can be modified just as cheaply
 		m_DeleteRawDataAtDestructor = true;
-		m_RawData = new uint8_t[other.m_RawDataLen];
+		m_Headroom = other.m_Headroom;
+		m_Tailroom = other.m_Tailroom;
+		m_RawData = new uint8_t[m_Headroom + other.m_RawDataLen + m_Tailroom] + m_Headroom;
 		m_RawDataLen = other.m_RawDataLen;
 	}
 
@@ -99,12 +210,14 @@ bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec tim
 	if(frameLength == -1)
 		frameLength = rawDataLen;
 	m_FrameLength = frameLength;
-	if (m_RawData != 0 && m_DeleteRawDataAtDestructor)
+	if (m_DeleteRawDataAtDestructor)
 	{
-		delete[] m_RawData;
+		freeRawData();
 	}
 
 	m_RawData = (uint8_t*)pRawData;
+	m_Headroom = 0;
+	m_Tailroom = 0;
 	m_RawDataLen = rawDataLen;
 	m_TimeStamp = timestamp;
 	m_RawPacketSet = true;
@@ -114,10 +227,8 @@ bool RawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec tim
 
 void RawPacket::clear()
 {
-	if (m_RawData != 0)
-		delete[] m_RawData;
+	freeRawData();
 
-	m_RawData = 0;
 	m_RawDataLen = 0;
 	m_FrameLength = 0;
 	m_RawPacketSet = false;
@@ -128,6 +239,7 @@ void RawPacket::appendData(const uint8_t* dataToAppend, size_t dataToAppendLen)
 	memcpy((uint8_t*)m_RawData + m_RawDataLen, dataToAppend, dataToAppendLen);
 	m_RawDataLen += dataToAppendLen;
 	m_FrameLength = m_RawDataLen;
+	m_Tailroom = (m_Tailroom > dataToAppendLen ? m_Tailroom - dataToAppendLen : 0);
 }
 
 void RawPacket::insertData(int atIndex, const uint8_t* dataToInsert, size_t dataToInsertLen)
@@ -144,6 +256,34 @@ void RawPacket::insertData(int atIndex, const uint8_t* dataToInsert, size_t data
 	
 	m_RawDataLen += dataToInsertLen;
 	m_FrameLength = m_RawDataLen;
+	m_Tailroom = (m_Tailroom > dataToInsertLen ? m_Tailroom - dataToInsertLen : 0);
+}
+
+bool RawPacket::insertDataUsingHeadroom(int atIndex, const uint8_t* dataToInsert, size_t dataToInsertLen)
+{
+	if (dataToInsertLen > m_Headroom)
+	{
+		LOG_ERROR("Not enough headroom to insert %d bytes. Headroom: %d", (int)dataToInsertLen, (int)m_Headroom);
+		return false;
+	}
+
+	if (atIndex < 0 || atIndex > m_RawDataLen)
+	{
+		LOG_ERROR("Insert index is out of raw packet bound");
+		return false;
+	}
+
+	// move the data before the index back into the headroom
+	m_RawData -= dataToInsertLen;
+	m_Headroom -= dataToInsertLen;
+	memmove(m_RawData, m_RawData + dataToInsertLen, atIndex);
+
+	if (dataToInsert != NULL)
+		memcpy(m_RawData + atIndex, dataToInsert, dataToInsertLen);
+
+	m_RawDataLen += dataToInsertLen;
+	m_FrameLength = m_RawDataLen;
+	return true;
 }
 
 bool RawPacket::reallocateData(size_t newBufferLength)
@@ -157,14 +297,28 @@ bool RawPacket::reallocateData(size_t newBufferLength)
 		return false;
 	}
 
-	uint8_t* newBuffer = new uint8_t[newBufferLength];
-	memset(newBuffer, 0, newBufferLength);
-	memcpy(newBuffer, m_RawData, m_RawDataLen);
+	return reallocateData(newBufferLength, m_Headroom);
+}
+
+bool RawPacket::reallocateData(size_t newBufferLength, size_t headroom)
+{
+	if ((int)newBufferLength < m_RawDataLen)
+	{
+		LOG_ERROR("Cannot reallocate raw packet to a smaller size. Current data length: %d; requested length: %d", m_RawDataLen, (int)newBufferLength);
+		return false;
+	}
+
+	uint8_t* newBuffer = new uint8_t[headroom + newBufferLength];
+	memset(newBuffer, 0, headroom + newBufferLength);
+	if (m_RawData != NULL)
+		memcpy(newBuffer + headroom, m_RawData, m_RawDataLen);
 	if (m_DeleteRawDataAtDestructor)
-		delete [] m_RawData;
+		freeRawData();
 
 	m_DeleteRawDataAtDestructor = true;
-	m_RawData = newBuffer;
+	m_RawData = newBuffer + headroom;
+	m_Headroom = headroom;
+	m_Tailroom = newBufferLength - m_RawDataLen;
 
 	return true;
 }
@@ -183,6 +337,25 @@ bool RawPacket::removeData(int atIndex, size_t numOfBytesToRemove)
 		// memmove copies data as if there was an intermediate buffer inbetween - so it allows for copying processes on overlapping src/dest ptrs
 		memmove((uint8_t*)m_RawData + atIndex, (uint8_t*)m_RawData + atIndex + numOfBytesToRemove, m_RawDataLen - (atIndex + numOfBytesToRemove));
 	
+	m_RawDataLen -= numOfBytesToRemove;
+	m_FrameLength = m_RawDataLen;
+	m_Tailroom += numOfBytesToRemove;
+	return true;
+}
+
+bool RawPacket::removeDataUsingHeadroom(int atIndex, size_t numOfBytesToRemove)
+{
+	if (atIndex < 0 || (atIndex + (int)numOfBytesToRemove) > m_RawDataLen)
+	{
+		LOG_ERROR("Remove section is out of raw packet bound");
+		return false;
+	}
+
+	// move the data before the removed section forward and return the space to the headroom
+	memmove(m_RawData + numOfBytesToRemove, m_RawData, atIndex);
+	m_RawData += numOfBytesToRemove;
+	m_Headroom += numOfBytesToRemove;
+
 	m_RawDataLen -= numOfBytesToRemove;
 	m_FrameLength = m_RawDataLen;
 	return true;
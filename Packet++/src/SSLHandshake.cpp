@@ -4,6 +4,7 @@
 #include <string.h>
 #include <sstream>
 #include <map>
+#include <algorithm>
 #include "Logger.h"
 #include "SSLHandshake.h"
 
@@ -341,337 +342,381 @@ static const SSLCipherSuite Cipher323 = SSLCipherSuite(0xCCAD, SSL_KEYX_DHE, SSL
 static const SSLCipherSuite Cipher324 = SSLCipherSuite(0xCCAE, SSL_KEYX_RSA, SSL_AUTH_PSK, SSL_SYM_CHACHA20_POLY1305, SSL_HASH_SHA256, "TLS_RSA_PSK_WITH_CHACHA20_POLY1305_SHA256");
 
 
-static std::map<uint16_t, SSLCipherSuite*> createCipherSuiteIdToObjectMap()
-{
-	std::map<uint16_t, SSLCipherSuite*> result;
-
-	result[0x0000] = (SSLCipherSuite*)&Cipher1;
-	result[0x0001] = (SSLCipherSuite*)&Cipher2;
-	result[0x0002] = (SSLCipherSuite*)&Cipher3;
-	result[0x0003] = (SSLCipherSuite*)&Cipher4;
-	result[0x0004] = (SSLCipherSuite*)&Cipher5;
-	result[0x0005] = (SSLCipherSuite*)&Cipher6;
-	result[0x0006] = (SSLCipherSuite*)&Cipher7;
-	result[0x0007] = (SSLCipherSuite*)&Cipher8;
-	result[0x0008] = (SSLCipherSuite*)&Cipher9;
-	result[0x0009] = (SSLCipherSuite*)&Cipher10;
-	result[0x000A] = (SSLCipherSuite*)&Cipher11;
-	result[0x000B] = (SSLCipherSuite*)&Cipher12;
-	result[0x000C] = (SSLCipherSuite*)&Cipher13;
-	result[0x000D] = (SSLCipherSuite*)&Cipher14;
-	result[0x000E] = (SSLCipherSuite*)&Cipher15;
-	result[0x000F] = (SSLCipherSuite*)&Cipher16;
-	result[0x0010] = (SSLCipherSuite*)&Cipher17;
-	result[0x0011] = (SSLCipherSuite*)&Cipher18;
-	result[0x0012] = (SSLCipherSuite*)&Cipher19;
-	result[0x0013] = (SSLCipherSuite*)&Cipher20;
-	result[0x0014] = (SSLCipherSuite*)&Cipher21;
-	result[0x0015] = (SSLCipherSuite*)&Cipher22;
-	result[0x0016] = (SSLCipherSuite*)&Cipher23;
-	result[0x0017] = (SSLCipherSuite*)&Cipher24;
-	result[0x0018] = (SSLCipherSuite*)&Cipher25;
-	result[0x0019] = (SSLCipherSuite*)&Cipher26;
-	result[0x001A] = (SSLCipherSuite*)&Cipher27;
-	result[0x001B] = (SSLCipherSuite*)&Cipher28;
-	result[0x001E] = (SSLCipherSuite*)&Cipher29;
-	result[0x001F] = (SSLCipherSuite*)&Cipher30;
-	result[0x0020] = (SSLCipherSuite*)&Cipher31;
-	result[0x0021] = (SSLCipherSuite*)&Cipher32;
-	result[0x0022] = (SSLCipherSuite*)&Cipher33;
-	result[0x0023] = (SSLCipherSuite*)&Cipher34;
-	result[0x0024] = (SSLCipherSuite*)&Cipher35;
-	result[0x0025] = (SSLCipherSuite*)&Cipher36;
-	result[0x0026] = (SSLCipherSuite*)&Cipher37;
-	result[0x0027] = (SSLCipherSuite*)&Cipher38;
-	result[0x0028] = (SSLCipherSuite*)&Cipher39;
-	result[0x0029] = (SSLCipherSuite*)&Cipher40;
-	result[0x002A] = (SSLCipherSuite*)&Cipher41;
-	result[0x002B] = (SSLCipherSuite*)&Cipher42;
-	result[0x002C] = (SSLCipherSuite*)&Cipher43;
-	result[0x002D] = (SSLCipherSuite*)&Cipher44;
-	result[0x002E] = (SSLCipherSuite*)&Cipher45;
-	result[0x002F] = (SSLCipherSuite*)&Cipher46;
-	result[0x0030] = (SSLCipherSuite*)&Cipher47;
-	result[0x0031] = (SSLCipherSuite*)&Cipher48;
-	result[0x0032] = (SSLCipherSuite*)&Cipher49;
-	result[0x0033] = (SSLCipherSuite*)&Cipher50;
-	result[0x0034] = (SSLCipherSuite*)&Cipher51;
-	result[0x0035] = (SSLCipherSuite*)&Cipher52;
-	result[0x0036] = (SSLCipherSuite*)&Cipher53;
-	result[0x0037] = (SSLCipherSuite*)&Cipher54;
-	result[0x0038] = (SSLCipherSuite*)&Cipher55;
-	result[0x0039] = (SSLCipherSuite*)&Cipher56;
-	result[0x003A] = (SSLCipherSuite*)&Cipher57;
-	result[0x003B] = (SSLCipherSuite*)&Cipher58;
-	result[0x003C] = (SSLCipherSuite*)&Cipher59;
-	result[0x003D] = (SSLCipherSuite*)&Cipher60;
-	result[0x003E] = (SSLCipherSuite*)&Cipher61;
-	result[0x003F] = (SSLCipherSuite*)&Cipher62;
-	result[0x0040] = (SSLCipherSuite*)&Cipher63;
-	result[0x0041] = (SSLCipherSuite*)&Cipher64;
-	result[0x0042] = (SSLCipherSuite*)&Cipher65;
-	result[0x0043] = (SSLCipherSuite*)&Cipher66;
-	result[0x0044] = (SSLCipherSuite*)&Cipher67;
-	result[0x0045] = (SSLCipherSuite*)&Cipher68;
-	result[0x0046] = (SSLCipherSuite*)&Cipher69;
-	result[0x0067] = (SSLCipherSuite*)&Cipher70;
-	result[0x0068] = (SSLCipherSuite*)&Cipher71;
-	result[0x0069] = (SSLCipherSuite*)&Cipher72;
-	result[0x006A] = (SSLCipherSuite*)&Cipher73;
-	result[0x006B] = (SSLCipherSuite*)&Cipher74;
-	result[0x006C] = (SSLCipherSuite*)&Cipher75;
-	result[0x006D] = (SSLCipherSuite*)&Cipher76;
-	result[0x0084] = (SSLCipherSuite*)&Cipher77;
-	result[0x0085] = (SSLCipherSuite*)&Cipher78;
-	result[0x0086] = (SSLCipherSuite*)&Cipher79;
-	result[0x0087] = (SSLCipherSuite*)&Cipher80;
-	result[0x0088] = (SSLCipherSuite*)&Cipher81;
-	result[0x0089] = (SSLCipherSuite*)&Cipher82;
-	result[0x008A] = (SSLCipherSuite*)&Cipher83;
-	result[0x008B] = (SSLCipherSuite*)&Cipher84;
-	result[0x008C] = (SSLCipherSuite*)&Cipher85;
-	result[0x008D] = (SSLCipherSuite*)&Cipher86;
-	result[0x008E] = (SSLCipherSuite*)&Cipher87;
-	result[0x008F] = (SSLCipherSuite*)&Cipher88;
-	result[0x0090] = (SSLCipherSuite*)&Cipher89;
-	result[0x0091] = (SSLCipherSuite*)&Cipher90;
-	result[0x0092] = (SSLCipherSuite*)&Cipher91;
-	result[0x0093] = (SSLCipherSuite*)&Cipher92;
-	result[0x0094] = (SSLCipherSuite*)&Cipher93;
-	result[0x0095] = (SSLCipherSuite*)&Cipher94;
-	result[0x0096] = (SSLCipherSuite*)&Cipher95;
-	result[0x0097] = (SSLCipherSuite*)&Cipher96;
-	result[0x0098] = (SSLCipherSuite*)&Cipher97;
-	result[0x0099] = (SSLCipherSuite*)&Cipher98;
-	result[0x009A] = (SSLCipherSuite*)&Cipher99;
-	result[0x009B] = (SSLCipherSuite*)&Cipher100;
-	result[0x009C] = (SSLCipherSuite*)&Cipher101;
-	result[0x009D] = (SSLCipherSuite*)&Cipher102;
-	result[0x009E] = (SSLCipherSuite*)&Cipher103;
-	result[0x009F] = (SSLCipherSuite*)&Cipher104;
-	result[0x00A0] = (SSLCipherSuite*)&Cipher105;
-	result[0x00A1] = (SSLCipherSuite*)&Cipher106;
-	result[0x00A2] = (SSLCipherSuite*)&Cipher107;
-	result[0x00A3] = (SSLCipherSuite*)&Cipher108;
-	result[0x00A4] = (SSLCipherSuite*)&Cipher109;
-	result[0x00A5] = (SSLCipherSuite*)&Cipher110;
-	result[0x00A6] = (SSLCipherSuite*)&Cipher111;
-	result[0x00A7] = (SSLCipherSuite*)&Cipher112;
-	result[0x00A8] = (SSLCipherSuite*)&Cipher113;
-	result[0x00A9] = (SSLCipherSuite*)&Cipher114;
-	result[0x00AA] = (SSLCipherSuite*)&Cipher115;
-	result[0x00AB] = (SSLCipherSuite*)&Cipher116;
-	result[0x00AC] = (SSLCipherSuite*)&Cipher117;
-	result[0x00AD] = (SSLCipherSuite*)&Cipher118;
-	result[0x00AE] = (SSLCipherSuite*)&Cipher119;
-	result[0x00AF] = (SSLCipherSuite*)&Cipher120;
-	result[0x00B0] = (SSLCipherSuite*)&Cipher121;
-	result[0x00B1] = (SSLCipherSuite*)&Cipher122;
-	result[0x00B2] = (SSLCipherSuite*)&Cipher123;
-	result[0x00B3] = (SSLCipherSuite*)&Cipher124;
-	result[0x00B4] = (SSLCipherSuite*)&Cipher125;
-	result[0x00B5] = (SSLCipherSuite*)&Cipher126;
-	result[0x00B6] = (SSLCipherSuite*)&Cipher127;
-	result[0x00B7] = (SSLCipherSuite*)&Cipher128;
-	result[0x00B8] = (SSLCipherSuite*)&Cipher129;
-	result[0x00B9] = (SSLCipherSuite*)&Cipher130;
-	result[0x00BA] = (SSLCipherSuite*)&Cipher131;
-	result[0x00BB] = (SSLCipherSuite*)&Cipher132;
-	result[0x00BC] = (SSLCipherSuite*)&Cipher133;
-	result[0x00BD] = (SSLCipherSuite*)&Cipher134;
-	result[0x00BE] = (SSLCipherSuite*)&Cipher135;
-	result[0x00BF] = (SSLCipherSuite*)&Cipher136;
-	result[0x00C0] = (SSLCipherSuite*)&Cipher137;
-	result[0x00C1] = (SSLCipherSuite*)&Cipher138;
-	result[0x00C2] = (SSLCipherSuite*)&Cipher139;
-	result[0x00C3] = (SSLCipherSuite*)&Cipher140;
-	result[0x00C4] = (SSLCipherSuite*)&Cipher141;
-	result[0x00C5] = (SSLCipherSuite*)&Cipher142;
-	result[0xC001] = (SSLCipherSuite*)&Cipher143;
-	result[0xC002] = (SSLCipherSuite*)&Cipher144;
-	result[0xC003] = (SSLCipherSuite*)&Cipher145;
-	result[0xC004] = (SSLCipherSuite*)&Cipher146;
-	result[0xC005] = (SSLCipherSuite*)&Cipher147;
-	result[0xC006] = (SSLCipherSuite*)&Cipher148;
-	result[0xC007] = (SSLCipherSuite*)&Cipher149;
-	result[0xC008] = (SSLCipherSuite*)&Cipher150;
-	result[0xC009] = (SSLCipherSuite*)&Cipher151;
-	result[0xC00A] = (SSLCipherSuite*)&Cipher152;
-	result[0xC00B] = (SSLCipherSuite*)&Cipher153;
-	result[0xC00C] = (SSLCipherSuite*)&Cipher154;
-	result[0xC00D] = (SSLCipherSuite*)&Cipher155;
-	result[0xC00E] = (SSLCipherSuite*)&Cipher156;
-	result[0xC00F] = (SSLCipherSuite*)&Cipher157;
-	result[0xC010] = (SSLCipherSuite*)&Cipher158;
-	result[0xC011] = (SSLCipherSuite*)&Cipher159;
-	result[0xC012] = (SSLCipherSuite*)&Cipher160;
-	result[0xC013] = (SSLCipherSuite*)&Cipher161;
-	result[0xC014] = (SSLCipherSuite*)&Cipher162;
-	result[0xC015] = (SSLCipherSuite*)&Cipher163;
-	result[0xC016] = (SSLCipherSuite*)&Cipher164;
-	result[0xC017] = (SSLCipherSuite*)&Cipher165;
-	result[0xC018] = (SSLCipherSuite*)&Cipher166;
-	result[0xC019] = (SSLCipherSuite*)&Cipher167;
-	result[0xC01A] = (SSLCipherSuite*)&Cipher168;
-	result[0xC01B] = (SSLCipherSuite*)&Cipher169;
-	result[0xC01C] = (SSLCipherSuite*)&Cipher170;
-	result[0xC01D] = (SSLCipherSuite*)&Cipher171;
-	result[0xC01E] = (SSLCipherSuite*)&Cipher172;
-	result[0xC01F] = (SSLCipherSuite*)&Cipher173;
-	result[0xC020] = (SSLCipherSuite*)&Cipher174;
-	result[0xC021] = (SSLCipherSuite*)&Cipher175;
-	result[0xC022] = (SSLCipherSuite*)&Cipher176;
-	result[0xC023] = (SSLCipherSuite*)&Cipher177;
-	result[0xC024] = (SSLCipherSuite*)&Cipher178;
-	result[0xC025] = (SSLCipherSuite*)&Cipher179;
-	result[0xC026] = (SSLCipherSuite*)&Cipher180;
-	result[0xC027] = (SSLCipherSuite*)&Cipher181;
-	result[0xC028] = (SSLCipherSuite*)&Cipher182;
-	result[0xC029] = (SSLCipherSuite*)&Cipher183;
-	result[0xC02A] = (SSLCipherSuite*)&Cipher184;
-	result[0xC02B] = (SSLCipherSuite*)&Cipher185;
-	result[0xC02C] = (SSLCipherSuite*)&Cipher186;
-	result[0xC02D] = (SSLCipherSuite*)&Cipher187;
-	result[0xC02E] = (SSLCipherSuite*)&Cipher188;
-	result[0xC02F] = (SSLCipherSuite*)&Cipher189;
-	result[0xC030] = (SSLCipherSuite*)&Cipher190;
-	result[0xC031] = (SSLCipherSuite*)&Cipher191;
-	result[0xC032] = (SSLCipherSuite*)&Cipher192;
-	result[0xC033] = (SSLCipherSuite*)&Cipher193;
-	result[0xC034] = (SSLCipherSuite*)&Cipher194;
-	result[0xC035] = (SSLCipherSuite*)&Cipher195;
-	result[0xC036] = (SSLCipherSuite*)&Cipher196;
-	result[0xC037] = (SSLCipherSuite*)&Cipher197;
-	result[0xC038] = (SSLCipherSuite*)&Cipher198;
-	result[0xC039] = (SSLCipherSuite*)&Cipher199;
-	result[0xC03A] = (SSLCipherSuite*)&Cipher200;
-	result[0xC03B] = (SSLCipherSuite*)&Cipher201;
-	result[0xC03C] = (SSLCipherSuite*)&Cipher202;
-	result[0xC03D] = (SSLCipherSuite*)&Cipher203;
-	result[0xC03E] = (SSLCipherSuite*)&Cipher204;
-	result[0xC03F] = (SSLCipherSuite*)&Cipher205;
-	result[0xC040] = (SSLCipherSuite*)&Cipher206;
-	result[0xC041] = (SSLCipherSuite*)&Cipher207;
-	result[0xC042] = (SSLCipherSuite*)&Cipher208;
-	result[0xC043] = (SSLCipherSuite*)&Cipher209;
-	result[0xC044] = (SSLCipherSuite*)&Cipher210;
-	result[0xC045] = (SSLCipherSuite*)&Cipher211;
-	result[0xC046] = (SSLCipherSuite*)&Cipher212;
-	result[0xC047] = (SSLCipherSuite*)&Cipher213;
-	result[0xC048] = (SSLCipherSuite*)&Cipher214;
-	result[0xC049] = (SSLCipherSuite*)&Cipher215;
-	result[0xC04A] = (SSLCipherSuite*)&Cipher216;
-	result[0xC04B] = (SSLCipherSuite*)&Cipher217;
-	result[0xC04C] = (SSLCipherSuite*)&Cipher218;
-	result[0xC04D] = (SSLCipherSuite*)&Cipher219;
-	result[0xC04E] = (SSLCipherSuite*)&Cipher220;
-	result[0xC04F] = (SSLCipherSuite*)&Cipher221;
-	result[0xC050] = (SSLCipherSuite*)&Cipher222;
-	result[0xC051] = (SSLCipherSuite*)&Cipher223;
-	result[0xC052] = (SSLCipherSuite*)&Cipher224;
-	result[0xC053] = (SSLCipherSuite*)&Cipher225;
-	result[0xC054] = (SSLCipherSuite*)&Cipher226;
-	result[0xC055] = (SSLCipherSuite*)&Cipher227;
-	result[0xC056] = (SSLCipherSuite*)&Cipher228;
-	result[0xC057] = (SSLCipherSuite*)&Cipher229;
-	result[0xC058] = (SSLCipherSuite*)&Cipher230;
-	result[0xC059] = (SSLCipherSuite*)&Cipher231;
-	result[0xC05A] = (SSLCipherSuite*)&Cipher232;
-	result[0xC05B] = (SSLCipherSuite*)&Cipher233;
-	result[0xC05C] = (SSLCipherSuite*)&Cipher234;
-	result[0xC05D] = (SSLCipherSuite*)&Cipher235;
-	result[0xC05E] = (SSLCipherSuite*)&Cipher236;
-	result[0xC05F] = (SSLCipherSuite*)&Cipher237;
-	result[0xC060] = (SSLCipherSuite*)&Cipher238;
-	result[0xC061] = (SSLCipherSuite*)&Cipher239;
-	result[0xC062] = (SSLCipherSuite*)&Cipher240;
-	result[0xC063] = (SSLCipherSuite*)&Cipher241;
-	result[0xC064] = (SSLCipherSuite*)&Cipher242;
-	result[0xC065] = (SSLCipherSuite*)&Cipher243;
-	result[0xC066] = (SSLCipherSuite*)&Cipher244;
-	result[0xC067] = (SSLCipherSuite*)&Cipher245;
-	result[0xC068] = (SSLCipherSuite*)&Cipher246;
-	result[0xC069] = (SSLCipherSuite*)&Cipher247;
-	result[0xC06A] = (SSLCipherSuite*)&Cipher248;
-	result[0xC06B] = (SSLCipherSuite*)&Cipher249;
-	result[0xC06C] = (SSLCipherSuite*)&Cipher250;
-	result[0xC06D] = (SSLCipherSuite*)&Cipher251;
-	result[0xC06E] = (SSLCipherSuite*)&Cipher252;
-	result[0xC06F] = (SSLCipherSuite*)&Cipher253;
-	result[0xC070] = (SSLCipherSuite*)&Cipher254;
-	result[0xC071] = (SSLCipherSuite*)&Cipher255;
-	result[0xC072] = (SSLCipherSuite*)&Cipher256;
-	result[0xC073] = (SSLCipherSuite*)&Cipher257;
-	result[0xC074] = (SSLCipherSuite*)&Cipher258;
-	result[0xC075] = (SSLCipherSuite*)&Cipher259;
-	result[0xC076] = (SSLCipherSuite*)&Cipher260;
-	result[0xC077] = (SSLCipherSuite*)&Cipher261;
-	result[0xC078] = (SSLCipherSuite*)&Cipher262;
-	result[0xC079] = (SSLCipherSuite*)&Cipher263;
-	result[0xC07A] = (SSLCipherSuite*)&Cipher264;
-	result[0xC07B] = (SSLCipherSuite*)&Cipher265;
-	result[0xC07C] = (SSLCipherSuite*)&Cipher266;
-	result[0xC07D] = (SSLCipherSuite*)&Cipher267;
-	result[0xC07E] = (SSLCipherSuite*)&Cipher268;
-	result[0xC07F] = (SSLCipherSuite*)&Cipher269;
-	result[0xC080] = (SSLCipherSuite*)&Cipher270;
-	result[0xC081] = (SSLCipherSuite*)&Cipher271;
-	result[0xC082] = (SSLCipherSuite*)&Cipher272;
-	result[0xC083] = (SSLCipherSuite*)&Cipher273;
-	result[0xC084] = (SSLCipherSuite*)&Cipher274;
-	result[0xC085] = (SSLCipherSuite*)&Cipher275;
-	result[0xC086] = (SSLCipherSuite*)&Cipher276;
-	result[0xC087] = (SSLCipherSuite*)&Cipher277;
-	result[0xC088] = (SSLCipherSuite*)&Cipher278;
-	result[0xC089] = (SSLCipherSuite*)&Cipher279;
-	result[0xC08A] = (SSLCipherSuite*)&Cipher280;
-	result[0xC08B] = (SSLCipherSuite*)&Cipher281;
-	result[0xC08C] = (SSLCipherSuite*)&Cipher282;
-	result[0xC08D] = (SSLCipherSuite*)&Cipher283;
-	result[0xC08E] = (SSLCipherSuite*)&Cipher284;
-	result[0xC08F] = (SSLCipherSuite*)&Cipher285;
-	result[0xC090] = (SSLCipherSuite*)&Cipher286;
-	result[0xC091] = (SSLCipherSuite*)&Cipher287;
-	result[0xC092] = (SSLCipherSuite*)&Cipher288;
-	result[0xC093] = (SSLCipherSuite*)&Cipher289;
-	result[0xC094] = (SSLCipherSuite*)&Cipher290;
-	result[0xC095] = (SSLCipherSuite*)&Cipher291;
-	result[0xC096] = (SSLCipherSuite*)&Cipher292;
-	result[0xC097] = (SSLCipherSuite*)&Cipher293;
-	result[0xC098] = (SSLCipherSuite*)&Cipher294;
-	result[0xC099] = (SSLCipherSuite*)&Cipher295;
-	result[0xC09A] = (SSLCipherSuite*)&Cipher296;
-	result[0xC09B] = (SSLCipherSuite*)&Cipher297;
-	result[0xC09C] = (SSLCipherSuite*)&Cipher298;
-	result[0xC09D] = (SSLCipherSuite*)&Cipher299;
-	result[0xC09E] = (SSLCipherSuite*)&Cipher300;
-	result[0xC09F] = (SSLCipherSuite*)&Cipher301;
-	result[0xC0A0] = (SSLCipherSuite*)&Cipher302;
-	result[0xC0A1] = (SSLCipherSuite*)&Cipher303;
-	result[0xC0A2] = (SSLCipherSuite*)&Cipher304;
-	result[0xC0A3] = (SSLCipherSuite*)&Cipher305;
-	result[0xC0A4] = (SSLCipherSuite*)&Cipher306;
-	result[0xC0A5] = (SSLCipherSuite*)&Cipher307;
-	result[0xC0A6] = (SSLCipherSuite*)&Cipher308;
-	result[0xC0A7] = (SSLCipherSuite*)&Cipher309;
-	result[0xC0A8] = (SSLCipherSuite*)&Cipher310;
-	result[0xC0A9] = (SSLCipherSuite*)&Cipher311;
-	result[0xC0AA] = (SSLCipherSuite*)&Cipher312;
-	result[0xC0AB] = (SSLCipherSuite*)&Cipher313;
-	result[0xC0AC] = (SSLCipherSuite*)&Cipher314;
-	result[0xC0AD] = (SSLCipherSuite*)&Cipher315;
-	result[0xC0AE] = (SSLCipherSuite*)&Cipher316;
-	result[0xC0AF] = (SSLCipherSuite*)&Cipher317;
-	result[0xCCA8] = (SSLCipherSuite*)&Cipher318;
-	result[0xCCA9] = (SSLCipherSuite*)&Cipher319;
-	result[0xCCAA] = (SSLCipherSuite*)&Cipher320;
-	result[0xCCAB] = (SSLCipherSuite*)&Cipher321;
-	result[0xCCAC] = (SSLCipherSuite*)&Cipher322;
-	result[0xCCAD] = (SSLCipherSuite*)&Cipher323;
-	result[0xCCAE] = (SSLCipherSuite*)&Cipher324;
+// all known cipher-suites
+static const SSLCipherSuite* const CipherSuites[] = {
+	&Cipher1,
+	&Cipher2,
+	&Cipher3,
+	&Cipher4,
+	&Cipher5,
+	&Cipher6,
+	&Cipher7,
+	&Cipher8,
+	&Cipher9,
+	&Cipher10,
+	&Cipher11,
+	&Cipher12,
+	&Cipher13,
+	&Cipher14,
+	&Cipher15,
+	&Cipher16,
+	&Cipher17,
+	&Cipher18,
+	&Cipher19,
+	&Cipher20,
+	&Cipher21,
+	&Cipher22,
+	&Cipher23,
+	&Cipher24,
+	&Cipher25,
+	&Cipher26,
+	&Cipher27,
+	&Cipher28,
+	&Cipher29,
+	&Cipher30,
+	&Cipher31,
+	&Cipher32,
+	&Cipher33,
+	&Cipher34,
+	&Cipher35,
+	&Cipher36,
+	&Cipher37,
+	&Cipher38,
+	&Cipher39,
+	&Cipher40,
+	&Cipher41,
+	&Cipher42,
+	&Cipher43,
+	&Cipher44,
+	&Cipher45,
+	&Cipher46,
+	&Cipher47,
+	&Cipher48,
+	&Cipher49,
+	&Cipher50,
+	&Cipher51,
+	&Cipher52,
+	&Cipher53,
+	&Cipher54,
+	&Cipher55,
+	&Cipher56,
+	&Cipher57,
+	&Cipher58,
+	&Cipher59,
+	&Cipher60,
+	&Cipher61,
+	&Cipher62,
+	&Cipher63,
+	&Cipher64,
+	&Cipher65,
+	&Cipher66,
+	&Cipher67,
+	&Cipher68,
+	&Cipher69,
+	&Cipher70,
+	&Cipher71,
+	&Cipher72,
+	&Cipher73,
+	&Cipher74,
+	&Cipher75,
+	&Cipher76,
+	&Cipher77,
+	&Cipher78,
+	&Cipher79,
+	&Cipher80,
+	&Cipher81,
+	&Cipher82,
+	&Cipher83,
+	&Cipher84,
+	&Cipher85,
+	&Cipher86,
+	&Cipher87,
+	&Cipher88,
+	&Cipher89,
+	&Cipher90,
+	&Cipher91,
+	&Cipher92,
+	&Cipher93,
+	&Cipher94,
+	&Cipher95,
+	&Cipher96,
+	&Cipher97,
+	&Cipher98,
+	&Cipher99,
+	&Cipher100,
+	&Cipher101,
+	&Cipher102,
+	&Cipher103,
+	&Cipher104,
+	&Cipher105,
+	&Cipher106,
+	&Cipher107,
+	&Cipher108,
+	&Cipher109,
+	&Cipher110,
+	&Cipher111,
+	&Cipher112,
+	&Cipher113,
+	&Cipher114,
+	&Cipher115,
+	&Cipher116,
+	&Cipher117,
+	&Cipher118,
+	&Cipher119,
+	&Cipher120,
+	&Cipher121,
+	&Cipher122,
+	&Cipher123,
+	&Cipher124,
+	&Cipher125,
+	&Cipher126,
+	&Cipher127,
+	&Cipher128,
+	&Cipher129,
+	&Cipher130,
+	&Cipher131,
+	&Cipher132,
+	&Cipher133,
+	&Cipher134,
+	&Cipher135,
+	&Cipher136,
+	&Cipher137,
+	&Cipher138,
+	&Cipher139,
+	&Cipher140,
+	&Cipher141,
+	&Cipher142,
+	&Cipher143,
+	&Cipher144,
+	&Cipher145,
+	&Cipher146,
+	&Cipher147,
+	&Cipher148,
+	&Cipher149,
+	&Cipher150,
+	&Cipher151,
+	&Cipher152,
+	&Cipher153,
+	&Cipher154,
+	&Cipher155,
+	&Cipher156,
+	&Cipher157,
+	&Cipher158,
+	&Cipher159,
+	&Cipher160,
+	&Cipher161,
+	&Cipher162,
+	&Cipher163,
+	&Cipher164,
+	&Cipher165,
+	&Cipher166,
+	&Cipher167,
+	&Cipher168,
+	&Cipher169,
+	&Cipher170,
+	&Cipher171,
+	&Cipher172,
+	&Cipher173,
+	&Cipher174,
+	&Cipher175,
+	&Cipher176,
+	&Cipher177,
+	&Cipher178,
+	&Cipher179,
+	&Cipher180,
+	&Cipher181,
+	&Cipher182,
+	&Cipher183,
+	&Cipher184,
+	&Cipher185,
+	&Cipher186,
+	&Cipher187,
+	&Cipher188,
+	&Cipher189,
+	&Cipher190,
+	&Cipher191,
+	&Cipher192,
+	&Cipher193,
+	&Cipher194,
+	&Cipher195,
+	&Cipher196,
+	&Cipher197,
+	&Cipher198,
+	&Cipher199,
+	&Cipher200,
+	&Cipher201,
+	&Cipher202,
+	&Cipher203,
+	&Cipher204,
+	&Cipher205,
+	&Cipher206,
+	&Cipher207,
+	&Cipher208,
+	&Cipher209,
+	&Cipher210,
+	&Cipher211,
+	&Cipher212,
+	&Cipher213,
+	&Cipher214,
+	&Cipher215,
+	&Cipher216,
+	&Cipher217,
+	&Cipher218,
+	&Cipher219,
+	&Cipher220,
+	&Cipher221,
+	&Cipher222,
+	&Cipher223,
+	&Cipher224,
+	&Cipher225,
+	&Cipher226,
+	&Cipher227,
+	&Cipher228,
+	&Cipher229,
+	&Cipher230,
+	&Cipher231,
+	&Cipher232,
+	&Cipher233,
+	&Cipher234,
+	&Cipher235,
+	&Cipher236,
+	&Cipher237,
+	&Cipher238,
+	&Cipher239,
+	&Cipher240,
+	&Cipher241,
+	&Cipher242,
+	&Cipher243,
+	&Cipher244,
+	&Cipher245,
+	&Cipher246,
+	&Cipher247,
+	&Cipher248,
+	&Cipher249,
+	&Cipher250,
+	&Cipher251,
+	&Cipher252,
+	&Cipher253,
+	&Cipher254,
+	&Cipher255,
+	&Cipher256,
+	&Cipher257,
+	&Cipher258,
+	&Cipher259,
+	&Cipher260,
+	&Cipher261,
+	&Cipher262,
+	&Cipher263,
+	&Cipher264,
+	&Cipher265,
+	&Cipher266,
+	&Cipher267,
+	&Cipher268,
+	&Cipher269,
+	&Cipher270,
+	&Cipher271,
+	&Cipher272,
+	&Cipher273,
+	&Cipher274,
+	&Cipher275,
+	&Cipher276,
+	&Cipher277,
+	&Cipher278,
+	&Cipher279,
+	&Cipher280,
+	&Cipher281,
+	&Cipher282,
+	&Cipher283,
+	&Cipher284,
+	&Cipher285,
+	&Cipher286,
+	&Cipher287,
+	&Cipher288,
+	&Cipher289,
+	&Cipher290,
+	&Cipher291,
+	&Cipher292,
+	&Cipher293,
+	&Cipher294,
+	&Cipher295,
+	&Cipher296,
+	&Cipher297,
+	&Cipher298,
+	&Cipher299,
+	&Cipher300,
+	&Cipher301,
+	&Cipher302,
+	&Cipher303,
+	&Cipher304,
+	&Cipher305,
+	&Cipher306,
+	&Cipher307,
+	&Cipher308,
+	&Cipher309,
+	&Cipher310,
+	&Cipher311,
+	&Cipher312,
+	&Cipher313,
+	&Cipher314,
+	&Cipher315,
+	&Cipher316,
+	&Cipher317,
+	&Cipher318,
+	&Cipher319,
+	&Cipher320,
+	&Cipher321,
+	&Cipher322,
+	&Cipher323,
+	&Cipher324
+};
+
+// the maximum number of pages of CipherSuiteIdTable. The known cipher-suites need only 3 pages (0x00, 0xC0 and 0xCC)
+#define PCPP_CIPHER_SUITE_TABLE_MAX_PAGES 8
+
+// A flat lookup table of cipher-suites by ID. The high byte of the ID selects a page of 256 entries which is indexed by the low
+// byte, so a lookup is two array accesses. Only pages that contain known cipher-suites exist
+class CipherSuiteIdTable
+{
+public:
+	CipherSuiteIdTable()
+	{
+		memset(m_PageOfHighByte, 0, sizeof(m_PageOfHighByte));
+		memset(m_Pages, 0, sizeof(m_Pages));
+		m_NumOfPages = 0;
 
-	return result;
-}
+		for (size_t i = 0; i < sizeof(CipherSuites)/sizeof(CipherSuites[0]); i++)
+			addCipherSuite(CipherSuites[i]);
+	}
+
+	SSLCipherSuite* getCipherSuite(uint16_t id) const
+	{
+		uint8_t page = m_PageOfHighByte[id >> 8];
+		if (page == 0)
+			return NULL;
+
+		return m_Pages[page - 1][id & 0xff];
+	}
+
+private:
+	// the page number of each high byte plus 1, or 0 if there is no page for this high byte
+	uint8_t m_PageOfHighByte[256];
+	SSLCipherSuite* m_Pages[PCPP_CIPHER_SUITE_TABLE_MAX_PAGES][256];
+	size_t m_NumOfPages;
+
+	void addCipherSuite(const SSLCipherSuite* cipherSuite)
+	{
+		uint8_t highByte = (uint8_t)(cipherSuite->getID() >> 8);
+		if (m_PageOfHighByte[highByte] == 0)
+		{
+			if (m_NumOfPages == PCPP_CIPHER_SUITE_TABLE_MAX_PAGES)
+				return;
+
+			m_PageOfHighByte[highByte] = (uint8_t)(++m_NumOfPages);
+		}
+
+		m_Pages[m_PageOfHighByte[highByte] - 1][cipherSuite->getID() & 0xff] = (SSLCipherSuite*)cipherSuite;
+	}
+};
 
 static std::map<std::string, SSLCipherSuite*> createCipherSuiteStringToObjectMap()
 {
@@ -1005,17 +1050,13 @@ static std::map<std::string, SSLCipherSuite*> createCipherSuiteStringToObjectMap
 	return result;
 }
 
-static const std::map<uint16_t, SSLCipherSuite*> CipherSuiteIdToObjectMap = createCipherSuiteIdToObjectMap();
+static const CipherSuiteIdTable CipherSuiteIdToObjectTable;
 
 static const std::map<std::string, SSLCipherSuite*> CipherSuiteStringToObjectMap = createCipherSuiteStringToObjectMap();
 
 SSLCipherSuite* SSLCipherSuite::getCipherSuiteByID(uint16_t id)
 {
-	std::map<uint16_t, SSLCipherSuite*>::const_iterator pos = CipherSuiteIdToObjectMap.find(id);
-	if (pos == CipherSuiteIdToObjectMap.end())
-	    return NULL;
-	else
-	    return pos->second;
+	return CipherSuiteIdToObjectTable.getCipherSuite(id);
 }
 
 SSLCipherSuite* SSLCipherSuite::getCipherSuiteByName(std::string name)
@@ -1159,13 +1200,391 @@ bool SSLHandshakeMessage::isMessageComplete() const
 }
 
 
+// ---------------------------------
+// JA3/JA3S fingerprint calculation
+// ---------------------------------
+
+// A minimal MD5 implementation (RFC 1321) for hashing JA3/JA3S fingerprints without allocating memory
+struct MD5Context
+{
+	uint32_t state[4];
+	uint64_t numOfBytes;
+	uint8_t block[64];
+};
+
+#define PCPP_MD5_ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+static const uint32_t MD5SineTable[64] = {
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static const uint8_t MD5ShiftTable[64] = {
+	7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+	5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20, 5, 9, 14, 20,
+	4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+	6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+};
+
+static void md5Init(MD5Context& context)
+{
+	context.state[0] = 0x67452301;
+	context.state[1] = 0xefcdab89;
+	context.state[2] = 0x98badcfe;
+	context.state[3] = 0x10325476;
+	context.numOfBytes = 0;
+}
+
+static void md5ProcessBlock(MD5Context& context, const uint8_t* block)
+{
+	uint32_t words[16];
+	for (int i = 0; i < 16; i++)
+		words[i] = (uint32_t)block[i*4] | ((uint32_t)block[i*4 + 1] << 8) | ((uint32_t)block[i*4 + 2] << 16) | ((uint32_t)block[i*4 + 3] << 24);
+
+	uint32_t a = context.state[0], b = context.state[1], c = context.state[2], d = context.state[3];
+	for (int i = 0; i < 64; i++)
+	{
+		uint32_t f;
+		int wordIndex;
+		if (i < 16)
+		{
+			f = (b & c) | (~b & d);
+			wordIndex = i;
+		}
+		else if (i < 32)
+		{
+			f = (d & b) | (~d & c);
+			wordIndex = (5*i + 1) % 16;
+		}
+		else if (i < 48)
+		{
+			f = b ^ c ^ d;
+			wordIndex = (3*i + 5) % 16;
+		}
+		else
+		{
+			f = c ^ (b | ~d);
+			wordIndex = (7*i) % 16;
+		}
+
+		uint32_t temp = d;
+		d = c;
+		c = b;
+		b = b + PCPP_MD5_ROTL32(a + f + MD5SineTable[i] + words[wordIndex], MD5ShiftTable[i]);
+		a = temp;
+	}
+
+	context.state[0] += a;
+	context.state[1] += b;
+	context.state[2] += c;
+	context.state[3] += d;
+}
+
+static void md5Update(MD5Context& context, const uint8_t* data, size_t dataLen)
+{
+	size_t blockOffset = (size_t)(context.numOfBytes % 64);
+	context.numOfBytes += dataLen;
+
+	while (dataLen > 0)
+	{
+		size_t bytesToCopy = 64 - blockOffset;
+		if (bytesToCopy > dataLen)
+			bytesToCopy = dataLen;
+
+		memcpy(context.block + blockOffset, data, bytesToCopy);
+		blockOffset += bytesToCopy;
+		data += bytesToCopy;
+		dataLen -= bytesToCopy;
+
+		if (blockOffset == 64)
+		{
+			md5ProcessBlock(context, context.block);
+			blockOffset = 0;
+		}
+	}
+}
+
+static void md5Final(MD5Context& context, uint8_t digest[16])
+{
+	uint64_t numOfBits = context.numOfBytes * 8;
+
+	// pad with 0x80 and zeros up to 8 bytes before the end of a block, then append the message length in bits (little endian)
+	uint8_t padding[64];
+	memset(padding, 0, sizeof(padding));
+	padding[0] = 0x80;
+	size_t blockOffset = (size_t)(context.numOfBytes % 64);
+	md5Update(context, padding, (blockOffset < 56 ? 56 - blockOffset : 120 - blockOffset));
+
+	uint8_t lengthBytes[8];
+	for (int i = 0; i < 8; i++)
+		lengthBytes[i] = (uint8_t)(numOfBits >> (8*i));
+	md5Update(context, lengthBytes, sizeof(lengthBytes));
+
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			digest[i*4 + j] = (uint8_t)(context.state[i] >> (8*j));
+}
+
+// GREASE values (RFC 8701) are of the form 0x?A?A where both bytes are equal. JA3 ignores them
+static inline bool isGreaseValue(uint16_t value)
+{
+	return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
+}
+
+// Writes a fingerprint string into a caller buffer, or feeds it into an MD5 calculation
+class FingerprintWriter
+{
+public:
+	FingerprintWriter(char* buffer, size_t bufferLen) : m_Buffer(buffer), m_BufferLen(bufferLen), m_Length(0), m_IsTruncated(false), m_MD5Context(NULL)
+	{
+		m_Buffer[0] = 0;
+	}
+
+	explicit FingerprintWriter(MD5Context* md5Context) : m_Buffer(NULL), m_BufferLen(0), m_Length(0), m_IsTruncated(false), m_MD5Context(md5Context) {}
+
+	void append(const char* str, size_t len)
+	{
+		if (m_MD5Context != NULL)
+			md5Update(*m_MD5Context, (const uint8_t*)str, len);
+		else if (m_Length + len + 1 > m_BufferLen)
+			m_IsTruncated = true;
+		else
+		{
+			memcpy(m_Buffer + m_Length, str, len);
+			m_Buffer[m_Length + len] = 0;
+		}
+
+		m_Length += len;
+	}
+
+	void appendSeparator(char separator) { append(&separator, 1); }
+
+	void appendNumber(uint32_t number)
+	{
+		char digits[10];
+		size_t numOfDigits = 0;
+		do
+		{
+			digits[sizeof(digits) - 1 - numOfDigits++] = (char)('0' + number % 10);
+			number /= 10;
+		} while (number > 0);
+
+		append(digits + sizeof(digits) - numOfDigits, numOfDigits);
+	}
+
+	// write the values of a list of 1 or 2 byte big endian values separated by '-', skipping GREASE values
+	void appendValueList(const uint8_t* list, size_t listLen, size_t valueSize)
+	{
+		bool isFirst = true;
+		for (size_t offset = 0; offset + valueSize <= listLen; offset += valueSize)
+		{
+			uint16_t value = (valueSize == 1 ? list[offset] : (uint16_t)((list[offset] << 8) | list[offset + 1]));
+			if (valueSize == sizeof(uint16_t) && isGreaseValue(value))
+				continue;
+
+			if (!isFirst)
+				appendSeparator('-');
+			appendNumber(value);
+			isFirst = false;
+		}
+	}
+
+	bool isTruncated() const { return m_IsTruncated; }
+
+	size_t getLength() const { return m_Length; }
+
+private:
+	char* m_Buffer;
+	size_t m_BufferLen;
+	size_t m_Length;
+	bool m_IsTruncated;
+	MD5Context* m_MD5Context;
+};
+
+// The variable length fields of a client-hello or server-hello message as located by walking over the raw message
+struct HelloMessageFields
+{
+	uint16_t handshakeVersion;
+	const uint8_t* cipherSuites;
+	size_t cipherSuitesLen;
+	const uint8_t* extensions;
+	size_t extensionsLen;
+};
+
+static bool locateHelloMessageFields(const uint8_t* data, size_t dataLen, bool isClientHello, HelloMessageFields& fields)
+{
+	size_t offset = sizeof(ssl_tls_client_server_hello);
+	if (offset + sizeof(uint8_t) > dataLen)
+		return false;
+
+	fields.handshakeVersion = be16toh(((ssl_tls_client_server_hello*)data)->handshakeVersion);
+
+	// session ID
+	offset += sizeof(uint8_t) + data[offset];
+
+	// cipher-suites: a list in the client-hello, a single cipher-suite in the server-hello
+	if (isClientHello)
+	{
+		if (offset + sizeof(uint16_t) > dataLen)
+			return false;
+
+		fields.cipherSuitesLen = be16toh(*(uint16_t*)(data + offset));
+		offset += sizeof(uint16_t);
+	}
+	else
+		fields.cipherSuitesLen = sizeof(uint16_t);
+
+	if (offset + fields.cipherSuitesLen > dataLen)
+		return false;
+
+	fields.cipherSuites = data + offset;
+	offset += fields.cipherSuitesLen;
+
+	// compression methods: a list in the client-hello, a single byte in the server-hello
+	if (isClientHello)
+		offset += sizeof(uint8_t) + (offset < dataLen ? data[offset] : 0);
+	else
+		offset += sizeof(uint8_t);
+
+	// the extensions are optional. If the extension list is truncated use only the extensions within the message bounds
+	fields.extensions = NULL;
+	fields.extensionsLen = 0;
+	if (offset + sizeof(uint16_t) <= dataLen)
+	{
+		fields.extensionsLen = be16toh(*(uint16_t*)(data + offset));
+		offset += sizeof(uint16_t);
+		fields.extensions = data + offset;
+		if (offset + fields.extensionsLen > dataLen)
+			fields.extensionsLen = dataLen - offset;
+	}
+
+	return true;
+}
+
+// write the "handshake version,cipher-suites,extensions" part common to JA3 and JA3S. For JA3 also write the elliptic curves and
+// the elliptic curve point formats, which are taken from the supported groups and EC point formats extensions
+static bool writeFingerprint(const uint8_t* data, size_t dataLen, bool isClientHello, FingerprintWriter& writer)
+{
+	HelloMessageFields fields;
+	if (!locateHelloMessageFields(data, dataLen, isClientHello, fields))
+		return false;
+
+	writer.appendNumber(fields.handshakeVersion);
+	writer.appendSeparator(',');
+	writer.appendValueList(fields.cipherSuites, fields.cipherSuitesLen, sizeof(uint16_t));
+	writer.appendSeparator(',');
+
+	const uint8_t* ellipticCurves = NULL;
+	size_t ellipticCurvesLen = 0;
+	const uint8_t* pointFormats = NULL;
+	size_t pointFormatsLen = 0;
+
+	bool isFirst = true;
+	size_t offset = 0;
+	while (offset + 2*sizeof(uint16_t) <= fields.extensionsLen)
+	{
+		const uint8_t* extension = fields.extensions + offset;
+		uint16_t extensionType = be16toh(*(uint16_t*)extension);
+		size_t extensionDataLen = be16toh(*(uint16_t*)(extension + sizeof(uint16_t)));
+		const uint8_t* extensionData = extension + 2*sizeof(uint16_t);
+		offset += 2*sizeof(uint16_t) + extensionDataLen;
+		if (offset > fields.extensionsLen)
+			break;
+
+		if (!isGreaseValue(extensionType))
+		{
+			if (!isFirst)
+				writer.appendSeparator('-');
+			writer.appendNumber(extensionType);
+			isFirst = false;
+		}
+
+		if (extensionType == SSL_EXT_ELLIPTIC_CURVES && extensionDataLen >= sizeof(uint16_t))
+		{
+			ellipticCurves = extensionData + sizeof(uint16_t);
+			ellipticCurvesLen = std::min<size_t>(be16toh(*(uint16_t*)extensionData), extensionDataLen - sizeof(uint16_t));
+		}
+		else if (extensionType == SSL_EXT_EC_POINT_FORMATS && extensionDataLen >= sizeof(uint8_t))
+		{
+			pointFormats = extensionData + sizeof(uint8_t);
+			pointFormatsLen = std::min<size_t>(extensionData[0], extensionDataLen - sizeof(uint8_t));
+		}
+	}
+
+	if (isClientHello)
+	{
+		writer.appendSeparator(',');
+		writer.appendValueList(ellipticCurves, ellipticCurvesLen, sizeof(uint16_t));
+		writer.appendSeparator(',');
+		writer.appendValueList(pointFormats, pointFormatsLen, sizeof(uint8_t));
+	}
+
+	return true;
+}
+
+static bool writeFingerprintString(const uint8_t* data, size_t dataLen, bool isClientHello, char* buffer, size_t bufferLen, size_t* fingerprintLen)
+{
+	if (buffer == NULL || bufferLen == 0)
+		return false;
+
+	FingerprintWriter writer(buffer, bufferLen);
+	if (!writeFingerprint(data, dataLen, isClientHello, writer) || writer.isTruncated())
+		return false;
+
+	if (fingerprintLen != NULL)
+		*fingerprintLen = writer.getLength();
+
+	return true;
+}
+
+static bool writeFingerprintMD5(const uint8_t* data, size_t dataLen, bool isClientHello, char* buffer, size_t bufferLen)
+{
+	if (buffer == NULL || bufferLen < PCPP_SSL_FINGERPRINT_MD5_BUFFER_SIZE)
+		return false;
+
+	MD5Context md5Context;
+	md5Init(md5Context);
+	FingerprintWriter writer(&md5Context);
+	if (!writeFingerprint(data, dataLen, isClientHello, writer))
+		return false;
+
+	uint8_t digest[16];
+	md5Final(md5Context, digest);
+
+	static const char hexDigits[] = "0123456789abcdef";
+	for (int i = 0; i < 16; i++)
+	{
+		buffer[i*2] = hexDigits[digest[i] >> 4];
+		buffer[i*2 + 1] = hexDigits[digest[i] & 0x0f];
+	}
+	buffer[32] = 0;
+
+	return true;
+}
+
+
 // -----------------------------
 // SSLClientHelloMessage methods
 // -----------------------------
 
 SSLClientHelloMessage::SSLClientHelloMessage(uint8_t* data, size_t dataLen, SSLHandshakeLayer* container)
-	: SSLHandshakeMessage(data, dataLen, container)
+	: SSLHandshakeMessage(data, dataLen, container), m_ExtensionsParsed(false)
+{
+}
+
+void SSLClientHelloMessage::parseExtensions() const
 {
+	if (m_ExtensionsParsed)
+		return;
+
+	m_ExtensionsParsed = true;
+
 	size_t extensionLengthOffset = sizeof(ssl_tls_client_server_hello) + sizeof(uint8_t) + getSessionIDLength() + sizeof(uint16_t) + sizeof(uint16_t)*getCipherSuiteCount() + 2*sizeof(uint8_t);
 	if (extensionLengthOffset + sizeof(uint16_t) > m_DataLen)
 		return;
@@ -1254,6 +1673,7 @@ uint8_t SSLClientHelloMessage::getCompressionMethodsValue() const
 
 int SSLClientHelloMessage::getExtensionCount() const
 {
+	parseExtensions();
 	return m_ExtensionList.size();
 }
 
@@ -1269,11 +1689,14 @@ uint16_t SSLClientHelloMessage::getExtensionsLenth() const
 
 SSLExtension* SSLClientHelloMessage::getExtension(int index) const
 {
+	parseExtensions();
 	return const_cast<SSLExtension*>(m_ExtensionList.at(index));
 }
 
 SSLExtension* SSLClientHelloMessage::getExtensionOfType(uint16_t type) const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -1287,6 +1710,8 @@ SSLExtension* SSLClientHelloMessage::getExtensionOfType(uint16_t type) const
 
 SSLExtension* SSLClientHelloMessage::getExtensionOfType(SSLExtensionType type) const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -1303,14 +1728,72 @@ std::string SSLClientHelloMessage::toString() const
 	return "Client Hello message";
 }
 
+bool SSLClientHelloMessage::getJA3Fingerprint(char* buffer, size_t bufferLen, size_t* fingerprintLen) const
+{
+	return writeFingerprintString(m_Data, getMessageLength(), true, buffer, bufferLen, fingerprintLen);
+}
+
+bool SSLClientHelloMessage::getJA3FingerprintMD5(char* buffer, size_t bufferLen) const
+{
+	return writeFingerprintMD5(m_Data, getMessageLength(), true, buffer, bufferLen);
+}
+
+bool SSLClientHelloMessage::getServerName(char* buffer, size_t bufferLen, size_t* serverNameLen) const
+{
+	HelloMessageFields fields;
+	if (buffer == NULL || bufferLen == 0 || !locateHelloMessageFields(m_Data, getMessageLength(), true, fields))
+		return false;
+
+	size_t offset = 0;
+	while (offset + 2*sizeof(uint16_t) <= fields.extensionsLen)
+	{
+		const uint8_t* extension = fields.extensions + offset;
+		size_t extensionDataLen = be16toh(*(uint16_t*)(extension + sizeof(uint16_t)));
+		offset += 2*sizeof(uint16_t) + extensionDataLen;
+		if (offset > fields.extensionsLen)
+			return false;
+
+		if (be16toh(*(uint16_t*)extension) != SSL_EXT_SERVER_NAME)
+			continue;
+
+		// server name list length (2 bytes), name type (1 byte), host name length (2 bytes) and the host name
+		const uint8_t* extensionData = extension + 2*sizeof(uint16_t);
+		size_t hostNameOffset = 2*sizeof(uint16_t) + sizeof(uint8_t);
+		if (extensionDataLen < hostNameOffset)
+			return false;
+
+		size_t hostNameLen = be16toh(*(uint16_t*)(extensionData + sizeof(uint16_t) + sizeof(uint8_t)));
+		if (hostNameOffset + hostNameLen > extensionDataLen || hostNameLen + 1 > bufferLen)
+			return false;
+
+		memcpy(buffer, extensionData + hostNameOffset, hostNameLen);
+		buffer[hostNameLen] = 0;
+		if (serverNameLen != NULL)
+			*serverNameLen = hostNameLen;
+
+		return true;
+	}
+
+	return false;
+}
+
 
 // -----------------------------
 // SSLServerHelloMessage methods
 // -----------------------------
 
 SSLServerHelloMessage::SSLServerHelloMessage(uint8_t* data, size_t dataLen, SSLHandshakeLayer* container)
-	: SSLHandshakeMessage(data, dataLen, container)
+	: SSLHandshakeMessage(data, dataLen, container), m_ExtensionsParsed(false)
+{
+}
+
+void SSLServerHelloMessage::parseExtensions() const
 {
+	if (m_ExtensionsParsed)
+		return;
+
+	m_ExtensionsParsed = true;
+
 	size_t extensionLengthOffset = sizeof(ssl_tls_client_server_hello) + sizeof(uint8_t) + getSessionIDLength() + sizeof(uint16_t) + sizeof(uint8_t);
 	if (extensionLengthOffset + sizeof(uint16_t) > m_DataLen)
 		return;
@@ -1389,6 +1872,7 @@ uint8_t SSLServerHelloMessage::getCompressionMethodsValue() const
 
 int SSLServerHelloMessage::getExtensionCount() const
 {
+	parseExtensions();
 	return m_ExtensionList.size();
 }
 
@@ -1404,6 +1888,8 @@ uint16_t SSLServerHelloMessage::getExtensionsLenth() const
 
 SSLExtension* SSLServerHelloMessage::getExtension(int index) const
 {
+	parseExtensions();
+
 	if (index < 0 || index >= (int)m_ExtensionList.size())
 		return NULL;
 
@@ -1412,6 +1898,8 @@ SSLExtension* SSLServerHelloMessage::getExtension(int index) const
 
 SSLExtension* SSLServerHelloMessage::getExtensionOfType(uint16_t type) const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -1425,6 +1913,8 @@ SSLExtension* SSLServerHelloMessage::getExtensionOfType(uint16_t type) const
 
 SSLExtension* SSLServerHelloMessage::getExtensionOfType(SSLExtensionType type) const
 {
+	parseExtensions();
+
 	size_t vecSize = m_ExtensionList.size();
 	for (size_t i = 0; i < vecSize; i++)
 	{
@@ -1441,6 +1931,16 @@ std::string SSLServerHelloMessage::toString() const
 	return "Server Hello message";
 }
 
+bool SSLServerHelloMessage::getJA3SFingerprint(char* buffer, size_t bufferLen, size_t* fingerprintLen) const
+{
+	return writeFingerprintString(m_Data, getMessageLength(), false, buffer, bufferLen, fingerprintLen);
+}
+
+bool SSLServerHelloMessage::getJA3SFingerprintMD5(char* buffer, size_t bufferLen) const
+{
+	return writeFingerprintMD5(m_Data, getMessageLength(), false, buffer, bufferLen);
+}
+
 
 // -----------------------------
 // SSLCertificateMessage methods
@@ -12,6 +12,33 @@
 namespace pcpp
 {
 
+const HeaderFieldName SipFieldNames::From(PCPP_SIP_FROM_FIELD);
+const HeaderFieldName SipFieldNames::To(PCPP_SIP_TO_FIELD);
+const HeaderFieldName SipFieldNames::Via(PCPP_SIP_VIA_FIELD);
+const HeaderFieldName SipFieldNames::CallID(PCPP_SIP_CALL_ID_FIELD);
+const HeaderFieldName SipFieldNames::ContentType(PCPP_SIP_CONTENT_TYPE_FIELD);
+const HeaderFieldName SipFieldNames::ContentLength(PCPP_SIP_CONTENT_LENGTH_FIELD);
+const HeaderFieldName SipFieldNames::ContentDisposition(PCPP_SIP_CONTENT_DISPOSITION_FIELD);
+const HeaderFieldName SipFieldNames::ContentEncoding(PCPP_SIP_CONTENT_ENCODING_FIELD);
+const HeaderFieldName SipFieldNames::ContentLanguage(PCPP_SIP_CONTENT_LANGUAGE_FIELD);
+const HeaderFieldName SipFieldNames::CSeq(PCPP_SIP_CSEQ_FIELD);
+const HeaderFieldName SipFieldNames::Contact(PCPP_SIP_CONTACT_FIELD);
+const HeaderFieldName SipFieldNames::MaxForwards(PCPP_SIP_MAX_FORWARDS_FIELD);
+const HeaderFieldName SipFieldNames::UserAgent(PCPP_SIP_USER_AGENT_FIELD);
+const HeaderFieldName SipFieldNames::Accept(PCPP_SIP_ACCEPT_FIELD);
+const HeaderFieldName SipFieldNames::AcceptEncoding(PCPP_SIP_ACCEPT_ENCODING_FIELD);
+const HeaderFieldName SipFieldNames::AcceptLanguage(PCPP_SIP_ACCEPT_LANGUAGE_FIELD);
+const HeaderFieldName SipFieldNames::Allow(PCPP_SIP_ALLOW_FIELD);
+const HeaderFieldName SipFieldNames::Authorization(PCPP_SIP_AUTHORIZATION_FIELD);
+const HeaderFieldName SipFieldNames::Date(PCPP_SIP_DATE_FIELD);
+const HeaderFieldName SipFieldNames::MimeVersion(PCPP_SIP_MIME_VERSION_FIELD);
+const HeaderFieldName SipFieldNames::Reason(PCPP_SIP_REASON_FIELD);
+const HeaderFieldName SipFieldNames::Supported(PCPP_SIP_SUPPORTED_FIELD);
+const HeaderFieldName SipFieldNames::Server(PCPP_SIP_SERVER_FIELD);
+const HeaderFieldName SipFieldNames::WwwAuthenticate(PCPP_SIP_WWW_AUTHENTICATE_FIELD);
+const HeaderFieldName SipFieldNames::RetryAfter(PCPP_SIP_RETRY_AFTER_FIELD);
+const HeaderFieldName SipFieldNames::RecordRoute(PCPP_SIP_RECORD_ROUTE_FIELD);
+
 const std::string SipMethodEnumToString[14] = {
 		"INVITE",
 		"ACK",
@@ -36,9 +63,7 @@ const std::string SipMethodEnumToString[14] = {
 
 int SipLayer::getContentLength() const
 {
-	std::string contentLengthFieldName(PCPP_SIP_CONTENT_LENGTH_FIELD);
-	std::transform(contentLengthFieldName.begin(), contentLengthFieldName.end(), contentLengthFieldName.begin(), ::tolower);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
+	HeaderField* contentLengthField = getFieldByName(SipFieldNames::ContentLength);
 	if (contentLengthField != NULL)
 		return atoi(contentLengthField->getFieldValue().c_str());
 	return 0;
@@ -48,8 +73,7 @@ HeaderField* SipLayer::setContentLength(int contentLength, const std::string pre
 {
 	char contentLengthAsString[20];
 	snprintf (contentLengthAsString, sizeof(contentLengthAsString), "%d",contentLength);
-	std::string contentLengthFieldName(PCPP_SIP_CONTENT_LENGTH_FIELD);
-	HeaderField* contentLengthField = getFieldByName(contentLengthFieldName);
+	HeaderField* contentLengthField = getFieldByName(SipFieldNames::ContentLength);
 	if (contentLengthField == NULL)
 	{
 		HeaderField* prevField = getFieldByName(prevFieldName);
@@ -69,17 +93,17 @@ void SipLayer::parseNextLayer()
 	size_t headerLen = getHeaderLen();
 	if (getContentLength() > 0)
 	{
-		m_NextLayer = new SdpLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) SdpLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
 	}
 	else
 	{
-		m_NextLayer = new PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
+		m_NextLayer = new(m_Packet) PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
 	}
 }
 
 void SipLayer::computeCalculateFields()
 {
-	HeaderField* contentLengthField = getFieldByName(PCPP_SIP_CONTENT_LENGTH_FIELD);
+	HeaderField* contentLengthField = getFieldByName(SipFieldNames::ContentLength);
 	if (contentLengthField == NULL)
 		return;
 
@@ -317,6 +341,7 @@ void SipRequestFirstLine::parseVersion()
 
 bool SipRequestFirstLine::setMethod(SipRequestLayer::SipMethod newMethod)
 {
+	m_SipRequest->makePacketWritable();
 	if (newMethod == SipRequestLayer::SipMethodUnknown)
 	{
 		LOG_ERROR("Requested method is SipMethodUnknown");
@@ -373,6 +398,7 @@ std::string SipRequestFirstLine::getUri() const
 
 bool SipRequestFirstLine::setUri(std::string newUri)
 {
+	m_SipRequest->makePacketWritable();
 	if (newUri == "")
 	{
 		LOG_ERROR("URI cannot be empty");
@@ -747,6 +773,7 @@ std::string SipResponseFirstLine::getStatusCodeString() const
 
 bool SipResponseFirstLine::setStatusCode(SipResponseLayer::SipResponseStatusCode newStatusCode, std::string statusCodeString)
 {
+	m_SipResponse->makePacketWritable();
 	if (newStatusCode == SipResponseLayer::SipStatusCodeUnknown)
 	{
 		LOG_ERROR("Requested status code is SipStatusCodeUnknown");
@@ -803,6 +830,7 @@ bool SipResponseFirstLine::setStatusCode(SipResponseLayer::SipResponseStatusCode
 
 void SipResponseFirstLine::setVersion(std::string newVersion)
 {
+	m_SipResponse->makePacketWritable();
 	if (newVersion == "")
 		return;
 
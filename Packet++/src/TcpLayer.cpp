@@ -5,6 +5,7 @@
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "HttpLayer.h"
 #include "SSLLayer.h"
 #include "SipLayer.h"
@@ -96,6 +97,69 @@ size_t TcpLayer::getTcpOptionCount() const
 	return m_OptionReader.getTLVRecordCount(getOptionsBasePtr(), getHeaderLen() - sizeof(tcphdr));
 }
 
+void TcpLayer::getStandardTcpOptions(TcpStandardOptions& options) const
+{
+	options.clear();
+
+	uint8_t* optionsBasePtr = getOptionsBasePtr();
+	size_t optionsLen = getHeaderLen() - sizeof(tcphdr);
+	for (TcpOption curOpt = m_OptionReader.getFirstTLVRecord(optionsBasePtr, optionsLen); curOpt.isNotNull();
+			curOpt = m_OptionReader.getNextTLVRecord(curOpt, optionsBasePtr, optionsLen))
+	{
+		size_t totalSize = curOpt.getTotalSize();
+		if (curOpt.getRecordBasePtr() + totalSize > optionsBasePtr + optionsLen)
+			break;
+
+		switch (curOpt.getType())
+		{
+		case TCPOPT_MSS:
+			if (totalSize == PCPP_TCPOLEN_MSS && !options.hasMss)
+			{
+				options.hasMss = true;
+				options.mss = be16toh(curOpt.getValueAs<uint16_t>());
+			}
+			break;
+		case PCPP_TCPOPT_WINDOW:
+			if (totalSize == PCPP_TCPOLEN_WINDOW && !options.hasWindowScale)
+			{
+				options.hasWindowScale = true;
+				options.windowScale = curOpt.getValueAs<uint8_t>();
+			}
+			break;
+		case TCPOPT_SACK_PERM:
+			if (totalSize == PCPP_TCPOLEN_SACK_PERM)
+				options.isSackPermitted = true;
+			break;
+		case PCPP_TCPOPT_TIMESTAMP:
+			if (totalSize == PCPP_TCPOLEN_TIMESTAMP && !options.hasTimestamp)
+			{
+				options.hasTimestamp = true;
+				options.timestampValue = be32toh(curOpt.getValueAs<uint32_t>());
+				options.timestampEchoReply = be32toh(curOpt.getValueAs<uint32_t>(sizeof(uint32_t)));
+			}
+			break;
+		case PCPP_TCPOPT_SACK:
+			if (options.numOfSackBlocks == 0)
+			{
+				size_t numOfBlocks = curOpt.getDataSize() / (2 * sizeof(uint32_t));
+				if (numOfBlocks > PCPP_TCP_MAX_SACK_BLOCKS)
+					numOfBlocks = PCPP_TCP_MAX_SACK_BLOCKS;
+
+				for (size_t i = 0; i < numOfBlocks; i++)
+				{
+					options.sackBlocks[i].leftEdge = be32toh(curOpt.getValueAs<uint32_t>(i * 2 * sizeof(uint32_t)));
+					options.sackBlocks[i].rightEdge = be32toh(curOpt.getValueAs<uint32_t>((i * 2 + 1) * sizeof(uint32_t)));
+				}
+
+				options.numOfSackBlocks = (uint8_t)numOfBlocks;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 TcpOption TcpLayer::addTcpOption(const TcpOptionBuilder& optionBuilder)
 {
 	return addTcpOptionAt(optionBuilder, getHeaderLen()-m_NumOfTrailingBytes);
@@ -227,6 +291,42 @@ void TcpLayer::adjustTcpOptionTrailer(size_t totalOptSize)
 	getTcpHeader()->dataOffset = (sizeof(tcphdr) + totalOptSize + m_NumOfTrailingBytes)/4;
 }
 
+uint16_t TcpLayer::getSrcPort() const
+{
+	return be16toh(getTcpHeader()->portSrc);
+}
+
+uint16_t TcpLayer::getDstPort() const
+{
+	return be16toh(getTcpHeader()->portDst);
+}
+
+void TcpLayer::setSrcPort(uint16_t port, bool updateChecksum)
+{
+	makePacketWritable();
+	setPort(&getTcpHeader()->portSrc, port, updateChecksum);
+}
+
+void TcpLayer::setDstPort(uint16_t port, bool updateChecksum)
+{
+	makePacketWritable();
+	setPort(&getTcpHeader()->portDst, port, updateChecksum);
+}
+
+void TcpLayer::setPort(uint16_t* portField, uint16_t port, bool updateChecksum)
+{
+	uint16_t oldValue = *portField;
+	*portField = htobe16(port);
+
+	if (updateChecksum)
+	{
+		tcphdr* tcpHdr = getTcpHeader();
+		tcpHdr->headerChecksum = update_checksum(tcpHdr->headerChecksum, oldValue, *portField);
+	}
+	else
+		m_IsModified = true;
+}
+
 uint16_t TcpLayer::calculateChecksum(bool writeResultToPacket)
 {
 	tcphdr* tcpHdr = getTcpHeader();
@@ -341,25 +441,10 @@ void TcpLayer::parseNextLayer()
 	uint16_t portDst = be16toh(tcpHder->portDst);
 	uint16_t portSrc = be16toh(tcpHder->portSrc);
 
-	if (HttpMessage::isHttpPort(portDst) && HttpRequestFirstLine::parseMethod((char*)payload, payloadLen) != HttpRequestLayer::HttpMethodUnknown)
-		m_NextLayer = new HttpRequestLayer(payload, payloadLen, this, m_Packet);
-	else if (HttpMessage::isHttpPort(portSrc) && HttpResponseFirstLine::parseStatusCode((char*)payload, payloadLen) != HttpResponseLayer::HttpStatusCodeUnknown)
-		m_NextLayer = new HttpResponseLayer(payload, payloadLen, this, m_Packet);
-	else if (SSLLayer::IsSSLMessage(portSrc, portDst, payload, payloadLen))
-		m_NextLayer = SSLLayer::createSSLMessage(payload, payloadLen, this, m_Packet);
-	else if (SipLayer::isSipPort(portDst))
-	{
-		if (SipRequestFirstLine::parseMethod((char*)payload, payloadLen) != SipRequestLayer::SipMethodUnknown)
-			m_NextLayer = new SipRequestLayer(payload, payloadLen, this, m_Packet);
-		else if (SipResponseFirstLine::parseStatusCode((char*)payload, payloadLen) != SipResponseLayer::SipStatusCodeUnknown)
-			m_NextLayer = new SipResponseLayer(payload, payloadLen, this, m_Packet);
-		else
-			m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
-	}
-	else if (BgpLayer::isBgpPort(portSrc, portDst))
-		m_NextLayer = BgpLayer::parseBgpLayer(payload, payloadLen, this, m_Packet);
-	else
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
+	// the application protocol parsers are registered by port (see NextLayerRegistry)
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::TcpPortTable, portSrc, portDst, payload, payloadLen, this, m_Packet);
+	if (m_NextLayer == NULL)
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 }
 
 void TcpLayer::computeCalculateFields()
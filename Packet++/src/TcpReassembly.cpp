@@ -4,24 +4,21 @@
 #include "TcpLayer.h"
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
-#include "PacketUtils.h"
 #include "IpAddress.h"
 #include "Logger.h"
 #include <sstream>
 #include <vector>
 #include "EndianPortable.h"
 #include "TimespecTimeval.h"
-#ifdef _MSC_VER
-#include <time.h>
-#endif
-
-#define PURGE_FREQ_SECS 1
-
 #define SEQ_LT(a,b)  ((int32_t)((a)-(b)) < 0)
 #define SEQ_LEQ(a,b) ((int32_t)((a)-(b)) <= 0)
 #define SEQ_GT(a,b)  ((int32_t)((a)-(b)) > 0)
 #define SEQ_GEQ(a,b) ((int32_t)((a)-(b)) >= 0)
 
+// the number of out-of-order fragments and data blocks the fragment pool allocates at once
+#define PCPP_TCP_REASSEMBLY_FRAGMENT_SLAB_SIZE 256
+#define PCPP_TCP_REASSEMBLY_BLOCK_SLAB_SIZE 32
+
 namespace
 {
 	timeval timespec_to_timeval(const timespec &in)
@@ -91,7 +88,115 @@ void TcpReassembly::TcpOneSideData::setSrcIP(IPAddress* sourrcIP)
 }
 
 
-TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* userCookie, OnTcpConnectionStart onConnectionStartCallback, OnTcpConnectionEnd onConnectionEndCallback, const TcpReassemblyConfiguration &config)
+TcpReassembly::TcpFragmentPool::~TcpFragmentPool()
+{
+	for (size_t i = 0; i < m_FragmentSlabs.size(); i++)
+		delete [] m_FragmentSlabs[i];
+
+	for (size_t i = 0; i < m_BlockSlabs.size(); i++)
+		delete [] m_BlockSlabs[i];
+}
+
+TcpReassembly::TcpFragment* TcpReassembly::TcpFragmentPool::allocateFragment(const uint8_t* data, size_t dataLength)
+{
+	if (m_FreeFragments == NULL)
+	{
+		TcpFragment* slab = new TcpFragment[PCPP_TCP_REASSEMBLY_FRAGMENT_SLAB_SIZE];
+		m_FragmentSlabs.push_back(slab);
+		for (int i = 0; i < PCPP_TCP_REASSEMBLY_FRAGMENT_SLAB_SIZE; i++)
+		{
+			slab[i].next = m_FreeFragments;
+			m_FreeFragments = &slab[i];
+		}
+	}
+
+	TcpFragment* fragment = m_FreeFragments;
+	m_FreeFragments = fragment->next;
+	fragment->dataLength = dataLength;
+	fragment->blocks = NULL;
+
+	// copy the data to a chain of blocks
+	TcpFragmentBlock** lastBlock = &fragment->blocks;
+	size_t offset = 0;
+	while (offset < dataLength)
+	{
+		if (m_FreeBlocks == NULL)
+		{
+			TcpFragmentBlock* slab = new TcpFragmentBlock[PCPP_TCP_REASSEMBLY_BLOCK_SLAB_SIZE];
+			m_BlockSlabs.push_back(slab);
+			for (int i = 0; i < PCPP_TCP_REASSEMBLY_BLOCK_SLAB_SIZE; i++)
+			{
+				slab[i].next = m_FreeBlocks;
+				m_FreeBlocks = &slab[i];
+			}
+		}
+
+		TcpFragmentBlock* block = m_FreeBlocks;
+		m_FreeBlocks = block->next;
+		block->next = NULL;
+
+		size_t len = dataLength - offset;
+		if (len > PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE)
+			len = PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE;
+		memcpy(block->data, data + offset, len);
+		offset += len;
+
+		*lastBlock = block;
+		lastBlock = &block->next;
+	}
+
+	return fragment;
+}
+
+void TcpReassembly::TcpFragmentPool::freeFragment(TcpFragment* fragment)
+{
+	TcpFragmentBlock* block = fragment->blocks;
+	while (block != NULL)
+	{
+		TcpFragmentBlock* next = block->next;
+		block->next = m_FreeBlocks;
+		m_FreeBlocks = block;
+		block = next;
+	}
+
+	fragment->blocks = NULL;
+	fragment->next = m_FreeFragments;
+	m_FreeFragments = fragment;
+}
+
+size_t TcpReassembly::TcpFragmentPool::getFragmentMemorySize(size_t dataLength)
+{
+	size_t numOfBlocks = (dataLength + PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE - 1) / PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE;
+	return numOfBlocks * sizeof(TcpFragmentBlock) + sizeof(TcpFragment);
+}
+
+const uint8_t* TcpReassembly::TcpFragmentPool::getFragmentData(const TcpFragment* fragment, std::vector<uint8_t>& buffer) const
+{
+	if (fragment->dataLength <= PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE)
+		return fragment->blocks->data;
+
+	buffer.resize(fragment->dataLength);
+	copyFragmentData(fragment, &buffer[0]);
+	return &buffer[0];
+}
+
+void TcpReassembly::TcpFragmentPool::copyFragmentData(const TcpFragment* fragment, uint8_t* dest) const
+{
+	size_t offset = 0;
+	for (const TcpFragmentBlock* block = fragment->blocks; block != NULL; block = block->next)
+	{
+		size_t len = fragment->dataLength - offset;
+		if (len > PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE)
+			len = PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE;
+		memcpy(dest + offset, block->data, len);
+		offset += len;
+	}
+}
+
+
+TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* userCookie, OnTcpConnectionStart onConnectionStartCallback, OnTcpConnectionEnd onConnectionEndCallback, const TcpReassemblyConfiguration &config) :
+	m_ConnectionList(config.connectionTableCapacity > 0 ? config.connectionTableCapacity : PCPP_FLOW_TABLE_DEFAULT_CAPACITY),
+	m_ConnectionInfo(config.connectionTableCapacity > 0 ? config.connectionTableCapacity : PCPP_FLOW_TABLE_DEFAULT_CAPACITY)
 {
 	m_OnMessageReadyCallback = onMessageReadyCallback;
 	m_UserCookie = userCookie;
@@ -100,30 +205,31 @@ TcpReassembly::TcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* use
 	m_ClosedConnectionDelay = (config.closedConnectionDelay > 0) ? config.closedConnectionDelay : 5;
 	m_RemoveConnInfo = config.removeConnInfo;
 	m_MaxNumToClean = (config.removeConnInfo == true && config.maxNumToClean == 0) ? 30 : config.maxNumToClean;
-	m_PurgeTimepoint = time(NULL) + PURGE_FREQ_SECS;
+	m_UseInnerTuple = config.useInnerTuple;
+	m_IdleTimeout = config.idleTimeout;
+	m_CurrentTime = 0;
+	m_OldestFragment = NULL;
+	m_NewestFragment = NULL;
+	m_OutOfOrderBytes = 0;
+	m_MaxOutOfOrderBytesPerConnection = config.maxOutOfOrderBytesPerConnection;
+	m_MaxOutOfOrderBytes = config.maxOutOfOrderBytes;
 }
 
 TcpReassembly::~TcpReassembly()
 {
-	while (!m_ConnectionList.empty())
+	for (ConnectionList::iterator iter = m_ConnectionList.begin(); iter != m_ConnectionList.end(); ++iter)
 	{
-		if(m_ConnectionList.begin()->second != NULL)
-			delete m_ConnectionList.begin()->second;
-		m_ConnectionList.erase(m_ConnectionList.begin());
+		if (iter->second.data != NULL)
+			delete iter->second.data;
 	}
+
+	m_ConnectionList.clear();
 }
 
 TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 {
-	// automatic cleanup
-	if (m_RemoveConnInfo == true)
-	{
-		if(time(NULL) >= m_PurgeTimepoint)
-		{
-			purgeClosedConnections();
-			m_PurgeTimepoint = time(NULL) + PURGE_FREQ_SECS;
-		}
-	}
+	// close idle connections and clean up closed connections whose delay has passed
+	advanceTime(tcpData.getRawPacket()->getPacketTimeStamp());
 
 	// get IP layer
 	Layer* ipLayer = NULL;
@@ -154,6 +260,14 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 		return NonTcpPacket;
 	}
 
+	// in inner tuple mode the connection is identified by the IP layer that carries the TCP layer (the inner packet of a tunnel)
+	if (m_UseInnerTuple)
+	{
+		Layer* innerIPLayer = tcpLayer->getPrevLayer();
+		if (innerIPLayer != NULL && (innerIPLayer->getProtocol() == IPv4 || innerIPLayer->getProtocol() == IPv6))
+			ipLayer = innerIPLayer;
+	}
+
 	ReassemblyStatus status = TcpMessageHandled;
 
 	// set the TCP payload size
@@ -173,16 +287,16 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 	TcpReassemblyData* tcpReassemblyData = NULL;
 
 	// calculate flow key for this packet
-	uint32_t flowKey = hash5Tuple(&tcpData);
+	FlowKey flowKey = FlowKey::fromLayers(ipLayer, tcpLayer);
 
 	// find the connection in the connection map
 	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
 
 	// if this packet belongs to a connection that was already closed (for example: data packet that comes after FIN), ignore it.
 	// the connection is already closed when the value of mapped type is NULL
-	if (iter != m_ConnectionList.end() && iter->second == NULL)
+	if (iter != m_ConnectionList.end() && iter->second.data == NULL)
 	{
-		LOG_DEBUG("Ignoring packet of already closed flow [0x%X]", flowKey);
+		LOG_DEBUG("Ignoring packet of already closed flow [%s]", flowKey.toString().c_str());
 		return Ignore_PacketOfClosedFlow;
 	}
 
@@ -220,7 +334,11 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 		timeval ts = timespec_to_timeval(tcpData.getRawPacket()->getPacketTimeStamp());
 		tcpReassemblyData->connData.setStartTime(ts);
 
-		m_ConnectionList[flowKey] = tcpReassemblyData;
+		iter = m_ConnectionList.insert(ConnectionList::value_type(flowKey, ConnectionEntry())).first;
+		iter->second.data = tcpReassemblyData;
+		iter->second.timer.data = iter.getHandle();
+		if (m_IdleTimeout > 0)
+			m_IdleTimers.schedule(&iter->second.timer, m_CurrentTime + m_IdleTimeout);
 		m_ConnectionInfo[flowKey] = tcpReassemblyData->connData;
 
 		// fire connection start callback
@@ -229,7 +347,7 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 	}
 	else // connection already exists
 	{
-		tcpReassemblyData = iter->second;
+		tcpReassemblyData = iter->second.data;
 		timeval currTime = timespec_to_timeval(tcpData.getRawPacket()->getPacketTimeStamp());
 		if (currTime.tv_sec > tcpReassemblyData->connData.endTime.tv_sec)
 		{
@@ -244,6 +362,9 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 		}
 	}
 
+	// the idle timer isn't rescheduled on every packet, it checks the last activity when it expires
+	tcpReassemblyData->lastActivity = m_CurrentTime;
+
 	int sideIndex = -1;
 	bool first = false;
 
@@ -485,15 +606,9 @@ TcpReassembly::ReassemblyStatus TcpReassembly::reassemblePacket(Packet& tcpData)
 			return status;
 		}
 
-		// create a new TcpFragment, copy the TCP data to it and add this packet to the the out-of-order packet list
-		TcpFragment* newTcpFrag = new TcpFragment();
-		newTcpFrag->data = new uint8_t[tcpPayloadSize];
-		newTcpFrag->dataLength = tcpPayloadSize;
-		newTcpFrag->sequence = sequence;
-		memcpy(newTcpFrag->data, tcpLayer->getLayerPayload(), tcpPayloadSize);
-		tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.pushBack(newTcpFrag);
-
-		LOG_DEBUG("Found out-of-order packet and added a new TCP fragment with size %d to the out-of-order list of side %d", (int)tcpPayloadSize, sideIndex);
+		// copy the TCP data to a new fragment and add it to the out-of-order list of this side. If the out-of-order data limits are exceeded
+		// buffered data may be sent to the callback as if the data before it is missing
+		insertFragment(tcpReassemblyData, sideIndex, sequence, tcpLayer->getLayerPayload(), tcpPayloadSize);
 		status = OutOfOrderTcpMessageBuffered;
 
 		// handle case where this packet is FIN or RST
@@ -519,7 +634,7 @@ std::string TcpReassembly::prepareMissingDataMessage(uint32_t missingDataLen)
 	return missingDataTextStream.str();
 }
 
-void TcpReassembly::handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int sideIndex, uint32_t flowKey)
+void TcpReassembly::handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int sideIndex, const FlowKey& flowKey)
 {
 	// if this side already saw a FIN or RST packet, do nothing and return
 	if (tcpReassemblyData->twoSides[sideIndex].gotFinOrRst)
@@ -540,199 +655,237 @@ void TcpReassembly::handleFinOrRst(TcpReassemblyData* tcpReassemblyData, int sid
 
 void TcpReassembly::checkOutOfOrderFragments(TcpReassemblyData* tcpReassemblyData, int sideIndex, bool cleanWholeFragList)
 {
-	bool foundSomething = false;
+	LOG_DEBUG("Looking for out-of-order fragments that match the current sequence or have smaller sequence on side %d", sideIndex);
+
+	deliverInOrderFragments(tcpReassemblyData, sideIndex);
+
+	// if got here it means we're left only with fragments that have higher sequence than current sequence. This means out-of-order packets or
+	// missing data. If we don't want to clear the frag list yet, assume it's out-of-order and return
+	if (!cleanWholeFragList)
+		return;
+
+	LOG_DEBUG("Handling missing data on side %d", sideIndex);
+
+	// the stop condition is when the list is empty
+	while (tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.head != NULL)
+		deliverFirstFragmentAfterMissingData(tcpReassemblyData, sideIndex);
+}
 
-	do
+void TcpReassembly::deliverInOrderFragments(TcpReassemblyData* tcpReassemblyData, int sideIndex)
+{
+	TcpOneSideData& side = tcpReassemblyData->twoSides[sideIndex];
+
+	// the list is sorted by sequence, so all fragments that match the current sequence or have smaller sequence are at its beginning
+	while (side.tcpFragmentList.head != NULL && SEQ_LEQ(side.tcpFragmentList.head->sequence, side.sequence))
 	{
-		LOG_DEBUG("Starting first iteration of checkOutOfOrderFragments - looking for fragments that match the current sequence or have smaller sequence");
+		TcpFragment* curTcpFrag = side.tcpFragmentList.head;
 
-		int index = 0;
-		foundSomething = false;
+		// check if it still has new data
+		uint32_t newSequence = curTcpFrag->sequence + curTcpFrag->dataLength;
 
-		do
+		// it has new data
+		if (SEQ_GT(newSequence, side.sequence))
 		{
-			index = 0;
-			foundSomething = false;
+			// the size of the data the current sequence already covers
+			uint32_t oldLength = side.sequence - curTcpFrag->sequence;
+
+			LOG_DEBUG("Found an out-of-order fragment which contains new data. Calling the callback with the new data. Fragment size is %d on side %d, new data size is %d",
+				(int)curTcpFrag->dataLength, sideIndex, (int)(curTcpFrag->dataLength - oldLength));
+
+			// update current sequence with the new data size
+			side.sequence = newSequence;
 
-			// first fragment list iteration - go over the whole fragment list and see if can find fragments that match the current sequence
-			// or have smaller sequence but have big enough payload to get new data
-			while (index < (int)tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size())
+			// send only the new data to the callback
+			if (m_OnMessageReadyCallback != NULL)
 			{
-				TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(index);
-
-				// if fragment sequence matches the current sequence
-				if (curTcpFrag->sequence == tcpReassemblyData->twoSides[sideIndex].sequence)
-				{
-					// update sequence
-					tcpReassemblyData->twoSides[sideIndex].sequence += curTcpFrag->dataLength;
-					if (curTcpFrag->data != NULL)
-					{
-						LOG_DEBUG("Found an out-of-order packet matching to the current sequence with size %d on side %d. Pulling it out of the list and sending the data to the callback", (int)curTcpFrag->dataLength, sideIndex);
-
-						// send new data to callback
-
-						if (m_OnMessageReadyCallback != NULL)
-						{
-							TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, tcpReassemblyData->connData);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
-					}
-
-
-					// remove fragment from list
-					tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + index);
-
-					foundSomething = true;
-
-					continue;
-				}
-
-				// if fragment sequence has lower sequence than the current sequence
-				if (SEQ_LT(curTcpFrag->sequence, tcpReassemblyData->twoSides[sideIndex].sequence))
-				{
-					// check if it still has new data
-					uint32_t newSequence = curTcpFrag->sequence + curTcpFrag->dataLength;
-
-					// it has new data
-					if (SEQ_GT(newSequence, tcpReassemblyData->twoSides[sideIndex].sequence))
-					{
-						// calculate the delta new data size
-						uint32_t newLength = tcpReassemblyData->twoSides[sideIndex].sequence - curTcpFrag->sequence;
-
-						LOG_DEBUG("Found a fragment in the out-of-order list which its sequence is lower than expected but its payload is long enough to contain new data. "
-							"Calling the callback with the new data. Fragment size is %d on side %d, new data size is %d", (int)curTcpFrag->dataLength, sideIndex, (int)(curTcpFrag->dataLength - newLength));
-
-						// update current sequence with the delta new data size
-						tcpReassemblyData->twoSides[sideIndex].sequence += curTcpFrag->dataLength - newLength;
-
-						// send only the new data to the callback
-						if (m_OnMessageReadyCallback != NULL)
-						{
-							TcpStreamData streamData(curTcpFrag->data + newLength, curTcpFrag->dataLength - newLength, tcpReassemblyData->connData);
-							m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-						}
-
-						foundSomething = true;
-					}
-					else
-					{
-						LOG_DEBUG("Found a fragment in the out-of-order list which doesn't contain any new data, ignoring it. Fragment size is %d on side %d", (int)curTcpFrag->dataLength, sideIndex);
-					}
-
-					// delete fragment from list
-					tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + index);
-
-					continue;
-				}
-
-				//if got to here it means the fragment has higher sequence than current sequence, increment index and continue
-				index++;
+				const uint8_t* data = m_FragmentPool.getFragmentData(curTcpFrag, tcpReassemblyData->dataBuffer);
+				TcpStreamData streamData(data + oldLength, curTcpFrag->dataLength - oldLength, tcpReassemblyData->connData);
+				m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
 			}
+		}
+		else
+		{
+			LOG_DEBUG("Found a fragment in the out-of-order list which doesn't contain any new data, ignoring it. Fragment size is %d on side %d", (int)curTcpFrag->dataLength, sideIndex);
+		}
 
-			// if managed to find new segment, do the search all over again
-		} while (foundSomething);
+		// remove fragment from list
+		removeFragment(curTcpFrag);
+	}
+}
 
+void TcpReassembly::deliverFirstFragmentAfterMissingData(TcpReassemblyData* tcpReassemblyData, int sideIndex)
+{
+	TcpOneSideData& side = tcpReassemblyData->twoSides[sideIndex];
 
-		// if got here it means we're left only with fragments that have higher sequence than current sequence. This means out-of-order packets or
-		// missing data. If we don't want to clear the frag list yet, assume it's out-of-order and return
-		if (!cleanWholeFragList)
-			return;
+	deliverInOrderFragments(tcpReassemblyData, sideIndex);
 
-		LOG_DEBUG("Starting second  iteration of checkOutOfOrderFragments - handle missing data");
+	// the first fragment is the one with the closest sequence to the current one
+	TcpFragment* curTcpFrag = side.tcpFragmentList.head;
+	if (curTcpFrag == NULL)
+		return;
 
-		// second fragment list iteration - now we're left only with fragments that have higher sequence than current sequence. This means missing data.
-		// Search for the fragment with the closest sequence to the current one
+	// calculate number of missing bytes
+	uint32_t missingDataLen = curTcpFrag->sequence - side.sequence;
 
-		uint32_t closestSequence = 0xffffffff;
-		bool closestSequenceDefined = false;
-		int closestSequenceFragIndex = -1;
-		index = 0;
+	// update sequence
+	side.sequence = curTcpFrag->sequence + curTcpFrag->dataLength;
 
-		while (index < (int)tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.size())
-		{
-			// extract segment at current index
-			TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(index);
+	// send new data to callback
+	if (m_OnMessageReadyCallback != NULL)
+	{
+		// prepare missing data text
+		std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
 
-			// check if its sequence is closer than current closest sequence
-			if (!closestSequenceDefined || SEQ_LT(curTcpFrag->sequence, closestSequence))
-			{
-				closestSequence = curTcpFrag->sequence;
-				closestSequenceFragIndex = index;
-				closestSequenceDefined = true;
-			}
+		// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
+		// "[xx bytes missing]<original_data>"
+		std::vector<uint8_t>& dataWithMissingDataText = tcpReassemblyData->dataBuffer;
+		dataWithMissingDataText.resize(missingDataTextStr.length() + curTcpFrag->dataLength);
+		memcpy(&dataWithMissingDataText[0], missingDataTextStr.c_str(), missingDataTextStr.length());
+		m_FragmentPool.copyFragmentData(curTcpFrag, &dataWithMissingDataText[missingDataTextStr.length()]);
 
-			index++;
-		}
+		TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), tcpReassemblyData->connData);
+		m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
 
-		// this means fragment list is not empty at this stage
-		if (closestSequenceFragIndex > -1)
-		{
-			// get the fragment with the closest sequence
-			TcpFragment* curTcpFrag = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.at(closestSequenceFragIndex);
+		LOG_DEBUG("Found missing data on side %d: %d byte are missing. Sending the closest fragment which is in size %d + missing text message which size is %d",
+			sideIndex, missingDataLen, (int)curTcpFrag->dataLength, (int)missingDataTextStr.length());
+	}
 
-			// calculate number of missing bytes
-			uint32_t missingDataLen = curTcpFrag->sequence - tcpReassemblyData->twoSides[sideIndex].sequence;
+	// remove fragment from list
+	removeFragment(curTcpFrag);
 
-			// update sequence
-			tcpReassemblyData->twoSides[sideIndex].sequence = curTcpFrag->sequence + curTcpFrag->dataLength;
-			if (curTcpFrag->data != NULL)
-			{
-				// send new data to callback
-				if (m_OnMessageReadyCallback != NULL)
-				{
-					// prepare missing data text
-					std::string missingDataTextStr = prepareMissingDataMessage(missingDataLen);
-
-					// add missing data text to the data that will be sent to the callback. This means that the data will look something like:
-					// "[xx bytes missing]<original_data>"
-					std::vector<uint8_t> dataWithMissingDataText;
-					dataWithMissingDataText.reserve(missingDataTextStr.length() + curTcpFrag->dataLength);
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), missingDataTextStr.begin(), missingDataTextStr.end());
-					dataWithMissingDataText.insert(dataWithMissingDataText.end(), curTcpFrag->data, curTcpFrag->data + curTcpFrag->dataLength);
-
-					//TcpStreamData streamData(curTcpFrag->data, curTcpFrag->dataLength, tcpReassemblyData->connData);
-					TcpStreamData streamData(&dataWithMissingDataText[0], dataWithMissingDataText.size(), tcpReassemblyData->connData);
-					m_OnMessageReadyCallback(sideIndex, streamData, m_UserCookie);
-
-					LOG_DEBUG("Found missing data on side %d: %d byte are missing. Sending the closest fragment which is in size %d + missing text message which size is %d",
-						sideIndex, missingDataLen, (int)curTcpFrag->dataLength, (int)missingDataTextStr.length());
-				}
-			}
+	// the fragments that follow the delivered one may fit now
+	deliverInOrderFragments(tcpReassemblyData, sideIndex);
+}
+
+void TcpReassembly::insertFragment(TcpReassemblyData* tcpReassemblyData, int sideIndex, uint32_t sequence, const uint8_t* data, size_t dataLength)
+{
+	TcpFragmentList& fragList = tcpReassemblyData->twoSides[sideIndex].tcpFragmentList;
 
-			// remove fragment from list
-			tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.erase(tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.begin() + closestSequenceFragIndex);
+	// out-of-order segments usually arrive in increasing sequence, so look for the fragment to insert after from the end of the list.
+	// Fragments with the same sequence are kept in the order they arrived
+	TcpFragment* prevFrag = fragList.tail;
+	while (prevFrag != NULL && SEQ_GT(prevFrag->sequence, sequence))
+		prevFrag = prevFrag->prev;
 
-			LOG_DEBUG("Calling checkOutOfOrderFragments again from the start");
+	if (prevFrag != NULL && prevFrag->sequence == sequence && prevFrag->dataLength >= dataLength)
+	{
+		LOG_DEBUG("Out-of-order packet with size %d on side %d is a retransmission of data which is already in the out-of-order list, ignoring it", (int)dataLength, sideIndex);
+		return;
+	}
 
-			// call the method again from the start to do the whole search again (both iterations). 
-			// the stop condition is when the list is empty (so closestSequenceFragIndex == -1)
-			foundSomething = true;
-		}
+	TcpFragment* newTcpFrag = m_FragmentPool.allocateFragment(data, dataLength);
+	newTcpFrag->sequence = sequence;
+	newTcpFrag->connection = tcpReassemblyData;
+	newTcpFrag->sideIndex = sideIndex;
+
+	// link the fragment to the side's list after prevFrag
+	newTcpFrag->prev = prevFrag;
+	newTcpFrag->next = (prevFrag != NULL ? prevFrag->next : fragList.head);
+	if (newTcpFrag->next != NULL)
+		newTcpFrag->next->prev = newTcpFrag;
+	else
+		fragList.tail = newTcpFrag;
+	if (prevFrag != NULL)
+		prevFrag->next = newTcpFrag;
+	else
+		fragList.head = newTcpFrag;
+	fragList.count++;
+
+	// link the fragment to the end of the list of all fragments
+	newTcpFrag->older = m_NewestFragment;
+	newTcpFrag->newer = NULL;
+	if (m_NewestFragment != NULL)
+		m_NewestFragment->newer = newTcpFrag;
+	else
+		m_OldestFragment = newTcpFrag;
+	m_NewestFragment = newTcpFrag;
 
-	} while (foundSomething);
+	// the limits are enforced on the memory the fragment pins in the pool rather than on its data length, so small segments can't take much more memory than the limits allow
+	size_t memorySize = TcpFragmentPool::getFragmentMemorySize(dataLength);
+	tcpReassemblyData->outOfOrderBytes += memorySize;
+	m_OutOfOrderBytes += memorySize;
+
+	LOG_DEBUG("Found out-of-order packet and added a new TCP fragment with size %d to the out-of-order list of side %d", (int)dataLength, sideIndex);
+
+	enforceOutOfOrderLimits(tcpReassemblyData, sideIndex);
 }
 
-void TcpReassembly::closeConnection(uint32_t flowKey)
+void TcpReassembly::removeFragment(TcpFragment* fragment)
+{
+	TcpFragmentList& fragList = fragment->connection->twoSides[fragment->sideIndex].tcpFragmentList;
+
+	if (fragment->prev != NULL)
+		fragment->prev->next = fragment->next;
+	else
+		fragList.head = fragment->next;
+	if (fragment->next != NULL)
+		fragment->next->prev = fragment->prev;
+	else
+		fragList.tail = fragment->prev;
+	fragList.count--;
+
+	if (fragment->older != NULL)
+		fragment->older->newer = fragment->newer;
+	else
+		m_OldestFragment = fragment->newer;
+	if (fragment->newer != NULL)
+		fragment->newer->older = fragment->older;
+	else
+		m_NewestFragment = fragment->older;
+
+	size_t memorySize = TcpFragmentPool::getFragmentMemorySize(fragment->dataLength);
+	fragment->connection->outOfOrderBytes -= memorySize;
+	m_OutOfOrderBytes -= memorySize;
+
+	m_FragmentPool.freeFragment(fragment);
+}
+
+void TcpReassembly::enforceOutOfOrderLimits(TcpReassemblyData* tcpReassemblyData, int sideIndex)
+{
+	// when the connection exceeds its limit stop waiting for missing data on the side of the new data, or on the other side if this side has
+	// nothing buffered (which can happen if the new data was already delivered)
+	while (m_MaxOutOfOrderBytesPerConnection > 0 && tcpReassemblyData->outOfOrderBytes > m_MaxOutOfOrderBytesPerConnection)
+	{
+		int evictedSide = (tcpReassemblyData->twoSides[sideIndex].tcpFragmentList.head != NULL ? sideIndex : 1 - sideIndex);
+
+		LOG_DEBUG("Out-of-order data of connection takes %d bytes of memory which is more than its limit, treating the data before the first fragment of side %d as missing",
+			(int)tcpReassemblyData->outOfOrderBytes, evictedSide);
+
+		deliverFirstFragmentAfterMissingData(tcpReassemblyData, evictedSide);
+	}
+
+	// when all connections together exceed the limit stop waiting for missing data on the side which buffered the oldest fragment
+	while (m_MaxOutOfOrderBytes > 0 && m_OutOfOrderBytes > m_MaxOutOfOrderBytes && m_OldestFragment != NULL)
+	{
+		LOG_DEBUG("Out-of-order data takes %d bytes of memory which is more than the limit, treating the data before the first fragment of side %d of the connection with the oldest fragment as missing",
+			(int)m_OutOfOrderBytes, m_OldestFragment->sideIndex);
+
+		deliverFirstFragmentAfterMissingData(m_OldestFragment->connection, m_OldestFragment->sideIndex);
+	}
+}
+
+void TcpReassembly::closeConnection(const FlowKey& flowKey)
 {
 	closeConnectionInternal(flowKey, TcpReassembly::TcpReassemblyConnectionClosedManually);
 }
 
-void TcpReassembly::closeConnectionInternal(uint32_t flowKey, ConnectionEndReason reason)
+void TcpReassembly::closeConnectionInternal(FlowKey flowKey, ConnectionEndReason reason)
 {
+	// flowKey is taken by value because the caller may pass the key stored in the connection data which is deleted below
 	TcpReassemblyData* tcpReassemblyData = NULL;
 	ConnectionList::iterator iter = m_ConnectionList.find(flowKey);
 	if (iter == m_ConnectionList.end())
 	{
-		LOG_ERROR("Cannot close flow with key 0x%X: cannot find flow", flowKey);
+		LOG_ERROR("Cannot close flow with key [%s]: cannot find flow", flowKey.toString().c_str());
 		return;
 	}
 
-	if (iter->second == NULL) // the connection is already closed
+	if (iter->second.data == NULL) // the connection is already closed
 		return;
 
-	LOG_DEBUG("Closing connection with flow key 0x%X", flowKey);
+	LOG_DEBUG("Closing connection with flow key [%s]", flowKey.toString().c_str());
 
-	tcpReassemblyData = iter->second;
+	tcpReassemblyData = iter->second.data;
 
 	LOG_DEBUG("Calling checkOutOfOrderFragments on side 0");
 	checkOutOfOrderFragments(tcpReassemblyData, 0, true);
@@ -744,10 +897,10 @@ void TcpReassembly::closeConnectionInternal(uint32_t flowKey, ConnectionEndReaso
 		m_OnConnEnd(tcpReassemblyData->connData, reason, m_UserCookie);
 
 	delete tcpReassemblyData;
-	iter->second = NULL; // mark the connection as closed
-	insertIntoCleanupList(flowKey);
+	iter->second.data = NULL; // mark the connection as closed
+	insertIntoCleanupList(iter->second);
 
-	LOG_DEBUG("Connection with flow key 0x%X is closed", flowKey);
+	LOG_DEBUG("Connection with flow key [%s] is closed", flowKey.toString().c_str());
 }
 
 void TcpReassembly::closeAllConnections()
@@ -757,13 +910,13 @@ void TcpReassembly::closeAllConnections()
 	ConnectionList::iterator iter = m_ConnectionList.begin(), iterEnd = m_ConnectionList.end();
 	for (; iter != iterEnd; ++iter)
 	{
-		if (iter->second == NULL) // the connection is already closed, skip it
+		if (iter->second.data == NULL) // the connection is already closed, skip it
 			continue;
 
-		TcpReassemblyData* tcpReassemblyData = iter->second;
+		TcpReassemblyData* tcpReassemblyData = iter->second.data;
 
-		uint32_t flowKey = tcpReassemblyData->connData.flowKey;
-		LOG_DEBUG("Closing connection with flow key 0x%X", flowKey);
+		FlowKey flowKey = tcpReassemblyData->connData.flowKey;
+		LOG_DEBUG("Closing connection with flow key [%s]", flowKey.toString().c_str());
 
 		LOG_DEBUG("Calling checkOutOfOrderFragments on side 0");
 		checkOutOfOrderFragments(tcpReassemblyData, 0, true);
@@ -775,10 +928,10 @@ void TcpReassembly::closeAllConnections()
 			m_OnConnEnd(tcpReassemblyData->connData, TcpReassemblyConnectionClosedManually, m_UserCookie);
 
 		delete tcpReassemblyData;
-		iter->second = NULL; // mark the connection as closed
-		insertIntoCleanupList(flowKey);
+		iter->second.data = NULL; // mark the connection as closed
+		insertIntoCleanupList(iter->second);
 
-		LOG_DEBUG("Connection with flow key 0x%X is closed", flowKey);
+		LOG_DEBUG("Connection with flow key [%s] is closed", flowKey.toString().c_str());
 	}
 }
 
@@ -786,21 +939,49 @@ int TcpReassembly::isConnectionOpen(const ConnectionData& connection) const
 {
 	ConnectionList::const_iterator iter = m_ConnectionList.find(connection.flowKey);
 	if (iter != m_ConnectionList.end())
-		return iter->second != NULL; // If the value of mapped type is NULL then this connection is closed
+		return iter->second.data != NULL; // If the connection's data is NULL then this connection is closed
 
 	return -1;
 }
 
-void TcpReassembly::insertIntoCleanupList(uint32_t flowKey)
+void TcpReassembly::insertIntoCleanupList(ConnectionEntry& connection)
 {
-	// m_CleanupList is a map with key of type time_t (expiration time). The mapped type is a list that stores the flow keys to be cleared in certain point of time.
-	// m_CleanupList.insert inserts an empty list if the container does not already contain an element with an equivalent key,
-	// otherwise this method returns an iterator to the element that prevents insertion.
-	std::pair<CleanupList::iterator, bool> pair = m_CleanupList.insert(std::make_pair(time(NULL) + m_ClosedConnectionDelay, CleanupList::mapped_type()));
+	// the connection's timer moves from the idle timers (if it was there) to the closed connection timers. It expires when the connection should be
+	// cleaned up, and waits in the expired list of m_ClosedTimers until purgeClosedConnections() takes it
+	m_IdleTimers.cancel(&connection.timer);
+	m_ClosedTimers.schedule(&connection.timer, m_CurrentTime + m_ClosedConnectionDelay);
+}
 
-	// getting the reference to list
-	CleanupList::mapped_type& keysList = pair.first->second;
-	keysList.push_front(flowKey);
+void TcpReassembly::advanceTime(const timespec& currentTime)
+{
+	// time moves only forward and only in whole seconds, packets with an older timestamp or in the same second don't trigger expiry
+	if (currentTime.tv_sec <= 0 || (uint64_t)currentTime.tv_sec <= m_CurrentTime)
+		return;
+
+	m_CurrentTime = (uint64_t)currentTime.tv_sec;
+	m_IdleTimers.advance(m_CurrentTime);
+	m_ClosedTimers.advance(m_CurrentTime);
+
+	ConnectionTimers::Timer* timer;
+	while ((timer = m_IdleTimers.popExpired()) != NULL)
+	{
+		ConnectionList::value_type& connection = m_ConnectionList.at(timer->data);
+
+		// the connection had packets after the timer was scheduled, wait for the rest of the timeout from its last activity
+		uint64_t expiry = connection.second.data->lastActivity + m_IdleTimeout;
+		if (expiry > m_CurrentTime)
+		{
+			m_IdleTimers.schedule(timer, expiry);
+			continue;
+		}
+
+		LOG_DEBUG("Connection with flow key [%s] is idle for %d seconds", connection.first.toString().c_str(), (int)m_IdleTimeout);
+		closeConnectionInternal(connection.first, TcpReassemblyConnectionClosedByTimeout);
+	}
+
+	// automatic cleanup
+	if (m_RemoveConnInfo == true)
+		purgeClosedConnections();
 }
 
 uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
@@ -810,23 +991,18 @@ uint32_t TcpReassembly::purgeClosedConnections(uint32_t maxNumToClean)
 	if(maxNumToClean == 0)
 		maxNumToClean = m_MaxNumToClean;
 
-	CleanupList::iterator iterTime = m_CleanupList.begin(), iterTimeEnd = m_CleanupList.upper_bound(time(NULL));
-	while(iterTime != iterTimeEnd && count < maxNumToClean)
+	// expired timers that aren't handled because of maxNumToClean stay in the expired list for the next call
+	while (count < maxNumToClean)
 	{
-		CleanupList::mapped_type& keysList = iterTime->second;
-
-		for (; !keysList.empty() && count < maxNumToClean; ++count)
-		{
-			const CleanupList::mapped_type::reference key = keysList.front();
-			m_ConnectionInfo.erase(key);
-			m_ConnectionList.erase(key);
-			keysList.pop_front();
-		}
-
-		if(keysList.empty())
-			m_CleanupList.erase(iterTime++);
-		else
-			++iterTime;
+		ConnectionTimers::Timer* timer = m_ClosedTimers.popExpired();
+		if (timer == NULL)
+			break;
+
+		// the key is copied because the entry it's stored in is erased
+		FlowKey key = m_ConnectionList.at(timer->data).first;
+		m_ConnectionInfo.erase(key);
+		m_ConnectionList.erase(key);
+		count++;
 	}
 
 	return count;
@@ -2,7 +2,6 @@
 #include "Logger.h"
 #include "PayloadLayer.h"
 #include <string.h>
-#include <algorithm>
 #include <stdlib.h>
 
 namespace pcpp
@@ -21,12 +20,68 @@ size_t tbp_my_own_strnlen(const char* s, size_t n)
 	return (size_t) (p - s);
 }
 
+// lowercase ASCII letters regardless of the locale
+static inline char tbp_to_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+
+
+// -------- Class HeaderFieldName -----------------
+
+
+HeaderFieldName::HeaderFieldName(const char* name) : m_Name(name), m_NameLen(name == NULL ? 0 : strlen(name))
+{
+	m_Hash = calculateHash(m_Name, m_NameLen);
+}
+
+HeaderFieldName::HeaderFieldName(const char* name, size_t nameLen) : m_Name(name), m_NameLen(nameLen)
+{
+	m_Hash = calculateHash(m_Name, m_NameLen);
+}
+
+uint32_t HeaderFieldName::calculateHash(const char* name, size_t nameLen)
+{
+	// FNV-1a of the lowercase name
+	uint32_t hash = 2166136261U;
+	for (size_t i = 0; i < nameLen; i++)
+	{
+		hash ^= (uint8_t)tbp_to_lower(name[i]);
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+bool HeaderFieldName::equals(const char* name, size_t nameLen) const
+{
+	if (nameLen != m_NameLen)
+		return false;
+
+	for (size_t i = 0; i < nameLen; i++)
+	{
+		if (tbp_to_lower(name[i]) != tbp_to_lower(m_Name[i]))
+			return false;
+	}
+
+	return true;
+}
+
 
 // -------- Class TextBasedProtocolMessage -----------------
 
 
 TextBasedProtocolMessage::TextBasedProtocolMessage(uint8_t* data, size_t dataLen, Layer* prevLayer, Packet* packet) : Layer(data, dataLen, prevLayer, packet),
-						m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0) {}
+						m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0)
+{
+	memset(m_FieldNameIndex, 0, sizeof(m_FieldNameIndex));
+}
+
+TextBasedProtocolMessage::TextBasedProtocolMessage() : m_FieldList(NULL), m_LastField(NULL), m_FieldsOffset(0)
+{
+	memset(m_FieldNameIndex, 0, sizeof(m_FieldNameIndex));
+}
 
 TextBasedProtocolMessage::TextBasedProtocolMessage(const TextBasedProtocolMessage& other) : Layer(other)
 {
@@ -77,10 +132,11 @@ void TextBasedProtocolMessage::copyDataFrom(const TextBasedProtocolMessage& othe
 
 	m_FieldsOffset = other.m_FieldsOffset;
 
-	// copy map
+	// build the field name index
+	memset(m_FieldNameIndex, 0, sizeof(m_FieldNameIndex));
 	for(HeaderField* field = m_FieldList; field != NULL; field = field->getNextField())
 	{
-		m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(field->getFieldName(), field));
+		addFieldToIndex(field);
 	}
 }
 
@@ -99,9 +155,7 @@ void TextBasedProtocolMessage::parseFields()
 	else
 		m_FieldList->setNextField(firstField);
 
-	std::string fieldName = firstField->getFieldName();
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-	m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, firstField));
+	addFieldToIndex(firstField);
 
 	// Last field will be empty and contain just "\n" or "\r\n". This field will mark the end of the header
 	HeaderField* curField = m_FieldList;
@@ -119,9 +173,7 @@ void TextBasedProtocolMessage::parseFields()
 			LOG_DEBUG("     Field value = %s", newField->getFieldValue().c_str());
 			curField->setNextField(newField);
 			curField = newField;
-			fieldName = newField->getFieldName();
-			std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-			m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, newField));
+			addFieldToIndex(newField);
 		}
 		else
 		{
@@ -243,33 +295,15 @@ HeaderField* TextBasedProtocolMessage::insertField(HeaderField* prevField, const
 	if (newFieldToAdd->getNextField() == NULL)
 		m_LastField = newFieldToAdd;
 
-	// insert the new field into name to field map
-	std::string fieldName = newFieldToAdd->getFieldName();
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-	m_FieldNameToFieldMap.insert(std::pair<std::string, HeaderField*>(fieldName, newFieldToAdd));
+	// insert the new field into the field name index
+	addFieldToIndex(newFieldToAdd);
 
 	return newFieldToAdd;
 }
 
-bool TextBasedProtocolMessage::removeField(std::string fieldName, int index)
+bool TextBasedProtocolMessage::removeField(const std::string& fieldName, int index)
 {
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-
-	HeaderField* fieldToRemove = NULL;
-
-	std::pair <std::multimap<std::string,HeaderField*>::iterator, std::multimap<std::string,HeaderField*>::iterator> range;
-	range = m_FieldNameToFieldMap.equal_range(fieldName);
-	int i = 0;
-	for (std::multimap<std::string,HeaderField*>::iterator iter = range.first; iter != range.second; ++iter)
-	{
-		if (i == index)
-		{
-			fieldToRemove = iter->second;
-			break;
-		}
-
-		i++;
-	}
+	HeaderField* fieldToRemove = getFieldByName(fieldName, index);
 
 	if (fieldToRemove != NULL)
 		return removeField(fieldToRemove);
@@ -291,8 +325,6 @@ bool TextBasedProtocolMessage::removeField(HeaderField* fieldToRemove)
 		return false;
 	}
 
-	std::string fieldName = fieldToRemove->getFieldName();
-
 	// shorten layer and delete this field
 	if (!shortenLayer(fieldToRemove->m_NameOffsetInMessage, fieldToRemove->getFieldSize()))
 	{
@@ -338,18 +370,8 @@ bool TextBasedProtocolMessage::removeField(HeaderField* fieldToRemove)
 		}
 	}
 
-	// remove the hash entry for this field
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
-	std::pair <std::multimap<std::string,HeaderField*>::iterator, std::multimap<std::string,HeaderField*>::iterator> range;
-	range = m_FieldNameToFieldMap.equal_range(fieldName);
-	for (std::multimap<std::string,HeaderField*>::iterator iter = range.first; iter != range.second; ++iter)
-	{
-		if (iter->second == fieldToRemove)
-		{
-			m_FieldNameToFieldMap.erase(iter);
-			break;
-		}
-	}
+	// remove the index entry for this field
+	removeFieldFromIndex(fieldToRemove);
 
 	// finally - delete this field
 	delete fieldToRemove;
@@ -376,24 +398,59 @@ void TextBasedProtocolMessage::shiftFieldsOffset(HeaderField* fromField, int num
 	}
 }
 
-HeaderField* TextBasedProtocolMessage::getFieldByName(std::string fieldName, int index) const
+HeaderField* TextBasedProtocolMessage::getFieldByName(const std::string& fieldName, int index) const
 {
-	std::transform(fieldName.begin(), fieldName.end(), fieldName.begin(), ::tolower);
+	return getFieldByName(HeaderFieldName(fieldName.c_str(), fieldName.length()), index);
+}
 
-	std::pair <std::multimap<std::string,HeaderField*>::const_iterator, std::multimap<std::string,HeaderField*>::const_iterator> range;
-	range = m_FieldNameToFieldMap.equal_range(fieldName);
-	int i = 0;
-	for (std::multimap<std::string,HeaderField*>::const_iterator iter = range.first; iter != range.second; ++iter)
+HeaderField* TextBasedProtocolMessage::getFieldByName(const HeaderFieldName& fieldName, int index) const
+{
+	HeaderField* curField = m_FieldNameIndex[fieldName.getHash() & (PCPP_TEXT_BASED_PROTOCOL_FIELD_INDEX_SIZE - 1)];
+	while (curField != NULL)
 	{
-		if (i == index)
-			return iter->second;
+		if (curField->m_FieldNameHash == fieldName.getHash() && fieldName.equals(curField->getFieldNamePtr(), curField->getFieldNameLen()))
+		{
+			if (index == 0)
+				return curField;
 
-		i++;
+			index--;
+		}
+
+		curField = curField->m_NextFieldInBucket;
 	}
 
 	return NULL;
 }
 
+void TextBasedProtocolMessage::addFieldToIndex(HeaderField* field)
+{
+	field->m_FieldNameHash = HeaderFieldName::calculateHash(field->getFieldNamePtr(), field->getFieldNameLen());
+
+	// append the field to the end of its bucket, so fields with the same name are found in the order they were parsed or added
+	HeaderField** bucketEntry = &m_FieldNameIndex[field->m_FieldNameHash & (PCPP_TEXT_BASED_PROTOCOL_FIELD_INDEX_SIZE - 1)];
+	while (*bucketEntry != NULL)
+		bucketEntry = &((*bucketEntry)->m_NextFieldInBucket);
+
+	field->m_NextFieldInBucket = NULL;
+	*bucketEntry = field;
+}
+
+void TextBasedProtocolMessage::removeFieldFromIndex(HeaderField* field)
+{
+	HeaderField** bucketEntry = &m_FieldNameIndex[field->m_FieldNameHash & (PCPP_TEXT_BASED_PROTOCOL_FIELD_INDEX_SIZE - 1)];
+	while (*bucketEntry != NULL)
+	{
+		if (*bucketEntry == field)
+		{
+			*bucketEntry = field->m_NextFieldInBucket;
+			field->m_NextFieldInBucket = NULL;
+			return;
+		}
+
+		bucketEntry = &((*bucketEntry)->m_NextFieldInBucket);
+	}
+}
+
 int TextBasedProtocolMessage::getFieldCount() const
 {
 	int result = 0;
@@ -415,7 +472,7 @@ void TextBasedProtocolMessage::parseNextLayer()
 	if (m_DataLen <= headerLen)
 		return;
 
-	m_NextLayer = new PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
+	m_NextLayer = new(m_Packet) PayloadLayer(m_Data + headerLen, m_DataLen - headerLen, this, m_Packet);
 }
 
 size_t TextBasedProtocolMessage::getHeaderLen() const
@@ -437,7 +494,7 @@ void TextBasedProtocolMessage::computeCalculateFields()
 
 HeaderField::HeaderField(TextBasedProtocolMessage* TextBasedProtocolMessage, int offsetInMessage, char nameValueSeperator, bool spacesAllowedBetweenNameAndValue) :
 		m_NewFieldData(NULL), m_TextBasedProtocolMessage(TextBasedProtocolMessage), m_NameOffsetInMessage(offsetInMessage), m_NextField(NULL),
-		m_NameValueSeperator(nameValueSeperator), m_SpacesAllowedBetweenNameAndValue(spacesAllowedBetweenNameAndValue)
+		m_NextFieldInBucket(NULL), m_FieldNameHash(0), m_NameValueSeperator(nameValueSeperator), m_SpacesAllowedBetweenNameAndValue(spacesAllowedBetweenNameAndValue)
 {
 	char* fieldData = (char*)(m_TextBasedProtocolMessage->m_Data + m_NameOffsetInMessage);
 	//char* fieldEndPtr = strchr(fieldData, '\n');
@@ -527,6 +584,8 @@ void HeaderField::initNewField(std::string name, std::string value)
 	m_TextBasedProtocolMessage = NULL;
 	m_NameOffsetInMessage = 0;
 	m_NextField = NULL;
+	m_NextFieldInBucket = NULL;
+	m_FieldNameHash = 0;
 
 	// first building the name-value separator
 	std::string nameValueSeparation(1, m_NameValueSeperator);
@@ -625,6 +684,22 @@ std::string HeaderField::getFieldValue() const
 	return result;
 }
 
+const char* HeaderField::getFieldNamePtr() const
+{
+	if (m_FieldNameSize == (size_t)-1)
+		return NULL;
+
+	return getData() + m_NameOffsetInMessage;
+}
+
+const char* HeaderField::getFieldValuePtr() const
+{
+	if (m_ValueOffsetInMessage == -1)
+		return NULL;
+
+	return getData() + m_ValueOffsetInMessage;
+}
+
 bool HeaderField::setFieldValue(std::string newValue)
 {
 	// Field isn't linked with any message yet
@@ -636,6 +711,8 @@ bool HeaderField::setFieldValue(std::string newValue)
 		return true;
 	}
 
+	m_TextBasedProtocolMessage->makePacketWritable();
+
 	std::string curValue = getFieldValue();
 	int lengthDifference = newValue.length() - curValue.length();
 	// new value is longer than current value
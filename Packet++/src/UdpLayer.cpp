@@ -4,6 +4,7 @@
 #include "UdpLayer.h"
 #include "IpUtils.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "DnsLayer.h"
@@ -31,6 +32,41 @@ UdpLayer::UdpLayer(uint16_t portSrc, uint16_t portDst)
 	m_Protocol = UDP;
 }
 
+uint16_t UdpLayer::getSrcPort() const
+{
+	return be16toh(getUdpHeader()->portSrc);
+}
+
+uint16_t UdpLayer::getDstPort() const
+{
+	return be16toh(getUdpHeader()->portDst);
+}
+
+void UdpLayer::setSrcPort(uint16_t port, bool updateChecksum)
+{
+	makePacketWritable();
+	setPort(&getUdpHeader()->portSrc, port, updateChecksum);
+}
+
+void UdpLayer::setDstPort(uint16_t port, bool updateChecksum)
+{
+	makePacketWritable();
+	setPort(&getUdpHeader()->portDst, port, updateChecksum);
+}
+
+void UdpLayer::setPort(uint16_t* portField, uint16_t port, bool updateChecksum)
+{
+	uint16_t oldValue = *portField;
+	*portField = htobe16(port);
+
+	// a zero checksum means the checksum isn't used
+	udphdr* udpHdr = getUdpHeader();
+	if (!updateChecksum)
+		m_IsModified = true;
+	else if (udpHdr->headerChecksum != 0)
+		udpHdr->headerChecksum = update_checksum(udpHdr->headerChecksum, oldValue, *portField);
+}
+
 uint16_t UdpLayer::calculateChecksum(bool writeResultToPacket)
 {
 	udphdr* udpHdr = (udphdr*)m_Data;
@@ -95,28 +131,10 @@ void UdpLayer::parseNextLayer()
 	uint8_t* udpData = m_Data + sizeof(udphdr);
 	size_t udpDataLen = m_DataLen - sizeof(udphdr);
 
-	if ((portSrc == 68 && portDst == 67) || (portSrc == 67 && portDst == 68) || (portSrc == 67 && portDst == 67))
-		m_NextLayer = new DhcpLayer(udpData, udpDataLen, this, m_Packet);
-	else if (VxlanLayer::isVxlanPort(portDst))
-		m_NextLayer = new VxlanLayer(udpData, udpDataLen, this, m_Packet);
-	else if ((udpDataLen >= sizeof(dnshdr)) && (DnsLayer::isDnsPort(portDst) || DnsLayer::isDnsPort(portSrc)))
-		m_NextLayer = new DnsLayer(udpData, udpDataLen, this, m_Packet);
-	else if(SipLayer::isSipPort(portDst) || SipLayer::isSipPort(portSrc))
-	{
-		if (SipRequestFirstLine::parseMethod((char*)udpData, udpDataLen) != SipRequestLayer::SipMethodUnknown)
-			m_NextLayer = new SipRequestLayer(udpData, udpDataLen, this, m_Packet);
-		else if (SipResponseFirstLine::parseStatusCode((char*)udpData, udpDataLen) != SipResponseLayer::SipStatusCodeUnknown
-						&& SipResponseFirstLine::parseVersion((char*)udpData, udpDataLen) != "")
-			m_NextLayer = new SipResponseLayer(udpData, udpDataLen, this, m_Packet);
-		else
-			m_NextLayer = new PayloadLayer(udpData, udpDataLen, this, m_Packet);
-	}
-	else if ((RadiusLayer::isRadiusPort(portDst) || RadiusLayer::isRadiusPort(portSrc)) && RadiusLayer::isDataValid(udpData, udpDataLen))
-		m_NextLayer = new RadiusLayer(udpData, udpDataLen, this, m_Packet);
-	else if ((GtpV1Layer::isGTPv1Port(portDst) || GtpV1Layer::isGTPv1Port(portSrc)) && GtpV1Layer::isGTPv1(udpData, udpDataLen))
-		m_NextLayer = new GtpV1Layer(udpData, udpDataLen, this, m_Packet);
-	else
-		m_NextLayer = new PayloadLayer(udpData, udpDataLen, this, m_Packet);
+	// the application protocol parsers are registered by port (see NextLayerRegistry)
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::UdpPortTable, portSrc, portDst, udpData, udpDataLen, this, m_Packet);
+	if (m_NextLayer == NULL)
+		m_NextLayer = new(m_Packet) PayloadLayer(udpData, udpDataLen, this, m_Packet);
 }
 
 void UdpLayer::computeCalculateFields()
@@ -4,6 +4,7 @@
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
 #include "ArpLayer.h"
 #include "PPPoELayer.h"
 #include "MplsLayer.h"
@@ -42,14 +43,17 @@ uint8_t VlanLayer::getPriority() const {
 }
 
 void VlanLayer::setVlanID(uint16_t id) {
+	makePacketWritable();
 	getVlanHeader()->vlan = htobe16((be16toh(getVlanHeader()->vlan) & (~0xFFF)) | (id & 0xFFF));
 }
 
 void VlanLayer::setCFI(bool cfi) {
+	makePacketWritable();
 	getVlanHeader()->vlan = htobe16((be16toh(getVlanHeader()->vlan) & (~(1 << 12))) | ((cfi & 1) << 12));
 }
 
 void VlanLayer::setPriority(uint8_t priority) {
+	makePacketWritable();
 	getVlanHeader()->vlan = htobe16((be16toh(getVlanHeader()->vlan) & (~(7 << 13))) | ((priority & 7) << 13));
 }
 
@@ -62,36 +66,9 @@ void VlanLayer::parseNextLayer()
 	size_t payloadLen = m_DataLen - sizeof(vlan_header);
 
 	vlan_header* hdr = getVlanHeader();
-	switch (be16toh(hdr->etherType))
-	{
-	case PCPP_ETHERTYPE_IP:
-		m_NextLayer = IPv4Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv4Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
-		break;
-	case PCPP_ETHERTYPE_IPV6:
-		m_NextLayer = IPv6Layer::isDataValid(payload, payloadLen)
-			? static_cast<Layer*>(new IPv6Layer(payload, payloadLen, this, m_Packet))
-			: static_cast<Layer*>(new PayloadLayer(payload, payloadLen, this, m_Packet));
-		break;
-	case PCPP_ETHERTYPE_ARP:
-		m_NextLayer = new ArpLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_VLAN:
-		m_NextLayer = new VlanLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_PPPOES:
-		m_NextLayer = new PPPoESessionLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_PPPOED:
-		m_NextLayer = new PPPoEDiscoveryLayer(payload, payloadLen, this, m_Packet);
-		break;
-	case PCPP_ETHERTYPE_MPLS:
-		m_NextLayer = new MplsLayer(payload, payloadLen, this, m_Packet);
-		break;
-	default:
-		m_NextLayer = new PayloadLayer(payload, payloadLen, this, m_Packet);
-	}
+	m_NextLayer = NextLayerRegistry::getInstance().parseNextLayer(NextLayerRegistry::EtherTypeTable, be16toh(hdr->etherType), payload, payloadLen, this, m_Packet);
+	if (m_NextLayer == NULL)
+		m_NextLayer = new(m_Packet) PayloadLayer(payload, payloadLen, this, m_Packet);
 }
 
 std::string VlanLayer::toString() const
@@ -199,6 +199,48 @@ namespace pcpp
 		 */
 		bool reallocateData(size_t newBufferLength);
 
+		/**
+		 * The headroom of an MBufRawPacket is the headroom of its mbuf, so it can't be changed. This method only performs the same check as
+		 * reallocateData(size_t) and verifies the mbuf already has the requested headroom
+		 * @param[in] newBufferLength The new buffer length as required by the user
+		 * @param[in] headroom The requested headroom
+		 * @return True if the mbuf has room for the new size and the requested headroom, false otherwise
+		 */
+		bool reallocateData(size_t newBufferLength, size_t headroom);
+
+		/**
+		 * Insert data near the beginning of the packet by moving the data before it into the headroom of the mbuf (using rte_pktmbuf_prepend())
+		 * @param[in] atIndex The index to insert the new data to
+		 * @param[in] dataToInsert A pointer to the new data to insert
+		 * @param[in] dataToInsertLen Length in bytes of dataToInsert
+		 * @return True if the data was inserted, false otherwise. In case of an error it's printed to log
+		 */
+		bool insertDataUsingHeadroom(int atIndex, const uint8_t* dataToInsert, size_t dataToInsertLen);
+
+		/**
+		 * Remove data near the beginning of the packet by moving the data before it forward and returning the space to the headroom of the
+		 * mbuf (using rte_pktmbuf_adj())
+		 * @param[in] atIndex The index to start removing bytes from
+		 * @param[in] numOfBytesToRemove Number of bytes to remove
+		 * @return True if the data was removed, false otherwise. In case of an error it's printed to log
+		 */
+		bool removeDataUsingHeadroom(int atIndex, size_t numOfBytesToRemove);
+
+		/**
+		 * Take over the mbuf attached to another MBufRawPacket without copying its data. The mbuf currently attached to this instance
+		 * is freed first (if it should be freed, see setFreeMbuf()) and the other instance is left uninitialized
+		 * @param[in] other The raw packet to take the mbuf from. Must be an MBufRawPacket
+		 * @return True if the mbuf was adopted or false if the other raw packet isn't an MBufRawPacket. In case of an error it's printed to log
+		 */
+		bool adoptRawData(RawPacket& other);
+
+		/**
+		 * The data of an MBufRawPacket lives inside an mbuf and can't be released as a plain buffer, so this method always fails.
+		 * Use adoptRawData() to hand the mbuf to another MBufRawPacket
+		 * @return Always NULL. An error is printed to log
+		 */
+		uint8_t* releaseRawData(size_t* headroom = NULL);
+
 		/**
 		 * Set an indication whether to free the mbuf when done using it or not ("done using it" means setting another mbuf or class d'tor).
 		 * Default value is true.
@@ -0,0 +1,336 @@
+#ifndef PCAPPP_SHARDED_TCP_REASSEMBLY
+#define PCAPPP_SHARDED_TCP_REASSEMBLY
+
+#include "TcpReassembly.h"
+#include "RawPacket.h"
+#include <vector>
+#include <pthread.h>
+
+/// @file
+
+/**
+ * The size in bytes of the packet buffers of the rings that pass packets to the shards of pcpp#ShardedTcpReassembly. Packets up to this size
+ * are copied into the ring, larger packets are copied to a buffer allocated on the heap and only a pointer to it is passed in the ring
+ */
+#define PCPP_SHARDED_TCP_REASSEMBLY_SLOT_DATA_SIZE 2048
+
+/**
+ * The default number of packets each ring of pcpp#ShardedTcpReassembly can hold
+ */
+#define PCPP_SHARDED_TCP_REASSEMBLY_DEFAULT_RING_CAPACITY 1024
+
+/**
+ * \namespace pcpp
+ * \brief The main namespace for the PcapPlusPlus lib
+ */
+namespace pcpp
+{
+
+	/**
+	 * @struct ShardedTcpReassemblyConfiguration
+	 * A structure for configuring the ShardedTcpReassembly class
+	 */
+	struct ShardedTcpReassemblyConfiguration
+	{
+		/** The number of shards, each running its own pcpp#TcpReassembly in its own thread. If the value is set to 0 the number of cores of
+		 * the machine is used
+		 */
+		size_t numOfShards;
+
+		/** The number of producers, meaning the number of threads that may feed packets at the same time. Each producer has its own ring to
+		 * each shard
+		 */
+		size_t numOfProducers;
+
+		/** The number of packets each ring (between one producer and one shard) can hold. The value is rounded up to a power of 2. If it's set
+		 * to 0 the default value (#PCPP_SHARDED_TCP_REASSEMBLY_DEFAULT_RING_CAPACITY) is used
+		 */
+		size_t ringCapacity;
+
+		/** What a producer does when the ring to the shard of a packet is full. If it's false (the default) the producer waits until the shard
+		 * makes room, so no packet is lost. If it's true the packet is dropped and counted in TcpReassemblyShardStats#packetsDropped, which
+		 * fits live capture threads that shouldn't be blocked
+		 */
+		bool dropWhenFull;
+
+		/** The configuration of the pcpp#TcpReassembly instance of each shard. Its useInnerTuple flag also selects the tuple packets are
+		 * steered to shards by
+		 */
+		TcpReassemblyConfiguration reassemblyConfig;
+
+		/**
+		 * A c'tor for this struct
+		 * @param[in] numOfShards The number of shards. The default is 0 which means one shard per core
+		 * @param[in] numOfProducers The number of producers. The default is 1
+		 * @param[in] ringCapacity The number of packets each ring can hold. The default is 0 which means #PCPP_SHARDED_TCP_REASSEMBLY_DEFAULT_RING_CAPACITY
+		 * @param[in] dropWhenFull Whether to drop packets when a ring is full instead of waiting. The default is false
+		 * @param[in] reassemblyConfig The configuration of the pcpp#TcpReassembly instance of each shard
+		 */
+		ShardedTcpReassemblyConfiguration(size_t numOfShards = 0, size_t numOfProducers = 1, size_t ringCapacity = 0, bool dropWhenFull = false,
+				const TcpReassemblyConfiguration& reassemblyConfig = TcpReassemblyConfiguration()) :
+			numOfShards(numOfShards), numOfProducers(numOfProducers), ringCapacity(ringCapacity), dropWhenFull(dropWhenFull), reassemblyConfig(reassemblyConfig)
+		{
+		}
+	};
+
+
+	/**
+	 * @struct TcpReassemblyShardStats
+	 * The statistics of one shard of pcpp#ShardedTcpReassembly. While the shards are running the counters are updated atomically by the shard's
+	 * thread and the producers, so each counter read while they run is a value it had recently but the counters may not be consistent with each
+	 * other. After ShardedTcpReassembly#flush() or ShardedTcpReassembly#stop() they're exact
+	 */
+	struct TcpReassemblyShardStats
+	{
+		/** The number of packets the producers queued to the shard */
+		uint64_t packetsQueued;
+		/** The number of packets the producers dropped because the shard's ring was full (see ShardedTcpReassemblyConfiguration#dropWhenFull) */
+		uint64_t packetsDropped;
+		/** The number of packets the shard processed */
+		uint64_t packetsProcessed;
+		/** The number of processed packets whose data was sent to the user or was a new connection's first packet (TcpReassembly#TcpMessageHandled) */
+		uint64_t tcpMessagesHandled;
+		/** The number of processed packets whose data was queued as out-of-order data (TcpReassembly#OutOfOrderTcpMessageBuffered) */
+		uint64_t outOfOrderPackets;
+		/** The number of processed packets that aren't TCP packets over IPv4 or IPv6 */
+		uint64_t nonTcpPackets;
+		/** The number of processed TCP packets that were ignored: retransmissions, packets with no data, packets of closed connections, etc. */
+		uint64_t ignoredPackets;
+		/** The number of times the message callback was invoked */
+		uint64_t messagesDelivered;
+		/** The number of bytes sent to the message callback */
+		uint64_t bytesDelivered;
+		/** The number of connections that started */
+		uint64_t connectionsStarted;
+		/** The number of connections that ended */
+		uint64_t connectionsEnded;
+
+		/**
+		 * A c'tor for this struct that zeroes all counters
+		 */
+		TcpReassemblyShardStats() { clear(); }
+
+		/**
+		 * Zero all counters
+		 */
+		void clear()
+		{
+			packetsQueued = 0; packetsDropped = 0; packetsProcessed = 0; tcpMessagesHandled = 0; outOfOrderPackets = 0; nonTcpPackets = 0;
+			ignoredPackets = 0; messagesDelivered = 0; bytesDelivered = 0; connectionsStarted = 0; connectionsEnded = 0;
+		}
+
+		/**
+		 * Add the counters of other stats to these stats
+		 * @param[in] other The stats to add
+		 */
+		void add(const TcpReassemblyShardStats& other)
+		{
+			packetsQueued += other.packetsQueued; packetsDropped += other.packetsDropped; packetsProcessed += other.packetsProcessed;
+			tcpMessagesHandled += other.tcpMessagesHandled; outOfOrderPackets += other.outOfOrderPackets; nonTcpPackets += other.nonTcpPackets;
+			ignoredPackets += other.ignoredPackets; messagesDelivered += other.messagesDelivered; bytesDelivered += other.bytesDelivered;
+			connectionsStarted += other.connectionsStarted; connectionsEnded += other.connectionsEnded;
+		}
+	};
+
+
+	/**
+	 * @class ShardedTcpReassembly
+	 * A multi-threaded TCP reassembly engine. It runs several shards, each with its own pcpp#TcpReassembly instance in its own thread, and
+	 * spreads the connections between them:
+	 * - Packets are fed by any number of producer threads (for example capture threads) with reassemblePacket(). Each producer has an index
+	 *   and at any time only one thread may feed packets with a certain producer index
+	 * - The producer calculates the shard of the packet from a symmetric hash of the packet's pcpp#FlowKey (see getShardIndex()), so both
+	 *   sides of a connection always go to the same shard, and copies the packet to a lock-free single-producer single-consumer ring
+	 *   (pcpp#SpscRing) between this producer and this shard. No locks are taken and no memory is allocated on this path (except for packets
+	 *   larger than #PCPP_SHARDED_TCP_REASSEMBLY_SLOT_DATA_SIZE)
+	 * - Each shard thread takes the packets from its rings and reassembles them. All callbacks of a connection are invoked in the thread of
+	 *   the shard that owns it, with the shard's index, so the user can keep state per shard without locking
+	 * - Packets of a connection are processed in the order they were fed as long as they're fed by the same producer. So like with NIC RSS
+	 *   queues, the producers should get the packets of a connection from the same source
+	 * - Each shard has its own statistics (see getShardStats())
+	 * - flush() and closeAllConnections() coordinate all shards: they wait until every shard processed all the packets queued before the call,
+	 *   and closeAllConnections() then closes all of the shard's connections in the shard's thread
+	 *
+	 * A typical usage is: create an instance, call start(), feed packets from the capture threads, call closeAllConnections() after capturing
+	 * is done and finally stop(). start(), stop(), flush() and closeAllConnections() may be called from any thread: they're serialized by a
+	 * mutex, so when several threads call them at once they run one after the other. They can't be called from a shard's thread, meaning from
+	 * inside the callbacks, since they wait for all shards including the calling one. Such calls are refused with an error log
+	 */
+	class ShardedTcpReassembly
+	{
+	public:
+
+		/**
+		 * @typedef OnTcpMessageReady
+		 * A callback invoked in a shard's thread when new data arrives on a connection. See pcpp#TcpReassembly#OnTcpMessageReady
+		 * @param[in] side The side this data belongs to. The value is 0 or 1 where 0 is the first side seen in the connection
+		 * @param[in] tcpData The TCP data itself + connection information. The data is valid only until the callback returns
+		 * @param[in] shardIndex The index of the shard that owns the connection
+		 * @param[in] userCookie A pointer to the cookie provided by the user in ShardedTcpReassembly c'tor (or NULL if no cookie provided)
+		 */
+		typedef void (*OnTcpMessageReady)(int side, const TcpStreamData& tcpData, int shardIndex, void* userCookie);
+
+		/**
+		 * @typedef OnTcpConnectionStart
+		 * A callback invoked in a shard's thread when a new connection is identified
+		 * @param[in] connectionData Connection information
+		 * @param[in] shardIndex The index of the shard that owns the connection
+		 * @param[in] userCookie A pointer to the cookie provided by the user in ShardedTcpReassembly c'tor (or NULL if no cookie provided)
+		 */
+		typedef void (*OnTcpConnectionStart)(const ConnectionData& connectionData, int shardIndex, void* userCookie);
+
+		/**
+		 * @typedef OnTcpConnectionEnd
+		 * A callback invoked in a shard's thread when a connection ends
+		 * @param[in] connectionData Connection information
+		 * @param[in] reason The reason for connection termination
+		 * @param[in] shardIndex The index of the shard that owned the connection
+		 * @param[in] userCookie A pointer to the cookie provided by the user in ShardedTcpReassembly c'tor (or NULL if no cookie provided)
+		 */
+		typedef void (*OnTcpConnectionEnd)(const ConnectionData& connectionData, TcpReassembly::ConnectionEndReason reason, int shardIndex, void* userCookie);
+
+		/**
+		 * A c'tor for this class. It creates the shards and their rings but doesn't start their threads
+		 * @param[in] onMessageReadyCallback The callback to be invoked when new data arrives
+		 * @param[in] userCookie A pointer to an object provided by the user. This pointer will be returned when invoking the various callbacks. This
+		 * parameter is optional, default cookie is NULL
+		 * @param[in] onConnectionStartCallback The callback to be invoked when a new connection is identified. This parameter is optional
+		 * @param[in] onConnectionEndCallback The callback to be invoked when a connection ends. This parameter is optional
+		 * @param[in] config Optional parameter for defining the shards, the rings and the configuration of the shards' pcpp#TcpReassembly
+		 */
+		ShardedTcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* userCookie = NULL, OnTcpConnectionStart onConnectionStartCallback = NULL,
+				OnTcpConnectionEnd onConnectionEndCallback = NULL, const ShardedTcpReassemblyConfiguration& config = ShardedTcpReassemblyConfiguration());
+
+		/**
+		 * A d'tor for this class. Stops the shards' threads if they're running (see stop()) and frees all memory
+		 */
+		~ShardedTcpReassembly();
+
+		/**
+		 * Start the threads of the shards
+		 * @return True if all threads started, false if they're already running or a thread couldn't be created (in which case the threads
+		 * that started are stopped)
+		 */
+		bool start();
+
+		/**
+		 * Stop the threads of the shards. Each shard first processes all the packets that were queued to it. Connections that are still open
+		 * stay open, so to get their out-of-order data call closeAllConnections() before stopping. The producers must stop feeding packets
+		 * before this method is called. Calling this method from a shard's thread is refused
+		 */
+		void stop();
+
+		/**
+		 * @return True if the threads of the shards are running
+		 */
+		bool isRunning() const;
+
+		/**
+		 * Queue a packet to the shard that owns its connection. The packet's data is copied, so the packet may be reused or freed when this
+		 * method returns
+		 * @param[in] tcpRawData The packet to queue
+		 * @param[in] producerIndex The index of the calling producer, between 0 and the number of producers - 1. At any time only one thread
+		 * may call this method with a certain producer index
+		 * @return True if the packet was queued. False if the shards aren't running, the producer index is invalid or the ring to the shard
+		 * was full and ShardedTcpReassemblyConfiguration#dropWhenFull is set
+		 */
+		bool reassemblePacket(const RawPacket* tcpRawData, size_t producerIndex = 0);
+
+		/**
+		 * Calculate the shard that owns the connection of a packet. The packet is parsed with pcpp#PacketView (which is much cheaper than
+		 * parsing a pcpp#Packet) and the shard is chosen by a hash of its pcpp#FlowKey. Since the key is normalized for direction both sides of
+		 * a connection have the same shard. For packets that aren't carried directly over TCP (for example tunneled packets) the key has only
+		 * the IP addresses, because the connection pcpp#TcpReassembly identifies for these packets has the same addresses but its ports are of
+		 * an inner header. If useInnerTuple is set in the reassembly configuration the key is the innermost flow key extracted by
+		 * pcpp#FlowKey#extractTunnelFlowKeys() instead. Packets that aren't IPv4 or IPv6 go to shard 0
+		 * @param[in] rawPacket The packet
+		 * @return The index of the shard
+		 */
+		int getShardIndex(const RawPacket* rawPacket) const;
+
+		/**
+		 * Wait until every shard processed all the packets that were queued before this method was called. If the shards aren't running the
+		 * queued packets are processed in the calling thread
+		 * @return True if the shards processed the packets, false if the method was called from a shard's thread (for example from a callback),
+		 * in which case nothing is done
+		 */
+		bool flush();
+
+		/**
+		 * Close all open connections of all shards. Each shard first processes all the packets that were queued before this method was
+		 * called and then closes its connections in its own thread, which sends the out-of-order data of the connections to the message
+		 * callback and invokes the connection end callback with a reason of TcpReassembly#TcpReassemblyConnectionClosedManually. The method
+		 * returns after all shards are done. If the shards aren't running all of this is done in the calling thread
+		 * @return True if the connections were closed, false if the method was called from a shard's thread (for example from a callback), in
+		 * which case nothing is done
+		 */
+		bool closeAllConnections();
+
+		/**
+		 * @return The number of shards
+		 */
+		int getNumOfShards() const { return (int)m_Shards.size(); }
+
+		/**
+		 * @return The number of producers
+		 */
+		size_t getNumOfProducers() const { return m_NumOfProducers; }
+
+		/**
+		 * Get the statistics of a shard
+		 * @param[in] shardIndex The index of the shard
+		 * @param[out] stats The statistics of the shard. If the shard index is invalid the statistics are zeroed
+		 */
+		void getShardStats(int shardIndex, TcpReassemblyShardStats& stats) const;
+
+		/**
+		 * Get the sum of the statistics of all shards
+		 * @param[out] stats The sum of the statistics
+		 */
+		void getTotalStats(TcpReassemblyShardStats& stats) const;
+
+	private:
+		struct Shard;
+
+		enum ShardCommand
+		{
+			NoCommand,
+			FlushCommand,
+			CloseAllConnectionsCommand
+		};
+
+		std::vector<Shard*> m_Shards;
+		size_t m_NumOfProducers;
+		bool m_DropWhenFull;
+		bool m_UseInnerTuple;
+		long m_Running;
+		// serializes start(), stop() and the commands, and protects m_CommandSeq
+		pthread_mutex_t m_CommandMutex;
+		long m_CommandSeq;
+		// set in the shards' threads to their shard, to detect calls that would wait for the calling thread itself
+		pthread_key_t m_ShardThreadKey;
+
+		OnTcpMessageReady m_OnMessageReadyCallback;
+		OnTcpConnectionStart m_OnConnStart;
+		OnTcpConnectionEnd m_OnConnEnd;
+		void* m_UserCookie;
+
+		ShardedTcpReassembly(const ShardedTcpReassembly& other);
+		ShardedTcpReassembly& operator=(const ShardedTcpReassembly& other);
+
+		bool isShardThread() const;
+		void stopShards();
+		bool runCommand(ShardCommand command);
+
+		static void* shardThreadMain(void* shardPtr);
+		static size_t processShardPackets(Shard* shard, size_t maxPacketsPerRing);
+		static void executeShardCommand(Shard* shard, ShardCommand command);
+
+		static void onMessageReady(int side, const TcpStreamData& tcpData, void* shardPtr);
+		static void onConnectionStart(const ConnectionData& connectionData, void* shardPtr);
+		static void onConnectionEnd(const ConnectionData& connectionData, TcpReassembly::ConnectionEndReason reason, void* shardPtr);
+	};
+
+} // namespace pcpp
+
+#endif /* PCAPPP_SHARDED_TCP_REASSEMBLY */
@@ -41,6 +41,41 @@ MBufRawPacket::~MBufRawPacket()
 	}
 }
 
+bool MBufRawPacket::adoptRawData(RawPacket& other)
+{
+	if (this == &other)
+		return true;
+
+	if (other.getObjectType() != MBUFRAWPACKET_OBJECT_TYPE)
+	{
+		LOG_ERROR("Cannot adopt the raw data of a raw packet which isn't an MBufRawPacket");
+		return false;
+	}
+
+	MBufRawPacket& otherMBufPacket = (MBufRawPacket&)other;
+
+	if (m_MBuf != NULL && m_FreeMbuf)
+		rte_pktmbuf_free(m_MBuf);
+
+	m_MBuf = otherMBufPacket.m_MBuf;
+	m_Mempool = otherMBufPacket.m_Mempool;
+	m_FreeMbuf = otherMBufPacket.m_FreeMbuf;
+	moveDataFrom(other);
+
+	// the data belongs to the mbuf, it's never deleted as a plain buffer
+	m_DeleteRawDataAtDestructor = false;
+	otherMBufPacket.m_DeleteRawDataAtDestructor = false;
+	otherMBufPacket.m_MBuf = NULL;
+	otherMBufPacket.m_Mempool = NULL;
+	return true;
+}
+
+uint8_t* MBufRawPacket::releaseRawData(size_t* /*headroom*/)
+{
+	LOG_ERROR("The data of an MBufRawPacket belongs to its mbuf and can't be released");
+	return NULL;
+}
+
 bool MBufRawPacket::init(struct rte_mempool* mempool)
 {
 	if (m_MBuf != NULL)
@@ -92,6 +127,7 @@ bool MBufRawPacket::initFromRawPacket(const RawPacket* rawPacket, struct rte_mem
 
 	m_RawData = rte_pktmbuf_mtod(m_MBuf, uint8_t*);
 	m_RawDataLen = rte_pktmbuf_pkt_len(m_MBuf);
+	m_Headroom = rte_pktmbuf_headroom(m_MBuf);
 
 	copyDataFrom(*rawPacket, false);
 
@@ -164,6 +200,8 @@ MBufRawPacket& MBufRawPacket::operator=(const MBufRawPacket& other)
 		}
 	}
 
+	m_RawData = rte_pktmbuf_mtod(m_MBuf, uint8_t*);
+	m_Headroom = rte_pktmbuf_headroom(m_MBuf);
 	m_RawPacketSet = false;
 
 	copyDataFrom(other, false);
@@ -208,6 +246,7 @@ bool MBufRawPacket::setRawData(const uint8_t* pRawData, int rawDataLen, timespec
 
 	m_RawData = rte_pktmbuf_mtod(m_MBuf, uint8_t*);
 	m_RawDataLen = rte_pktmbuf_pkt_len(m_MBuf);
+	m_Headroom = rte_pktmbuf_headroom(m_MBuf);
 	memcpy(m_RawData, pRawData, m_RawDataLen);
 	delete [] pRawData;
 	m_TimeStamp = timestamp;
@@ -313,6 +352,61 @@ bool MBufRawPacket::reallocateData(size_t newBufferLength)
 	return true;
 }
 
+bool MBufRawPacket::reallocateData(size_t newBufferLength, size_t headroom)
+{
+	if (headroom > m_Headroom)
+	{
+		LOG_ERROR("Cannot reserve more headroom than the mBuf has. mBuf headroom: %d; requested headroom: %d", (int)m_Headroom, (int)headroom);
+		return false;
+	}
+
+	return reallocateData(newBufferLength);
+}
+
+bool MBufRawPacket::insertDataUsingHeadroom(int atIndex, const uint8_t* dataToInsert, size_t dataToInsertLen)
+{
+	if (m_MBuf == NULL)
+	{
+		LOG_ERROR("MBufRawPacket not initialized. Please call the init() method");
+		return false;
+	}
+
+	if (!RawPacket::insertDataUsingHeadroom(atIndex, dataToInsert, dataToInsertLen))
+		return false;
+
+	// the data pointer was moved back, move the start of the mbuf data accordingly
+	if (rte_pktmbuf_prepend(m_MBuf, dataToInsertLen) == NULL)
+	{
+		LOG_ERROR("Couldn't prepend %d bytes to mbuf", (int)dataToInsertLen);
+		return false;
+	}
+
+	LOG_DEBUG("Inserted %d bytes to MBufRawPacket using headroom", (int)dataToInsertLen);
+	return true;
+}
+
+bool MBufRawPacket::removeDataUsingHeadroom(int atIndex, size_t numOfBytesToRemove)
+{
+	if (m_MBuf == NULL)
+	{
+		LOG_ERROR("MBufRawPacket not initialized. Please call the init() method");
+		return false;
+	}
+
+	if (!RawPacket::removeDataUsingHeadroom(atIndex, numOfBytesToRemove))
+		return false;
+
+	// the data pointer was moved forward, move the start of the mbuf data accordingly
+	if (rte_pktmbuf_adj(m_MBuf, numOfBytesToRemove) == NULL)
+	{
+		LOG_ERROR("Couldn't remove %d bytes from the beginning of the mbuf", (int)numOfBytesToRemove);
+		return false;
+	}
+
+	LOG_DEBUG("Removed %d bytes from MBufRawPacket using headroom", (int)numOfBytesToRemove);
+	return true;
+}
+
 void MBufRawPacket::setMBuf(struct rte_mbuf* mBuf, timespec timestamp)
 {
 	if (m_MBuf != NULL && m_FreeMbuf)
@@ -326,6 +420,7 @@ void MBufRawPacket::setMBuf(struct rte_mbuf* mBuf, timespec timestamp)
 
 	m_MBuf = mBuf;
 	RawPacket::setRawData(rte_pktmbuf_mtod(mBuf, const uint8_t*), rte_pktmbuf_pkt_len(mBuf), timestamp, LINKTYPE_ETHERNET);
+	m_Headroom = rte_pktmbuf_headroom(mBuf);
 }
 
 } // namespace pcpp
@@ -0,0 +1,598 @@
+#define LOG_MODULE PcapLogModuleShardedTcpReassembly
+
+#include "ShardedTcpReassembly.h"
+#include "SpscRing.h"
+#include "FlowKey.h"
+#include "LayerArena.h"
+#include "Packet.h"
+#include "IPv4Layer.h"
+#include "SystemUtils.h"
+#include "Logger.h"
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+#include <windows.h>
+#else
+#include <sched.h>
+#include <time.h>
+#endif
+
+// the number of times a thread that has nothing to do yields its CPU before it starts sleeping between checks
+#define SHARD_IDLE_YIELD_ROUNDS 64
+// how long a thread that has nothing to do sleeps between checks, in microseconds
+#define SHARD_IDLE_SLEEP_USEC 100
+// the maximum number of packets a shard takes from one ring before it moves to the next ring, so a busy producer doesn't starve the others
+#define SHARD_RING_BURST_SIZE 64
+
+namespace pcpp
+{
+
+// the state shared between the threads (the running flag and the command sequences) is read with acquire and written with release semantics
+static inline long loadAcquire(const long* value)
+{
+#ifdef _MSC_VER
+	long result = *(const volatile long*)value;
+	_ReadWriteBarrier();
+	return result;
+#else
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void storeRelease(long* target, long value)
+{
+#ifdef _MSC_VER
+	_ReadWriteBarrier();
+	*(volatile long*)target = value;
+#else
+	__atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// the statistics counters are read by any thread while a single thread (the shard's thread or the ring's producer) updates each of them, so
+// they're accessed atomically but need no ordering
+static inline uint64_t loadRelaxed(const uint64_t* counter)
+{
+#ifdef _MSC_VER
+	return (uint64_t)InterlockedCompareExchange64((volatile LONGLONG*)counter, 0, 0);
+#else
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void storeRelaxed(uint64_t* counter, uint64_t value)
+{
+#ifdef _MSC_VER
+	InterlockedExchange64((volatile LONGLONG*)counter, (LONGLONG)value);
+#else
+	__atomic_store_n(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+// only the counter's owner thread may call it, so no read-modify-write instruction is needed
+static inline void incrementCounter(uint64_t* counter, uint64_t value = 1)
+{
+	storeRelaxed(counter, loadRelaxed(counter) + value);
+}
+
+static void idleWait(int idleRounds)
+{
+#if defined(WIN32) || defined(WINx64) || defined(PCAPPP_MINGW_ENV)
+	if (idleRounds < SHARD_IDLE_YIELD_ROUNDS)
+		SwitchToThread();
+	else
+		Sleep(1);
+#else
+	if (idleRounds < SHARD_IDLE_YIELD_ROUNDS)
+	{
+		sched_yield();
+	}
+	else
+	{
+		struct timespec sleepTime;
+		sleepTime.tv_sec = 0;
+		sleepTime.tv_nsec = SHARD_IDLE_SLEEP_USEC * 1000;
+		nanosleep(&sleepTime, NULL);
+	}
+#endif
+}
+
+
+// a packet passed from a producer to a shard
+struct ShardPacket
+{
+	// points to inlineData or, for packets that don't fit in it, to a buffer the shard frees after processing the packet
+	uint8_t* data;
+	bool dataOnHeap;
+	int dataLen;
+	int frameLength;
+	timespec timestamp;
+	LinkLayerType linkType;
+	uint8_t inlineData[PCPP_SHARDED_TCP_REASSEMBLY_SLOT_DATA_SIZE];
+};
+
+// the ring between one producer and one shard, with the counters the producer updates. The counters are accessed with loadRelaxed() and
+// incrementCounter()
+struct ShardRing
+{
+	SpscRing<ShardPacket> ring;
+	uint64_t packetsQueued;
+	uint64_t packetsDropped;
+
+	explicit ShardRing(size_t capacity) : ring(capacity), packetsQueued(0), packetsDropped(0) {}
+};
+
+struct ShardedTcpReassembly::Shard
+{
+	ShardedTcpReassembly* engine;
+	int index;
+	std::vector<ShardRing*> rings;
+	TcpReassembly* reassembly;
+	// updated only by the thread that processes the shard's packets, accessed with loadRelaxed() and incrementCounter()
+	TcpReassemblyShardStats stats;
+
+	// the packet objects are reused for all packets, and the layers are allocated from the arena. The arena is declared first so it's
+	// destructed after the packet
+	LayerArena layerArena;
+	RawPacket rawPacket;
+	Packet packet;
+
+	pthread_t thread;
+	bool threadStarted;
+	long stopRequested;
+
+	// a command is posted by setting command and then incrementing commandSeq. The shard sets completedSeq to commandSeq when it's done
+	ShardCommand command;
+	long commandSeq;
+	long completedSeq;
+
+	Shard(ShardedTcpReassembly* engine, int index, const ShardedTcpReassemblyConfiguration& config) :
+		engine(engine), index(index), reassembly(NULL), rawPacket(NULL, 0, timespec(), false), threadStarted(false), stopRequested(0),
+		command(NoCommand), commandSeq(0), completedSeq(0)
+	{
+		size_t ringCapacity = (config.ringCapacity > 0 ? config.ringCapacity : PCPP_SHARDED_TCP_REASSEMBLY_DEFAULT_RING_CAPACITY);
+		for (size_t i = 0; i < config.numOfProducers; i++)
+			rings.push_back(new ShardRing(ringCapacity));
+
+		reassembly = new TcpReassembly(&ShardedTcpReassembly::onMessageReady, this, &ShardedTcpReassembly::onConnectionStart,
+				&ShardedTcpReassembly::onConnectionEnd, config.reassemblyConfig);
+	}
+
+	~Shard()
+	{
+		// free the buffers of packets that were never processed
+		for (size_t i = 0; i < rings.size(); i++)
+		{
+			ShardPacket* shardPacket;
+			while ((shardPacket = rings[i]->ring.front()) != NULL)
+			{
+				if (shardPacket->dataOnHeap)
+					delete [] shardPacket->data;
+				rings[i]->ring.pop();
+			}
+
+			delete rings[i];
+		}
+
+		delete reassembly;
+	}
+};
+
+
+ShardedTcpReassembly::ShardedTcpReassembly(OnTcpMessageReady onMessageReadyCallback, void* userCookie, OnTcpConnectionStart onConnectionStartCallback,
+		OnTcpConnectionEnd onConnectionEndCallback, const ShardedTcpReassemblyConfiguration& config)
+{
+	m_OnMessageReadyCallback = onMessageReadyCallback;
+	m_UserCookie = userCookie;
+	m_OnConnStart = onConnectionStartCallback;
+	m_OnConnEnd = onConnectionEndCallback;
+	m_NumOfProducers = (config.numOfProducers > 0 ? config.numOfProducers : 1);
+	m_DropWhenFull = config.dropWhenFull;
+	m_UseInnerTuple = config.reassemblyConfig.useInnerTuple;
+	m_Running = 0;
+	m_CommandSeq = 0;
+	pthread_mutex_init(&m_CommandMutex, NULL);
+	pthread_key_create(&m_ShardThreadKey, NULL);
+
+	ShardedTcpReassemblyConfiguration shardConfig = config;
+	shardConfig.numOfProducers = m_NumOfProducers;
+
+	size_t numOfShards = config.numOfShards;
+	if (numOfShards == 0)
+		numOfShards = (size_t)getNumOfCores();
+	if (numOfShards == 0)
+		numOfShards = 1;
+
+	for (size_t i = 0; i < numOfShards; i++)
+		m_Shards.push_back(new Shard(this, (int)i, shardConfig));
+}
+
+ShardedTcpReassembly::~ShardedTcpReassembly()
+{
+	stop();
+
+	for (size_t i = 0; i < m_Shards.size(); i++)
+		delete m_Shards[i];
+
+	pthread_key_delete(m_ShardThreadKey);
+	pthread_mutex_destroy(&m_CommandMutex);
+}
+
+bool ShardedTcpReassembly::isRunning() const
+{
+	return loadAcquire(&m_Running) != 0;
+}
+
+bool ShardedTcpReassembly::isShardThread() const
+{
+	return pthread_getspecific(m_ShardThreadKey) != NULL;
+}
+
+bool ShardedTcpReassembly::start()
+{
+	pthread_mutex_lock(&m_CommandMutex);
+
+	if (isRunning())
+	{
+		pthread_mutex_unlock(&m_CommandMutex);
+		LOG_ERROR("Shards are already running");
+		return false;
+	}
+
+	for (size_t i = 0; i < m_Shards.size(); i++)
+	{
+		Shard* shard = m_Shards[i];
+		shard->stopRequested = 0;
+		shard->completedSeq = shard->commandSeq;
+		int err = pthread_create(&shard->thread, NULL, &ShardedTcpReassembly::shardThreadMain, (void*)shard);
+		if (err != 0)
+		{
+			LOG_ERROR("Cannot create the thread of shard %d: [%s]", (int)i, strerror(err));
+			storeRelease(&m_Running, 1);
+			stopShards();
+			pthread_mutex_unlock(&m_CommandMutex);
+			return false;
+		}
+
+		shard->threadStarted = true;
+	}
+
+	storeRelease(&m_Running, 1);
+	pthread_mutex_unlock(&m_CommandMutex);
+	LOG_DEBUG("Started %d shards", (int)m_Shards.size());
+	return true;
+}
+
+void ShardedTcpReassembly::stop()
+{
+	if (isShardThread())
+	{
+		LOG_ERROR("Cannot stop the shards from a shard's thread");
+		return;
+	}
+
+	pthread_mutex_lock(&m_CommandMutex);
+	stopShards();
+	pthread_mutex_unlock(&m_CommandMutex);
+}
+
+void ShardedTcpReassembly::stopShards()
+{
+	if (!isRunning())
+		return;
+
+	for (size_t i = 0; i < m_Shards.size(); i++)
+		storeRelease(&m_Shards[i]->stopRequested, 1);
+
+	for (size_t i = 0; i < m_Shards.size(); i++)
+	{
+		Shard* shard = m_Shards[i];
+		if (!shard->threadStarted)
+			continue;
+
+		LOG_DEBUG("Stopping the thread of shard %d, waiting for it to join...", (int)i);
+		pthread_join(shard->thread, NULL);
+		shard->threadStarted = false;
+	}
+
+	storeRelease(&m_Running, 0);
+}
+
+int ShardedTcpReassembly::getShardIndex(const RawPacket* rawPacket) const
+{
+	if (m_Shards.size() == 1)
+		return 0;
+
+	FlowKey flowKey;
+	if (m_UseInnerTuple)
+	{
+		TunnelFlowKeys tunnelFlowKeys;
+		FlowKey::extractTunnelFlowKeys(rawPacket, tunnelFlowKeys);
+		flowKey = tunnelFlowKeys.innerFlowKey;
+	}
+	else
+	{
+		flowKey = FlowKey::fromRawPacket(rawPacket);
+	}
+
+	if (!flowKey.isValid())
+		return 0;
+
+	// TcpReassembly identifies connections of packets that aren't carried directly over TCP by ports of an inner header, which isn't
+	// parsed here, so only the addresses are used for them
+	if (flowKey.getProtocol() != PACKETPP_IPPROTO_TCP)
+		flowKey = flowKey.getIPPairKey();
+
+	uint64_t hash = flowKey.hash();
+	return (int)((uint32_t)(hash ^ (hash >> 32)) % (uint32_t)m_Shards.size());
+}
+
+bool ShardedTcpReassembly::reassemblePacket(const RawPacket* tcpRawData, size_t producerIndex)
+{
+	if (!isRunning())
+	{
+		LOG_ERROR("Shards aren't running, call start() first");
+		return false;
+	}
+
+	if (producerIndex >= m_NumOfProducers)
+	{
+		LOG_ERROR("Producer index %d is out of range, the number of producers is %d", (int)producerIndex, (int)m_NumOfProducers);
+		return false;
+	}
+
+	ShardRing* shardRing = m_Shards[getShardIndex(tcpRawData)]->rings[producerIndex];
+
+	ShardPacket* shardPacket = shardRing->ring.reserve();
+	if (shardPacket == NULL)
+	{
+		if (m_DropWhenFull)
+		{
+			incrementCounter(&shardRing->packetsDropped);
+			return false;
+		}
+
+		int idleRounds = 0;
+		while ((shardPacket = shardRing->ring.reserve()) == NULL)
+		{
+			if (loadAcquire(&m_Running) == 0)
+				return false;
+
+			idleWait(idleRounds++);
+		}
+	}
+
+	int dataLen = tcpRawData->getRawDataLen();
+	if (dataLen <= PCPP_SHARDED_TCP_REASSEMBLY_SLOT_DATA_SIZE)
+	{
+		shardPacket->data = shardPacket->inlineData;
+		shardPacket->dataOnHeap = false;
+	}
+	else
+	{
+		shardPacket->data = new uint8_t[dataLen];
+		shardPacket->dataOnHeap = true;
+	}
+
+	memcpy(shardPacket->data, tcpRawData->getRawData(), dataLen);
+	shardPacket->dataLen = dataLen;
+	shardPacket->frameLength = tcpRawData->getFrameLength();
+	shardPacket->timestamp = tcpRawData->getPacketTimeStamp();
+	shardPacket->linkType = tcpRawData->getLinkLayerType();
+
+	shardRing->ring.commit();
+	incrementCounter(&shardRing->packetsQueued);
+	return true;
+}
+
+bool ShardedTcpReassembly::flush()
+{
+	return runCommand(FlushCommand);
+}
+
+bool ShardedTcpReassembly::closeAllConnections()
+{
+	return runCommand(CloseAllConnectionsCommand);
+}
+
+bool ShardedTcpReassembly::runCommand(ShardCommand command)
+{
+	// the command waits for all shards, so a shard's thread would wait for itself
+	if (isShardThread())
+	{
+		LOG_ERROR("Cannot run a command on the shards from a shard's thread");
+		return false;
+	}
+
+	pthread_mutex_lock(&m_CommandMutex);
+
+	if (!isRunning())
+	{
+		// there are no shard threads, so the calling thread can take their place
+		for (size_t i = 0; i < m_Shards.size(); i++)
+			executeShardCommand(m_Shards[i], command);
+
+		pthread_mutex_unlock(&m_CommandMutex);
+		return true;
+	}
+
+	long seq = ++m_CommandSeq;
+	for (size_t i = 0; i < m_Shards.size(); i++)
+	{
+		m_Shards[i]->command = command;
+		storeRelease(&m_Shards[i]->commandSeq, seq);
+	}
+
+	int idleRounds = 0;
+	for (size_t i = 0; i < m_Shards.size(); i++)
+	{
+		while (loadAcquire(&m_Shards[i]->completedSeq) != seq)
+			idleWait(idleRounds++);
+	}
+
+	pthread_mutex_unlock(&m_CommandMutex);
+	return true;
+}
+
+void ShardedTcpReassembly::getShardStats(int shardIndex, TcpReassemblyShardStats& stats) const
+{
+	stats.clear();
+	if (shardIndex < 0 || shardIndex >= (int)m_Shards.size())
+		return;
+
+	const Shard* shard = m_Shards[shardIndex];
+	stats.packetsProcessed = loadRelaxed(&shard->stats.packetsProcessed);
+	stats.tcpMessagesHandled = loadRelaxed(&shard->stats.tcpMessagesHandled);
+	stats.outOfOrderPackets = loadRelaxed(&shard->stats.outOfOrderPackets);
+	stats.nonTcpPackets = loadRelaxed(&shard->stats.nonTcpPackets);
+	stats.ignoredPackets = loadRelaxed(&shard->stats.ignoredPackets);
+	stats.messagesDelivered = loadRelaxed(&shard->stats.messagesDelivered);
+	stats.bytesDelivered = loadRelaxed(&shard->stats.bytesDelivered);
+	stats.connectionsStarted = loadRelaxed(&shard->stats.connectionsStarted);
+	stats.connectionsEnded = loadRelaxed(&shard->stats.connectionsEnded);
+	for (size_t i = 0; i < shard->rings.size(); i++)
+	{
+		stats.packetsQueued += loadRelaxed(&shard->rings[i]->packetsQueued);
+		stats.packetsDropped += loadRelaxed(&shard->rings[i]->packetsDropped);
+	}
+}
+
+void ShardedTcpReassembly::getTotalStats(TcpReassemblyShardStats& stats) const
+{
+	stats.clear();
+	for (int i = 0; i < (int)m_Shards.size(); i++)
+	{
+		TcpReassemblyShardStats shardStats;
+		getShardStats(i, shardStats);
+		stats.add(shardStats);
+	}
+}
+
+void* ShardedTcpReassembly::shardThreadMain(void* shardPtr)
+{
+	Shard* shard = (Shard*)shardPtr;
+	pthread_setspecific(shard->engine->m_ShardThreadKey, shard);
+	LOG_DEBUG("Shard %d thread started", shard->index);
+
+	int idleRounds = 0;
+	while (true)
+	{
+		size_t numOfPackets = processShardPackets(shard, SHARD_RING_BURST_SIZE);
+
+		long commandSeq = loadAcquire(&shard->commandSeq);
+		if (commandSeq != shard->completedSeq)
+		{
+			executeShardCommand(shard, shard->command);
+			storeRelease(&shard->completedSeq, commandSeq);
+			idleRounds = 0;
+			continue;
+		}
+
+		if (loadAcquire(&shard->stopRequested) != 0)
+		{
+			// process the packets that were queued before stopping
+			while (processShardPackets(shard, SHARD_RING_BURST_SIZE) > 0) {}
+			break;
+		}
+
+		if (numOfPackets > 0)
+			idleRounds = 0;
+		else
+			idleWait(idleRounds++);
+	}
+
+	LOG_DEBUG("Shard %d thread stopped", shard->index);
+	return NULL;
+}
+
+size_t ShardedTcpReassembly::processShardPackets(Shard* shard, size_t maxPacketsPerRing)
+{
+	size_t numOfPackets = 0;
+
+	for (size_t i = 0; i < shard->rings.size(); i++)
+	{
+		SpscRing<ShardPacket>& ring = shard->rings[i]->ring;
+		for (size_t j = 0; j < maxPacketsPerRing; j++)
+		{
+			ShardPacket* shardPacket = ring.front();
+			if (shardPacket == NULL)
+				break;
+
+			shard->rawPacket.setRawData(shardPacket->data, shardPacket->dataLen, shardPacket->timestamp, shardPacket->linkType, shardPacket->frameLength);
+			shard->packet.setRawPacket(&shard->rawPacket, false, UnknownProtocol, OsiModelLayerUnknown, &shard->layerArena);
+
+			TcpReassembly::ReassemblyStatus status = shard->reassembly->reassemblePacket(shard->packet);
+			incrementCounter(&shard->stats.packetsProcessed);
+			switch (status)
+			{
+			case TcpReassembly::TcpMessageHandled:
+				incrementCounter(&shard->stats.tcpMessagesHandled);
+				break;
+			case TcpReassembly::OutOfOrderTcpMessageBuffered:
+				incrementCounter(&shard->stats.outOfOrderPackets);
+				break;
+			case TcpReassembly::NonIpPacket:
+			case TcpReassembly::NonTcpPacket:
+				incrementCounter(&shard->stats.nonTcpPackets);
+				break;
+			default:
+				incrementCounter(&shard->stats.ignoredPackets);
+				break;
+			}
+
+			if (shardPacket->dataOnHeap)
+				delete [] shardPacket->data;
+
+			ring.pop();
+			numOfPackets++;
+		}
+	}
+
+	return numOfPackets;
+}
+
+void ShardedTcpReassembly::executeShardCommand(Shard* shard, ShardCommand command)
+{
+	// all packets that were queued before the command was posted are visible at this point, so process them first
+	while (processShardPackets(shard, SHARD_RING_BURST_SIZE) > 0) {}
+
+	if (command == CloseAllConnectionsCommand)
+	{
+		LOG_DEBUG("Closing all connections of shard %d", shard->index);
+		shard->reassembly->closeAllConnections();
+	}
+}
+
+void ShardedTcpReassembly::onMessageReady(int side, const TcpStreamData& tcpData, void* shardPtr)
+{
+	Shard* shard = (Shard*)shardPtr;
+	incrementCounter(&shard->stats.messagesDelivered);
+	incrementCounter(&shard->stats.bytesDelivered, tcpData.getDataLength());
+
+	ShardedTcpReassembly* engine = shard->engine;
+	if (engine->m_OnMessageReadyCallback != NULL)
+		engine->m_OnMessageReadyCallback(side, tcpData, shard->index, engine->m_UserCookie);
+}
+
+void ShardedTcpReassembly::onConnectionStart(const ConnectionData& connectionData, void* shardPtr)
+{
+	Shard* shard = (Shard*)shardPtr;
+	incrementCounter(&shard->stats.connectionsStarted);
+
+	ShardedTcpReassembly* engine = shard->engine;
+	if (engine->m_OnConnStart != NULL)
+		engine->m_OnConnStart(connectionData, shard->index, engine->m_UserCookie);
+}
+
+void ShardedTcpReassembly::onConnectionEnd(const ConnectionData& connectionData, TcpReassembly::ConnectionEndReason reason, void* shardPtr)
+{
+	Shard* shard = (Shard*)shardPtr;
+	incrementCounter(&shard->stats.connectionsEnded);
+
+	ShardedTcpReassembly* engine = shard->engine;
+	if (engine->m_OnConnEnd != NULL)
+		engine->m_OnConnEnd(connectionData, reason, shard->index, engine->m_UserCookie);
+}
+
+} // namespace pcpp
@@ -35,6 +35,7 @@ PTF_TEST_CASE(TcpPacketWithOptionsParsing2);
 PTF_TEST_CASE(TcpMalformedPacketParsing);
 PTF_TEST_CASE(TcpPacketCreation);
 PTF_TEST_CASE(TcpPacketCreation2);
+PTF_TEST_CASE(TcpStandardOptionsTest);
 
 // Implemented in PacketTests.cpp
 PTF_TEST_CASE(InsertDataToPacket);
@@ -46,6 +47,24 @@ PTF_TEST_CASE(RawPacketTimeStampSetterTest);
 PTF_TEST_CASE(ParsePartialPacketTest);
 PTF_TEST_CASE(PacketTrailerTest);
 PTF_TEST_CASE(ResizeLayerTest);
+PTF_TEST_CASE(LayerArenaTest);
+PTF_TEST_CASE(LazyParsingTest);
+PTF_TEST_CASE(PacketViewTest);
+PTF_TEST_CASE(PacketBurstParsingTest);
+PTF_TEST_CASE(LayerRecyclingTest);
+PTF_TEST_CASE(FlowKeyTest);
+PTF_TEST_CASE(TunnelFlowKeysTest);
+PTF_TEST_CASE(FlowTableTest);
+PTF_TEST_CASE(StackParserTest);
+PTF_TEST_CASE(ToeplitzHashTest);
+PTF_TEST_CASE(ChecksumImplementationTest);
+PTF_TEST_CASE(IncrementalChecksumTest);
+PTF_TEST_CASE(ModifiedLayersTest);
+PTF_TEST_CASE(PacketHeadroomTest);
+PTF_TEST_CASE(MovePacketTest);
+PTF_TEST_CASE(CopyOnWritePacketTest);
+PTF_TEST_CASE(CopyOnWriteSettersTest);
+PTF_TEST_CASE(NextLayerRegistryTest);
 
 // Implemented in HttpTests.cpp
 PTF_TEST_CASE(HttpRequestLayerParsingTest);
@@ -54,6 +73,7 @@ PTF_TEST_CASE(HttpRequestLayerEditTest);
 PTF_TEST_CASE(HttpResponseLayerParsingTest);
 PTF_TEST_CASE(HttpResponseLayerCreationTest);
 PTF_TEST_CASE(HttpResponseLayerEditTest);
+PTF_TEST_CASE(TextBasedProtocolFieldIndexTest);
 
 // Implemented in PPPoETests.cpp
 PTF_TEST_CASE(PPPoESessionLayerParsingTest);
@@ -67,6 +87,7 @@ PTF_TEST_CASE(DnsLayerQueryCreationTest);
 PTF_TEST_CASE(DnsLayerResourceCreationTest);
 PTF_TEST_CASE(DnsLayerEditTest);
 PTF_TEST_CASE(DnsLayerRemoveResourceTest);
+PTF_TEST_CASE(DnsLayerZeroCopyParsingTest);
 
 // Implemented in IcmpTests.cpp
 PTF_TEST_CASE(IcmpParsingTest);
@@ -98,6 +119,7 @@ PTF_TEST_CASE(SSLMultipleRecordParsing3Test);
 PTF_TEST_CASE(SSLMultipleRecordParsing4Test);
 PTF_TEST_CASE(SSLPartialCertificateParseTest);
 PTF_TEST_CASE(SSLNewSessionTicketParseTest);
+PTF_TEST_CASE(SSLFingerprintTest);
 
 // Implemented in IgmpTests.cpp
 PTF_TEST_CASE(IgmpParsingTest);
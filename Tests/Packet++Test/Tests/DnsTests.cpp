@@ -629,3 +629,99 @@ PTF_TEST_CASE(DnsLayerRemoveResourceTest)
 	PTF_ASSERT_FALSE(dnsLayer4->removeAdditionalRecord("blabla", false));
 	PTF_ASSERT_EQUAL(dnsLayer4->getHeaderLen(), sizeof(pcpp::dnshdr), size);
 } // DnsLayerRemoveResourceTest
+
+
+
+PTF_TEST_CASE(DnsLayerZeroCopyParsingTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/Dns3.dat");
+
+	pcpp::Packet dnsPacket(&rawPacket1);
+
+	pcpp::DnsLayer* dnsLayer = dnsPacket.getLayerOfType<pcpp::DnsLayer>();
+	PTF_ASSERT_NOT_NULL(dnsLayer);
+
+	char name[PCPP_DNS_NAME_BUFFER_SIZE];
+	size_t nameLen = 0;
+	pcpp::DnsResourceInfo info;
+
+	// read the records before any resource object was created
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsQueryType, 0, info));
+	PTF_ASSERT_EQUAL(info.offsetInLayer, sizeof(pcpp::dnshdr), size);
+	PTF_ASSERT_EQUAL(info.dnsType, pcpp::DNS_TYPE_ALL, enum);
+	PTF_ASSERT_EQUAL(info.dnsClass, pcpp::DNS_CLASS_IN, enum);
+	PTF_ASSERT_NULL(info.data);
+	PTF_ASSERT_EQUAL(info.dataLength, 0, size);
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name), &nameLen));
+	PTF_ASSERT_EQUAL(std::string(name), "Yaels-iPhone.local", string);
+	PTF_ASSERT_EQUAL(nameLen, 18, size);
+
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsQueryType, 1, info));
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name)));
+	PTF_ASSERT_EQUAL(std::string(name), "Yaels-iPhone.local", string);
+	PTF_ASSERT_FALSE(dnsLayer->getResourceInfo(pcpp::DnsQueryType, 2, info));
+	PTF_ASSERT_FALSE(dnsLayer->getResourceInfo(pcpp::DnsAnswerType, 0, info));
+
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsAuthorityType, 0, info));
+	PTF_ASSERT_EQUAL(info.dnsType, pcpp::DNS_TYPE_A, enum);
+	PTF_ASSERT_EQUAL(info.dnsClass, pcpp::DNS_CLASS_IN, enum);
+	PTF_ASSERT_EQUAL(info.ttl, 120, u32);
+	PTF_ASSERT_EQUAL(info.dataLength, 4, size);
+	PTF_ASSERT_NOT_NULL(info.data);
+	uint32_t authorityAddr;
+	memcpy(&authorityAddr, info.data, sizeof(authorityAddr));
+	PTF_ASSERT_EQUAL(pcpp::IPv4Address(authorityAddr), pcpp::IPv4Address(std::string("10.0.0.2")), object);
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name)));
+	PTF_ASSERT_EQUAL(std::string(name), "Yaels-iPhone.local", string);
+
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsAuthorityType, 1, info));
+	PTF_ASSERT_EQUAL(info.dnsType, pcpp::DNS_TYPE_AAAA, enum);
+	PTF_ASSERT_EQUAL(info.dataLength, 16, size);
+	PTF_ASSERT_FALSE(dnsLayer->getResourceInfo(pcpp::DnsAuthorityType, 2, info));
+
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsAdditionalType, 0, info));
+	PTF_ASSERT_EQUAL(info.dnsType, pcpp::DNS_TYPE_OPT, enum);
+	PTF_ASSERT_EQUAL(info.dnsClass, 0x05a0, u16);
+	PTF_ASSERT_EQUAL(info.ttl, 0x1194, u32);
+	PTF_ASSERT_EQUAL(info.dataLength, 12, size);
+	PTF_ASSERT_EQUAL(info.offsetInLayer + info.nameLength + 10 + info.dataLength, dnsLayer->getHeaderLen(), size);
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name), &nameLen));
+	PTF_ASSERT_EQUAL(std::string(name), "", string);
+	PTF_ASSERT_EQUAL(nameLen, 0, size);
+
+	// a buffer too small for the name holds only the labels that fit
+	char shortName[14];
+	PTF_ASSERT_FALSE(dnsLayer->decodeName(sizeof(pcpp::dnshdr), shortName, sizeof(shortName)));
+	PTF_ASSERT_EQUAL(std::string(shortName), "Yaels-iPhone", string);
+	PTF_ASSERT_FALSE(dnsLayer->decodeName(dnsLayer->getHeaderLen(), name, sizeof(name)));
+
+	// the names decoded by the resource objects are the same
+	PTF_ASSERT_EQUAL(dnsLayer->getFirstAuthority()->getName(), "Yaels-iPhone.local", string);
+
+	// the index is updated after the layer is edited
+	pcpp::IPv4DnsResourceData ipv4DnsData(std::string("1.2.3.4"));
+	PTF_ASSERT_NOT_NULL(dnsLayer->addAnswer("www.example.com", pcpp::DNS_TYPE_A, pcpp::DNS_CLASS_IN, 30, &ipv4DnsData));
+	PTF_ASSERT_TRUE(dnsLayer->removeQuery(dnsLayer->getNextQuery(dnsLayer->getFirstQuery())));
+
+	PTF_ASSERT_FALSE(dnsLayer->getResourceInfo(pcpp::DnsQueryType, 1, info));
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsAnswerType, 0, info));
+	PTF_ASSERT_EQUAL(info.ttl, 30, u32);
+	PTF_ASSERT_EQUAL(info.dataLength, 4, size);
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name)));
+	PTF_ASSERT_EQUAL(std::string(name), "www.example.com", string);
+	PTF_ASSERT_TRUE(dnsLayer->getResourceInfo(pcpp::DnsAuthorityType, 1, info));
+	PTF_ASSERT_EQUAL(info.dnsType, pcpp::DNS_TYPE_AAAA, enum);
+	PTF_ASSERT_TRUE(dnsLayer->decodeName(info.offsetInLayer, name, sizeof(name)));
+	PTF_ASSERT_EQUAL(std::string(name), "Yaels-iPhone.local", string);
+
+	// a copied layer parses its records lazily as well
+	pcpp::DnsLayer copiedLayer(*dnsLayer);
+	PTF_ASSERT_TRUE(copiedLayer.getResourceInfo(pcpp::DnsAnswerType, 0, info));
+	PTF_ASSERT_TRUE(copiedLayer.decodeName(info.offsetInLayer, name, sizeof(name)));
+	PTF_ASSERT_EQUAL(std::string(name), "www.example.com", string);
+	PTF_ASSERT_EQUAL(copiedLayer.getFirstAnswer()->getName(), "www.example.com", string);
+	PTF_ASSERT_EQUAL(copiedLayer.getQueryCount(), 1, size);
+} // DnsLayerZeroCopyParsingTest
@@ -7,6 +7,7 @@
 #include "IPv4Layer.h"
 #include "TcpLayer.h"
 #include "HttpLayer.h"
+#include "SipLayer.h"
 #include "PayloadLayer.h"
 #include "SystemUtils.h"
 
@@ -298,3 +299,70 @@ PTF_TEST_CASE(HttpResponseLayerEditTest)
 	expectedHttpResponse = "HTTP/1.1 413 This is a test\r\nContent-Length: 345\r\n";
 	PTF_ASSERT_BUF_COMPARE(expectedHttpResponse.c_str(), responseLayer->getData(), expectedHttpResponse.length());
 } // HttpResponseLayerEditTest
+
+
+
+PTF_TEST_CASE(TextBasedProtocolFieldIndexTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+
+	pcpp::Packet httpPacket(&rawPacket1);
+	pcpp::HttpRequestLayer* requestLayer = httpPacket.getLayerOfType<pcpp::HttpRequestLayer>();
+	PTF_ASSERT_NOT_NULL(requestLayer);
+
+	// zero-copy access to the field name and value
+	pcpp::HeaderField* hostField = requestLayer->getFieldByName(pcpp::HttpFieldNames::Host);
+	PTF_ASSERT_NOT_NULL(hostField);
+	PTF_ASSERT_EQUAL(std::string(hostField->getFieldNamePtr(), hostField->getFieldNameLen()), "Host", string);
+	PTF_ASSERT_EQUAL(std::string(hostField->getFieldValuePtr(), hostField->getFieldValueLen()), "www.ynet.co.il", string);
+	PTF_ASSERT_TRUE(hostField->getFieldValuePtr() >= (const char*)requestLayer->getData());
+	PTF_ASSERT_TRUE(hostField->getFieldValuePtr() < (const char*)requestLayer->getData() + requestLayer->getDataLen());
+
+	// lookups are case insensitive
+	PTF_ASSERT_TRUE(requestLayer->getFieldByName(pcpp::HeaderFieldName("hOsT")) == hostField);
+	PTF_ASSERT_TRUE(requestLayer->getFieldByName("HOST") == hostField);
+	PTF_ASSERT_TRUE(requestLayer->getFieldByName(pcpp::HeaderFieldName("Hos", 3)) == NULL);
+	PTF_ASSERT_EQUAL(pcpp::HeaderFieldName::calculateHash("Content-Length", 14), pcpp::HeaderFieldName::calculateHash("content-LENGTH", 14), u32);
+	PTF_ASSERT_TRUE(pcpp::HttpFieldNames::ContentLength.equals("CONTENT-LENGTH", 14));
+	PTF_ASSERT_FALSE(pcpp::HttpFieldNames::ContentLength.equals("Content-Lengt", 13));
+
+	// the end-of-header field has no name and no value
+	pcpp::HeaderField* endOfHeader = requestLayer->getFieldByName(PCPP_END_OF_TEXT_BASED_PROTOCOL_HEADER);
+	PTF_ASSERT_NOT_NULL(endOfHeader);
+	PTF_ASSERT_TRUE(endOfHeader->isEndOfHeader());
+	PTF_ASSERT_EQUAL(endOfHeader->getFieldNameLen(), 0, size);
+	PTF_ASSERT_EQUAL(endOfHeader->getFieldValueLen(), 0, size);
+
+	// the index is kept up to date when fields are added and removed
+	PTF_ASSERT_TRUE(requestLayer->removeField("host"));
+	PTF_ASSERT_TRUE(requestLayer->getFieldByName(pcpp::HttpFieldNames::Host) == NULL);
+	pcpp::HeaderField* newHostField = requestLayer->insertField(NULL, PCPP_HTTP_HOST_FIELD, "www.example.com");
+	PTF_ASSERT_NOT_NULL(newHostField);
+	PTF_ASSERT_TRUE(requestLayer->getFieldByName(pcpp::HttpFieldNames::Host) == newHostField);
+	PTF_ASSERT_EQUAL(requestLayer->getUrl(), "www.example.com/home/0,7340,L-8,00.html", string);
+
+	// a copy of the message has its own index
+	pcpp::HttpRequestLayer requestLayerCopy(*requestLayer);
+	pcpp::HeaderField* copiedHostField = requestLayerCopy.getFieldByName("host");
+	PTF_ASSERT_NOT_NULL(copiedHostField);
+	PTF_ASSERT_TRUE(copiedHostField != newHostField);
+	PTF_ASSERT_EQUAL(copiedHostField->getFieldValue(), "www.example.com", string);
+
+	// fields with the same name are returned in the order they were added to the message
+	pcpp::SipRequestLayer sipRequest(pcpp::SipRequestLayer::SipINVITE, "sip:alice@example.com");
+	PTF_ASSERT_NOT_NULL(sipRequest.addField(PCPP_SIP_CALL_ID_FIELD, "12345"));
+	pcpp::HeaderField* secondVia = sipRequest.addField(PCPP_SIP_VIA_FIELD, "SIP/2.0/UDP second");
+	PTF_ASSERT_NOT_NULL(secondVia);
+	pcpp::HeaderField* firstVia = sipRequest.insertField(NULL, PCPP_SIP_VIA_FIELD, "SIP/2.0/UDP first");
+	PTF_ASSERT_NOT_NULL(firstVia);
+	PTF_ASSERT_TRUE(sipRequest.getFieldByName(pcpp::SipFieldNames::Via) == secondVia);
+	PTF_ASSERT_TRUE(sipRequest.getFieldByName(pcpp::SipFieldNames::Via, 1) == firstVia);
+	PTF_ASSERT_TRUE(sipRequest.getFieldByName(pcpp::SipFieldNames::Via, 2) == NULL);
+	PTF_ASSERT_EQUAL(sipRequest.getFieldByName(pcpp::SipFieldNames::CallID)->getFieldValue(), "12345", string);
+	PTF_ASSERT_TRUE(sipRequest.removeField("via", 0));
+	PTF_ASSERT_TRUE(sipRequest.getFieldByName(pcpp::SipFieldNames::Via) == firstVia);
+	PTF_ASSERT_EQUAL(std::string(firstVia->getFieldValuePtr(), firstVia->getFieldValueLen()), "SIP/2.0/UDP first", string);
+} // TextBasedProtocolFieldIndexTest
@@ -7,6 +7,7 @@
 #include "IPv4Layer.h"
 #include "IPv6Layer.h"
 #include "PPPoELayer.h"
+#include "MplsLayer.h"
 #include "VlanLayer.h"
 #include "IcmpLayer.h"
 #include "TcpLayer.h"
@@ -18,6 +19,13 @@
 #include "RadiusLayer.h"
 #include "PacketTrailerLayer.h"
 #include "PayloadLayer.h"
+#include "NextLayerRegistry.h"
+#include "PacketView.h"
+#include "FlowKey.h"
+#include "FlowTable.h"
+#include "PacketUtils.h"
+#include "StackParser.h"
+#include "IpUtils.h"
 #include "SystemUtils.h"
 
 PTF_TEST_CASE(InsertDataToPacket)
@@ -915,4 +923,1664 @@ PTF_TEST_CASE(ResizeLayerTest)
 	PTF_ASSERT_EQUAL(rawData2[5], 0xAD, u8);
 	PTF_ASSERT_EQUAL(rawData2[6], 0xBE, u8);
 	PTF_ASSERT_EQUAL(rawData2[7], 0xEF, u8);
-} // ResizeLayerTest
\ No newline at end of file
+} // ResizeLayerTest
+
+
+PTF_TEST_CASE(LayerArenaTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Dns3.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/radius_1.dat");
+
+	pcpp::LayerArena arena(1024);
+	PTF_ASSERT_EQUAL(arena.getSlabSize(), 1024, size);
+	PTF_ASSERT_EQUAL(arena.getNumOfSlabs(), 1, size);
+
+	// parse a packet with an arena and make sure all layers were allocated from it
+	{
+		pcpp::Packet tcpPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+		PTF_ASSERT_TRUE(tcpPacket.getLayerArena() == &arena);
+		PTF_ASSERT_TRUE(tcpPacket.isPacketOfType(pcpp::TCP));
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 4, size);
+		pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+		PTF_ASSERT_NOT_NULL(tcpLayer);
+		PTF_ASSERT_EQUAL(tcpLayer->getTcpOptionCount(), 3, size);
+
+		// re-parse the same packet object, the layers of the previous packet should be freed first
+		tcpPacket.setRawPacket(&rawPacket2, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 4, size);
+		pcpp::DnsLayer* dnsLayer = tcpPacket.getLayerOfType<pcpp::DnsLayer>();
+		PTF_ASSERT_NOT_NULL(dnsLayer);
+		PTF_ASSERT_EQUAL(dnsLayer->getQueryCount(), 2, size);
+
+		// the arena can be shared by several packets
+		pcpp::Packet radiusPacket(&rawPacket3, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 8, size);
+		PTF_ASSERT_NOT_NULL(radiusPacket.getLayerOfType<pcpp::RadiusLayer>());
+
+		// can't reset the arena while layers are still alive
+		pcpp::LoggerPP::getInstance().supressErrors();
+		PTF_ASSERT_FALSE(arena.reset());
+		pcpp::LoggerPP::getInstance().enableErrors();
+
+		// a detached layer is kept alive in the arena until it's deleted
+		pcpp::Layer* detachedLayer = radiusPacket.detachLayer(pcpp::Radius);
+		PTF_ASSERT_NOT_NULL(detachedLayer);
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 8, size);
+		delete detachedLayer;
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 7, size);
+	}
+
+	// all layers were freed, so the arena was rewound and no new slabs are needed for the next packets
+	PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 0, size);
+	size_t numOfSlabs = arena.getNumOfSlabs();
+	for (int i = 0; i < 10; i++)
+	{
+		pcpp::Packet packet(&rawPacket2, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+		PTF_ASSERT_NOT_NULL(packet.getLayerOfType<pcpp::DnsLayer>());
+	}
+	PTF_ASSERT_EQUAL(arena.getNumOfSlabs(), numOfSlabs, size);
+	PTF_ASSERT_EQUAL(arena.getTotalNumOfAllocations(), 52, u64);
+
+	// a copied packet doesn't use the arena
+	{
+		pcpp::Packet tcpPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+		pcpp::Packet tcpPacketCopy(tcpPacket);
+		PTF_ASSERT_NULL(tcpPacketCopy.getLayerArena());
+		PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 4, size);
+		PTF_ASSERT_NOT_NULL(tcpPacketCopy.getLayerOfType<pcpp::TcpLayer>());
+	}
+
+	PTF_ASSERT_TRUE(arena.reset());
+} // LayerArenaTest
+
+
+PTF_TEST_CASE(LazyParsingTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/packet_trailer_ipv4.dat");
+
+	// only the first layer is parsed upfront
+	pcpp::Packet httpPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, NULL, true);
+	PTF_ASSERT_TRUE(httpPacket.isLazyParsing());
+	PTF_ASSERT_NOT_NULL(httpPacket.getFirstLayer());
+	PTF_ASSERT_EQUAL(httpPacket.getFirstLayer()->getProtocol(), pcpp::Ethernet, u64);
+
+	// asking for a protocol parses layers only until it's found
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::IPv4));
+	pcpp::IPv4Layer* ipLayer = httpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_FALSE(httpPacket.isPacketOfType(pcpp::IPv6));
+	PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::TCP));
+	PTF_ASSERT_TRUE(ipLayer->getNextLayer() == httpPacket.getLayerOfType<pcpp::TcpLayer>());
+
+	// the last layer is available after all layers are parsed
+	PTF_ASSERT_NOT_NULL(httpPacket.getLayerOfType<pcpp::HttpRequestLayer>());
+	PTF_ASSERT_EQUAL(httpPacket.getLastLayer()->getProtocol(), pcpp::HTTPRequest, u64);
+	PTF_ASSERT_NULL(httpPacket.getLastLayer()->getNextLayer());
+
+	// lazy parsing yields exactly the same layers as eager parsing, including the packet trailer
+	pcpp::Packet lazyTrailerPacket(&rawPacket2, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, NULL, true);
+	pcpp::Packet eagerTrailerPacket(&rawPacket2);
+	PTF_ASSERT_FALSE(eagerTrailerPacket.isLazyParsing());
+	PTF_ASSERT_TRUE(lazyTrailerPacket.isPacketOfType(pcpp::PacketTrailer));
+	pcpp::Layer* lazyLayer = lazyTrailerPacket.getFirstLayer();
+	pcpp::Layer* eagerLayer = eagerTrailerPacket.getFirstLayer();
+	while (eagerLayer != NULL)
+	{
+		PTF_ASSERT_NOT_NULL(lazyLayer);
+		PTF_ASSERT_EQUAL(lazyLayer->getProtocol(), eagerLayer->getProtocol(), u64);
+		PTF_ASSERT_EQUAL(lazyLayer->getDataLen(), eagerLayer->getDataLen(), size);
+		lazyLayer = lazyLayer->getNextLayer();
+		eagerLayer = eagerLayer->getNextLayer();
+	}
+	PTF_ASSERT_NULL(lazyLayer);
+	PTF_ASSERT_TRUE(lazyTrailerPacket.toString() == eagerTrailerPacket.toString());
+
+	// parse limits are respected in lazy mode
+	pcpp::Packet limitedPacket(&rawPacket1, false, pcpp::TCP, pcpp::OsiModelLayerUnknown, NULL, true);
+	PTF_ASSERT_FALSE(limitedPacket.isPacketOfType(pcpp::HTTP));
+	PTF_ASSERT_EQUAL(limitedPacket.getLastLayer()->getProtocol(), pcpp::TCP, u64);
+	limitedPacket.setRawPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelTransportLayer, NULL, true);
+	PTF_ASSERT_FALSE(limitedPacket.isPacketOfType(pcpp::HTTP));
+	PTF_ASSERT_EQUAL(limitedPacket.getLastLayer()->getProtocol(), pcpp::TCP, u64);
+
+	// modifying a lazily parsed packet parses all of its layers first
+	pcpp::Packet editedPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, NULL, true);
+	pcpp::PayloadLayer newPayload((uint8_t*)"abcd", 4, false);
+	PTF_ASSERT_TRUE(editedPacket.addLayer(&newPayload));
+	PTF_ASSERT_TRUE(editedPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_TRUE(editedPacket.getLastLayer() == &newPayload);
+	PTF_ASSERT_TRUE(editedPacket.getLayerOfType<pcpp::HttpRequestLayer>()->getNextLayer() == &newPayload);
+	PTF_ASSERT_TRUE(editedPacket.detachLayer(&newPayload));
+} // LazyParsingTest
+
+PTF_TEST_CASE(PacketViewTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	// the view should find exactly the same L2-L4 headers as Packet does
+	const char* fileNames[] = {
+		"PacketExamples/TcpPacketWithOptions.dat",
+		"PacketExamples/TwoHttpRequests1.dat",
+		"PacketExamples/Dns3.dat",
+		"PacketExamples/IPv6UdpPacket.dat",
+		"PacketExamples/MplsPackets1.dat",
+		"PacketExamples/MplsPackets2.dat",
+		"PacketExamples/ArpRequestWithVlan.dat",
+		"PacketExamples/IPv4Frag2.dat",
+		"PacketExamples/IPv6Frag2.dat",
+		"PacketExamples/ipv6_options_ah.dat",
+		"PacketExamples/ipv6_options_multi.dat",
+		"PacketExamples/IcmpEchoRequest.dat",
+		"PacketExamples/packet_trailer_ipv4.dat",
+		"PacketExamples/EthDot3.dat"
+	};
+
+	const pcpp::ProtocolType viewProtocols = pcpp::Ethernet | pcpp::EthernetDot3 | pcpp::VLAN | pcpp::MPLS | pcpp::ARP |
+			pcpp::IPv4 | pcpp::IPv6 | pcpp::TCP | pcpp::UDP | pcpp::ICMP;
+
+	for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); i++)
+	{
+		int bufferLength = 0;
+		uint8_t* buffer = pcpp_tests::readFileIntoBuffer(fileNames[i], bufferLength);
+		PTF_ASSERT_NOT_NULL(buffer);
+		pcpp::RawPacket rawPacket((const uint8_t*)buffer, bufferLength, time, true);
+		pcpp::Packet packet(&rawPacket);
+		pcpp::PacketView view(&rawPacket);
+
+		PTF_ASSERT_TRUE(view.getData() == rawPacket.getRawData());
+		pcpp::ProtocolType packetProtocols = pcpp::UnknownProtocol;
+		for (pcpp::Layer* curLayer = packet.getFirstLayer(); curLayer != NULL; curLayer = curLayer->getNextLayer())
+			packetProtocols |= curLayer->getProtocol();
+		PTF_ASSERT_EQUAL(view.getProtocolTypes(), (packetProtocols & viewProtocols), u64);
+
+		pcpp::Layer* ipLayer = packet.getLayerOfType<pcpp::IPv4Layer>();
+		if (ipLayer == NULL)
+			ipLayer = packet.getLayerOfType<pcpp::IPv6Layer>();
+		if (ipLayer != NULL)
+		{
+			PTF_ASSERT_EQUAL(view.getL3Offset(), ipLayer->getData() - rawPacket.getRawData(), int);
+			PTF_ASSERT_EQUAL(view.getIPDatagramLen(), ipLayer->getDataLen(), size);
+		}
+		else
+		{
+			PTF_ASSERT_EQUAL(view.getL3Offset(), PCPP_PACKET_VIEW_NO_OFFSET, u16);
+		}
+
+		pcpp::Layer* l4Layer = packet.getLayerOfType<pcpp::TcpLayer>();
+		if (l4Layer == NULL)
+			l4Layer = packet.getLayerOfType<pcpp::UdpLayer>();
+		if (l4Layer != NULL)
+		{
+			PTF_ASSERT_EQUAL(view.getL4Offset(), l4Layer->getData() - rawPacket.getRawData(), int);
+			PTF_ASSERT_EQUAL(view.getL7Offset(), l4Layer->getLayerPayload() - rawPacket.getRawData(), int);
+			PTF_ASSERT_EQUAL(view.getPayloadLen(), l4Layer->getLayerPayloadSize(), size);
+		}
+		else
+		{
+			PTF_ASSERT_EQUAL(view.getL7Offset(), PCPP_PACKET_VIEW_NO_OFFSET, u16);
+			PTF_ASSERT_NULL(view.getPayload());
+		}
+
+		// the transport layer of fragments isn't parsed
+		PTF_ASSERT_TRUE(view.isFragment() == (strstr(fileNames[i], "Frag") != NULL));
+		if (view.isFragment())
+		{
+			PTF_ASSERT_EQUAL(view.getL4Offset(), PCPP_PACKET_VIEW_NO_OFFSET, u16);
+		}
+	}
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Dns3.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/MplsPackets1.dat");
+
+	// typed accessors point to the same headers the layers point to
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::PacketView tcpView(&rawPacket1);
+	PTF_ASSERT_TRUE(tcpView.getEthHeader() == tcpPacket.getLayerOfType<pcpp::EthLayer>()->getEthHeader());
+	PTF_ASSERT_TRUE(tcpView.getIPv4Header() == tcpPacket.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header());
+	PTF_ASSERT_TRUE(tcpView.getTcpHeader() == tcpPacket.getLayerOfType<pcpp::TcpLayer>()->getTcpHeader());
+	PTF_ASSERT_NULL(tcpView.getIPv6Header());
+	PTF_ASSERT_NULL(tcpView.getUdpHeader());
+	PTF_ASSERT_NULL(tcpView.getIcmpHeader());
+	PTF_ASSERT_NULL(tcpView.getSctpHeader());
+	PTF_ASSERT_EQUAL(tcpView.getEtherType(), PCPP_ETHERTYPE_IP, u16);
+	PTF_ASSERT_EQUAL(tcpView.getIPProtocol(), pcpp::PACKETPP_IPPROTO_TCP, u8);
+	PTF_ASSERT_EQUAL(tcpView.getSrcPort(), be16toh(tcpPacket.getLayerOfType<pcpp::TcpLayer>()->getTcpHeader()->portSrc), u16);
+	PTF_ASSERT_EQUAL(tcpView.getDstPort(), be16toh(tcpPacket.getLayerOfType<pcpp::TcpLayer>()->getTcpHeader()->portDst), u16);
+
+	pcpp::Packet mplsPacket(&rawPacket3);
+	pcpp::PacketView mplsView(&rawPacket3);
+	PTF_ASSERT_EQUAL(mplsView.getVlanTagCount(), 2, u8);
+	PTF_ASSERT_EQUAL(mplsView.getOuterVlanId(), 215, u16);
+	PTF_ASSERT_EQUAL(mplsView.getMplsLabelCount(), 1, u8);
+	PTF_ASSERT_EQUAL(mplsView.getEtherType(), PCPP_ETHERTYPE_IP, u16);
+	PTF_ASSERT_TRUE(mplsView.getTcpHeader() == mplsPacket.getLayerOfType<pcpp::TcpLayer>()->getTcpHeader());
+
+	// Q-in-Q: an 802.1ad service tag followed by an 802.1Q customer tag, built around the IPv4 packet of rawPacket1
+	const size_t ipOffset = sizeof(pcpp::ether_header);
+	size_t qinqLen = rawPacket1.getRawDataLen() + 2 * sizeof(pcpp::vlan_header);
+	uint8_t qinqData[2048];
+	PTF_ASSERT_TRUE(qinqLen <= sizeof(qinqData));
+	memcpy(qinqData, rawPacket1.getRawData(), 12);
+	uint8_t qinqTags[] = { 0x88, 0xa8, 0x00, 0x64, 0x81, 0x00, 0x00, 0xc8, 0x08, 0x00 };
+	memcpy(qinqData + 12, qinqTags, sizeof(qinqTags));
+	memcpy(qinqData + ipOffset + 2 * sizeof(pcpp::vlan_header), rawPacket1.getRawData() + ipOffset, rawPacket1.getRawDataLen() - ipOffset);
+	pcpp::PacketView qinqView(qinqData, qinqLen);
+	PTF_ASSERT_TRUE(qinqView.isPacketOfType(pcpp::VLAN));
+	PTF_ASSERT_EQUAL(qinqView.getVlanTagCount(), 2, u8);
+	PTF_ASSERT_EQUAL(qinqView.getOuterVlanId(), 100, u16);
+	PTF_ASSERT_EQUAL(qinqView.getL3Offset(), tcpView.getL3Offset() + 8, u16);
+	PTF_ASSERT_EQUAL(qinqView.getL7Offset(), tcpView.getL7Offset() + 8, u16);
+	PTF_ASSERT_EQUAL(qinqView.getPayloadLen(), tcpView.getPayloadLen(), size);
+
+	// SCTP: change the IP protocol of a UDP packet, the SCTP common header starts with the same ports
+	pcpp::Packet udpPacket(&rawPacket2);
+	pcpp::PacketView udpView(&rawPacket2);
+	uint16_t srcPort = udpView.getSrcPort();
+	PTF_ASSERT_EQUAL(srcPort, be16toh(udpPacket.getLayerOfType<pcpp::UdpLayer>()->getUdpHeader()->portSrc), u16);
+	uint8_t sctpData[2048];
+	PTF_ASSERT_TRUE((size_t)rawPacket2.getRawDataLen() <= sizeof(sctpData));
+	memcpy(sctpData, rawPacket2.getRawData(), rawPacket2.getRawDataLen());
+	((pcpp::iphdr*)(sctpData + udpView.getL3Offset()))->protocol = pcpp::PACKETPP_IPPROTO_SCTP;
+	pcpp::PacketView sctpView(sctpData, rawPacket2.getRawDataLen());
+	PTF_ASSERT_FALSE(sctpView.isPacketOfType(pcpp::UDP));
+	PTF_ASSERT_NOT_NULL(sctpView.getSctpHeader());
+	PTF_ASSERT_EQUAL(sctpView.getSrcPort(), srcPort, u16);
+	PTF_ASSERT_EQUAL(sctpView.getL7Offset(), udpView.getL4Offset() + sizeof(pcpp::sctphdr), u16);
+
+	// a view can be reused and cleared
+	PTF_ASSERT_TRUE(sctpView.parse(&rawPacket1));
+	PTF_ASSERT_NOT_NULL(sctpView.getTcpHeader());
+	sctpView.clear();
+	PTF_ASSERT_NULL(sctpView.getData());
+	PTF_ASSERT_EQUAL(sctpView.getProtocolTypes(), pcpp::UnknownProtocol, u64);
+	PTF_ASSERT_FALSE(sctpView.parse(NULL, 0));
+
+	// raw IP link type
+	pcpp::PacketView rawIPView(rawPacket1.getRawData() + ipOffset, rawPacket1.getRawDataLen() - ipOffset, pcpp::LINKTYPE_RAW);
+	PTF_ASSERT_EQUAL(rawIPView.getProtocolTypes(), (pcpp::IPv4 | pcpp::TCP), u64);
+	PTF_ASSERT_EQUAL(rawIPView.getL2Offset(), PCPP_PACKET_VIEW_NO_OFFSET, u16);
+	PTF_ASSERT_EQUAL(rawIPView.getL3Offset(), 0, u16);
+	PTF_ASSERT_NULL(rawIPView.getEthHeader());
+} // PacketViewTest
+
+PTF_TEST_CASE(PacketBurstParsingTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	const char* fileNames[] = {
+		"PacketExamples/TcpPacketWithOptions.dat",
+		"PacketExamples/Dns3.dat",
+		"PacketExamples/IPv6UdpPacket.dat",
+		"PacketExamples/MplsPackets1.dat",
+		"PacketExamples/ArpRequestWithVlan.dat",
+		"PacketExamples/IPv6Frag2.dat",
+		"PacketExamples/IcmpEchoRequest.dat",
+		"PacketExamples/ipv6_options_multi.dat",
+		"PacketExamples/TwoHttpRequests1.dat",
+		"PacketExamples/packet_trailer_ipv4.dat"
+	};
+	const size_t numOfPackets = sizeof(fileNames) / sizeof(fileNames[0]);
+
+	pcpp::PointerVector<pcpp::RawPacket> rawPacketVec;
+	for (size_t i = 0; i < numOfPackets; i++)
+	{
+		int bufferLength = 0;
+		uint8_t* buffer = pcpp_tests::readFileIntoBuffer(fileNames[i], bufferLength);
+		PTF_ASSERT_NOT_NULL(buffer);
+		rawPacketVec.pushBack(new pcpp::RawPacket((const uint8_t*)buffer, bufferLength, time, true));
+	}
+
+	// the burst results should be identical to parsing each packet separately
+	pcpp::PacketView views[numOfPackets];
+	pcpp::PacketFiveTuple fiveTuples[numOfPackets];
+	PTF_ASSERT_EQUAL(pcpp::parsePacketBurst(rawPacketVec, views, fiveTuples), numOfPackets, size);
+	for (size_t i = 0; i < numOfPackets; i++)
+	{
+		pcpp::PacketView view(rawPacketVec.at(i));
+		PTF_ASSERT_TRUE(views[i].getData() == view.getData());
+		PTF_ASSERT_EQUAL(views[i].getProtocolTypes(), view.getProtocolTypes(), u64);
+		PTF_ASSERT_EQUAL(views[i].getL3Offset(), view.getL3Offset(), u16);
+		PTF_ASSERT_EQUAL(views[i].getL4Offset(), view.getL4Offset(), u16);
+		PTF_ASSERT_EQUAL(views[i].getL7Offset(), view.getL7Offset(), u16);
+
+		pcpp::PacketFiveTuple fiveTuple;
+		PTF_ASSERT_TRUE(view.getFiveTuple(fiveTuple) == view.isPacketOfType(pcpp::IP));
+		PTF_ASSERT_TRUE(memcmp(&fiveTuple, &fiveTuples[i], sizeof(pcpp::PacketFiveTuple)) == 0);
+	}
+
+	// check the 5-tuple of an IPv4 TCP packet against the layers
+	pcpp::Packet tcpPacket(rawPacketVec.at(0));
+	pcpp::IPv4Layer* ipLayer = tcpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_EQUAL(fiveTuples[0].ipVersion, 4, u8);
+	PTF_ASSERT_EQUAL(fiveTuples[0].protocol, pcpp::PACKETPP_IPPROTO_TCP, u8);
+	PTF_ASSERT_TRUE(memcmp(fiveTuples[0].srcIP, &ipLayer->getIPv4Header()->ipSrc, 4) == 0);
+	PTF_ASSERT_TRUE(memcmp(fiveTuples[0].dstIP, &ipLayer->getIPv4Header()->ipDst, 4) == 0);
+	PTF_ASSERT_EQUAL(fiveTuples[0].srcPort, be16toh(tcpLayer->getTcpHeader()->portSrc), u16);
+	PTF_ASSERT_EQUAL(fiveTuples[0].dstPort, be16toh(tcpLayer->getTcpHeader()->portDst), u16);
+
+	// IPv6 UDP packet
+	pcpp::Packet udpPacket(rawPacketVec.at(2));
+	pcpp::IPv6Layer* ip6Layer = udpPacket.getLayerOfType<pcpp::IPv6Layer>();
+	PTF_ASSERT_EQUAL(fiveTuples[2].ipVersion, 6, u8);
+	PTF_ASSERT_EQUAL(fiveTuples[2].protocol, pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_TRUE(memcmp(fiveTuples[2].srcIP, ip6Layer->getIPv6Header()->ipSrc, 16) == 0);
+	PTF_ASSERT_EQUAL(fiveTuples[2].dstPort, be16toh(udpPacket.getLayerOfType<pcpp::UdpLayer>()->getUdpHeader()->portDst), u16);
+
+	// ARP has no 5-tuple, IPv6 fragments have no ports
+	PTF_ASSERT_EQUAL(fiveTuples[4].ipVersion, 0, u8);
+	PTF_ASSERT_EQUAL(fiveTuples[5].ipVersion, 6, u8);
+	PTF_ASSERT_EQUAL(fiveTuples[5].srcPort, 0, u16);
+
+	// a plain array with NULL entries and no 5-tuples
+	pcpp::RawPacket* rawPacketArr[numOfPackets];
+	for (size_t i = 0; i < numOfPackets; i++)
+		rawPacketArr[i] = (i % 3 == 1 ? NULL : rawPacketVec.at(i));
+	PTF_ASSERT_EQUAL(pcpp::parsePacketBurst(rawPacketArr, numOfPackets, views), numOfPackets - 3, size);
+	for (size_t i = 0; i < numOfPackets; i++)
+	{
+		const uint8_t* expectedData = (rawPacketArr[i] == NULL ? NULL : rawPacketArr[i]->getRawData());
+		PTF_ASSERT_TRUE(views[i].getData() == expectedData);
+	}
+
+	PTF_ASSERT_EQUAL(pcpp::parsePacketBurst(rawPacketArr, 0, views), 0, size);
+} // PacketBurstParsingTest
+
+PTF_TEST_CASE(LayerRecyclingTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpRequests2.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/Dns3.dat");
+
+	// the first raw packet has nothing to recycle
+	pcpp::Packet packet(&rawPacket1);
+	PTF_ASSERT_EQUAL(packet.getNumOfLayerAllocations(), 4, u64);
+	PTF_ASSERT_EQUAL(packet.getNumOfRecycledLayerAllocations(), 0, u64);
+
+	// same protocol stack - all layers are recycled
+	packet.setRawPacket(&rawPacket2, false);
+	PTF_ASSERT_EQUAL(packet.getNumOfLayerAllocations(), 8, u64);
+	PTF_ASSERT_EQUAL(packet.getNumOfRecycledLayerAllocations(), 4, u64);
+	pcpp::HttpRequestLayer* httpLayer = packet.getLayerOfType<pcpp::HttpRequestLayer>();
+	PTF_ASSERT_NOT_NULL(httpLayer);
+	PTF_ASSERT_TRUE(httpLayer->getData() > rawPacket2.getRawData() && httpLayer->getData() < rawPacket2.getRawData() + rawPacket2.getRawDataLen());
+	PTF_ASSERT_EQUAL(httpLayer->getFirstLine()->getUri(), "/Common/Api/Video/CmmLightboxPlayerJs/0,14153,061014181713,00.js", string);
+
+	// a different transport and application layer - only layers of the same size are recycled
+	packet.setRawPacket(&rawPacket3, false);
+	PTF_ASSERT_EQUAL(packet.getNumOfLayerAllocations(), 12, u64);
+	PTF_ASSERT_TRUE(packet.getNumOfRecycledLayerAllocations() >= 6);
+	PTF_ASSERT_NOT_NULL(packet.getLayerOfType<pcpp::DnsLayer>());
+	PTF_ASSERT_EQUAL(packet.getLayerOfType<pcpp::DnsLayer>()->getQueryCount(), 2, size);
+	PTF_ASSERT_NULL(packet.getLayerOfType<pcpp::TcpLayer>());
+
+	// the result of parsing a recycled packet is identical to parsing a new one
+	for (int i = 0; i < 10; i++)
+	{
+		packet.setRawPacket(i % 2 == 0 ? &rawPacket1 : &rawPacket3, false);
+		pcpp::Packet freshPacket(i % 2 == 0 ? &rawPacket1 : &rawPacket3);
+		PTF_ASSERT_TRUE(packet.toString() == freshPacket.toString());
+	}
+
+	// layers that were added by the user and owned by the packet are recycled as well
+	pcpp::PayloadLayer* newPayload = new pcpp::PayloadLayer((uint8_t*)"abcd", 4, false);
+	packet.setRawPacket(&rawPacket3, false);
+	PTF_ASSERT_TRUE(packet.addLayer(newPayload, true));
+	uint64_t numOfRecycled = packet.getNumOfRecycledLayerAllocations();
+	packet.setRawPacket(&rawPacket1, false);
+	PTF_ASSERT_EQUAL(packet.getNumOfRecycledLayerAllocations(), numOfRecycled + 4, u64);
+
+	// layers allocated from an arena aren't recycled
+	pcpp::LayerArena arena;
+	packet.setRawPacket(&rawPacket1, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, &arena);
+	PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 4, size);
+	packet.setRawPacket(&rawPacket2, false);
+	PTF_ASSERT_EQUAL(arena.getNumOfLiveAllocations(), 0, size);
+} // LayerRecyclingTest
+
+
+
+PTF_TEST_CASE(FlowKeyTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/IPv6UdpPacket.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/IcmpDestUnreachableUdp.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/ArpResponsePacket.dat");
+	READ_FILE_AND_CREATE_PACKET(5, "PacketExamples/gtp-u-1ext.dat");
+
+	// IPv4 TCP packet - the key extracted from the parsed packet and from the raw bytes is the same
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::FlowKey tcpKey = pcpp::FlowKey::fromPacket(tcpPacket);
+	PTF_ASSERT_TRUE(tcpKey.isValid());
+	PTF_ASSERT_EQUAL(tcpKey.getIPVersion(), 4, u8);
+	PTF_ASSERT_EQUAL(tcpKey.getProtocol(), pcpp::PACKETPP_IPPROTO_TCP, u8);
+	PTF_ASSERT_EQUAL(tcpKey.getPortA(), 60378, u16);
+	PTF_ASSERT_EQUAL(tcpKey.getPortB(), 80, u16);
+	PTF_ASSERT_EQUAL(tcpKey.toString(), "10.0.0.1:60378 <-> 212.199.202.60:80 proto 6", string);
+	PTF_ASSERT_TRUE(tcpKey == pcpp::FlowKey::fromRawPacket(&rawPacket1));
+	PTF_ASSERT_TRUE(tcpKey == pcpp::FlowKey::fromRawData(rawPacket1.getRawData(), rawPacket1.getRawDataLen()));
+	PTF_ASSERT_EQUAL(tcpKey.hash(), pcpp::FlowKey::fromRawPacket(&rawPacket1).hash(), u64);
+
+	// the opposite direction of the flow has the same key
+	pcpp::Packet reversedPacket(tcpPacket);
+	pcpp::IPv4Layer* ipLayer = reversedPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::IPv4Address srcIP = ipLayer->getSrcIpAddress();
+	ipLayer->setSrcIpAddress(ipLayer->getDstIpAddress());
+	ipLayer->setDstIpAddress(srcIP);
+	pcpp::tcphdr* tcpHeader = reversedPacket.getLayerOfType<pcpp::TcpLayer>()->getTcpHeader();
+	uint16_t srcPort = tcpHeader->portSrc;
+	tcpHeader->portSrc = tcpHeader->portDst;
+	tcpHeader->portDst = srcPort;
+	pcpp::FlowKey reversedKey = pcpp::FlowKey::fromPacket(reversedPacket);
+	PTF_ASSERT_TRUE(reversedKey == tcpKey);
+	PTF_ASSERT_FALSE(reversedKey < tcpKey || tcpKey < reversedKey);
+	PTF_ASSERT_EQUAL(reversedKey.hash(), tcpKey.hash(), u64);
+
+	// a different port means a different flow
+	tcpHeader->portSrc = htobe16(81);
+	pcpp::FlowKey otherKey = pcpp::FlowKey::fromPacket(reversedPacket);
+	PTF_ASSERT_TRUE(otherKey != tcpKey);
+	PTF_ASSERT_TRUE(otherKey < tcpKey || tcpKey < otherKey);
+	PTF_ASSERT_NOT_EQUAL(otherKey.hash(), tcpKey.hash(), u64);
+
+	// the address pair key ignores ports and protocol
+	PTF_ASSERT_TRUE(otherKey.getIPPairKey() == tcpKey.getIPPairKey());
+	PTF_ASSERT_EQUAL(tcpKey.getIPPairKey().getPortA(), 0, u16);
+	PTF_ASSERT_EQUAL(tcpKey.getIPPairKey().getProtocol(), 0, u8);
+
+	// IPv6 UDP packet
+	pcpp::Packet udpPacket(&rawPacket2);
+	pcpp::FlowKey udpKey = pcpp::FlowKey::fromPacket(udpPacket);
+	PTF_ASSERT_EQUAL(udpKey.getIPVersion(), 6, u8);
+	PTF_ASSERT_EQUAL(udpKey.getProtocol(), pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_EQUAL(udpKey.toString(), "[fe80::4dc7:f593:1f7b:dc11]:63628 <-> [ff02::c]:1900 proto 17", string);
+	PTF_ASSERT_TRUE(udpKey == pcpp::FlowKey::fromRawPacket(&rawPacket2));
+	PTF_ASSERT_TRUE(udpKey != tcpKey);
+
+	// ICMP errors carry the header of the original packet which isn't part of the key
+	pcpp::Packet icmpPacket(&rawPacket3);
+	pcpp::FlowKey icmpKey = pcpp::FlowKey::fromPacket(icmpPacket);
+	PTF_ASSERT_EQUAL(icmpKey.getProtocol(), pcpp::PACKETPP_IPPROTO_ICMP, u8);
+	PTF_ASSERT_EQUAL(icmpKey.getPortA(), 0, u16);
+	PTF_ASSERT_EQUAL(icmpKey.getPortB(), 0, u16);
+	PTF_ASSERT_TRUE(icmpKey == pcpp::FlowKey::fromRawPacket(&rawPacket3));
+
+	// non-IP packets get an invalid key
+	pcpp::Packet arpPacket(&rawPacket4);
+	PTF_ASSERT_FALSE(pcpp::FlowKey::fromPacket(arpPacket).isValid());
+	PTF_ASSERT_FALSE(pcpp::FlowKey::fromRawPacket(&rawPacket4).isValid());
+	PTF_ASSERT_TRUE(pcpp::FlowKey::fromPacket(arpPacket) == pcpp::FlowKey());
+
+	// the parsed packet key is the innermost flow of a tunnel while the raw key is the outer one
+	pcpp::Packet gtpPacket(&rawPacket5);
+	pcpp::FlowKey gtpKey = pcpp::FlowKey::fromPacket(gtpPacket);
+	PTF_ASSERT_EQUAL(gtpKey.toString(), "192.168.40.178:0 <-> 202.11.40.158:0 proto 1", string);
+	pcpp::FlowKey gtpOuterKey = pcpp::FlowKey::fromRawPacket(&rawPacket5);
+	PTF_ASSERT_EQUAL(gtpOuterKey.getProtocol(), pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_EQUAL(gtpOuterKey.getPortA(), 2152, u16);
+	PTF_ASSERT_TRUE(gtpKey != gtpOuterKey);
+} // FlowKeyTest
+
+
+
+PTF_TEST_CASE(TunnelFlowKeysTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/gtp-u-2ext.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/gtp-u-ipv6.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/gtp-c1.dat");
+	READ_FILE_AND_CREATE_PACKET(5, "PacketExamples/Vxlan1.dat");
+	READ_FILE_AND_CREATE_PACKET(6, "PacketExamples/GREv0_1.dat");
+	READ_FILE_AND_CREATE_PACKET(7, "PacketExamples/GREv1_2.dat");
+	READ_FILE_AND_CREATE_PACKET(8, "PacketExamples/ArpResponsePacket.dat");
+
+	// a packet that isn't tunneled has the same outer and inner key
+	pcpp::TunnelFlowKeys keys;
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket1, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::NoTunnel, enum);
+	PTF_ASSERT_EQUAL(keys.tunnelDepth, 0, u8);
+	PTF_ASSERT_FALSE(keys.hasTunnelId);
+	PTF_ASSERT_TRUE(keys.outerFlowKey == pcpp::FlowKey::fromRawPacket(&rawPacket1));
+	PTF_ASSERT_TRUE(keys.innerFlowKey == keys.outerFlowKey);
+
+	// GTP-U with extension headers
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket2, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::GtpUTunnel, enum);
+	PTF_ASSERT_EQUAL(keys.tunnelDepth, 1, u8);
+	PTF_ASSERT_TRUE(keys.hasTunnelId);
+	PTF_ASSERT_EQUAL(keys.tunnelId, 1, u32);
+	PTF_ASSERT_EQUAL(keys.outerFlowKey.toString(), "192.168.40.178:2152 <-> 192.168.40.179:2152 proto 17", string);
+	PTF_ASSERT_EQUAL(keys.innerFlowKey.toString(), "192.168.40.178:0 <-> 202.11.40.158:0 proto 1", string);
+	pcpp::Packet gtpPacket(&rawPacket2);
+	PTF_ASSERT_TRUE(keys.innerFlowKey == pcpp::FlowKey::fromPacket(gtpPacket));
+
+	// GTP-U carrying IPv6. The inner tuple changes the 5-tuple hash
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(rawPacket3.getRawData(), rawPacket3.getRawDataLen(), keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::GtpUTunnel, enum);
+	PTF_ASSERT_EQUAL(keys.tunnelId, 2327461905U, u32);
+	PTF_ASSERT_EQUAL(keys.innerFlowKey.toString(), "[2001:507:0:1:200:8600:0:1]:2396 <-> [2001:507:0:1:200:8600:0:2]:53 proto 17", string);
+	pcpp::Packet gtpIPv6Packet(&rawPacket3);
+	PTF_ASSERT_TRUE(keys.innerFlowKey == pcpp::FlowKey::fromPacket(gtpIPv6Packet));
+	PTF_ASSERT_NOT_EQUAL(pcpp::hash5Tuple(&gtpIPv6Packet), pcpp::hash5Tuple(&gtpIPv6Packet, true), u32);
+
+	// GTP-C isn't a tunnel
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket4, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::NoTunnel, enum);
+	PTF_ASSERT_TRUE(keys.innerFlowKey == keys.outerFlowKey);
+
+	// VXLAN
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket5, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::VxlanTunnel, enum);
+	PTF_ASSERT_TRUE(keys.hasTunnelId);
+	PTF_ASSERT_EQUAL(keys.tunnelId, 3000001, u32);
+	PTF_ASSERT_EQUAL(keys.outerFlowKey.getProtocol(), pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_EQUAL(keys.innerFlowKey.toString(), "192.168.203.3:0 <-> 192.168.203.5:0 proto 1", string);
+
+	// GRE without a key
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket6, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::GreTunnel, enum);
+	PTF_ASSERT_FALSE(keys.hasTunnelId);
+	PTF_ASSERT_EQUAL(keys.outerFlowKey.getProtocol(), pcpp::PACKETPP_IPPROTO_GRE, u8);
+	PTF_ASSERT_EQUAL(keys.innerFlowKey.getProtocol(), pcpp::PACKETPP_IPPROTO_ICMP, u8);
+
+	// IPv4 in IPv6 carrying PPTP (enhanced GRE) - the innermost tunnel is reported
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket7, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::GreTunnel, enum);
+	PTF_ASSERT_EQUAL(keys.tunnelDepth, 2, u8);
+	PTF_ASSERT_TRUE(keys.hasTunnelId);
+	PTF_ASSERT_EQUAL(keys.tunnelId, 17, u32);
+	PTF_ASSERT_EQUAL(keys.outerFlowKey.getIPVersion(), 6, u8);
+	PTF_ASSERT_EQUAL(keys.innerFlowKey.toString(), "8.8.8.8:53 <-> 172.16.44.3:40768 proto 17", string);
+	pcpp::Packet pptpPacket(&rawPacket7);
+	PTF_ASSERT_TRUE(keys.innerFlowKey == pcpp::FlowKey::fromPacket(pptpPacket));
+
+	// truncating the inner packet stops the decapsulation at the outer flow
+	PTF_ASSERT_TRUE(pcpp::FlowKey::extractTunnelFlowKeys(rawPacket5.getRawData(), 14 + 20 + 8 + 8 + 10, keys));
+	PTF_ASSERT_EQUAL(keys.tunnelType, pcpp::NoTunnel, enum);
+	PTF_ASSERT_TRUE(keys.innerFlowKey == keys.outerFlowKey);
+
+	// non-IP packets
+	PTF_ASSERT_FALSE(pcpp::FlowKey::extractTunnelFlowKeys(&rawPacket8, keys));
+	PTF_ASSERT_FALSE(keys.outerFlowKey.isValid());
+	PTF_ASSERT_FALSE(keys.innerFlowKey.isValid());
+} // TunnelFlowKeysTest
+
+
+
+static pcpp::FlowKey createTestFlowKey(uint32_t index, bool reversed = false)
+{
+	pcpp::PacketFiveTuple fiveTuple;
+	memset(&fiveTuple, 0, sizeof(fiveTuple));
+	fiveTuple.ipVersion = 4;
+	fiveTuple.protocol = pcpp::PACKETPP_IPPROTO_TCP;
+	fiveTuple.srcIP[0] = 10;
+	fiveTuple.srcIP[1] = (uint8_t)(index >> 16);
+	fiveTuple.srcIP[2] = (uint8_t)(index >> 8);
+	fiveTuple.srcIP[3] = (uint8_t)index;
+	fiveTuple.dstIP[0] = 192;
+	fiveTuple.dstIP[1] = 168;
+	fiveTuple.srcPort = (uint16_t)(1024 + (index % 1000));
+	fiveTuple.dstPort = 80;
+	if (reversed)
+	{
+		uint8_t ip[16];
+		memcpy(ip, fiveTuple.srcIP, sizeof(ip));
+		memcpy(fiveTuple.srcIP, fiveTuple.dstIP, sizeof(ip));
+		memcpy(fiveTuple.dstIP, ip, sizeof(ip));
+		uint16_t port = fiveTuple.srcPort;
+		fiveTuple.srcPort = fiveTuple.dstPort;
+		fiveTuple.dstPort = port;
+	}
+
+	return pcpp::FlowKey(fiveTuple);
+}
+
+PTF_TEST_CASE(FlowTableTest)
+{
+	typedef pcpp::FlowTable<uint32_t> TestFlowTable;
+	const uint32_t numOfFlows = 5000;
+
+	// a table with a small initial capacity so it has to grow
+	TestFlowTable table(10);
+	PTF_ASSERT_TRUE(table.empty());
+	PTF_ASSERT_TRUE(table.begin() == table.end());
+	PTF_ASSERT_TRUE(table.find(createTestFlowKey(0)) == table.end());
+	PTF_ASSERT_EQUAL(table.erase(createTestFlowKey(0)), 0, size);
+
+	std::pair<TestFlowTable::iterator, bool> firstInsert = table.insert(TestFlowTable::value_type(createTestFlowKey(0), 0));
+	PTF_ASSERT_TRUE(firstInsert.second);
+	TestFlowTable::Handle firstHandle = firstInsert.first.getHandle();
+	uint32_t* firstValue = &firstInsert.first->second;
+
+	for (uint32_t i = 1; i < numOfFlows; i++)
+	{
+		PTF_ASSERT_TRUE(table.insert(TestFlowTable::value_type(createTestFlowKey(i), i)).second);
+	}
+
+	PTF_ASSERT_EQUAL(table.size(), numOfFlows, size);
+	PTF_ASSERT_TRUE(table.capacity() >= numOfFlows);
+
+	// handles and pointers to entries stay valid when the table grows
+	PTF_ASSERT_TRUE(table.findHandle(createTestFlowKey(0)) == firstHandle);
+	PTF_ASSERT_TRUE(&table.at(firstHandle).second == firstValue);
+
+	// inserting an existing key doesn't modify the entry
+	std::pair<TestFlowTable::iterator, bool> duplicateInsert = table.insert(TestFlowTable::value_type(createTestFlowKey(7), 1000000));
+	PTF_ASSERT_FALSE(duplicateInsert.second);
+	PTF_ASSERT_EQUAL(duplicateInsert.first->second, 7, u32);
+	PTF_ASSERT_EQUAL(table.size(), numOfFlows, size);
+
+	// both directions of a flow are the same key
+	pcpp::FlowKey reversedKey = createTestFlowKey(12, true);
+	PTF_ASSERT_TRUE(table.find(reversedKey) != table.end());
+	PTF_ASSERT_EQUAL(table.find(reversedKey)->second, 12, u32);
+
+	// erase every other flow, the rest of the flows must still be found (backward shift deletion doesn't break probe sequences)
+	for (uint32_t i = 0; i < numOfFlows; i += 2)
+	{
+		PTF_ASSERT_EQUAL(table.erase(createTestFlowKey(i)), 1, size);
+	}
+
+	PTF_ASSERT_EQUAL(table.size(), numOfFlows / 2, size);
+	for (uint32_t i = 0; i < numOfFlows; i++)
+	{
+		TestFlowTable::iterator iter = table.find(createTestFlowKey(i));
+		if (i % 2 == 0)
+		{
+			PTF_ASSERT_TRUE(iter == table.end());
+		}
+		else
+		{
+			PTF_ASSERT_TRUE(iter != table.end());
+			PTF_ASSERT_EQUAL(iter->second, i, u32);
+			PTF_ASSERT_TRUE(iter->first == createTestFlowKey(i));
+		}
+	}
+
+	// erased entries are reused without growing the table
+	size_t capacityBefore = table.capacity();
+	for (uint32_t i = 0; i < numOfFlows; i += 2)
+	{
+		table[createTestFlowKey(i)] = i + 1;
+	}
+
+	PTF_ASSERT_EQUAL(table.size(), numOfFlows, size);
+	PTF_ASSERT_EQUAL(table.capacity(), capacityBefore, size);
+	PTF_ASSERT_EQUAL(table[createTestFlowKey(4)], 5, u32);
+
+	// iteration visits every entry exactly once
+	uint64_t sum = 0;
+	size_t count = 0;
+	for (TestFlowTable::const_iterator iter = table.begin(); iter != table.end(); ++iter)
+	{
+		sum += iter->second;
+		count++;
+	}
+
+	PTF_ASSERT_EQUAL(count, numOfFlows, size);
+	PTF_ASSERT_EQUAL(sum, (uint64_t)numOfFlows * (numOfFlows - 1) / 2 + numOfFlows / 2, u64);
+
+	// a copy is independent of the original table
+	TestFlowTable copy(table);
+	PTF_ASSERT_EQUAL(copy.size(), numOfFlows, size);
+	copy.erase(createTestFlowKey(1));
+	PTF_ASSERT_TRUE(copy.find(createTestFlowKey(1)) == copy.end());
+	PTF_ASSERT_TRUE(table.find(createTestFlowKey(1)) != table.end());
+
+	// erasing while iterating
+	for (TestFlowTable::iterator iter = copy.begin(); iter != copy.end(); )
+	{
+		if (iter->second % 3 == 0)
+			copy.erase(iter++);
+		else
+			++iter;
+	}
+
+	for (TestFlowTable::const_iterator iter = copy.begin(); iter != copy.end(); ++iter)
+	{
+		PTF_ASSERT_TRUE(iter->second % 3 != 0);
+	}
+
+	copy = table;
+	PTF_ASSERT_EQUAL(copy.size(), numOfFlows, size);
+
+	table.clear();
+	PTF_ASSERT_TRUE(table.empty());
+	PTF_ASSERT_TRUE(table.begin() == table.end());
+	PTF_ASSERT_TRUE(table.find(createTestFlowKey(1)) == table.end());
+	PTF_ASSERT_EQUAL(table.capacity(), capacityBefore, size);
+	PTF_ASSERT_EQUAL(copy[createTestFlowKey(1)], 1, u32);
+
+	// iteration follows the insertion order and visits only the live entries of a large preallocated table
+	TestFlowTable sparseTable(100000);
+	sparseTable.insert(TestFlowTable::value_type(createTestFlowKey(3), 3));
+	sparseTable.insert(TestFlowTable::value_type(createTestFlowKey(1), 1));
+	sparseTable.insert(TestFlowTable::value_type(createTestFlowKey(2), 2));
+	sparseTable.erase(createTestFlowKey(1));
+	sparseTable.insert(TestFlowTable::value_type(createTestFlowKey(4), 4));
+	uint32_t expectedOrder[] = { 3, 2, 4 };
+	count = 0;
+	for (TestFlowTable::const_iterator iter = sparseTable.begin(); iter != sparseTable.end(); ++iter)
+	{
+		PTF_ASSERT_TRUE(count < 3);
+		PTF_ASSERT_EQUAL(iter->second, expectedOrder[count], u32);
+		count++;
+	}
+
+	PTF_ASSERT_EQUAL(count, 3, size);
+	sparseTable.erase(createTestFlowKey(4));
+	sparseTable.erase(createTestFlowKey(3));
+	PTF_ASSERT_EQUAL(sparseTable.begin()->second, 2, u32);
+	PTF_ASSERT_TRUE(++sparseTable.begin() == sparseTable.end());
+	sparseTable.clear();
+	PTF_ASSERT_TRUE(sparseTable.begin() == sparseTable.end());
+} // FlowTableTest
+
+
+
+PTF_TEST_CASE(StackParserTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/ArpRequestWithVlan.dat");
+
+	// Eth/IPv4/TCP - the headers bound by the stack parser are the ones of the generically parsed packet
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::TcpLayer> tcpParser;
+	PTF_ASSERT_EQUAL(tcpParser.NumOfLayers, 3, int);
+	PTF_ASSERT_TRUE(tcpParser.parse(&rawPacket1));
+	PTF_ASSERT_TRUE(tcpParser.isMatched());
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::IPv4Layer* ipLayer = tcpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_TRUE(tcpParser.getHeader<0>() == tcpPacket.getLayerOfType<pcpp::EthLayer>()->getEthHeader());
+	PTF_ASSERT_TRUE(tcpParser.getHeader<1>() == ipLayer->getIPv4Header());
+	PTF_ASSERT_TRUE(tcpParser.getLayerHeader<pcpp::TcpLayer>() == tcpLayer->getTcpHeader());
+	PTF_ASSERT_EQUAL(tcpParser.getHeaderLen<1>(), ipLayer->getHeaderLen(), size);
+	PTF_ASSERT_EQUAL(tcpParser.getHeaderLen<2>(), tcpLayer->getHeaderLen(), size);
+	PTF_ASSERT_EQUAL(tcpParser.getHeaderOffset<2>(), 34, size);
+	PTF_ASSERT_EQUAL(be16toh(tcpParser.getLayerHeader<pcpp::TcpLayer>()->portDst), 80, u16);
+	PTF_ASSERT_TRUE(tcpParser.getPayload() == tcpLayer->getLayerPayload());
+	PTF_ASSERT_EQUAL(tcpParser.getPayloadLen(), tcpLayer->getLayerPayloadSize(), size);
+	// the generic parsing of a matched packet is done on demand
+	PTF_ASSERT_NOT_NULL(tcpParser.getPacket());
+	PTF_ASSERT_TRUE(tcpParser.getPacket()->isPacketOfType(pcpp::HTTPRequest));
+
+	// a stack that's a prefix of the packet matches as well
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer> ipParser;
+	PTF_ASSERT_TRUE(ipParser.parse(&rawPacket1));
+	PTF_ASSERT_EQUAL(ipParser.getPayloadLen(), ipLayer->getLayerPayloadSize(), size);
+
+	// a packet that doesn't match falls back to the generic parsing
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv4Layer, pcpp::UdpLayer> udpParser;
+	PTF_ASSERT_FALSE(udpParser.parse(&rawPacket1));
+	PTF_ASSERT_FALSE(udpParser.isMatched());
+	PTF_ASSERT_NULL(udpParser.getPayload());
+	PTF_ASSERT_EQUAL(udpParser.getPayloadLen(), 0, size);
+	PTF_ASSERT_NOT_NULL(udpParser.getPacket());
+	PTF_ASSERT_TRUE(udpParser.getPacket()->isPacketOfType(pcpp::TCP));
+	PTF_ASSERT_FALSE(udpParser.parse(&rawPacket2));
+	PTF_ASSERT_TRUE(udpParser.getPacket()->isPacketOfType(pcpp::ARP));
+
+	// Eth/VLAN/IPv6/UDP
+	pcpp::EthLayer ethLayer(pcpp::MacAddress("30:46:9a:23:fb:fa"), pcpp::MacAddress("6c:f0:49:b2:de:6e"));
+	pcpp::VlanLayer vlanLayer(100, false, 0, PCPP_ETHERTYPE_IPV6);
+	pcpp::IPv6Layer ipv6Layer(pcpp::IPv6Address(std::string("2001:db8::1")), pcpp::IPv6Address(std::string("2001:db8::2")));
+	pcpp::UdpLayer udpLayer(12345, 53);
+	uint8_t payload[10] = { 0 };
+	pcpp::PayloadLayer payloadLayer(payload, sizeof(payload), false);
+	pcpp::Packet vlanPacket(100);
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(&ethLayer));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(&vlanLayer));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(&ipv6Layer));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(&udpLayer));
+	PTF_ASSERT_TRUE(vlanPacket.addLayer(&payloadLayer));
+	vlanPacket.computeCalculateFields();
+
+	pcpp::StackParser<pcpp::EthLayer, pcpp::VlanLayer, pcpp::IPv6Layer, pcpp::UdpLayer> vlanParser;
+	PTF_ASSERT_TRUE(vlanParser.parse(vlanPacket.getRawPacket()));
+	PTF_ASSERT_EQUAL((be16toh(vlanParser.getLayerHeader<pcpp::VlanLayer>()->vlan) & 0xfff), 100, u16);
+	PTF_ASSERT_EQUAL(vlanParser.getHeader<2>()->nextHeader, pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_EQUAL(be16toh(vlanParser.getHeader<3>()->portDst), 53, u16);
+	PTF_ASSERT_EQUAL(vlanParser.getPayloadLen(), 10, size);
+
+	// the same stack without the VLAN tag doesn't match
+	pcpp::StackParser<pcpp::EthLayer, pcpp::IPv6Layer, pcpp::UdpLayer> noVlanParser;
+	PTF_ASSERT_FALSE(noVlanParser.parse(vlanPacket.getRawPacket()));
+	PTF_ASSERT_TRUE(noVlanParser.getPacket()->isPacketOfType(pcpp::VLAN));
+
+	// the payload is limited by the IP payload length, excluding the Ethernet padding
+	uint8_t paddedData[200];
+	memset(paddedData, 0, sizeof(paddedData));
+	memcpy(paddedData, vlanPacket.getRawPacket()->getRawData(), vlanPacket.getRawPacket()->getRawDataLen());
+	pcpp::RawPacket paddedRawPacket(paddedData, vlanPacket.getRawPacket()->getRawDataLen() + 20, time, false);
+	PTF_ASSERT_TRUE(vlanParser.parse(&paddedRawPacket));
+	PTF_ASSERT_EQUAL(vlanParser.getPayloadLen(), 10, size);
+
+	// truncated packets don't match
+	pcpp::RawPacket truncatedRawPacket(paddedData, 14 + 4 + 20, time, false);
+	PTF_ASSERT_FALSE(vlanParser.parse(&truncatedRawPacket));
+	PTF_ASSERT_TRUE(vlanParser.getPacket()->isPacketOfType(pcpp::VLAN));
+} // StackParserTest
+
+
+
+PTF_TEST_CASE(ToeplitzHashTest)
+{
+	// verification vectors from the Microsoft RSS specification
+	pcpp::ToeplitzHash msHash(pcpp::ToeplitzHash::MicrosoftKey, sizeof(pcpp::ToeplitzHash::MicrosoftKey));
+	PTF_ASSERT_EQUAL(msHash.getKeyLen(), 40, size);
+
+	pcpp::IPv4Address srcIPv4(std::string("66.9.149.187"));
+	pcpp::IPv4Address dstIPv4(std::string("161.142.100.80"));
+	PTF_ASSERT_EQUAL(msHash.hashIPv4(srcIPv4.toInt(), dstIPv4.toInt()), 0x323e8fc2, u32);
+	PTF_ASSERT_EQUAL(msHash.hashIPv4(srcIPv4.toInt(), dstIPv4.toInt(), 2794, 1766), 0x51ccc178, u32);
+
+	srcIPv4 = pcpp::IPv4Address(std::string("199.92.111.2"));
+	dstIPv4 = pcpp::IPv4Address(std::string("65.69.140.83"));
+	PTF_ASSERT_EQUAL(msHash.hashIPv4(srcIPv4.toInt(), dstIPv4.toInt()), 0xd718262a, u32);
+	PTF_ASSERT_EQUAL(msHash.hashIPv4(srcIPv4.toInt(), dstIPv4.toInt(), 14230, 4739), 0xc626b0ea, u32);
+
+	uint8_t srcIPv6[16], dstIPv6[16];
+	pcpp::IPv6Address(std::string("3ffe:2501:200:1fff::7")).copyTo(srcIPv6);
+	pcpp::IPv6Address(std::string("3ffe:2501:200:3::1")).copyTo(dstIPv6);
+	PTF_ASSERT_EQUAL(msHash.hashIPv6(srcIPv6, dstIPv6), 0x2cc18cd5, u32);
+	PTF_ASSERT_EQUAL(msHash.hashIPv6(srcIPv6, dstIPv6, 2794, 1766), 0x40207d3d, u32);
+
+	// the table-driven hash is identical to the bit-by-bit algorithm
+	uint8_t input[PCPP_TOEPLITZ_MAX_INPUT_LEN];
+	for (size_t i = 0; i < sizeof(input); i++)
+		input[i] = (uint8_t)(i * 37 + 11);
+	for (size_t len = 0; len <= sizeof(input); len++)
+	{
+		PTF_ASSERT_EQUAL(msHash.hash(input, len), pcpp::ToeplitzHash::hashBitByBit(pcpp::ToeplitzHash::MicrosoftKey, 40, input, len), u32);
+	}
+
+	// a short key hashes only the first (key length - 4) bytes
+	pcpp::ToeplitzHash shortKeyHash;
+	PTF_ASSERT_TRUE(shortKeyHash.setKey(pcpp::ToeplitzHash::MicrosoftKey, 16));
+	PTF_ASSERT_EQUAL(shortKeyHash.hash(input, sizeof(input)), msHash.hash(input, 12), u32);
+	PTF_ASSERT_FALSE(shortKeyHash.setKey(pcpp::ToeplitzHash::MicrosoftKey, 4));
+	PTF_ASSERT_FALSE(shortKeyHash.setKey(NULL, 40));
+	PTF_ASSERT_EQUAL(shortKeyHash.getKeyLen(), 16, size);
+
+	// the symmetric key gives the same hash to both directions of a connection
+	pcpp::ToeplitzHash symHash;
+	PTF_ASSERT_EQUAL(symHash.getKeyLen(), 40, size);
+	PTF_ASSERT_EQUAL(symHash.hashIPv4(srcIPv4.toInt(), dstIPv4.toInt(), 14230, 4739), symHash.hashIPv4(dstIPv4.toInt(), srcIPv4.toInt(), 4739, 14230), u32);
+	PTF_ASSERT_EQUAL(symHash.hashIPv6(srcIPv6, dstIPv6, 2794, 1766), symHash.hashIPv6(dstIPv6, srcIPv6, 1766, 2794), u32);
+	PTF_ASSERT_EQUAL(symHash.hashIPv6(srcIPv6, dstIPv6), symHash.hashIPv6(dstIPv6, srcIPv6), u32);
+
+	// packets: Packet, PacketView and burst hashing agree
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/IPv6UdpPacket.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/IcmpDestUnreachableUdp.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/ArpResponsePacket.dat");
+
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::IPv4Layer* ipLayer = tcpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	uint32_t expectedHash = msHash.hashIPv4(ipLayer->getIPv4Header()->ipSrc, ipLayer->getIPv4Header()->ipDst,
+			be16toh(tcpLayer->getTcpHeader()->portSrc), be16toh(tcpLayer->getTcpHeader()->portDst));
+	PTF_ASSERT_EQUAL(msHash.hashPacket(&tcpPacket), expectedHash, u32);
+	PTF_ASSERT_EQUAL(msHash.hashPacket(&tcpPacket, false), msHash.hashIPv4(ipLayer->getIPv4Header()->ipSrc, ipLayer->getIPv4Header()->ipDst), u32);
+
+	pcpp::RawPacket* rawPackets[4] = { &rawPacket1, &rawPacket2, &rawPacket3, &rawPacket4 };
+	pcpp::PacketView views[4];
+	pcpp::parsePacketBurst(rawPackets, 4, views);
+	uint32_t viewHashes[4], rawHashes[4];
+	msHash.hashBurst(views, 4, viewHashes);
+	msHash.hashBurst(rawPackets, 4, rawHashes);
+	for (int i = 0; i < 4; i++)
+	{
+		pcpp::Packet packet(rawPackets[i]);
+		PTF_ASSERT_EQUAL(msHash.hashPacket(views[i]), msHash.hashPacket(&packet), u32);
+		PTF_ASSERT_EQUAL(viewHashes[i], msHash.hashPacket(&packet), u32);
+		PTF_ASSERT_EQUAL(rawHashes[i], msHash.hashPacket(&packet), u32);
+	}
+
+	PTF_ASSERT_EQUAL(rawHashes[0], expectedHash, u32);
+	// ICMP has no ports so the 2-tuple is hashed
+	pcpp::iphdr* icmpIpHeader = views[2].getIPv4Header();
+	PTF_ASSERT_EQUAL(rawHashes[2], msHash.hashIPv4(icmpIpHeader->ipSrc, icmpIpHeader->ipDst), u32);
+	// non-IP packets get 0
+	PTF_ASSERT_EQUAL(rawHashes[3], 0, u32);
+} // ToeplitzHashTest
+
+
+
+// a straightforward reference of the Internet checksum of a single buffer, as defined in RFC 1071
+static uint16_t referenceChecksum(const uint8_t* data, size_t len)
+{
+	uint32_t sum = 0;
+	for (size_t i = 0; i + 1 < len; i += 2)
+		sum += (uint32_t)((data[i] << 8) | data[i + 1]);
+	if (len & 1)
+		sum += (uint32_t)(data[len - 1] << 8);
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)~sum;
+}
+
+PTF_TEST_CASE(ChecksumImplementationTest)
+{
+	pcpp::ChecksumImplementation defaultImpl = pcpp::getChecksumImplementation();
+	PTF_ASSERT_TRUE(pcpp::setChecksumImplementation(pcpp::ChecksumPortable));
+
+	// 9000 bytes (a jumbo frame) + some slack for misaligned starts
+	const size_t bufferLen = 9016;
+	uint8_t* buffer = new uint8_t[bufferLen];
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < bufferLen; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buffer[i] = (uint8_t)(seed >> 16);
+	}
+
+	pcpp::ChecksumImplementation impls[] = { pcpp::ChecksumPortable, pcpp::ChecksumSSE2, pcpp::ChecksumAVX2 };
+	const char* implNames[] = { "portable", "SSE2", "AVX2" };
+	size_t lengths[] = { 0, 1, 2, 3, 15, 16, 17, 20, 31, 32, 33, 63, 64, 65, 127, 1499, 1500, 9000 };
+
+	for (size_t implIndex = 0; implIndex < sizeof(impls)/sizeof(impls[0]); implIndex++)
+	{
+		if (!pcpp::setChecksumImplementation(impls[implIndex]))
+		{
+			PTF_PRINT_VERBOSE("Checksum implementation %s isn't supported", implNames[implIndex]);
+			continue;
+		}
+
+		PTF_ASSERT_EQUAL(pcpp::getChecksumImplementation(), impls[implIndex], enum);
+
+		// single buffers of various lengths and alignments are identical to the reference implementation
+		for (size_t lenIndex = 0; lenIndex < sizeof(lengths)/sizeof(lengths[0]); lenIndex++)
+		{
+			for (size_t offset = 0; offset < 4; offset++)
+			{
+				pcpp::ScalarBuffer<uint16_t> vec[1];
+				vec[0].buffer = (uint16_t*)(buffer + offset);
+				vec[0].len = lengths[lenIndex];
+				PTF_ASSERT_EQUAL(pcpp::compute_checksum(vec, 1), referenceChecksum(buffer + offset, lengths[lenIndex]), u16);
+			}
+		}
+
+		// all ones data exercises the carries of the wide accumulators
+		uint8_t* allOnes = new uint8_t[9000];
+		memset(allOnes, 0xff, 9000);
+		pcpp::ScalarBuffer<uint16_t> allOnesVec[1] = { { (uint16_t*)allOnes, 9000 } };
+		PTF_ASSERT_EQUAL(pcpp::compute_checksum(allOnesVec, 1), referenceChecksum(allOnes, 9000), u16);
+		delete [] allOnes;
+
+		// multiple buffers, like a pseudo header followed by a segment
+		pcpp::ScalarBuffer<uint16_t> multiVec[2] = { { (uint16_t*)buffer, 12 }, { (uint16_t*)(buffer + 101), 1481 } };
+		pcpp::setChecksumImplementation(pcpp::ChecksumPortable);
+		uint16_t expectedMulti = pcpp::compute_checksum(multiVec, 2);
+		pcpp::setChecksumImplementation(impls[implIndex]);
+		PTF_ASSERT_EQUAL(pcpp::compute_checksum(multiVec, 2), expectedMulti, u16);
+
+		// microbenchmark: checksum of a jumbo frame
+		pcpp::ScalarBuffer<uint16_t> jumboVec[1] = { { (uint16_t*)buffer, 9000 } };
+		const int iterations = 20000;
+		uint16_t dummy = 0;
+		timeval start, end;
+		gettimeofday(&start, NULL);
+		for (int i = 0; i < iterations; i++)
+			dummy ^= pcpp::compute_checksum(jumboVec, 1);
+		gettimeofday(&end, NULL);
+		double nsPerCall = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_usec - start.tv_usec) * 1e3) / iterations;
+		PTF_PRINT_VERBOSE("Checksum implementation %s: %.1f ns per 9000 bytes (%.2f GB/s) [%X]", implNames[implIndex], nsPerCall, 9000 / nsPerCall, dummy);
+	}
+
+	delete [] buffer;
+	PTF_ASSERT_TRUE(pcpp::setChecksumImplementation(defaultImpl));
+} // ChecksumImplementationTest
+
+
+
+PTF_TEST_CASE(IncrementalChecksumTest)
+{
+	// update_checksum() gives the same result as computing the checksum again
+	uint8_t buffer[1500];
+	uint32_t seed = 777;
+	for (size_t i = 0; i < sizeof(buffer); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		buffer[i] = (uint8_t)(seed >> 16);
+	}
+
+	pcpp::ScalarBuffer<uint16_t> vec[1] = { { (uint16_t*)buffer, sizeof(buffer) } };
+	uint16_t checksum = htobe16(pcpp::compute_checksum(vec, 1));
+	for (int i = 0; i < 100; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t offset = (seed >> 8) % (sizeof(buffer) - 16) & ~(size_t)1;
+		uint8_t oldData[16];
+		memcpy(oldData, buffer + offset, sizeof(oldData));
+		for (size_t j = 0; j < sizeof(oldData); j++)
+			buffer[offset + j] = (uint8_t)(seed >> j);
+
+		if (i % 2 == 0)
+		{
+			uint16_t oldValue, newValue;
+			memcpy(&oldValue, oldData, sizeof(oldValue));
+			memcpy(&newValue, buffer + offset, sizeof(newValue));
+			memcpy(buffer + offset + 2, oldData + 2, sizeof(oldData) - 2);
+			checksum = pcpp::update_checksum(checksum, oldValue, newValue);
+		}
+		else
+			checksum = pcpp::update_checksum(checksum, oldData, buffer + offset, sizeof(oldData));
+
+		PTF_ASSERT_EQUAL(checksum, htobe16(pcpp::compute_checksum(vec, 1)), u16);
+	}
+
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/Dns1.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/gtp-u2.dat");
+
+	// TCP: rewrite the addresses, the TTL and the ports like a NAT and compare to full recalculation
+	pcpp::Packet tcpPacket(&rawPacket1);
+	pcpp::IPv4Layer* ipLayer = tcpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = tcpPacket.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_NOT_NULL(tcpLayer);
+	PTF_ASSERT_EQUAL(tcpLayer->getSrcPort(), 60378, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getDstPort(), 80, u16);
+
+	ipLayer->setSrcIpAddress(pcpp::IPv4Address(std::string("10.20.30.40")), true);
+	ipLayer->setDstIpAddress(pcpp::IPv4Address(std::string("192.168.255.1")), true);
+	ipLayer->setTimeToLive(ipLayer->getIPv4Header()->timeToLive - 1, true);
+	tcpLayer->setSrcPort(1234, true);
+	tcpLayer->setDstPort(8080, true);
+	PTF_ASSERT_EQUAL(tcpLayer->getSrcPort(), 1234, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getDstPort(), 8080, u16);
+	PTF_ASSERT_EQUAL(ipLayer->getSrcIpAddress().toString(), "10.20.30.40", string);
+
+	uint16_t ipChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	uint16_t tcpChecksum = tcpLayer->getTcpHeader()->headerChecksum;
+	tcpPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, tcpChecksum, u16);
+
+	// without updating checksums only the fields change
+	ipLayer->setSrcIpAddress(pcpp::IPv4Address(std::string("1.1.1.1")));
+	tcpLayer->setSrcPort(4321);
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, tcpChecksum, u16);
+
+	// UDP
+	pcpp::Packet udpPacket(&rawPacket2);
+	ipLayer = udpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::UdpLayer* udpLayer = udpPacket.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_NOT_NULL(udpLayer);
+	PTF_ASSERT_EQUAL(udpLayer->getSrcPort(), 53, u16);
+
+	ipLayer->setDstIpAddress(pcpp::IPv4Address(std::string("172.16.0.99")), true);
+	udpLayer->setSrcPort(5353, true);
+	udpLayer->setDstPort(40000, true);
+	PTF_ASSERT_EQUAL(udpLayer->getSrcPort(), 5353, u16);
+	PTF_ASSERT_EQUAL(udpLayer->getDstPort(), 40000, u16);
+
+	ipChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	uint16_t udpChecksum = udpLayer->getUdpHeader()->headerChecksum;
+	udpPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum, u16);
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, udpChecksum, u16);
+
+	// a zero UDP checksum means no checksum and stays zero
+	pcpp::Packet gtpPacket(&rawPacket3);
+	ipLayer = gtpPacket.getLayerOfType<pcpp::IPv4Layer>();
+	udpLayer = gtpPacket.getLayerOfType<pcpp::UdpLayer>();
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, 0, u16);
+	ipLayer->setSrcIpAddress(pcpp::IPv4Address(std::string("10.0.0.1")), true);
+	udpLayer->setDstPort(2153, true);
+	PTF_ASSERT_EQUAL(udpLayer->getUdpHeader()->headerChecksum, 0, u16);
+	ipChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	ipLayer->computeCalculateFields();
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, ipChecksum, u16);
+} // IncrementalChecksumTest
+
+
+
+PTF_TEST_CASE(ModifiedLayersTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+
+	pcpp::Packet packet(&rawPacket1);
+	pcpp::EthLayer* ethLayer = packet.getLayerOfType<pcpp::EthLayer>();
+	pcpp::IPv4Layer* ipLayer = packet.getLayerOfType<pcpp::IPv4Layer>();
+	pcpp::TcpLayer* tcpLayer = packet.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_NOT_NULL(ethLayer);
+	PTF_ASSERT_NOT_NULL(ipLayer);
+	PTF_ASSERT_NOT_NULL(tcpLayer);
+	PTF_ASSERT_FALSE(ethLayer->isModified());
+	PTF_ASSERT_FALSE(ipLayer->isModified());
+	PTF_ASSERT_FALSE(tcpLayer->isModified());
+
+	uint16_t origIpChecksum = ipLayer->getIPv4Header()->headerChecksum;
+	uint16_t origTcpChecksum = tcpLayer->getTcpHeader()->headerChecksum;
+
+	// untracked changes to the checksums let us see which layers are recalculated
+	ipLayer->getIPv4Header()->headerChecksum = 0xdead;
+	tcpLayer->getTcpHeader()->headerChecksum = 0xbeef;
+
+	// rewriting the MAC addresses recalculates only the Ethernet layer
+	ethLayer->setSourceMac(pcpp::MacAddress("aa:bb:cc:dd:ee:ff"));
+	ethLayer->setDestMac(pcpp::MacAddress("11:22:33:44:55:66"));
+	PTF_ASSERT_TRUE(ethLayer->isModified());
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_FALSE(ethLayer->isModified());
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, 0xdead, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, 0xbeef, u16);
+
+	// nothing is modified so nothing is recalculated
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, 0xdead, u16);
+
+	// a modified IP layer is recalculated along with the TCP layer whose checksum covers the pseudo header
+	ipLayer->markAsModified();
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, origIpChecksum, u16);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, origTcpChecksum, u16);
+	PTF_ASSERT_FALSE(ipLayer->isModified());
+
+	// a modified TCP layer causes the IP layer below it to be recalculated
+	ipLayer->getIPv4Header()->headerChecksum = 0xdead;
+	tcpLayer->setDstPort(8080);
+	PTF_ASSERT_TRUE(tcpLayer->isModified());
+	PTF_ASSERT_FALSE(ipLayer->isModified());
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, origIpChecksum, u16);
+	PTF_ASSERT_NOT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, origTcpChecksum, u16);
+	uint16_t tcpChecksum = tcpLayer->getTcpHeader()->headerChecksum;
+
+	// setters that update checksums incrementally don't mark the layer
+	tcpLayer->setDstPort(80, true);
+	PTF_ASSERT_FALSE(tcpLayer->isModified());
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, origTcpChecksum, u16);
+
+	// extending a layer marks it and the IP total length is updated
+	size_t ipTotalLen = be16toh(ipLayer->getIPv4Header()->totalLength);
+	PTF_ASSERT_FALSE(tcpLayer->addTcpOption(pcpp::TcpOptionBuilder(pcpp::TcpOptionBuilder::NOP)).isNull());
+	PTF_ASSERT_TRUE(tcpLayer->isModified());
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(be16toh(ipLayer->getIPv4Header()->totalLength), ipTotalLen + 4, size);
+
+	// the full calculation still recalculates all layers
+	ipLayer->getIPv4Header()->headerChecksum = 0xdead;
+	tcpLayer->getTcpHeader()->headerChecksum = 0xbeef;
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, 0xbeef, u16);
+	packet.computeCalculateFields();
+	PTF_ASSERT_NOT_EQUAL(ipLayer->getIPv4Header()->headerChecksum, 0xdead, u16);
+	PTF_ASSERT_NOT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, 0xbeef, u16);
+	PTF_ASSERT_NOT_EQUAL(tcpLayer->getTcpHeader()->headerChecksum, tcpChecksum, u16);
+
+	// removing a layer marks the layers around it
+	PTF_ASSERT_TRUE(packet.removeLayer(pcpp::TCP));
+	PTF_ASSERT_TRUE(ipLayer->isModified());
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_FALSE(ipLayer->isModified());
+	PTF_ASSERT_EQUAL(be16toh(ipLayer->getIPv4Header()->totalLength), ipLayer->getDataLen(), size);
+
+	// added layers are marked
+	pcpp::UdpLayer* udpLayer = new pcpp::UdpLayer(1000, 2000);
+	PTF_ASSERT_TRUE(packet.insertLayer(ipLayer, udpLayer, true));
+	PTF_ASSERT_TRUE(udpLayer->isModified());
+	packet.computeCalculateFields(true);
+	PTF_ASSERT_EQUAL(ipLayer->getIPv4Header()->protocol, pcpp::PACKETPP_IPPROTO_UDP, u8);
+	PTF_ASSERT_EQUAL(be16toh(udpLayer->getUdpHeader()->length), udpLayer->getDataLen(), size);
+} // ModifiedLayersTest
+
+
+
+PTF_TEST_CASE(PacketHeadroomTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpRequests1.dat");
+
+	// the same encapsulation and decapsulation is done on a packet with headroom and on a packet without it
+	pcpp::Packet packet(&rawPacket1);
+	pcpp::Packet refPacket(&rawPacket2);
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 0, size);
+	PTF_ASSERT_TRUE(packet.reserveHeadroom(64));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 64, size);
+	PTF_ASSERT_TRUE(packet.reserveHeadroom(32));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 64, size);
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getRawDataLen(), refPacket.getRawPacket()->getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(packet.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawDataLen());
+
+	pcpp::TcpLayer* tcpLayer = packet.getLayerOfType<pcpp::TcpLayer>();
+	const uint8_t* tcpData = tcpLayer->getData();
+
+	// push a VLAN tag after the Ethernet header: only the Ethernet header is moved
+	pcpp::VlanLayer* vlanLayer = new pcpp::VlanLayer(100, false, 1, PCPP_ETHERTYPE_IP);
+	PTF_ASSERT_TRUE(packet.insertLayer(packet.getFirstLayer(), vlanLayer, true));
+	PTF_ASSERT_TRUE(refPacket.insertLayer(refPacket.getFirstLayer(), new pcpp::VlanLayer(100, false, 1, PCPP_ETHERTYPE_IP), true));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 60, size);
+	PTF_ASSERT_TRUE(tcpLayer->getData() == tcpData);
+	PTF_ASSERT_TRUE(packet.getLayerOfType<pcpp::EthLayer>()->getNextLayer() == vlanLayer);
+
+	// push an outer Ethernet + MPLS encapsulation in front of the packet
+	pcpp::EthLayer* outerEth = new pcpp::EthLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"), PCPP_ETHERTYPE_MPLS);
+	PTF_ASSERT_TRUE(packet.insertLayer(NULL, outerEth, true));
+	PTF_ASSERT_TRUE(packet.insertLayer(outerEth, new pcpp::MplsLayer(1000, 64, 0, true), true));
+	PTF_ASSERT_TRUE(refPacket.insertLayer(NULL, new pcpp::EthLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"), PCPP_ETHERTYPE_MPLS), true));
+	PTF_ASSERT_TRUE(refPacket.insertLayer(refPacket.getFirstLayer(), new pcpp::MplsLayer(1000, 64, 0, true), true));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 60 - 14 - 4, size);
+	PTF_ASSERT_TRUE(tcpLayer->getData() == tcpData);
+
+	packet.computeCalculateFields();
+	refPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getRawDataLen(), refPacket.getRawPacket()->getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(packet.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawDataLen());
+	PTF_ASSERT_TRUE(packet.isPacketOfType(pcpp::MPLS));
+
+	// a copy keeps the headroom
+	pcpp::Packet packetCopy(packet);
+	PTF_ASSERT_EQUAL(packetCopy.getRawPacket()->getHeadroom(), 42, size);
+	PTF_ASSERT_TRUE(packetCopy.insertLayer(packetCopy.getFirstLayer(), new pcpp::VlanLayer(200, false, 0, PCPP_ETHERTYPE_MPLS), true));
+	PTF_ASSERT_EQUAL(packetCopy.getRawPacket()->getHeadroom(), 38, size);
+
+	// decapsulation returns the space to the headroom without moving the rest of the packet
+	PTF_ASSERT_TRUE(packet.removeFirstLayer());
+	PTF_ASSERT_TRUE(packet.removeFirstLayer());
+	PTF_ASSERT_TRUE(packet.removeLayer(pcpp::VLAN));
+	PTF_ASSERT_TRUE(refPacket.removeFirstLayer());
+	PTF_ASSERT_TRUE(refPacket.removeFirstLayer());
+	PTF_ASSERT_TRUE(refPacket.removeLayer(pcpp::VLAN));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 64, size);
+	PTF_ASSERT_TRUE(tcpLayer->getData() == tcpData);
+	packet.computeCalculateFields();
+	refPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getRawDataLen(), rawPacket2.getRawDataLen(), int);
+	PTF_ASSERT_BUF_COMPARE(packet.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawData(), refPacket.getRawPacket()->getRawDataLen());
+
+	// extending the packet beyond its capacity keeps the headroom
+	PTF_ASSERT_TRUE(packet.addLayer(new pcpp::PayloadLayer(tcpData, 1000, false), true));
+	PTF_ASSERT_EQUAL(packet.getRawPacket()->getHeadroom(), 64, size);
+
+	// a new packet with headroom
+	pcpp::Packet newPacket(100, 32);
+	PTF_ASSERT_EQUAL(newPacket.getRawPacket()->getHeadroom(), 32, size);
+	PTF_ASSERT_EQUAL(newPacket.getRawPacket()->getTailroom(), 100, size);
+	pcpp::EthLayer* ethLayer = new pcpp::EthLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb"));
+	PTF_ASSERT_TRUE(newPacket.addLayer(ethLayer, true));
+	PTF_ASSERT_TRUE(newPacket.addLayer(new pcpp::IPv4Layer(pcpp::IPv4Address(std::string("1.1.1.1")), pcpp::IPv4Address(std::string("2.2.2.2"))), true));
+	PTF_ASSERT_EQUAL(newPacket.getRawPacket()->getTailroom(), 100 - 14 - 20, size);
+	PTF_ASSERT_TRUE(newPacket.insertLayer(ethLayer, new pcpp::VlanLayer(300, false, 0, PCPP_ETHERTYPE_IP), true));
+	PTF_ASSERT_EQUAL(newPacket.getRawPacket()->getHeadroom(), 28, size);
+	newPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType<pcpp::VlanLayer>()->getVlanID(), 300, u16);
+	PTF_ASSERT_EQUAL(newPacket.getLayerOfType<pcpp::IPv4Layer>()->getDstIpAddress().toString(), "2.2.2.2", string);
+} // PacketHeadroomTest
+
+
+
+PTF_TEST_CASE(MovePacketTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+
+	// adopt the buffer of a raw packet, then release it and hand it to a third raw packet
+	const uint8_t* origData = rawPacket1.getRawData();
+	int origDataLen = rawPacket1.getRawDataLen();
+	pcpp::RawPacket adoptingRawPacket;
+	PTF_ASSERT_TRUE(adoptingRawPacket.adoptRawData(rawPacket1));
+	PTF_ASSERT_TRUE(adoptingRawPacket.getRawData() == origData);
+	PTF_ASSERT_EQUAL(adoptingRawPacket.getRawDataLen(), origDataLen, int);
+	PTF_ASSERT_TRUE(adoptingRawPacket.isPacketSet());
+	PTF_ASSERT_FALSE(rawPacket1.isPacketSet());
+	PTF_ASSERT_TRUE(rawPacket1.getRawData() == NULL);
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataLen(), 0, int);
+
+	size_t headroom = 1;
+	uint8_t* releasedData = adoptingRawPacket.releaseRawData(&headroom);
+	PTF_ASSERT_TRUE(releasedData == origData);
+	PTF_ASSERT_EQUAL(headroom, 0, size);
+	PTF_ASSERT_FALSE(adoptingRawPacket.isPacketSet());
+	PTF_ASSERT_TRUE(adoptingRawPacket.releaseRawData() == NULL);
+	rawPacket1.setRawData(releasedData, origDataLen, time);
+
+	// releasing a buffer with headroom without asking for the headroom moves the data to the beginning of the buffer
+	pcpp::RawPacket rawPacketWithHeadroom(rawPacket1);
+	PTF_ASSERT_TRUE(rawPacketWithHeadroom.reallocateData(origDataLen, 16));
+	uint8_t* bufferStart = (uint8_t*)rawPacketWithHeadroom.getRawData() - 16;
+	releasedData = rawPacketWithHeadroom.releaseRawData();
+	PTF_ASSERT_TRUE(releasedData == bufferStart);
+	PTF_ASSERT_BUF_COMPARE(releasedData, rawPacket1.getRawData(), origDataLen);
+	delete [] releasedData;
+
+	// a raw packet that doesn't own its data can't release it
+	pcpp::RawPacket notOwningRawPacket(rawPacket1.getRawData(), origDataLen, time, false);
+	PTF_ASSERT_TRUE(notOwningRawPacket.releaseRawData() == NULL);
+
+#if __cplusplus > 199711L || _MSC_VER >= 1800
+	// move raw packets
+	pcpp::RawPacket movedRawPacket(std::move(rawPacket1));
+	PTF_ASSERT_TRUE(movedRawPacket.getRawData() == origData);
+	PTF_ASSERT_FALSE(rawPacket1.isPacketSet());
+	rawPacket1 = std::move(movedRawPacket);
+	PTF_ASSERT_TRUE(rawPacket1.getRawData() == origData);
+	PTF_ASSERT_EQUAL(rawPacket1.getRawDataLen(), origDataLen, int);
+	PTF_ASSERT_TRUE(movedRawPacket.getRawData() == NULL);
+
+	// move a parsed packet: neither the data nor the layers are copied
+	pcpp::Packet packet(&rawPacket1);
+	pcpp::TcpLayer* tcpLayer = packet.getLayerOfType<pcpp::TcpLayer>();
+	pcpp::Packet movedPacket(std::move(packet));
+	PTF_ASSERT_TRUE(movedPacket.getRawPacket() == &rawPacket1);
+	PTF_ASSERT_TRUE(movedPacket.getLayerOfType<pcpp::TcpLayer>() == tcpLayer);
+	PTF_ASSERT_TRUE(packet.getRawPacket() == NULL);
+	PTF_ASSERT_TRUE(packet.getFirstLayer() == NULL);
+	PTF_ASSERT_FALSE(packet.isPacketOfType(pcpp::TCP));
+
+	// the moved layers belong to the new packet, so modifying them changes the new packet
+	PTF_ASSERT_TRUE(movedPacket.insertLayer(movedPacket.getFirstLayer(), new pcpp::VlanLayer(100, false, 1, PCPP_ETHERTYPE_IP), true));
+	PTF_ASSERT_TRUE(movedPacket.isPacketOfType(pcpp::VLAN));
+	PTF_ASSERT_EQUAL(movedPacket.getRawPacket()->getRawDataLen(), origDataLen + 4, int);
+	movedPacket.computeCalculateFields();
+	PTF_ASSERT_EQUAL(movedPacket.getLayerOfType<pcpp::TcpLayer>()->getSrcPort(), 60378, u16);
+
+	// a lazily parsed packet keeps parsing on demand after it's moved
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpRequests1.dat");
+	pcpp::Packet lazyPacket(&rawPacket2, false, pcpp::UnknownProtocol, pcpp::OsiModelLayerUnknown, NULL, true);
+	pcpp::Packet movedLazyPacket(std::move(lazyPacket));
+	PTF_ASSERT_NOT_NULL(movedLazyPacket.getLayerOfType<pcpp::HttpRequestLayer>());
+	PTF_ASSERT_TRUE(movedLazyPacket.getLayerOfType<pcpp::HttpRequestLayer>()->getPrevLayer() == movedLazyPacket.getLayerOfType<pcpp::TcpLayer>());
+
+	// move assignment frees the layers of the assigned packet
+	pcpp::Packet newPacket(100);
+	newPacket.addLayer(new pcpp::EthLayer(pcpp::MacAddress("00:11:22:33:44:55"), pcpp::MacAddress("66:77:88:99:aa:bb")), true);
+	newPacket = std::move(movedLazyPacket);
+	PTF_ASSERT_TRUE(newPacket.getRawPacket() == &rawPacket2);
+	PTF_ASSERT_TRUE(newPacket.isPacketOfType(pcpp::HTTPRequest));
+	PTF_ASSERT_TRUE(movedLazyPacket.getRawPacket() == NULL);
+#endif
+} // MovePacketTest
+
+
+
+PTF_TEST_CASE(CopyOnWritePacketTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TwoHttpRequests1.dat");
+	pcpp::RawPacket* sharedRawPacket = new pcpp::RawPacket(rawPacket1);
+	const uint8_t* sharedData = sharedRawPacket->getRawData();
+
+	pcpp::Packet* original = new pcpp::Packet(sharedRawPacket, true);
+	PTF_ASSERT_FALSE(original->isRawDataShared());
+
+	// read-only clones share the raw packet and parse only what they look at
+	pcpp::Packet clone1(*original, true);
+	pcpp::Packet clone2(*original, true);
+	pcpp::Packet clone3(clone2, true);
+	PTF_ASSERT_TRUE(original->isRawDataShared());
+	PTF_ASSERT_TRUE(clone1.getRawPacket() == sharedRawPacket);
+	PTF_ASSERT_TRUE(clone3.getRawPacket() == sharedRawPacket);
+	PTF_ASSERT_TRUE(clone1.isLazyParsing());
+	PTF_ASSERT_EQUAL(clone1.getNumOfLayerAllocations(), 1, u64);
+	PTF_ASSERT_NOT_NULL(clone1.getLayerOfType<pcpp::TcpLayer>());
+	PTF_ASSERT_TRUE(clone1.getLayerOfType<pcpp::TcpLayer>()->getData() == original->getLayerOfType<pcpp::TcpLayer>()->getData());
+	PTF_ASSERT_EQUAL(clone1.getLayerOfType<pcpp::TcpLayer>()->getSrcPort(), 60378, u16);
+
+	// modifying a clone copies the data for that clone only
+	pcpp::IPv4Layer* ipLayer = clone2.getLayerOfType<pcpp::IPv4Layer>();
+	ipLayer->setDstIpAddress(pcpp::IPv4Address(std::string("10.0.0.1")), true);
+	PTF_ASSERT_FALSE(clone2.isRawDataShared());
+	PTF_ASSERT_TRUE(clone2.getRawPacket() != sharedRawPacket);
+	PTF_ASSERT_TRUE(ipLayer->getData() != original->getLayerOfType<pcpp::IPv4Layer>()->getData());
+	PTF_ASSERT_EQUAL(ipLayer->getDstIpAddress().toString(), "10.0.0.1", string);
+	PTF_ASSERT_NOT_EQUAL(original->getLayerOfType<pcpp::IPv4Layer>()->getDstIpAddress().toString(), "10.0.0.1", string);
+	PTF_ASSERT_NOT_EQUAL(clone3.getLayerOfType<pcpp::IPv4Layer>()->getDstIpAddress().toString(), "10.0.0.1", string);
+	PTF_ASSERT_TRUE(sharedRawPacket->getRawData() == sharedData);
+	PTF_ASSERT_BUF_COMPARE(sharedData, rawPacket1.getRawData(), rawPacket1.getRawDataLen());
+
+	// the checksums updated on the copy are the same as if they were calculated from scratch
+	pcpp::Packet modifiedClone(clone2);
+	modifiedClone.computeCalculateFields();
+	PTF_ASSERT_BUF_COMPARE(clone2.getRawPacket()->getRawData(), modifiedClone.getRawPacket()->getRawData(), modifiedClone.getRawPacket()->getRawDataLen());
+
+	// structural changes copy the data too, and the layers that were already parsed point to the copy
+	pcpp::EthLayer* ethLayer = clone3.getLayerOfType<pcpp::EthLayer>();
+	PTF_ASSERT_TRUE(clone3.insertLayer(ethLayer, new pcpp::VlanLayer(100, false, 1, PCPP_ETHERTYPE_IP), true));
+	PTF_ASSERT_FALSE(clone3.isRawDataShared());
+	PTF_ASSERT_TRUE(clone3.isPacketOfType(pcpp::VLAN));
+	PTF_ASSERT_FALSE(original->isPacketOfType(pcpp::VLAN));
+	PTF_ASSERT_EQUAL(clone3.getRawPacket()->getRawDataLen(), rawPacket1.getRawDataLen() + 4, int);
+	PTF_ASSERT_TRUE(sharedRawPacket->getRawData() == sharedData);
+
+	// the original is freed so clone1 is the last packet using the raw packet, which isn't shared anymore
+	delete original;
+	PTF_ASSERT_FALSE(clone1.isRawDataShared());
+	PTF_ASSERT_EQUAL(clone1.getLayerOfType<pcpp::HttpRequestLayer>()->getFirstLine()->getUri(), "/home/0,7340,L-8,00.html", string);
+
+	// explicit makeWritable() before writing to the layer data directly. clone1 is the last packet using the raw packet, so
+	// it keeps the raw packet instead of copying it
+	clone1.makeWritable();
+	PTF_ASSERT_FALSE(clone1.isRawDataShared());
+	PTF_ASSERT_TRUE(clone1.getRawPacket() == sharedRawPacket);
+	PTF_ASSERT_TRUE(clone1.getRawPacket()->getRawData() == sharedData);
+	clone1.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->timeToLive = 1;
+	PTF_ASSERT_EQUAL(clone1.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->timeToLive, 1, u8);
+
+	// a clone of a packet that doesn't own its raw packet doesn't free it
+	{
+		pcpp::Packet notOwning(&rawPacket1);
+		pcpp::Packet notOwningClone(notOwning, true);
+		PTF_ASSERT_TRUE(notOwningClone.getRawPacket() == &rawPacket1);
+	}
+	PTF_ASSERT_TRUE(rawPacket1.isPacketSet());
+
+	// copyOnWrite set to false is a regular copy
+	pcpp::Packet fullCopy(clone1, false);
+	PTF_ASSERT_FALSE(fullCopy.isRawDataShared());
+	PTF_ASSERT_TRUE(fullCopy.getRawPacket() != clone1.getRawPacket());
+	PTF_ASSERT_FALSE(fullCopy.isLazyParsing());
+
+	// a packet whose clones were all destructed isn't shared anymore, and modifying it doesn't copy the raw packet
+	{
+		pcpp::Packet tempClone(fullCopy, true);
+		PTF_ASSERT_TRUE(fullCopy.isRawDataShared());
+		PTF_ASSERT_TRUE(tempClone.isRawDataShared());
+	}
+	PTF_ASSERT_FALSE(fullCopy.isRawDataShared());
+	pcpp::RawPacket* fullCopyRawPacket = fullCopy.getRawPacket();
+	const uint8_t* fullCopyData = fullCopyRawPacket->getRawData();
+	fullCopy.getLayerOfType<pcpp::IPv4Layer>()->setTimeToLive(2);
+	PTF_ASSERT_TRUE(fullCopy.getRawPacket() == fullCopyRawPacket);
+	PTF_ASSERT_TRUE(fullCopy.getRawPacket()->getRawData() == fullCopyData);
+	PTF_ASSERT_EQUAL(fullCopy.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->timeToLive, 2, u8);
+} // CopyOnWritePacketTest
+
+
+
+PTF_TEST_CASE(CopyOnWriteSettersTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/ArpRequestWithVlan.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/MplsPackets1.dat");
+	READ_FILE_AND_CREATE_PACKET(3, "PacketExamples/Dns1.dat");
+	READ_FILE_AND_CREATE_PACKET(4, "PacketExamples/TwoHttpRequests1.dat");
+
+	// field setters of a clone copy the data for that clone only, so the data the other clones see doesn't change
+	pcpp::Packet vlanOriginal(new pcpp::RawPacket(rawPacket1), true);
+	pcpp::Packet vlanClone1(vlanOriginal, true);
+	pcpp::Packet vlanClone2(vlanOriginal, true);
+	pcpp::VlanLayer* vlanLayer = vlanClone1.getLayerOfType<pcpp::VlanLayer>();
+	PTF_ASSERT_NOT_NULL(vlanLayer);
+	uint16_t vlanID = vlanLayer->getVlanID();
+	vlanLayer->setVlanID(vlanID + 1);
+	vlanLayer->setPriority(7);
+	PTF_ASSERT_FALSE(vlanClone1.isRawDataShared());
+	PTF_ASSERT_EQUAL(vlanLayer->getVlanID(), vlanID + 1, u16);
+	PTF_ASSERT_EQUAL(vlanClone2.getLayerOfType<pcpp::VlanLayer>()->getVlanID(), vlanID, u16);
+	PTF_ASSERT_EQUAL(vlanOriginal.getLayerOfType<pcpp::VlanLayer>()->getVlanID(), vlanID, u16);
+	PTF_ASSERT_BUF_COMPARE(vlanClone2.getRawPacket()->getRawData(), rawPacket1.getRawData(), rawPacket1.getRawDataLen());
+
+	pcpp::Packet mplsOriginal(new pcpp::RawPacket(rawPacket2), true);
+	pcpp::Packet mplsClone1(mplsOriginal, true);
+	pcpp::Packet mplsClone2(mplsOriginal, true);
+	pcpp::MplsLayer* mplsLayer = mplsClone1.getLayerOfType<pcpp::MplsLayer>();
+	PTF_ASSERT_NOT_NULL(mplsLayer);
+	uint8_t mplsTTL = mplsLayer->getTTL();
+	mplsLayer->setTTL(mplsTTL - 1);
+	PTF_ASSERT_TRUE(mplsLayer->setMplsLabel(0x12345));
+	PTF_ASSERT_EQUAL(mplsLayer->getTTL(), mplsTTL - 1, u8);
+	PTF_ASSERT_EQUAL(mplsClone2.getLayerOfType<pcpp::MplsLayer>()->getTTL(), mplsTTL, u8);
+	PTF_ASSERT_BUF_COMPARE(mplsClone2.getRawPacket()->getRawData(), rawPacket2.getRawData(), rawPacket2.getRawDataLen());
+
+	// setters of DNS resources and of HTTP first lines and header fields, which aren't layers, copy the data of their layer's packet
+	pcpp::Packet dnsOriginal(new pcpp::RawPacket(rawPacket3), true);
+	pcpp::Packet dnsClone1(dnsOriginal, true);
+	pcpp::Packet dnsClone2(dnsOriginal, true);
+	pcpp::DnsQuery* dnsQuery = dnsClone1.getLayerOfType<pcpp::DnsLayer>()->getFirstQuery();
+	PTF_ASSERT_NOT_NULL(dnsQuery);
+	dnsQuery->setDnsClass(pcpp::DNS_CLASS_CH);
+	PTF_ASSERT_EQUAL(dnsQuery->getDnsClass(), pcpp::DNS_CLASS_CH, enum);
+	PTF_ASSERT_NOT_EQUAL(dnsClone2.getLayerOfType<pcpp::DnsLayer>()->getFirstQuery()->getDnsClass(), pcpp::DNS_CLASS_CH, enum);
+	PTF_ASSERT_BUF_COMPARE(dnsClone2.getRawPacket()->getRawData(), rawPacket3.getRawData(), rawPacket3.getRawDataLen());
+
+	pcpp::Packet httpOriginal(new pcpp::RawPacket(rawPacket4), true);
+	pcpp::Packet httpClone1(httpOriginal, true);
+	pcpp::Packet httpClone2(httpOriginal, true);
+	pcpp::HttpRequestLayer* httpLayer = httpClone1.getLayerOfType<pcpp::HttpRequestLayer>();
+	PTF_ASSERT_NOT_NULL(httpLayer);
+	PTF_ASSERT_TRUE(httpLayer->getFirstLine()->setMethod(pcpp::HttpRequestLayer::HttpHEAD));
+	PTF_ASSERT_TRUE(httpLayer->getFieldByName(PCPP_HTTP_HOST_FIELD)->setFieldValue("www.example.com"));
+	PTF_ASSERT_EQUAL(httpLayer->getFirstLine()->getMethod(), pcpp::HttpRequestLayer::HttpHEAD, enum);
+	PTF_ASSERT_EQUAL(httpClone2.getLayerOfType<pcpp::HttpRequestLayer>()->getFirstLine()->getMethod(), pcpp::HttpRequestLayer::HttpGET, enum);
+	PTF_ASSERT_BUF_COMPARE(httpClone2.getRawPacket()->getRawData(), rawPacket4.getRawData(), rawPacket4.getRawDataLen());
+} // CopyOnWriteSettersTest
+
+
+
+static pcpp::Layer* parseTestPortAsPayload(uint8_t* data, size_t dataLen, pcpp::Layer* prevLayer, pcpp::Packet* packet)
+{
+	// accept only payloads that start with 'G' to test falling back to the next parser
+	if (dataLen == 0 || data[0] != 'G')
+		return NULL;
+
+	return new(packet) pcpp::PayloadLayer(data, dataLen, prevLayer, packet);
+}
+
+PTF_TEST_CASE(NextLayerRegistryTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/Dns1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/TwoHttpRequests1.dat");
+
+	pcpp::NextLayerRegistry& registry = pcpp::NextLayerRegistry::getInstance();
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::UdpPortTable, 53, pcpp::DNS));
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::TcpPortTable, 80, pcpp::HTTP));
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::EtherTypeTable, PCPP_ETHERTYPE_IP, pcpp::IPv4));
+	PTF_ASSERT_FALSE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::UdpPortTable, 5000, pcpp::DNS));
+
+	// disable DNS parsing
+	PTF_ASSERT_TRUE(registry.unregisterProtocol(pcpp::NextLayerRegistry::UdpPortTable, pcpp::DNS));
+	PTF_ASSERT_FALSE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::UdpPortTable, 53, pcpp::DNS));
+	{
+		pcpp::Packet dnsPacket(&rawPacket1);
+		PTF_ASSERT_FALSE(dnsPacket.isPacketOfType(pcpp::DNS));
+		PTF_ASSERT_NOT_NULL(dnsPacket.getLayerOfType<pcpp::PayloadLayer>());
+	}
+	registry.resetToDefault();
+	{
+		pcpp::Packet dnsPacket(&rawPacket1);
+		PTF_ASSERT_TRUE(dnsPacket.isPacketOfType(pcpp::DNS));
+	}
+
+	// classify DNS on a non-standard port
+	{
+		pcpp::Packet dnsPacket(&rawPacket1);
+		dnsPacket.getLayerOfType<pcpp::UdpLayer>()->setSrcPort(5000);
+		dnsPacket.getLayerOfType<pcpp::UdpLayer>()->setDstPort(5001);
+	}
+	{
+		pcpp::Packet dnsPacket(&rawPacket1);
+		PTF_ASSERT_FALSE(dnsPacket.isPacketOfType(pcpp::DNS));
+	}
+	PTF_ASSERT_TRUE(registry.registerProtocol(pcpp::NextLayerRegistry::UdpPortTable, 5001, pcpp::DNS));
+	PTF_ASSERT_FALSE(registry.registerProtocol(pcpp::NextLayerRegistry::UdpPortTable, 5001, pcpp::HTTP));
+	{
+		pcpp::Packet dnsPacket(&rawPacket1);
+		PTF_ASSERT_TRUE(dnsPacket.isPacketOfType(pcpp::DNS));
+		PTF_ASSERT_EQUAL(dnsPacket.getLayerOfType<pcpp::DnsLayer>()->getQueryCount(), 1, size);
+	}
+	PTF_ASSERT_TRUE(registry.unregisterProtocol(pcpp::NextLayerRegistry::UdpPortTable, 5001, pcpp::DNS));
+	PTF_ASSERT_FALSE(registry.unregisterProtocol(pcpp::NextLayerRegistry::UdpPortTable, 5001, pcpp::DNS));
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::UdpPortTable, 53, pcpp::DNS));
+
+	// a user parser is tried after the built-in parsers, and only if they didn't accept the payload
+	PTF_ASSERT_TRUE(registry.registerParser(pcpp::NextLayerRegistry::TcpPortTable, 60378, parseTestPortAsPayload, pcpp::GenericPayload, pcpp::NextLayerRegistry::MatchSrcPort));
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::TcpPortTable, 60378, pcpp::GenericPayload));
+	{
+		pcpp::Packet httpPacket(&rawPacket2);
+		PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::HTTPRequest));
+	}
+	PTF_ASSERT_TRUE(registry.unregisterProtocol(pcpp::NextLayerRegistry::TcpPortTable, 80, pcpp::HTTP));
+	{
+		pcpp::Packet httpPacket(&rawPacket2);
+		PTF_ASSERT_FALSE(httpPacket.isPacketOfType(pcpp::HTTP));
+		PTF_ASSERT_NOT_NULL(httpPacket.getLayerOfType<pcpp::PayloadLayer>());
+	}
+	PTF_ASSERT_TRUE(registry.unregisterParser(pcpp::NextLayerRegistry::TcpPortTable, 60378, parseTestPortAsPayload));
+	PTF_ASSERT_FALSE(registry.unregisterParser(pcpp::NextLayerRegistry::TcpPortTable, 60378, parseTestPortAsPayload));
+
+	// disable TCP parsing by registering a payload parser to its IP protocol
+	PTF_ASSERT_FALSE(registry.registerParser(pcpp::NextLayerRegistry::IPProtocolTable, 256, pcpp::NextLayerRegistry::parseAsPayload));
+	PTF_ASSERT_TRUE(registry.registerParser(pcpp::NextLayerRegistry::IPProtocolTable, pcpp::PACKETPP_IPPROTO_TCP, pcpp::NextLayerRegistry::parseAsPayload));
+	{
+		pcpp::Packet httpPacket(&rawPacket2);
+		PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::IPv4));
+		PTF_ASSERT_FALSE(httpPacket.isPacketOfType(pcpp::TCP));
+		PTF_ASSERT_NOT_NULL(httpPacket.getLayerOfType<pcpp::PayloadLayer>());
+	}
+
+	registry.resetToDefault();
+	PTF_ASSERT_TRUE(registry.isProtocolRegistered(pcpp::NextLayerRegistry::TcpPortTable, 80, pcpp::HTTP));
+	{
+		pcpp::Packet httpPacket(&rawPacket2);
+		PTF_ASSERT_TRUE(httpPacket.isPacketOfType(pcpp::HTTPRequest));
+	}
+} // NextLayerRegistryTest
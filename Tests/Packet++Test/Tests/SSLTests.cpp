@@ -480,4 +480,72 @@ PTF_TEST_CASE(SSLNewSessionTicketParseTest)
 	PTF_ASSERT_EQUAL(newSessionTicketMsg->getSessionTicketData()[0], 0, hex);
 	PTF_ASSERT_EQUAL(newSessionTicketMsg->getSessionTicketData()[16], 0xf9, hex);
 	PTF_ASSERT_EQUAL(newSessionTicketMsg->getSessionTicketData()[213], 0x75, hex);
-} // SSLNewSessionTicketParseTest
\ No newline at end of file
+} // SSLNewSessionTicketParseTest
+
+
+
+PTF_TEST_CASE(SSLFingerprintTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/SSL-ClientHello1.dat");
+	READ_FILE_AND_CREATE_PACKET(2, "PacketExamples/SSL-MultipleRecords1.dat");
+
+	pcpp::Packet clientHelloPacket(&rawPacket1);
+	pcpp::Packet serverHelloPacket(&rawPacket2);
+
+	pcpp::SSLHandshakeLayer* handshakeLayer = clientHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>();
+	PTF_ASSERT_NOT_NULL(handshakeLayer);
+	pcpp::SSLClientHelloMessage* clientHelloMessage = handshakeLayer->getHandshakeMessageOfType<pcpp::SSLClientHelloMessage>();
+	PTF_ASSERT_NOT_NULL(clientHelloMessage);
+
+	char fingerprint[256];
+	size_t fingerprintLen = 0;
+	char md5[PCPP_SSL_FINGERPRINT_MD5_BUFFER_SIZE];
+	std::string expectedJA3 = "771,49195-49199-49162-49161-49171-49172-51-57-47-53-10,0-65281-10-11-35-13172-16-5-13,23-24-25,0";
+
+	PTF_ASSERT_TRUE(clientHelloMessage->getJA3Fingerprint(fingerprint, sizeof(fingerprint), &fingerprintLen));
+	PTF_ASSERT_EQUAL(std::string(fingerprint), expectedJA3, string);
+	PTF_ASSERT_EQUAL(fingerprintLen, expectedJA3.length(), size);
+	PTF_ASSERT_TRUE(clientHelloMessage->getJA3FingerprintMD5(md5, sizeof(md5)));
+	PTF_ASSERT_EQUAL(std::string(md5), "07b4162d4db57554961824a21c4a0fde", string);
+
+	// buffers that are too small
+	PTF_ASSERT_FALSE(clientHelloMessage->getJA3Fingerprint(fingerprint, expectedJA3.length()));
+	PTF_ASSERT_TRUE(clientHelloMessage->getJA3Fingerprint(fingerprint, expectedJA3.length() + 1));
+	PTF_ASSERT_FALSE(clientHelloMessage->getJA3FingerprintMD5(md5, sizeof(md5) - 1));
+
+	char serverName[64];
+	size_t serverNameLen = 0;
+	PTF_ASSERT_TRUE(clientHelloMessage->getServerName(serverName, sizeof(serverName), &serverNameLen));
+	PTF_ASSERT_EQUAL(std::string(serverName), "www.google.com", string);
+	PTF_ASSERT_EQUAL(serverNameLen, 14, size);
+	PTF_ASSERT_FALSE(clientHelloMessage->getServerName(serverName, 14));
+
+	// GREASE values are ignored: turn the first cipher-suite into a GREASE value
+	uint16_t* firstCipherSuite = (uint16_t*)(clientHelloMessage->getClientHelloHeader()->random + 32 + clientHelloMessage->getSessionIDLength() + 3);
+	PTF_ASSERT_EQUAL(be16toh(*firstCipherSuite), 0xc02b, u16);
+	*firstCipherSuite = htobe16(0x3a3a);
+	PTF_ASSERT_TRUE(clientHelloMessage->getJA3Fingerprint(fingerprint, sizeof(fingerprint)));
+	PTF_ASSERT_EQUAL(std::string(fingerprint), "771,49199-49162-49161-49171-49172-51-57-47-53-10,0-65281-10-11-35-13172-16-5-13,23-24-25,0", string);
+	PTF_ASSERT_TRUE(clientHelloMessage->getJA3FingerprintMD5(md5, sizeof(md5)));
+	PTF_ASSERT_EQUAL(std::string(md5), "61d65345687a5ef847c6a594ef6e954b", string);
+	PTF_ASSERT_NULL(clientHelloMessage->getCipherSuite(0));
+	PTF_ASSERT_EQUAL(clientHelloMessage->getCipherSuite(1)->asString(), "TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256", string);
+
+	handshakeLayer = serverHelloPacket.getLayerOfType<pcpp::SSLHandshakeLayer>();
+	PTF_ASSERT_NOT_NULL(handshakeLayer);
+	pcpp::SSLServerHelloMessage* serverHelloMessage = handshakeLayer->getHandshakeMessageOfType<pcpp::SSLServerHelloMessage>();
+	PTF_ASSERT_NOT_NULL(serverHelloMessage);
+	PTF_ASSERT_TRUE(serverHelloMessage->getJA3SFingerprint(fingerprint, sizeof(fingerprint), &fingerprintLen));
+	PTF_ASSERT_EQUAL(std::string(fingerprint), "771,49195,65281-16-11", string);
+	PTF_ASSERT_EQUAL(fingerprintLen, 21, size);
+	PTF_ASSERT_TRUE(serverHelloMessage->getJA3SFingerprintMD5(md5, sizeof(md5)));
+	PTF_ASSERT_EQUAL(std::string(md5), "554786d4c84f8a7953b7e453c6371067", string);
+
+	// cipher-suite lookup by ID
+	PTF_ASSERT_EQUAL(pcpp::SSLCipherSuite::getCipherSuiteByID(0x0000)->asString(), "TLS_NULL_WITH_NULL_NULL", string);
+	PTF_ASSERT_EQUAL(pcpp::SSLCipherSuite::getCipherSuiteByID(0xCCAE)->asString(), "TLS_RSA_PSK_WITH_CHACHA20_POLY1305_SHA256", string);
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0x1301));
+	PTF_ASSERT_NULL(pcpp::SSLCipherSuite::getCipherSuiteByID(0xC0FF));
+} // SSLFingerprintTest
\ No newline at end of file
@@ -285,4 +285,69 @@ PTF_TEST_CASE(TcpPacketCreation2)
 	pcpp::TcpOption tcpSnackOption = tcpLayer.addTcpOption(pcpp::TcpOptionBuilder(pcpp::TCPOPT_SNACK, NULL, PCPP_TCPOLEN_SNACK));
 	PTF_ASSERT_TRUE(tcpSnackOption.isNotNull());
 	PTF_ASSERT_TRUE(tcpSnackOption.setValue(htobe32(1000)));
-} // TcpPacketCreation2
\ No newline at end of file
+} // TcpPacketCreation2
+
+
+PTF_TEST_CASE(TcpStandardOptionsTest)
+{
+	timeval time;
+	gettimeofday(&time, NULL);
+
+	READ_FILE_AND_CREATE_PACKET(1, "PacketExamples/TcpPacketWithOptions3.dat");
+
+	pcpp::Packet tcpPaketWithOptions(&rawPacket1);
+	pcpp::TcpLayer* tcpLayer = tcpPaketWithOptions.getLayerOfType<pcpp::TcpLayer>();
+	PTF_ASSERT_NOT_NULL(tcpLayer);
+
+	pcpp::TcpOption timestampOption = tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_TIMESTAMP);
+	PTF_ASSERT_TRUE(timestampOption.isNotNull());
+	PTF_ASSERT_TRUE(tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_SACK).isNull());
+	PTF_ASSERT_TRUE(tcpLayer->getTcpOption(pcpp::TCPOPT_MD5).isNull());
+
+	pcpp::TcpStandardOptions options;
+	tcpLayer->getStandardTcpOptions(options);
+	PTF_ASSERT_TRUE(options.hasMss);
+	PTF_ASSERT_EQUAL(options.mss, 1460, u16);
+	PTF_ASSERT_TRUE(options.hasWindowScale);
+	PTF_ASSERT_EQUAL(options.windowScale, 4, u8);
+	PTF_ASSERT_TRUE(options.isSackPermitted);
+	PTF_ASSERT_TRUE(options.hasTimestamp);
+	PTF_ASSERT_EQUAL(options.timestampValue, be32toh(timestampOption.getValueAs<uint32_t>()), u32);
+	PTF_ASSERT_EQUAL(options.timestampEchoReply, be32toh(timestampOption.getValueAs<uint32_t>(4)), u32);
+	PTF_ASSERT_EQUAL(options.numOfSackBlocks, 0, u8);
+
+	// the option index is updated when options are removed and added
+	PTF_ASSERT_TRUE(tcpLayer->removeTcpOption(pcpp::TCPOPT_MSS));
+	PTF_ASSERT_TRUE(tcpLayer->getTcpOption(pcpp::TCPOPT_MSS).isNull());
+	pcpp::TcpOption windowScaleOption = tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_WINDOW);
+	PTF_ASSERT_TRUE(windowScaleOption.isNotNull());
+	PTF_ASSERT_EQUAL(windowScaleOption.getValueAs<uint8_t>(), 4, u8);
+
+	uint32_t sackBlocks[4] = { htobe32(1000), htobe32(2000), htobe32(3000), htobe32(4000) };
+	PTF_ASSERT_TRUE(tcpLayer->addTcpOption(pcpp::TcpOptionBuilder(pcpp::PCPP_TCPOPT_SACK, (uint8_t*)sackBlocks, sizeof(sackBlocks))).isNotNull());
+	PTF_ASSERT_TRUE(tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_SACK).isNotNull());
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_SACK).getDataSize(), 16, size);
+	PTF_ASSERT_EQUAL(tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_WINDOW).getValueAs<uint8_t>(), 4, u8);
+
+	tcpLayer->getStandardTcpOptions(options);
+	PTF_ASSERT_FALSE(options.hasMss);
+	PTF_ASSERT_TRUE(options.hasWindowScale);
+	PTF_ASSERT_TRUE(options.hasTimestamp);
+	PTF_ASSERT_EQUAL(options.numOfSackBlocks, 2, u8);
+	PTF_ASSERT_EQUAL(options.sackBlocks[0].leftEdge, 1000, u32);
+	PTF_ASSERT_EQUAL(options.sackBlocks[0].rightEdge, 2000, u32);
+	PTF_ASSERT_EQUAL(options.sackBlocks[1].leftEdge, 3000, u32);
+	PTF_ASSERT_EQUAL(options.sackBlocks[1].rightEdge, 4000, u32);
+
+	// a copy of the layer has its own valid index
+	pcpp::TcpLayer tcpLayerCopy(*tcpLayer);
+	PTF_ASSERT_EQUAL(tcpLayerCopy.getTcpOption(pcpp::PCPP_TCPOPT_SACK).getDataSize(), 16, size);
+	PTF_ASSERT_TRUE(tcpLayerCopy.getTcpOption(pcpp::PCPP_TCPOPT_SACK).getRecordBasePtr() != tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_SACK).getRecordBasePtr());
+
+	PTF_ASSERT_TRUE(tcpLayer->removeAllTcpOptions());
+	PTF_ASSERT_TRUE(tcpLayer->getTcpOption(pcpp::PCPP_TCPOPT_WINDOW).isNull());
+	tcpLayer->getStandardTcpOptions(options);
+	PTF_ASSERT_FALSE(options.hasWindowScale);
+	PTF_ASSERT_FALSE(options.hasTimestamp);
+	PTF_ASSERT_EQUAL(options.numOfSackBlocks, 0, u8);
+} // TcpStandardOptionsTest
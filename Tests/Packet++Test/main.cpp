@@ -127,6 +127,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TcpPacketWithOptionsParsing2, "tcp");
 	PTF_RUN_TEST(TcpPacketCreation, "tcp");
 	PTF_RUN_TEST(TcpPacketCreation2, "tcp");
+	PTF_RUN_TEST(TcpStandardOptionsTest, "tcp");
 	PTF_RUN_TEST(TcpMalformedPacketParsing, "tcp");
 
 	PTF_RUN_TEST(InsertDataToPacket, "packet;insert");
@@ -138,6 +139,24 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(ParsePartialPacketTest, "packet;partial_packet");
 	PTF_RUN_TEST(PacketTrailerTest, "packet;packet_trailer");
 	PTF_RUN_TEST(ResizeLayerTest, "packet;resize");
+	PTF_RUN_TEST(LayerArenaTest, "packet;layer_arena");
+	PTF_RUN_TEST(LazyParsingTest, "packet;lazy_parsing");
+	PTF_RUN_TEST(PacketViewTest, "packet;packet_view");
+	PTF_RUN_TEST(PacketBurstParsingTest, "packet;packet_view;packet_burst");
+	PTF_RUN_TEST(LayerRecyclingTest, "packet;layer_recycling");
+	PTF_RUN_TEST(FlowKeyTest, "packet;flow_key");
+	PTF_RUN_TEST(TunnelFlowKeysTest, "packet;flow_key");
+	PTF_RUN_TEST(FlowTableTest, "packet;flow_key");
+	PTF_RUN_TEST(StackParserTest, "packet;stack_parser");
+	PTF_RUN_TEST(ToeplitzHashTest, "packet;toeplitz_hash");
+	PTF_RUN_TEST(ChecksumImplementationTest, "packet;checksum");
+	PTF_RUN_TEST(IncrementalChecksumTest, "packet;checksum");
+	PTF_RUN_TEST(ModifiedLayersTest, "packet;modified_layers");
+	PTF_RUN_TEST(PacketHeadroomTest, "packet;headroom");
+	PTF_RUN_TEST(MovePacketTest, "packet;move");
+	PTF_RUN_TEST(CopyOnWritePacketTest, "packet;copy_on_write");
+	PTF_RUN_TEST(CopyOnWriteSettersTest, "packet;copy_on_write");
+	PTF_RUN_TEST(NextLayerRegistryTest, "packet;next_layer_registry");
 
 	PTF_RUN_TEST(HttpRequestLayerParsingTest, "http");
 	PTF_RUN_TEST(HttpRequestLayerCreationTest, "http");
@@ -145,6 +164,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(HttpResponseLayerParsingTest, "http");
 	PTF_RUN_TEST(HttpResponseLayerCreationTest, "http");
 	PTF_RUN_TEST(HttpResponseLayerEditTest, "http");
+	PTF_RUN_TEST(TextBasedProtocolFieldIndexTest, "http;sip");
 
 	PTF_RUN_TEST(PPPoESessionLayerParsingTest, "pppoe");
 	PTF_RUN_TEST(PPPoESessionLayerCreationTest, "pppoe");
@@ -156,6 +176,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(DnsLayerResourceCreationTest, "dns");
 	PTF_RUN_TEST(DnsLayerEditTest, "dns");
 	PTF_RUN_TEST(DnsLayerRemoveResourceTest, "dns");
+	PTF_RUN_TEST(DnsLayerZeroCopyParsingTest, "dns");
 
 	PTF_RUN_TEST(IcmpParsingTest, "icmp");
 	PTF_RUN_TEST(IcmpCreationTest, "icmp");
@@ -174,6 +195,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(SSLMultipleRecordParsing4Test, "ssl");
 	PTF_RUN_TEST(SSLPartialCertificateParseTest, "ssl");
 	PTF_RUN_TEST(SSLNewSessionTicketParseTest, "ssl");
+	PTF_RUN_TEST(SSLFingerprintTest, "ssl");
 
 	PTF_RUN_TEST(SllPacketParsingTest, "sll");
 	PTF_RUN_TEST(SllPacketCreationTest, "sll");
@@ -6,6 +6,7 @@
 PTF_TEST_CASE(TestIPAddress);
 PTF_TEST_CASE(TestMacAddress);
 PTF_TEST_CASE(TestLRUList);
+PTF_TEST_CASE(TestTimerWheel);
 PTF_TEST_CASE(TestGeneralUtils);
 PTF_TEST_CASE(TestGetMacAddress);
 
@@ -40,6 +41,7 @@ PTF_TEST_CASE(TestHttpRequestParsing);
 PTF_TEST_CASE(TestHttpResponseParsing);
 PTF_TEST_CASE(TestPrintPacketAndLayers);
 PTF_TEST_CASE(TestDnsParsing);
+PTF_TEST_CASE(TestPacketConcurrentClones);
 
 // Implemented in TcpReassemblyTests.cpp
 PTF_TEST_CASE(TestTcpReassemblySanity);
@@ -54,6 +56,13 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6MultConns);
 PTF_TEST_CASE(TestTcpReassemblyIPv6_OOO);
 PTF_TEST_CASE(TestTcpReassemblyCleanup);
 PTF_TEST_CASE(TestTcpReassemblyMaxSeq);
+PTF_TEST_CASE(TestTcpReassemblyInnerTuple);
+PTF_TEST_CASE(TestTcpReassemblyIdleTimeout);
+PTF_TEST_CASE(TestTcpReassemblyAdvanceTime);
+PTF_TEST_CASE(TestTcpReassemblyOOOLimits);
+PTF_TEST_CASE(TestTcpReassemblyOOOSmallSegs);
+PTF_TEST_CASE(TestTcpReassemblyZeroCopy);
+PTF_TEST_CASE(TestTcpReassemblySharded);
 
 // Implemented in IPFragmentationTests.cpp
 PTF_TEST_CASE(TestIPFragmentationSanity);
@@ -3,12 +3,14 @@
 #include "../Common/GlobalTestArgs.h"
 #include <sstream>
 #include <algorithm>
+#include <vector>
 #include "EndianPortable.h"
 #include "Logger.h"
 #include "GeneralUtils.h"
 #include "IpAddress.h"
 #include "MacAddress.h"
 #include "LRUList.h"
+#include "TimerWheel.h"
 #include "NetworkUtils.h"
 #include "PcapLiveDeviceList.h"
 #include "SystemUtils.h"
@@ -158,6 +160,108 @@ PTF_TEST_CASE(TestLRUList)
 
 
 
+PTF_TEST_CASE(TestTimerWheel)
+{
+	typedef pcpp::TimerWheel<uint32_t> TestTimerWheel;
+
+	TestTimerWheel wheel(1000);
+	PTF_ASSERT_EQUAL(wheel.getCurrentTick(), 1000, u64);
+	PTF_ASSERT_NULL(wheel.popExpired());
+
+	// timers in each level of the wheel, in the overflow list and one that already expired
+	const uint64_t delays[] = { 1, 5, 63, 64, 100, 4095, 4096, 300000, 16777216, 50000000 };
+	const int numOfTimers = sizeof(delays) / sizeof(delays[0]);
+	TestTimerWheel::Timer timers[numOfTimers];
+	for (int i = 0; i < numOfTimers; i++)
+	{
+		timers[i].data = i;
+		wheel.schedule(&timers[i], 1000 + delays[i]);
+		PTF_ASSERT_TRUE(timers[i].isScheduled());
+	}
+
+	TestTimerWheel::Timer expiredTimer;
+	wheel.schedule(&expiredTimer, 999);
+	PTF_ASSERT_TRUE(wheel.hasExpired());
+	PTF_ASSERT_TRUE(wheel.popExpired() == &expiredTimer);
+	PTF_ASSERT_FALSE(expiredTimer.isScheduled());
+	PTF_ASSERT_EQUAL(wheel.getNumOfPendingTimers(), (size_t)numOfTimers, size);
+
+	// each timer expires exactly when the wheel reaches its expiry, no matter how far the wheel advances at once
+	for (int i = 0; i < numOfTimers; i++)
+	{
+		wheel.advance(1000 + delays[i] - 1);
+		PTF_ASSERT_FALSE(wheel.hasExpired());
+		wheel.advance(1000 + delays[i]);
+		TestTimerWheel::Timer* timer = wheel.popExpired();
+		PTF_ASSERT_NOT_NULL(timer);
+		PTF_ASSERT_EQUAL(timer->data, (uint32_t)i, u32);
+		PTF_ASSERT_EQUAL(timer->getExpiry(), 1000 + delays[i], u64);
+		PTF_ASSERT_NULL(wheel.popExpired());
+	}
+
+	PTF_ASSERT_EQUAL(wheel.getNumOfPendingTimers(), 0, size);
+
+	// cancel and reschedule
+	wheel.schedule(&timers[0], wheel.getCurrentTick() + 10);
+	wheel.schedule(&timers[1], wheel.getCurrentTick() + 10);
+	wheel.cancel(&timers[0]);
+	PTF_ASSERT_FALSE(timers[0].isScheduled());
+	wheel.schedule(&timers[1], wheel.getCurrentTick() + 20);
+	wheel.advance(wheel.getCurrentTick() + 10);
+	PTF_ASSERT_FALSE(wheel.hasExpired());
+	wheel.advance(wheel.getCurrentTick() + 10);
+	PTF_ASSERT_TRUE(wheel.popExpired() == &timers[1]);
+
+	// expired timers wait in the expired list until they're popped
+	uint64_t now = wheel.getCurrentTick();
+	wheel.schedule(&timers[2], now + 3);
+	wheel.schedule(&timers[3], now + 3);
+	wheel.advance(now + 100);
+	TestTimerWheel::Timer* firstExpired = wheel.popExpired();
+	PTF_ASSERT_TRUE(firstExpired == &timers[2] || firstExpired == &timers[3]);
+	wheel.schedule(&timers[4], now + 200);
+	wheel.advance(now + 200);
+	PTF_ASSERT_TRUE(wheel.popExpired() == (firstExpired == &timers[2] ? &timers[3] : &timers[2]));
+	PTF_ASSERT_TRUE(wheel.popExpired() == &timers[4]);
+	PTF_ASSERT_NULL(wheel.popExpired());
+
+	// many timers with random expiries and random advance steps: a timer pops only after its expiry and no later than the first advance
+	// past it
+	const int numOfRandomTimers = 2000;
+	std::vector<TestTimerWheel::Timer> randomTimers(numOfRandomTimers);
+	uint32_t seed = 12345;
+	now = wheel.getCurrentTick();
+	for (int i = 0; i < numOfRandomTimers; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		randomTimers[i].data = i;
+		wheel.schedule(&randomTimers[i], now + 1 + (seed >> 8) % (1 << 22));
+	}
+
+	int numOfExpired = 0;
+	while (wheel.getNumOfPendingTimers() > 0)
+	{
+		seed = seed * 1103515245 + 12345;
+		uint64_t prevTick = wheel.getCurrentTick();
+		wheel.advance(prevTick + 1 + (seed >> 8) % 20000);
+		TestTimerWheel::Timer* timer;
+		while ((timer = wheel.popExpired()) != NULL)
+		{
+			PTF_ASSERT_TRUE(timer->getExpiry() > prevTick);
+			PTF_ASSERT_TRUE(timer->getExpiry() <= wheel.getCurrentTick());
+			numOfExpired++;
+		}
+	}
+
+	PTF_ASSERT_EQUAL(numOfExpired, numOfRandomTimers, int);
+	for (int i = 0; i < numOfRandomTimers; i++)
+	{
+		PTF_ASSERT_FALSE(randomTimers[i].isScheduled());
+	}
+} // TestTimerWheel
+
+
+
 PTF_TEST_CASE(TestGeneralUtils)
 {
 	uint8_t resultArr[4];
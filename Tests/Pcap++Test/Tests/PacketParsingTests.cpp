@@ -3,7 +3,10 @@
 #include <sstream>
 #include <fstream>
 #include <stdlib.h>
+#include <vector>
+#include <pthread.h>
 #include "Packet.h"
+#include "TcpLayer.h"
 #include "HttpLayer.h"
 #include "DnsLayer.h"
 #include "PcapFileDevice.h"
@@ -458,4 +461,98 @@ PTF_TEST_CASE(TestDnsParsing)
 	PTF_ASSERT_EQUAL(additionalWithLongUglyName, 12, int);
 	// wireshark filter: dns.count.add_rr > 0 and dns.resp.type == 47
 	PTF_ASSERT_EQUAL(additionalWithTypeNSEC, 14, int);
-} // TestDnsParsing
\ No newline at end of file
+} // TestDnsParsing
+
+
+
+struct ConcurrentCloneContext
+{
+	pcpp::Packet* sourcePacket;
+	pthread_mutex_t* startMutex;
+	pthread_cond_t* startCond;
+	bool* started;
+	std::vector<pcpp::Packet*> clones;
+};
+
+static void* concurrentCloneThreadMain(void* contextPtr)
+{
+	ConcurrentCloneContext* context = (ConcurrentCloneContext*)contextPtr;
+
+	// wait until all threads are created so they clone the packet at the same time
+	pthread_mutex_lock(context->startMutex);
+	while (!*context->started)
+		pthread_cond_wait(context->startCond, context->startMutex);
+	pthread_mutex_unlock(context->startMutex);
+
+	for (int i = 0; i < 20; i++)
+		context->clones.push_back(new pcpp::Packet(*context->sourcePacket, true));
+
+	return NULL;
+}
+
+PTF_TEST_CASE(TestPacketConcurrentClones)
+{
+	pcpp::PcapFileReaderDevice readerDev(EXAMPLE_PCAP_HTTP_REQUEST);
+	PTF_ASSERT_TRUE(readerDev.open());
+	pcpp::RawPacket rawPacket;
+	PTF_ASSERT_TRUE(readerDev.getNextPacket(rawPacket));
+	readerDev.close();
+
+	const int numOfThreads = 4;
+
+	// several analyzer threads clone the same packet at once: they must all share one reference count, so the raw packet is freed
+	// exactly once, by the last packet that shares it
+	for (int round = 0; round < 50; round++)
+	{
+		pcpp::Packet* sourcePacket = new pcpp::Packet(new pcpp::RawPacket(rawPacket), true);
+		pthread_mutex_t startMutex;
+		pthread_cond_t startCond;
+		bool started = false;
+		pthread_mutex_init(&startMutex, NULL);
+		pthread_cond_init(&startCond, NULL);
+
+		ConcurrentCloneContext contexts[numOfThreads];
+		pthread_t threads[numOfThreads];
+		for (int i = 0; i < numOfThreads; i++)
+		{
+			contexts[i].sourcePacket = sourcePacket;
+			contexts[i].startMutex = &startMutex;
+			contexts[i].startCond = &startCond;
+			contexts[i].started = &started;
+			PTF_ASSERT_EQUAL(pthread_create(&threads[i], NULL, concurrentCloneThreadMain, &contexts[i]), 0, int);
+		}
+
+		pthread_mutex_lock(&startMutex);
+		started = true;
+		pthread_cond_broadcast(&startCond);
+		pthread_mutex_unlock(&startMutex);
+
+		for (int i = 0; i < numOfThreads; i++)
+			pthread_join(threads[i], NULL);
+
+		pthread_cond_destroy(&startCond);
+		pthread_mutex_destroy(&startMutex);
+
+		PTF_ASSERT_TRUE(sourcePacket->isRawDataShared());
+		delete sourcePacket;
+
+		for (int i = 0; i < numOfThreads; i++)
+		{
+			PTF_ASSERT_EQUAL(contexts[i].clones.size(), 20, size);
+			for (size_t j = 0; j < contexts[i].clones.size(); j++)
+			{
+				pcpp::Packet* clone = contexts[i].clones[j];
+				PTF_ASSERT_TRUE(clone->isRawDataShared());
+				PTF_ASSERT_TRUE(clone->getRawPacketReadOnly() == contexts[0].clones[0]->getRawPacketReadOnly());
+				PTF_ASSERT_NOT_NULL(clone->getLayerOfType<pcpp::TcpLayer>());
+				PTF_ASSERT_EQUAL(clone->getLayerOfType<pcpp::TcpLayer>()->getDstPort(), 80, u16);
+			}
+		}
+
+		for (int i = 0; i < numOfThreads; i++)
+		{
+			for (size_t j = 0; j < contexts[i].clones.size(); j++)
+				delete contexts[i].clones[j];
+		}
+	}
+} // TestPacketConcurrentClones
\ No newline at end of file
@@ -3,8 +3,12 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <pthread.h>
 #include "EndianPortable.h"
+#include "Logger.h"
 #include "TcpReassembly.h"
+#include "ShardedTcpReassembly.h"
+#include "FlowKey.h"
 #include "IPv4Layer.h"
 #include "TcpLayer.h"
 #include "PayloadLayer.h"
@@ -25,11 +29,12 @@ struct TcpReassemblyStats
 	bool connectionsStarted;
 	bool connectionsEnded;
 	bool connectionsEndedManually;
+	bool connectionsEndedByTimeout;
 	pcpp::ConnectionData connData;
 
 	TcpReassemblyStats() { clear(); }
 
-	void clear() { reassembledData = ""; numOfDataPackets = 0; curSide = -1; numOfMessagesFromSide[0] = 0; numOfMessagesFromSide[1] = 0; connectionsStarted = false; connectionsEnded = false; connectionsEndedManually = false; }
+	void clear() { reassembledData = ""; numOfDataPackets = 0; curSide = -1; numOfMessagesFromSide[0] = 0; numOfMessagesFromSide[1] = 0; connectionsStarted = false; connectionsEnded = false; connectionsEndedManually = false; connectionsEndedByTimeout = false; }
 };
 
 
@@ -39,8 +44,8 @@ struct TcpReassemblyStats
 
 struct TcpReassemblyMultipleConnStats
 {
-	typedef std::vector<uint32_t> FlowKeysList;
-	typedef std::map<uint32_t, TcpReassemblyStats> Stats;
+	typedef std::vector<pcpp::FlowKey> FlowKeysList;
+	typedef std::map<pcpp::FlowKey, TcpReassemblyStats> Stats;
 
 	Stats stats;
 	FlowKeysList flowKeysList;
@@ -141,6 +146,8 @@ static void tcpReassemblyConnectionEndCallback(const pcpp::ConnectionData& conne
 
 	if (reason == pcpp::TcpReassembly::TcpReassemblyConnectionClosedManually)
 		iter->second.connectionsEndedManually = true;
+	else if (reason == pcpp::TcpReassembly::TcpReassemblyConnectionClosedByTimeout)
+		iter->second.connectionsEndedByTimeout = true;
 	else
 		iter->second.connectionsEnded = true;
 }
@@ -150,14 +157,14 @@ static void tcpReassemblyConnectionEndCallback(const pcpp::ConnectionData& conne
 // tcpReassemblyTest()
 // ~~~~~~~~~~~~~~~~~~~
 
-static bool tcpReassemblyTest(std::vector<pcpp::RawPacket>& packetStream, TcpReassemblyMultipleConnStats& results, bool monitorOpenCloseConns, bool closeConnsManually)
+static bool tcpReassemblyTest(std::vector<pcpp::RawPacket>& packetStream, TcpReassemblyMultipleConnStats& results, bool monitorOpenCloseConns, bool closeConnsManually, const pcpp::TcpReassemblyConfiguration& config = pcpp::TcpReassemblyConfiguration())
 {
 	pcpp::TcpReassembly* tcpReassembly = NULL;
 
 	if (monitorOpenCloseConns)
-		tcpReassembly = new pcpp::TcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+		tcpReassembly = new pcpp::TcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, config);
 	else
-		tcpReassembly = new pcpp::TcpReassembly(tcpReassemblyMsgReadyCallback, &results);
+		tcpReassembly = new pcpp::TcpReassembly(tcpReassemblyMsgReadyCallback, &results, NULL, NULL, config);
 
 	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
 	{
@@ -241,6 +248,27 @@ static pcpp::RawPacket tcpReassemblyAddRetransmissions(pcpp::RawPacket rawPacket
 }
 
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// tcpReassemblyEncapsulateInIPv4()
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static pcpp::RawPacket tcpReassemblyEncapsulateInIPv4(pcpp::RawPacket rawPacket, const pcpp::IPv4Address& outerSrcIP, const pcpp::IPv4Address& outerDstIP)
+{
+	pcpp::Packet packet(&rawPacket);
+
+	pcpp::Layer* ethLayer = packet.getFirstLayer();
+	pcpp::IPv4Layer outerIPLayer(outerSrcIP, outerDstIP);
+	outerIPLayer.getIPv4Header()->timeToLive = 64;
+	packet.insertLayer(ethLayer, &outerIPLayer);
+	packet.computeCalculateFields();
+
+	// IPv4Layer doesn't set the protocol of IP in IP so set it manually
+	packet.getLayerOfType<pcpp::IPv4Layer>()->getIPv4Header()->protocol = pcpp::PACKETPP_IPPROTO_IPIP;
+
+	return *(packet.getRawPacket());
+}
+
+
 
 // ~~~~~~~~~~~~~~~~~~~~~
 // ~~~~~~~~~~~~~~~~~~~~~
@@ -634,7 +662,8 @@ PTF_TEST_CASE(TestTcpReassemblyMultipleConns)
 	PTF_ASSERT_EQUAL(stats.size(), 3, size);
 	PTF_ASSERT_EQUAL(results.flowKeysList.size(), 3, size);
 
-	TcpReassemblyMultipleConnStats::Stats::iterator iter = stats.begin();
+	// look up the connections by the order in which they started
+	TcpReassemblyMultipleConnStats::Stats::iterator iter = stats.find(results.flowKeysList[1]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 2, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 1, int);
@@ -645,7 +674,7 @@ PTF_TEST_CASE(TestTcpReassemblyMultipleConns)
 	expectedReassemblyData = readFileIntoString(std::string("PcapExamples/three_http_streams_conn_1_output.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, iter->second.reassembledData, string);
 
-	iter++;
+	iter = stats.find(results.flowKeysList[2]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 2, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 1, int);
@@ -656,7 +685,7 @@ PTF_TEST_CASE(TestTcpReassemblyMultipleConns)
 	expectedReassemblyData = readFileIntoString(std::string("PcapExamples/three_http_streams_conn_2_output.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, iter->second.reassembledData, string);
 
-	iter++;
+	iter = stats.find(results.flowKeysList[0]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 2, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 1, int);
@@ -684,7 +713,13 @@ PTF_TEST_CASE(TestTcpReassemblyMultipleConns)
 	PTF_ASSERT_EQUAL(tcpReassembly.isConnectionOpen(iterConn3->second), 0, int);
 
 	pcpp::ConnectionData dummyConn;
-	dummyConn.flowKey = 0x12345678;
+	pcpp::PacketFiveTuple dummyTuple;
+	memset(&dummyTuple, 0, sizeof(dummyTuple));
+	dummyTuple.ipVersion = 4;
+	dummyTuple.protocol = pcpp::PACKETPP_IPPROTO_TCP;
+	dummyTuple.srcPort = 0x1234;
+	dummyTuple.dstPort = 0x5678;
+	dummyConn.flowKey = pcpp::FlowKey(dummyTuple);
 	PTF_ASSERT_LOWER_THAN(tcpReassembly.isConnectionOpen(dummyConn), 0, int);
 
 
@@ -757,7 +792,10 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6MultConns)
 	TcpReassemblyMultipleConnStats::Stats &stats = tcpReassemblyResults.stats;
 	PTF_ASSERT_EQUAL(stats.size(), 4, size);
 
-	TcpReassemblyMultipleConnStats::Stats::iterator iter = stats.begin();
+	// look up the connections by the order in which they started
+	const TcpReassemblyMultipleConnStats::FlowKeysList& flowKeys = tcpReassemblyResults.flowKeysList;
+	PTF_ASSERT_EQUAL(flowKeys.size(), 4, size);
+	TcpReassemblyMultipleConnStats::Stats::iterator iter = stats.find(flowKeys[0]);
 
 	pcpp::IPv6Address expectedSrcIP(std::string("2001:618:400::5199:cc70"));
 	pcpp::IPv6Address expectedDstIP1(std::string("2001:618:1:8000::5"));
@@ -781,7 +819,7 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6MultConns)
 	expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_ipv6_http_stream4.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, iter->second.reassembledData, string);
 
-	iter++;
+	iter = stats.find(flowKeys[2]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 10, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 1, int);
@@ -799,7 +837,7 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6MultConns)
 	PTF_ASSERT_EQUAL(stats.begin()->second.connData.endTime.tv_sec, 0, u64);
 	PTF_ASSERT_EQUAL(stats.begin()->second.connData.endTime.tv_usec, 0, u64);
 
-	iter++;
+	iter = stats.find(flowKeys[3]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 2, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 1, int);
@@ -819,7 +857,7 @@ PTF_TEST_CASE(TestTcpReassemblyIPv6MultConns)
 	expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_ipv6_http_stream3.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, iter->second.reassembledData, string);
 
-	iter++;
+	iter = stats.find(flowKeys[1]);
 
 	PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, 13, int);
 	PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], 4, int);
@@ -922,7 +960,10 @@ PTF_TEST_CASE(TestTcpReassemblyCleanup)
 	PTF_ASSERT_EQUAL(tcpReassembly.isConnectionOpen(iterConn2->second), 0, int);
 	PTF_ASSERT_EQUAL(tcpReassembly.isConnectionOpen(iterConn3->second), 0, int);
 
-	PCAP_SLEEP(3);
+	// the closed connection delay is measured by packet timestamps, so the last packet arrives 3 seconds after the connections were closed
+	timespec lastPacketTime = packetStream.back().getPacketTimeStamp();
+	lastPacketTime.tv_sec += 3;
+	lastPacket.setPacketTimeStamp(lastPacketTime);
 
 	tcpReassembly.reassemblePacket(&lastPacket); // automatic cleanup of 1 item
 	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), 2, size);
@@ -978,4 +1019,587 @@ PTF_TEST_CASE(TestTcpReassemblyMaxSeq)
 
 	std::string expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_tcp_stream_output.txt"));
 	PTF_ASSERT_EQUAL(expectedReassemblyData, stats.begin()->second.reassembledData, string);
-} //TestTcpReassemblyMaxSeq
\ No newline at end of file
+} //TestTcpReassemblyMaxSeq
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyInnerTuple)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+
+	// tunnel the stream in IP in IP
+	pcpp::IPv4Address outerSrcIP(std::string("192.168.1.1"));
+	pcpp::IPv4Address outerDstIP(std::string("192.168.1.2"));
+	std::vector<pcpp::RawPacket> tunneledPacketStream;
+	for (std::vector<pcpp::RawPacket>::iterator iter = packetStream.begin(); iter != packetStream.end(); iter++)
+	{
+		// the outer header of the server's packets is reversed like the inner one
+		pcpp::Packet packet(&(*iter));
+		bool fromClient = (packet.getLayerOfType<pcpp::IPv4Layer>()->getSrcIpAddress() == pcpp::IPv4Address(std::string("10.0.0.1")));
+		tunneledPacketStream.push_back(tcpReassemblyEncapsulateInIPv4(*iter, (fromClient ? outerSrcIP : outerDstIP), (fromClient ? outerDstIP : outerSrcIP)));
+	}
+
+	std::string expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_tcp_stream_output.txt"));
+
+	// by default the connection is identified by the outer IP layer
+	TcpReassemblyMultipleConnStats tcpReassemblyResults;
+	tcpReassemblyTest(tunneledPacketStream, tcpReassemblyResults, true, true);
+
+	TcpReassemblyMultipleConnStats::Stats &stats = tcpReassemblyResults.stats;
+	PTF_ASSERT_EQUAL(stats.size(), 1, size);
+	PTF_ASSERT_EQUAL(stats.begin()->second.numOfDataPackets, 19, int);
+	PTF_ASSERT_TRUE(stats.begin()->second.connData.srcIP->equals(&outerSrcIP));
+	PTF_ASSERT_TRUE(stats.begin()->second.connData.dstIP->equals(&outerDstIP));
+	PTF_ASSERT_EQUAL(expectedReassemblyData, stats.begin()->second.reassembledData, string);
+
+	// in inner tuple mode the connection is identified by the IP layer that carries the TCP layer
+	tcpReassemblyResults.clear();
+	tcpReassemblyTest(tunneledPacketStream, tcpReassemblyResults, true, true, pcpp::TcpReassemblyConfiguration(true, 5, 30, true));
+
+	PTF_ASSERT_EQUAL(stats.size(), 1, size);
+	PTF_ASSERT_EQUAL(stats.begin()->second.numOfDataPackets, 19, int);
+	pcpp::IPv4Address expectedSrcIP(std::string("10.0.0.1"));
+	pcpp::IPv4Address expectedDstIP(std::string("81.218.72.15"));
+	PTF_ASSERT_TRUE(stats.begin()->second.connData.srcIP->equals(&expectedSrcIP));
+	PTF_ASSERT_TRUE(stats.begin()->second.connData.dstIP->equals(&expectedDstIP));
+	PTF_ASSERT_EQUAL(expectedReassemblyData, stats.begin()->second.reassembledData, string);
+	pcpp::Packet firstPacket(&tunneledPacketStream.front());
+	PTF_ASSERT_TRUE(stats.begin()->second.connData.flowKey == pcpp::FlowKey::fromPacket(firstPacket));
+} // TestTcpReassemblyInnerTuple
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyIdleTimeout)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	// the stream has no packets between the 16th packet (at 1491516384) and the 17th packet (at 1491516394)
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+
+	std::string expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_tcp_stream_output.txt"));
+
+	// the connection times out when the 17th packet arrives, the rest of its packets are ignored since the closed connection isn't removed
+	TcpReassemblyMultipleConnStats results;
+	pcpp::TcpReassemblyConfiguration config(false, 5, 30, false, 0, 5);
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, config);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::Packet packet(&packetStream[i]);
+		pcpp::TcpReassembly::ReassemblyStatus status = tcpReassembly.reassemblePacket(packet);
+		if (i == 16)
+		{
+			PTF_ASSERT_EQUAL(status, pcpp::TcpReassembly::Ignore_PacketOfClosedFlow, enum);
+		}
+	}
+
+	PTF_ASSERT_EQUAL(results.stats.size(), 1, size);
+	TcpReassemblyStats& stats = results.stats.begin()->second;
+	PTF_ASSERT_TRUE(stats.connectionsStarted);
+	PTF_ASSERT_TRUE(stats.connectionsEndedByTimeout);
+	PTF_ASSERT_FALSE(stats.connectionsEnded);
+	PTF_ASSERT_FALSE(stats.connectionsEndedManually);
+
+	// the data reported before the timeout is the data of the packets before the gap
+	std::vector<pcpp::RawPacket> packetsBeforeGap(packetStream.begin(), packetStream.begin() + 16);
+	TcpReassemblyMultipleConnStats resultsBeforeGap;
+	tcpReassemblyTest(packetsBeforeGap, resultsBeforeGap, true, true);
+	TcpReassemblyStats& statsBeforeGap = resultsBeforeGap.stats.begin()->second;
+	PTF_ASSERT_EQUAL(stats.numOfDataPackets, statsBeforeGap.numOfDataPackets, int);
+	PTF_ASSERT_EQUAL(stats.reassembledData, statsBeforeGap.reassembledData, string);
+	PTF_ASSERT_TRUE(stats.reassembledData.size() < expectedReassemblyData.size());
+	PTF_ASSERT_EQUAL(expectedReassemblyData.substr(0, stats.reassembledData.size()), stats.reassembledData, string);
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), 1, size);
+	PTF_ASSERT_EQUAL(tcpReassembly.isConnectionOpen(tcpReassembly.getConnectionInformation().begin()->second), 0, int);
+
+	// when closed connections are removed, the connection is removed 5 seconds after it timed out and the packets after that open a new connection
+	results.clear();
+	pcpp::TcpReassemblyConfiguration removeConfig(true, 5, 30, false, 0, 5);
+	pcpp::TcpReassembly removingTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, removeConfig);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::Packet packet(&packetStream[i]);
+		removingTcpReassembly.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(removingTcpReassembly.getConnectionInformation().size(), 1, size);
+	PTF_ASSERT_EQUAL(removingTcpReassembly.isConnectionOpen(removingTcpReassembly.getConnectionInformation().begin()->second), 1, int);
+	PTF_ASSERT_TRUE(results.stats.begin()->second.connectionsEndedByTimeout);
+	PTF_ASSERT_TRUE(results.stats.begin()->second.connData.startTime.tv_sec == 1491516399);
+
+	// a timeout longer than the gap doesn't close the connection
+	results.clear();
+	tcpReassemblyTest(packetStream, results, true, true, pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 11));
+	PTF_ASSERT_EQUAL(results.stats.size(), 1, size);
+	PTF_ASSERT_FALSE(results.stats.begin()->second.connectionsEndedByTimeout);
+	PTF_ASSERT_TRUE(results.stats.begin()->second.connectionsEndedManually);
+	PTF_ASSERT_EQUAL(expectedReassemblyData, results.stats.begin()->second.reassembledData, string);
+} // TestTcpReassemblyIdleTimeout
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyAdvanceTime)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	// the connection is still open after the last packet of the stream
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+	timespec lastPacketTime = packetStream.back().getPacketTimeStamp();
+
+	// connections closed after the traffic ends are purged only when the time is moved forward
+	TcpReassemblyMultipleConnStats results;
+	pcpp::TcpReassemblyConfiguration config(false, 2);
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, config);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::Packet packet(&packetStream[i]);
+		tcpReassembly.reassemblePacket(packet);
+	}
+
+	tcpReassembly.closeAllConnections();
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), 1, size);
+	PTF_ASSERT_EQUAL(tcpReassembly.purgeClosedConnections(), 0, u32);
+
+	timespec currentTime = lastPacketTime;
+	currentTime.tv_sec += 1;
+	tcpReassembly.advanceTime(currentTime);
+	PTF_ASSERT_EQUAL(tcpReassembly.purgeClosedConnections(), 0, u32);
+
+	// an earlier time is ignored
+	tcpReassembly.advanceTime(lastPacketTime);
+	PTF_ASSERT_EQUAL(tcpReassembly.purgeClosedConnections(), 0, u32);
+
+	currentTime.tv_sec += 1;
+	tcpReassembly.advanceTime(currentTime);
+	PTF_ASSERT_EQUAL(tcpReassembly.purgeClosedConnections(), 1, u32);
+	PTF_ASSERT_EQUAL(tcpReassembly.getConnectionInformation().size(), 0, size);
+
+	// idle connections time out and with automatic cleanup are also purged when the time is moved forward
+	results.clear();
+	pcpp::TcpReassemblyConfiguration idleConfig(true, 2, 30, false, 0, 20);
+	pcpp::TcpReassembly idleTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, idleConfig);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::Packet packet(&packetStream[i]);
+		idleTcpReassembly.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(results.stats.size(), 1, size);
+	PTF_ASSERT_FALSE(results.stats.begin()->second.connectionsEndedByTimeout);
+
+	currentTime = lastPacketTime;
+	currentTime.tv_sec += 19;
+	idleTcpReassembly.advanceTime(currentTime);
+	PTF_ASSERT_FALSE(results.stats.begin()->second.connectionsEndedByTimeout);
+	PTF_ASSERT_EQUAL(idleTcpReassembly.isConnectionOpen(idleTcpReassembly.getConnectionInformation().begin()->second), 1, int);
+
+	currentTime.tv_sec += 1;
+	idleTcpReassembly.advanceTime(currentTime);
+	PTF_ASSERT_TRUE(results.stats.begin()->second.connectionsEndedByTimeout);
+	PTF_ASSERT_EQUAL(idleTcpReassembly.getConnectionInformation().size(), 1, size);
+	PTF_ASSERT_EQUAL(idleTcpReassembly.isConnectionOpen(idleTcpReassembly.getConnectionInformation().begin()->second), 0, int);
+
+	currentTime.tv_sec += 2;
+	idleTcpReassembly.advanceTime(currentTime);
+	PTF_ASSERT_EQUAL(idleTcpReassembly.getConnectionInformation().size(), 0, size);
+} // TestTcpReassemblyAdvanceTime
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyOOOLimits)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+
+	// remove a packet of the response so all of the response packets after it are buffered as out-of-order data
+	packetStream.erase(packetStream.begin() + 28);
+
+	// the expected data is the data sent when the connection is closed and the missing data is given up on
+	TcpReassemblyMultipleConnStats referenceResults;
+	tcpReassemblyTest(packetStream, referenceResults, true, true);
+	PTF_ASSERT_EQUAL(referenceResults.stats.size(), 1, size);
+	std::string expectedReassemblyData = referenceResults.stats.begin()->second.reassembledData;
+	PTF_ASSERT_TRUE(expectedReassemblyData.find("[1360 bytes missing]") != std::string::npos);
+
+	// without limits the out-of-order data is kept until the connection is closed
+	TcpReassemblyMultipleConnStats results;
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::Packet packet(&packetStream[i]);
+		tcpReassembly.reassemblePacket(packet);
+	}
+
+	// the 4 buffered segments take a pool block each
+	PTF_ASSERT_TRUE(tcpReassembly.getOutOfOrderBytes() > 4 * PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE);
+	PTF_ASSERT_TRUE(tcpReassembly.getOutOfOrderBytes() < 5 * PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE);
+	PTF_ASSERT_TRUE(results.stats.begin()->second.reassembledData.find("bytes missing]") == std::string::npos);
+	tcpReassembly.closeAllConnections();
+	PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderBytes(), 0, size);
+	PTF_ASSERT_EQUAL(expectedReassemblyData, results.stats.begin()->second.reassembledData, string);
+
+	// a per-connection limit and a global limit give up on the missing data as soon as they're exceeded, without closing the connection
+	pcpp::TcpReassemblyConfiguration limitConfigs[] = {
+		pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 0, 5000, 0),
+		pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 0, 0, 5000)
+	};
+
+	for (int configIndex = 0; configIndex < 2; configIndex++)
+	{
+		results.clear();
+		pcpp::TcpReassembly limitedTcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, limitConfigs[configIndex]);
+		for (size_t i = 0; i < packetStream.size(); i++)
+		{
+			pcpp::Packet packet(&packetStream[i]);
+			limitedTcpReassembly.reassemblePacket(packet);
+			PTF_ASSERT_TRUE(limitedTcpReassembly.getOutOfOrderBytes() <= 5000);
+		}
+
+		PTF_ASSERT_EQUAL(limitedTcpReassembly.getOutOfOrderBytes(), 0, size);
+		PTF_ASSERT_FALSE(results.stats.begin()->second.connectionsEndedManually);
+		PTF_ASSERT_EQUAL(expectedReassemblyData, results.stats.begin()->second.reassembledData, string);
+	}
+
+	// limits which are never exceeded don't change anything
+	results.clear();
+	tcpReassemblyTest(packetStream, results, true, true, pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 0, 100000, 100000));
+	PTF_ASSERT_EQUAL(expectedReassemblyData, results.stats.begin()->second.reassembledData, string);
+	PTF_ASSERT_EQUAL(referenceResults.stats.begin()->second.numOfDataPackets, results.stats.begin()->second.numOfDataPackets, int);
+} // TestTcpReassemblyOOOLimits
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyOOOSmallSegs)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+
+	// replace a packet of the response with many 1 byte segments with a gap before each of them, so every segment is buffered as a separate
+	// out-of-order fragment. Their data is far below the limits but the pool memory they take isn't
+	const int numOfSegments = 600;
+	std::vector<pcpp::RawPacket> smallSegments;
+	for (int i = 1; i <= numOfSegments; i++)
+		smallSegments.push_back(tcpReassemblyAddRetransmissions(packetStream[28], 2 * i, 1));
+	packetStream.erase(packetStream.begin() + 28, packetStream.end());
+	packetStream.insert(packetStream.end(), smallSegments.begin(), smallSegments.end());
+
+	const size_t limit = 8 * PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE;
+	pcpp::TcpReassemblyConfiguration limitConfigs[] = {
+		pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 0, limit, 0),
+		pcpp::TcpReassemblyConfiguration(true, 5, 30, false, 0, 0, 0, limit)
+	};
+
+	for (int configIndex = 0; configIndex < 2; configIndex++)
+	{
+		TcpReassemblyMultipleConnStats results;
+		pcpp::TcpReassembly tcpReassembly(tcpReassemblyMsgReadyCallback, &results, tcpReassemblyConnectionStartCallback, tcpReassemblyConnectionEndCallback, limitConfigs[configIndex]);
+		for (size_t i = 0; i < packetStream.size(); i++)
+		{
+			pcpp::Packet packet(&packetStream[i]);
+			tcpReassembly.reassemblePacket(packet);
+			PTF_ASSERT_TRUE(tcpReassembly.getOutOfOrderBytes() <= limit);
+
+			// even the first 1 byte segment takes a whole block
+			if (i == 28)
+				PTF_ASSERT_TRUE(tcpReassembly.getOutOfOrderBytes() > PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE);
+		}
+
+		// most of the segments were given up on before the connection is closed
+		std::string reassembledData = results.stats.begin()->second.reassembledData;
+		PTF_ASSERT_TRUE(tcpReassembly.getOutOfOrderBytes() > 0);
+		size_t numOfBuffered = tcpReassembly.getOutOfOrderBytes() / PCPP_TCP_REASSEMBLY_FRAGMENT_BLOCK_SIZE;
+		size_t numOfMissingMarkers = 0;
+		for (size_t pos = reassembledData.find("[1 bytes missing]"); pos != std::string::npos; pos = reassembledData.find("[1 bytes missing]", pos + 1))
+			numOfMissingMarkers++;
+		PTF_ASSERT_TRUE(numOfMissingMarkers + numOfBuffered >= numOfSegments - 1);
+		PTF_ASSERT_TRUE(numOfBuffered < 8);
+
+		tcpReassembly.closeAllConnections();
+		PTF_ASSERT_EQUAL(tcpReassembly.getOutOfOrderBytes(), 0, size);
+	}
+} // TestTcpReassemblyOOOSmallSegs
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// tcpReassemblyZeroCopyMsgReadyCallback()
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+struct TcpReassemblyZeroCopyStats
+{
+	const pcpp::RawPacket* curPacket;
+	int numOfDataInPacket;
+	int numOfDataNotInPacket;
+	std::string reassembledData;
+
+	TcpReassemblyZeroCopyStats() : curPacket(NULL), numOfDataInPacket(0), numOfDataNotInPacket(0) {}
+};
+
+static void tcpReassemblyZeroCopyMsgReadyCallback(int sideIndex, const pcpp::TcpStreamData& tcpData, void* userCookie)
+{
+	TcpReassemblyZeroCopyStats* stats = (TcpReassemblyZeroCopyStats*)userCookie;
+
+	const uint8_t* packetStart = stats->curPacket->getRawData();
+	const uint8_t* packetEnd = packetStart + stats->curPacket->getRawDataLen();
+	if (tcpData.getData() >= packetStart && tcpData.getData() + tcpData.getDataLength() <= packetEnd)
+		stats->numOfDataInPacket++;
+	else
+		stats->numOfDataNotInPacket++;
+
+	stats->reassembledData += std::string((char*)tcpData.getData(), tcpData.getDataLength());
+}
+
+
+
+PTF_TEST_CASE(TestTcpReassemblyZeroCopy)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/one_tcp_stream.pcap", packetStream, errMsg));
+
+	// data that arrives in order points into the packet that carried it
+	TcpReassemblyZeroCopyStats stats;
+	pcpp::TcpReassembly tcpReassembly(tcpReassemblyZeroCopyMsgReadyCallback, &stats);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		stats.curPacket = &packetStream[i];
+		pcpp::Packet packet(&packetStream[i]);
+		tcpReassembly.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(stats.numOfDataInPacket, 19, int);
+	PTF_ASSERT_EQUAL(stats.numOfDataNotInPacket, 0, int);
+	std::string expectedReassemblyData = readFileIntoString(std::string("PcapExamples/one_tcp_stream_output.txt"));
+	PTF_ASSERT_EQUAL(expectedReassemblyData, stats.reassembledData, string);
+
+	// only the data that was queued out-of-order is sent from TcpReassembly's own memory
+	std::swap(packetStream[9], packetStream[10]);
+	TcpReassemblyZeroCopyStats oooStats;
+	pcpp::TcpReassembly oooTcpReassembly(tcpReassemblyZeroCopyMsgReadyCallback, &oooStats);
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		oooStats.curPacket = &packetStream[i];
+		pcpp::Packet packet(&packetStream[i]);
+		oooTcpReassembly.reassemblePacket(packet);
+	}
+
+	PTF_ASSERT_EQUAL(oooStats.numOfDataInPacket, 18, int);
+	PTF_ASSERT_EQUAL(oooStats.numOfDataNotInPacket, 1, int);
+	PTF_ASSERT_EQUAL(expectedReassemblyData, oooStats.reassembledData, string);
+} // TestTcpReassemblyZeroCopy
+
+
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// shardedTcpReassembly callbacks - each shard writes only to its own results so no lock is needed
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+static void shardedTcpReassemblyMsgReadyCallback(int side, const pcpp::TcpStreamData& tcpData, int shardIndex, void* userCookie)
+{
+	tcpReassemblyMsgReadyCallback(side, tcpData, &((std::vector<TcpReassemblyMultipleConnStats>*)userCookie)->at(shardIndex));
+}
+
+static void shardedTcpReassemblyConnectionStartCallback(const pcpp::ConnectionData& connectionData, int shardIndex, void* userCookie)
+{
+	tcpReassemblyConnectionStartCallback(connectionData, &((std::vector<TcpReassemblyMultipleConnStats>*)userCookie)->at(shardIndex));
+}
+
+static void shardedTcpReassemblyConnectionEndCallback(const pcpp::ConnectionData& connectionData, pcpp::TcpReassembly::ConnectionEndReason reason, int shardIndex, void* userCookie)
+{
+	tcpReassemblyConnectionEndCallback(connectionData, reason, &((std::vector<TcpReassemblyMultipleConnStats>*)userCookie)->at(shardIndex));
+}
+
+struct ShardedTcpReassemblyReentrantCookie
+{
+	pcpp::ShardedTcpReassembly* shardedTcpReassembly;
+	int numOfMessages;
+	int numOfRefusedCommands;
+};
+
+static void shardedTcpReassemblyReentrantMsgReadyCallback(int side, const pcpp::TcpStreamData& tcpData, int shardIndex, void* userCookie)
+{
+	// commands wait for all shards, so calling them from a shard's thread must be refused rather than wait for the calling thread itself
+	ShardedTcpReassemblyReentrantCookie* cookie = (ShardedTcpReassemblyReentrantCookie*)userCookie;
+	cookie->numOfMessages++;
+	if (!cookie->shardedTcpReassembly->flush())
+		cookie->numOfRefusedCommands++;
+	if (!cookie->shardedTcpReassembly->closeAllConnections())
+		cookie->numOfRefusedCommands++;
+}
+
+struct ShardedTcpReassemblyProducer
+{
+	pcpp::ShardedTcpReassembly* shardedTcpReassembly;
+	std::vector<pcpp::RawPacket>* packetStream;
+	size_t producerIndex;
+	int numOfPacketsQueued;
+	bool flushed;
+};
+
+static void* shardedTcpReassemblyProducerMain(void* producerPtr)
+{
+	ShardedTcpReassemblyProducer* producer = (ShardedTcpReassemblyProducer*)producerPtr;
+	size_t numOfProducers = producer->shardedTcpReassembly->getNumOfProducers();
+
+	// like with RSS queues, all packets of a connection are fed by the same producer
+	for (size_t i = 0; i < producer->packetStream->size(); i++)
+	{
+		const pcpp::RawPacket* rawPacket = &producer->packetStream->at(i);
+		if (pcpp::FlowKey::fromRawPacket(rawPacket).getIPPairKey().hash() % numOfProducers != producer->producerIndex)
+			continue;
+
+		if (producer->shardedTcpReassembly->reassemblePacket(rawPacket, producer->producerIndex))
+			producer->numOfPacketsQueued++;
+	}
+
+	// the producers flush at the same time, which the commands are serialized for
+	producer->flushed = producer->shardedTcpReassembly->flush();
+	return NULL;
+}
+
+
+
+PTF_TEST_CASE(TestTcpReassemblySharded)
+{
+	std::string errMsg;
+	std::vector<pcpp::RawPacket> packetStream;
+
+	PTF_ASSERT_TRUE(readPcapIntoPacketVec("PcapExamples/example.pcap", packetStream, errMsg));
+
+	TcpReassemblyMultipleConnStats referenceResults;
+	tcpReassemblyTest(packetStream, referenceResults, true, true);
+	PTF_ASSERT_TRUE(referenceResults.stats.size() > 10);
+
+	const int numOfShards = 4;
+	const size_t numOfProducers = 2;
+	std::vector<TcpReassemblyMultipleConnStats> shardResults(numOfShards);
+
+	// small rings so the producers also have to wait for the shards
+	pcpp::ShardedTcpReassemblyConfiguration config(numOfShards, numOfProducers, 16);
+	pcpp::ShardedTcpReassembly shardedTcpReassembly(shardedTcpReassemblyMsgReadyCallback, &shardResults, shardedTcpReassemblyConnectionStartCallback, shardedTcpReassemblyConnectionEndCallback, config);
+	PTF_ASSERT_EQUAL(shardedTcpReassembly.getNumOfShards(), numOfShards, int);
+
+	// packets can't be queued before the shards are started
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_FALSE(shardedTcpReassembly.reassemblePacket(&packetStream[0]));
+	PTF_ASSERT_TRUE(shardedTcpReassembly.start());
+	PTF_ASSERT_FALSE(shardedTcpReassembly.start());
+	PTF_ASSERT_TRUE(shardedTcpReassembly.isRunning());
+	PTF_ASSERT_FALSE(shardedTcpReassembly.reassemblePacket(&packetStream[0], numOfProducers));
+	pcpp::LoggerPP::getInstance().enableErrors();
+
+	ShardedTcpReassemblyProducer producers[numOfProducers];
+	pthread_t producerThreads[numOfProducers];
+	for (size_t i = 0; i < numOfProducers; i++)
+	{
+		producers[i].shardedTcpReassembly = &shardedTcpReassembly;
+		producers[i].packetStream = &packetStream;
+		producers[i].producerIndex = i;
+		producers[i].numOfPacketsQueued = 0;
+		producers[i].flushed = false;
+		PTF_ASSERT_EQUAL(pthread_create(&producerThreads[i], NULL, shardedTcpReassemblyProducerMain, &producers[i]), 0, int);
+	}
+
+	for (size_t i = 0; i < numOfProducers; i++)
+		pthread_join(producerThreads[i], NULL);
+
+	PTF_ASSERT_TRUE(producers[0].flushed);
+	PTF_ASSERT_TRUE(producers[1].flushed);
+	PTF_ASSERT_TRUE(shardedTcpReassembly.closeAllConnections());
+
+	PTF_ASSERT_EQUAL(producers[0].numOfPacketsQueued + producers[1].numOfPacketsQueued, (int)packetStream.size(), int);
+
+	// every connection is reassembled by exactly one shard, which is the shard its packets are steered to, exactly as by a single TcpReassembly
+	TcpReassemblyMultipleConnStats::Stats mergedStats;
+	for (int shardIndex = 0; shardIndex < numOfShards; shardIndex++)
+	{
+		TcpReassemblyMultipleConnStats::Stats& stats = shardResults[shardIndex].stats;
+		for (TcpReassemblyMultipleConnStats::Stats::iterator iter = stats.begin(); iter != stats.end(); iter++)
+		{
+			PTF_ASSERT_TRUE(mergedStats.insert(*iter).second);
+		}
+	}
+
+	for (size_t i = 0; i < packetStream.size(); i++)
+	{
+		pcpp::FlowKey flowKey = pcpp::FlowKey::fromRawPacket(&packetStream[i]);
+		int shardIndex = shardedTcpReassembly.getShardIndex(&packetStream[i]);
+		if (flowKey.getProtocol() == pcpp::PACKETPP_IPPROTO_TCP && referenceResults.stats.find(flowKey) != referenceResults.stats.end())
+		{
+			PTF_ASSERT_TRUE(shardResults[shardIndex].stats.find(flowKey) != shardResults[shardIndex].stats.end());
+		}
+	}
+
+	PTF_ASSERT_EQUAL(mergedStats.size(), referenceResults.stats.size(), size);
+	int numOfShardsWithConnections = 0;
+	for (int shardIndex = 0; shardIndex < numOfShards; shardIndex++)
+	{
+		if (!shardResults[shardIndex].stats.empty())
+			numOfShardsWithConnections++;
+	}
+	PTF_ASSERT_TRUE(numOfShardsWithConnections > 1);
+
+	for (TcpReassemblyMultipleConnStats::Stats::iterator iter = referenceResults.stats.begin(); iter != referenceResults.stats.end(); iter++)
+	{
+		TcpReassemblyMultipleConnStats::Stats::iterator shardedIter = mergedStats.find(iter->first);
+		PTF_ASSERT_TRUE(shardedIter != mergedStats.end());
+		PTF_ASSERT_EQUAL(iter->second.reassembledData, shardedIter->second.reassembledData, string);
+		PTF_ASSERT_EQUAL(iter->second.numOfDataPackets, shardedIter->second.numOfDataPackets, int);
+		PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[0], shardedIter->second.numOfMessagesFromSide[0], int);
+		PTF_ASSERT_EQUAL(iter->second.numOfMessagesFromSide[1], shardedIter->second.numOfMessagesFromSide[1], int);
+		PTF_ASSERT_EQUAL(iter->second.connectionsStarted, shardedIter->second.connectionsStarted, int);
+		PTF_ASSERT_EQUAL(iter->second.connectionsEnded, shardedIter->second.connectionsEnded, int);
+		PTF_ASSERT_EQUAL(iter->second.connectionsEndedManually, shardedIter->second.connectionsEndedManually, int);
+	}
+
+	// per-shard stats add up to the whole stream
+	pcpp::TcpReassemblyShardStats totalStats;
+	shardedTcpReassembly.getTotalStats(totalStats);
+	PTF_ASSERT_EQUAL(totalStats.packetsQueued, (uint64_t)packetStream.size(), u64);
+	PTF_ASSERT_EQUAL(totalStats.packetsProcessed, (uint64_t)packetStream.size(), u64);
+	PTF_ASSERT_EQUAL(totalStats.packetsDropped, 0, u64);
+	PTF_ASSERT_EQUAL(totalStats.connectionsStarted, totalStats.connectionsEnded, u64);
+	PTF_ASSERT_EQUAL(totalStats.tcpMessagesHandled + totalStats.outOfOrderPackets + totalStats.nonTcpPackets + totalStats.ignoredPackets, totalStats.packetsProcessed, u64);
+
+	uint64_t numOfDataPackets = 0;
+	for (TcpReassemblyMultipleConnStats::Stats::iterator iter = referenceResults.stats.begin(); iter != referenceResults.stats.end(); iter++)
+		numOfDataPackets += iter->second.numOfDataPackets;
+	PTF_ASSERT_EQUAL(totalStats.messagesDelivered, numOfDataPackets, u64);
+
+	for (int shardIndex = 0; shardIndex < numOfShards; shardIndex++)
+	{
+		pcpp::TcpReassemblyShardStats shardStats;
+		shardedTcpReassembly.getShardStats(shardIndex, shardStats);
+		PTF_ASSERT_EQUAL(shardStats.connectionsStarted, (uint64_t)shardResults[shardIndex].flowKeysList.size(), u64);
+	}
+
+	shardedTcpReassembly.stop();
+	PTF_ASSERT_FALSE(shardedTcpReassembly.isRunning());
+
+	// commands called from the callbacks are refused instead of waiting forever. A single shard is used so the cookie is updated by one thread
+	ShardedTcpReassemblyReentrantCookie reentrantCookie;
+	reentrantCookie.numOfMessages = 0;
+	reentrantCookie.numOfRefusedCommands = 0;
+	pcpp::ShardedTcpReassembly reentrantTcpReassembly(shardedTcpReassemblyReentrantMsgReadyCallback, &reentrantCookie, NULL, NULL, pcpp::ShardedTcpReassemblyConfiguration(1));
+	reentrantCookie.shardedTcpReassembly = &reentrantTcpReassembly;
+	pcpp::LoggerPP::getInstance().supressErrors();
+	PTF_ASSERT_TRUE(reentrantTcpReassembly.start());
+	for (size_t i = 0; i < 100; i++)
+	{
+		PTF_ASSERT_TRUE(reentrantTcpReassembly.reassemblePacket(&packetStream[i]));
+	}
+
+	PTF_ASSERT_TRUE(reentrantTcpReassembly.flush());
+	reentrantTcpReassembly.stop();
+	pcpp::LoggerPP::getInstance().enableErrors();
+	PTF_ASSERT_TRUE(reentrantCookie.numOfMessages > 0);
+	PTF_ASSERT_EQUAL(reentrantCookie.numOfRefusedCommands, 2 * reentrantCookie.numOfMessages, int);
+} // TestTcpReassemblySharded
\ No newline at end of file
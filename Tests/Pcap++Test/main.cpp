@@ -198,6 +198,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestIPAddress, "no_network;ip");
 	PTF_RUN_TEST(TestMacAddress, "no_network;mac");
 	PTF_RUN_TEST(TestLRUList, "no_network");
+	PTF_RUN_TEST(TestTimerWheel, "no_network");
 	PTF_RUN_TEST(TestGeneralUtils, "no_network");
 	PTF_RUN_TEST(TestGetMacAddress, "mac");
 
@@ -228,6 +229,7 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestHttpResponseParsing, "no_network;http");
 	PTF_RUN_TEST(TestPrintPacketAndLayers, "no_network;print");
 	PTF_RUN_TEST(TestDnsParsing, "no_network;dns");
+	PTF_RUN_TEST(TestPacketConcurrentClones, "no_network;packet;skip_mem_leak_check");
 
 	PTF_RUN_TEST(TestPfRingDevice, "pf_ring");
 	PTF_RUN_TEST(TestPfRingDeviceSingleChannel, "pf_ring");
@@ -259,6 +261,13 @@ int main(int argc, char* argv[])
 	PTF_RUN_TEST(TestTcpReassemblyIPv6_OOO, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyCleanup, "no_network;tcp_reassembly");
 	PTF_RUN_TEST(TestTcpReassemblyMaxSeq, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyInnerTuple, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyIdleTimeout, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyAdvanceTime, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyOOOLimits, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyOOOSmallSegs, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblyZeroCopy, "no_network;tcp_reassembly");
+	PTF_RUN_TEST(TestTcpReassemblySharded, "no_network;tcp_reassembly;skip_mem_leak_check");
 
 	PTF_RUN_TEST(TestIPFragmentationSanity, "no_network;ip_frag");
 	PTF_RUN_TEST(TestIPFragOutOfOrder, "no_network;ip_frag");